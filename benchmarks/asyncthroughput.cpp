@@ -0,0 +1,115 @@
+/**
+ * @file asyncthroughput.cpp
+ * @brief Throughput of blocking sendPostRequest() threads against one AsyncNetworkAdapter loop
+ *        at 1, 64 and 1024 concurrent calls.
+ *
+ * Usage: benchmark-async-throughput [response delay in ms, default 2]
+ */
+#include "benchnode.hpp"
+#include "asyncnetworkadapter.hpp"
+#include "networkadapter.hpp"
+#include <iostream>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view kRequest = R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})";
+
+/**
+ * @brief Runs @p calls blocking calls spread over @p concurrency threads; returns calls per second.
+ */
+double blockingThroughput(const std::string& url, std::size_t concurrency, std::size_t calls) {
+    NetworkAdapterOptions options;
+    options.maxHandlesPerEndpoint = concurrency;
+    NetworkAdapter adapter(options);
+    std::atomic<std::size_t> failures {0};
+    const std::string request(kRequest);
+
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < concurrency; ++t) {
+        threads.emplace_back([&, share = calls / concurrency]() {
+            for (std::size_t i = 0; i < share; ++i) {
+                if (!adapter.sendPostRequest(url, request)) {
+                    failures.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (failures.load() > 0) {
+        std::cerr << failures.load() << " blocking calls failed" << std::endl;
+    }
+    return static_cast<double>(calls / concurrency * concurrency) / seconds;
+}
+
+/**
+ * @brief Keeps @p concurrency calls in flight on one event loop until @p calls completed; returns calls per second.
+ */
+double asyncThroughput(const std::string& url, std::size_t concurrency, std::size_t calls) {
+    AsyncNetworkAdapterOptions options;
+    options.maxConnectionsPerHost = concurrency;
+    AsyncNetworkAdapter adapter(options);
+    const std::string request(kRequest);
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t started = 0;
+    std::size_t completed = 0;
+    std::size_t failures = 0;
+    std::function<void()> launch;
+    launch = [&]() {
+        adapter.sendPostRequestAsync(url, request, [&](std::optional<std::string> response) {
+            bool next = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                failures += response ? 0 : 1;
+                ++completed;
+                if (started < calls) {
+                    ++started;
+                    next = true;
+                }
+                if (completed == calls) {
+                    finished.notify_one();
+                }
+            }
+            if (next) {
+                launch();
+            }
+        });
+    };
+
+    const auto start = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = std::min(concurrency, calls);
+    }
+    for (std::size_t i = 0; i < std::min(concurrency, calls); ++i) {
+        launch();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return completed == calls; });
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (failures > 0) {
+        std::cerr << failures << " async calls failed" << std::endl;
+    }
+    return static_cast<double>(calls) / seconds;
+}
+}
+
+int main(int argc, char** argv) {
+    const std::chrono::milliseconds delay(argc > 1 ? std::atoi(argv[1]) : 2);
+    BenchNode node({}, BenchNodeOptions {.responseDelay = delay});
+    std::cout << "eth_blockNumber against a stand-in node answering after " << delay.count() << " ms\n";
+    std::cout << "concurrency  blocking threads (calls/s)  async loop (calls/s)\n";
+    for (const std::size_t concurrency : {1, 64, 1024}) {
+        const std::size_t calls = std::max<std::size_t>(500, concurrency * 10);
+        const double blocking = blockingThroughput(node.url(), concurrency, calls);
+        const double async = asyncThroughput(node.url(), concurrency, calls);
+        std::printf("%11zu  %26.0f  %20.0f\n", concurrency, blocking, async);
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "benchnode.hpp"
+#include "jsonscan.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Reads the Content-Length of a request head, or 0 if it has none.
+ */
+std::size_t contentLength(std::string_view head) {
+    constexpr std::string_view name = "content-length:";
+    for (std::size_t line = 0; line < head.size();) {
+        const std::size_t end = std::min(head.find("\r\n", line), head.size());
+        const std::string_view text = head.substr(line, end - line);
+        if (text.size() > name.size()) {
+            bool match = true;
+            for (std::size_t i = 0; i < name.size() && match; ++i) {
+                match = std::tolower(static_cast<unsigned char>(text[i])) == name[i];
+            }
+            if (match) {
+                return std::strtoull(std::string(text.substr(name.size())).c_str(), nullptr, 10);
+            }
+        }
+        line = end + 2;
+    }
+    return 0;
+}
+}
+
+struct BenchNode::Connection {
+    int fd = -1;
+    Clock::time_point openedAt = Clock::now();
+    Clock::time_point activeAt = Clock::now(); ///< When the last request arrived or response was sent.
+    std::string in;   ///< Bytes received and not yet parsed.
+    std::string out;  ///< Bytes ready to be written.
+    std::size_t written = 0; ///< Bytes of out already written.
+    std::deque<std::pair<Clock::time_point, std::string>> scheduled; ///< Responses waiting for their delay, in order.
+};
+
+std::string benchResponse(std::string_view request, std::string_view result) {
+    const std::optional<JsonSpan> span = findMemberSpan(request, "id");
+    const std::string_view id = span ? request.substr(span->begin, span->end - span->begin) : std::string_view("null");
+    std::string body;
+    body.reserve(40 + id.size() + result.size());
+    body.append(R"({"jsonrpc":"2.0","id":)").append(id).append(R"(,"result":)").append(result).push_back('}');
+    return body;
+}
+
+BenchNode::BenchNode(Responder responder, BenchNodeOptions options)
+    : responder(responder ? std::move(responder) : [](std::string_view request) { return benchResponse(request, "\"0x10\""); }),
+      options(options) {
+    listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (listener < 0 || wakeup < 0
+        || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listener, 4096) != 0
+        || getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        throw std::runtime_error("BenchNode cannot listen on 127.0.0.1");
+    }
+    port = ntohs(address.sin_port);
+    loop = std::thread([this]() { run(); });
+}
+
+BenchNode::~BenchNode() {
+    const std::uint64_t one = 1;
+    (void)!write(wakeup, &one, sizeof(one));
+    loop.join();
+    close(listener);
+    close(wakeup);
+}
+
+std::string BenchNode::url() const {
+    return "http://127.0.0.1:" + std::to_string(port);
+}
+
+std::uint64_t BenchNode::connectionsAccepted() const {
+    return accepted.load();
+}
+
+void BenchNode::run() {
+    const int poller = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event);
+    event.data.ptr = &wakeup;
+    epoll_ctl(poller, EPOLL_CTL_ADD, wakeup, &event);
+
+    std::unordered_map<int, Scope<Connection>> connections;
+    std::vector<epoll_event> events(256);
+    std::vector<char> buffer(1 << 16);
+
+    const auto closeConnection = [&](Connection* connection) {
+        epoll_ctl(poller, EPOLL_CTL_DEL, connection->fd, nullptr);
+        close(connection->fd);
+        connections.erase(connection->fd);
+    };
+
+    // Moves due responses to the output and writes as much as the socket takes.
+    const auto flush = [&](Connection* connection, Clock::time_point now) {
+        while (!connection->scheduled.empty() && connection->scheduled.front().first <= now) {
+            const std::string& body = connection->scheduled.front().second;
+            connection->out.append("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: ");
+            connection->out.append(std::to_string(body.size())).append("\r\n\r\n").append(body);
+            connection->scheduled.pop_front();
+        }
+        while (connection->written < connection->out.size()) {
+            const ssize_t sent = send(connection->fd, connection->out.data() + connection->written,
+                                      connection->out.size() - connection->written, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                break;
+            }
+            connection->written += static_cast<std::size_t>(sent);
+        }
+        if (connection->written == connection->out.size()) {
+            connection->out.clear();
+            connection->written = 0;
+        }
+        epoll_event interest {};
+        interest.events = EPOLLIN | (connection->out.empty() ? 0u : static_cast<unsigned>(EPOLLOUT));
+        interest.data.ptr = connection;
+        epoll_ctl(poller, EPOLL_CTL_MOD, connection->fd, &interest);
+    };
+
+    for (;;) {
+        // Sleep until the earliest scheduled response is due or the earliest idle connection expires.
+        const Clock::time_point now = Clock::now();
+        int timeout = -1;
+        const auto wakeAt = [&](Clock::time_point due) {
+            const auto wait = static_cast<int>(std::max<long long>(std::chrono::ceil<std::chrono::milliseconds>(due - now).count(), 0));
+            timeout = timeout < 0 ? wait : std::min(timeout, wait);
+        };
+        for (const auto& [fd, connection] : connections) {
+            if (!connection->scheduled.empty()) {
+                wakeAt(connection->scheduled.front().first);
+            } else if (options.idleTimeout.count() > 0 && connection->out.empty()) {
+                wakeAt(connection->activeAt + options.idleTimeout);
+            }
+        }
+        const int ready = epoll_wait(poller, events.data(), static_cast<int>(events.size()), timeout);
+        for (int i = 0; i < ready; ++i) {
+            void* tag = events[i].data.ptr;
+            if (tag == &wakeup) {
+                for (auto& [fd, connection] : connections) {
+                    close(fd);
+                }
+                close(poller);
+                return;
+            }
+            if (tag == nullptr) {
+                for (int fd; (fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0;) {
+                    const int on = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                    auto connection = CreateScope<Connection>();
+                    connection->fd = fd;
+                    epoll_event interest {};
+                    interest.events = EPOLLIN;
+                    interest.data.ptr = connection.get();
+                    epoll_ctl(poller, EPOLL_CTL_ADD, fd, &interest);
+                    connections.emplace(fd, std::move(connection));
+                    accepted.fetch_add(1);
+                }
+                continue;
+            }
+
+            auto* connection = static_cast<Connection*>(tag);
+            if (events[i].events & EPOLLIN) {
+                bool closed = false;
+                for (;;) {
+                    const ssize_t received = recv(connection->fd, buffer.data(), buffer.size(), 0);
+                    if (received > 0) {
+                        connection->in.append(buffer.data(), static_cast<std::size_t>(received));
+                        continue;
+                    }
+                    closed = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                    break;
+                }
+                // Answer every complete request, in order.
+                for (;;) {
+                    const std::size_t headEnd = connection->in.find("\r\n\r\n");
+                    if (headEnd == std::string::npos) {
+                        break;
+                    }
+                    const std::size_t length = contentLength(std::string_view(connection->in).substr(0, headEnd));
+                    if (connection->in.size() < headEnd + 4 + length) {
+                        break;
+                    }
+                    const Clock::time_point due = std::max(Clock::now() + options.responseDelay,
+                                                           connection->openedAt + options.connectDelay);
+                    connection->scheduled.emplace_back(due, responder(std::string_view(connection->in).substr(headEnd + 4, length)));
+                    connection->in.erase(0, headEnd + 4 + length);
+                    connection->activeAt = Clock::now();
+                }
+                if (closed) {
+                    closeConnection(connection);
+                    continue;
+                }
+            }
+            flush(connection, Clock::now());
+        }
+
+        const Clock::time_point after = Clock::now();
+        std::vector<Connection*> idle;
+        for (auto& [fd, connection] : connections) {
+            if (!connection->scheduled.empty() && connection->scheduled.front().first <= after) {
+                flush(connection.get(), after);
+                connection->activeAt = after;
+            } else if (options.idleTimeout.count() > 0 && connection->scheduled.empty() && connection->out.empty()
+                       && connection->activeAt + options.idleTimeout <= after) {
+                idle.push_back(connection.get());
+            }
+        }
+        for (Connection* connection : idle) {
+            closeConnection(connection);
+        }
+    }
+}
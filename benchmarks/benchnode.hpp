@@ -0,0 +1,80 @@
+#ifndef BENCHNODE_HPP
+#define BENCHNODE_HPP
+
+#include "common.hpp"
+
+/**
+ * @struct BenchNodeOptions
+ * @brief Latencies a BenchNode adds, standing in for a real node and network.
+ */
+struct BenchNodeOptions {
+    std::chrono::milliseconds responseDelay {0}; ///< Added before every response, standing in for the node's processing time.
+    std::chrono::milliseconds connectDelay {0};  ///< Added before the first response on a new connection, standing in for TCP and TLS handshakes.
+    std::chrono::milliseconds idleTimeout {0};   ///< Closes connections idle for this long, as nodes and proxies do; 0 never closes them.
+};
+
+/**
+ * @class BenchNode
+ * @brief In-process HTTP/1.1 JSON-RPC stand-in node for benchmarks.
+ *
+ * Listens on an ephemeral 127.0.0.1 port and serves every connection from
+ * one epoll thread. Connections are kept alive and requests may be
+ * pipelined; bodies are answered with Content-Length, in order.
+ */
+class BenchNode {
+public:
+    /**
+     * @brief Produces the response body for a request body.
+     */
+    using Responder = std::function<std::string(std::string_view request)>;
+
+    /**
+     * @brief Starts listening.
+     * @param responder Answers requests; when empty, every request gets "result":"0x10" with its own id.
+     * @param options Latencies to add.
+     */
+    explicit BenchNode(Responder responder = {}, BenchNodeOptions options = {});
+
+    /**
+     * @brief Stops the server thread and closes every connection.
+     */
+    ~BenchNode();
+
+    BenchNode(const BenchNode&) = delete;
+    BenchNode& operator=(const BenchNode&) = delete;
+
+    /**
+     * @brief Retrieves the node's URL, e.g. "http://127.0.0.1:40123".
+     */
+    std::string url() const;
+
+    /**
+     * @brief Retrieves the number of connections accepted so far.
+     */
+    std::uint64_t connectionsAccepted() const;
+
+private:
+    struct Connection;
+
+    /**
+     * @brief Runs the event loop until the destructor signals it.
+     */
+    void run();
+
+    Responder responder;     ///< Answers requests.
+    BenchNodeOptions options; ///< Added latencies.
+    int listener = -1;       ///< Listening socket.
+    int wakeup = -1;         ///< eventfd that stops the loop.
+    int port = 0;            ///< Port the listener is bound to.
+    std::atomic<std::uint64_t> accepted {0}; ///< Connections accepted.
+    std::thread loop;        ///< The event-loop thread.
+};
+
+/**
+ * @brief Answers a JSON-RPC request object with a fixed result and the request's own id.
+ * @param request The request body.
+ * @param result The result as JSON text.
+ */
+std::string benchResponse(std::string_view request, std::string_view result);
+
+#endif // BENCHNODE_HPP
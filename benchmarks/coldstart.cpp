@@ -0,0 +1,88 @@
+/**
+ * @file coldstart.cpp
+ * @brief Time to the first successful eth_blockNumber of a fresh NetworkAdapter, with and without warmup(),
+ *        and after the connections sat idle.
+ *
+ * The stand-in node adds a delay to the first response on every new connection,
+ * standing in for the TCP and TLS handshakes, and closes connections idle for 2.5 s.
+ *
+ * Usage: benchmark-cold-start [connect delay in ms, default 40]
+ */
+#include "benchnode.hpp"
+#include "ethereumclient.hpp"
+#include "networkadapter.hpp"
+#include <iostream>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kBurst = 4;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Times one call, then a burst of kBurst concurrent calls; returns both in milliseconds.
+ */
+std::pair<double, double> firstCalls(EthereumClient& client) {
+    auto start = Clock::now();
+    if (!client.getBlockNumber()) {
+        std::cerr << "first call failed" << std::endl;
+    }
+    const double first = millisecondsSince(start);
+
+    start = Clock::now();
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < kBurst; ++i) {
+        threads.emplace_back([&client]() {
+            if (!client.getBlockNumber()) {
+                std::cerr << "burst call failed" << std::endl;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return {first, millisecondsSince(start)};
+}
+
+void report(const char* scenario, std::pair<double, double> times) {
+    std::printf("%-34s %8.1f ms  %8.1f ms\n", scenario, times.first, times.second);
+}
+}
+
+int main(int argc, char** argv) {
+    const std::chrono::milliseconds connectDelay(argc > 1 ? std::atoi(argv[1]) : 40);
+    const BenchNodeOptions nodeOptions {.connectDelay = connectDelay, .idleTimeout = std::chrono::milliseconds(2500)};
+    std::cout << "Stand-in node adding " << connectDelay.count() << " ms to new connections\n";
+    std::printf("%-34s %11s  %11s\n", "scenario", "first call", "burst of 4");
+
+    {
+        BenchNode node({}, nodeOptions);
+        NetworkAdapter adapter;
+        EthereumClient client(node.url(), adapter);
+        report("cold", firstCalls(client));
+    }
+    {
+        BenchNode node({}, nodeOptions);
+        NetworkAdapter adapter;
+        EthereumClient client(node.url(), adapter);
+        const auto start = Clock::now();
+        adapter.warmup(node.url(), kBurst);
+        const double warmup = millisecondsSince(start);
+        report("after warmup(4)", firstCalls(client));
+        std::printf("%-34s %8.1f ms\n", "  (warmup itself)", warmup);
+    }
+    for (const auto interval : {std::chrono::milliseconds(1000), std::chrono::milliseconds(0)}) {
+        BenchNode node({}, nodeOptions);
+        NetworkAdapterOptions options;
+        options.keepAliveInterval = interval;
+        NetworkAdapter adapter(options);
+        EthereumClient client(node.url(), adapter);
+        adapter.warmup(node.url(), kBurst);
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        report(interval.count() > 0 ? "after 5 s idle, keep-alive 1 s" : "after 5 s idle, keep-alive off", firstCalls(client));
+    }
+    return 0;
+}
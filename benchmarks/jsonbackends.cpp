@@ -0,0 +1,126 @@
+/**
+ * @file jsonbackends.cpp
+ * @brief Parse throughput of jsoncpp against SimdJsonBackend at each SIMD level, for a full block and a page of logs.
+ *
+ * Usage: benchmark-json-backends
+ */
+#include "ethereumclient.hpp"
+#include "loopbacktransport.hpp"
+#include "simdjsonbackend.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::mt19937_64 engine(7);
+
+std::string hex(std::size_t bytes) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string text = "\"0x";
+    for (std::size_t i = 0; i < bytes * 2; ++i) {
+        text += kDigits[engine() % 16];
+    }
+    return text + "\"";
+}
+
+/**
+ * @brief A block with full transactions, shaped like eth_getBlockByNumber(..., true) on mainnet.
+ */
+std::string blockDocument(std::size_t transactions) {
+    std::string text = "{\"baseFeePerGas\":" + hex(5) + ",\"difficulty\":\"0x0\",\"extraData\":" + hex(16)
+                       + ",\"gasLimit\":\"0x1c9c380\",\"gasUsed\":\"0x1036640\",\"hash\":" + hex(32) + ",\"logsBloom\":" + hex(256)
+                       + ",\"miner\":" + hex(20) + ",\"number\":\"0x112a880\",\"parentHash\":" + hex(32)
+                       + ",\"timestamp\":\"0x64f1c2a3\",\"transactions\":[";
+    for (std::size_t i = 0; i < transactions; ++i) {
+        text += i > 0 ? ",{\"accessList\":[" : "{\"accessList\":[";
+        for (std::size_t a = 0, entries = engine() % 3; a < entries; ++a) {
+            text += (a > 0 ? ",{\"address\":" : "{\"address\":") + hex(20) + ",\"storageKeys\":[" + hex(32) + "," + hex(32) + "]}";
+        }
+        text += "],\"blockHash\":" + hex(32) + ",\"blockNumber\":\"0x112a880\",\"chainId\":\"0x1\",\"from\":" + hex(20)
+                + ",\"gas\":" + hex(3) + ",\"gasPrice\":" + hex(5) + ",\"hash\":" + hex(32) + ",\"input\":" + hex(engine() % 600)
+                + ",\"maxFeePerGas\":" + hex(5) + ",\"maxPriorityFeePerGas\":" + hex(4) + ",\"nonce\":" + hex(2)
+                + ",\"r\":" + hex(32) + ",\"s\":" + hex(32) + ",\"to\":" + hex(20) + ",\"transactionIndex\":" + hex(1)
+                + ",\"type\":\"0x2\",\"v\":\"0x1\",\"value\":" + hex(8) + ",\"yParity\":\"0x1\"}";
+    }
+    return text + "],\"uncles\":[]}";
+}
+
+/**
+ * @brief A page of logs, shaped like an eth_getLogs result.
+ */
+std::string logsDocument(std::size_t logs) {
+    std::string text = "[";
+    for (std::size_t i = 0; i < logs; ++i) {
+        text += (i > 0 ? ",{\"address\":" : "{\"address\":") + hex(20) + ",\"blockHash\":" + hex(32)
+                + ",\"blockNumber\":\"0x112a880\",\"data\":" + hex(32 * (1 + engine() % 4)) + ",\"logIndex\":" + hex(2)
+                + ",\"removed\":false,\"topics\":[";
+        for (std::size_t t = 0, topics = 1 + engine() % 4; t < topics; ++t) {
+            text += (t > 0 ? "," : "") + hex(32);
+        }
+        text += "],\"transactionHash\":" + hex(32) + ",\"transactionIndex\":" + hex(1) + "}";
+    }
+    return text + "]";
+}
+
+/**
+ * @brief Runs @p work over @p document repeatedly, about 200 MB in total, and returns GB/s.
+ */
+template <typename Work>
+double throughput(const std::string& document, Work work) {
+    const std::size_t repetitions = std::max<std::size_t>(3, 200'000'000 / document.size());
+    work();
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < repetitions; ++i) {
+        work();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(document.size() * repetitions) / seconds / 1e9;
+}
+}
+
+int main() {
+    const std::pair<const char*, std::string> documents[] = {
+        {"full block, 200 transactions", blockDocument(200)},
+        {"eth_getLogs page, 10000 logs", logsDocument(10000)},
+    };
+    std::vector<Ref<JsonBackend>> backends = {JsoncppBackend::shared()};
+    for (const SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2}) {
+        if (level <= SimdJsonBackend::detectLevel()) {
+            backends.push_back(CreateRef<SimdJsonBackend>(level));
+        }
+    }
+
+    for (const auto& [name, document] : documents) {
+        std::printf("%s: %.2f MB\n", name, static_cast<double>(document.size()) / 1e6);
+        for (const Ref<JsonBackend>& backend : backends) {
+            const double rate = throughput(document, [&]() {
+                Json::Value value;
+                backend->parse(document, value, nullptr);
+            });
+            std::printf("  parse         %-12s %6.3f GB/s\n", backend->name().c_str(), rate);
+        }
+        for (std::size_t i = 1; i < backends.size(); ++i) {
+            const auto& simd = static_cast<const SimdJsonBackend&>(*backends[i]);
+            std::vector<std::uint32_t> index;
+            const double rate = throughput(document, [&]() { simd.buildIndex(document, index); });
+            std::printf("  stage 1 only  %-12s %6.3f GB/s\n", std::string(simdLevelName(simd.level())).c_str(), rate);
+        }
+    }
+
+    LoopbackTransport loopback;
+    loopback.setResult("eth_getBlockByNumber", documents[0].second);
+    loopback.setResult("eth_getLogs", documents[1].second);
+    EthereumClient client("loopback", loopback);
+    for (const Ref<JsonBackend>& backend : backends) {
+        client.setJsonBackend(backend);
+        const auto start = Clock::now();
+        for (int i = 0; i < 20; ++i) {
+            client.getBlockByNumber("latest", true);
+            client.getLogs(Json::Value(Json::objectValue));
+        }
+        const double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / 20;
+        std::printf("getBlockByNumber + getLogs through EthereumClient, %-12s %7.2f ms\n", backend->name().c_str(), milliseconds);
+    }
+    return 0;
+}
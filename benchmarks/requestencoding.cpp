@@ -0,0 +1,115 @@
+/**
+ * @file requestencoding.cpp
+ * @brief Time and heap allocations per encoded request: a Json::Value tree written by StreamWriterBuilder,
+ *        as requests were built before, against RpcMethod descriptors and appendRequest().
+ *
+ * Usage: benchmark-request-encoding [requests, default 200000]
+ */
+#include "ethereumclient.hpp"
+#include "loopbacktransport.hpp"
+#include "rpcmethod.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace {
+std::atomic<std::uint64_t> allocations {0};
+}
+
+// Every allocation of the program is counted.
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr RpcMethod<"eth_getBlockByNumber", StringParam, BoolParam> kGetBlockByNumber;
+
+/**
+ * @brief Keeps the compiler from discarding an encoded request.
+ */
+void keep(const std::string& text) {
+    asm volatile("" : : "r"(text.data()) : "memory");
+}
+
+/**
+ * @brief Runs @p encode @p count times after a warm-up and prints nanoseconds and allocations per run.
+ */
+template <typename Encode>
+void measure(const char* name, std::size_t count, Encode encode) {
+    for (std::size_t i = 0; i < 1000; ++i) {
+        encode();
+    }
+    const std::uint64_t before = allocations.load();
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        encode();
+    }
+    const double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    const auto allocated = static_cast<double>(allocations.load() - before);
+    std::printf("%-46s %8.0f ns/request  %5.1f allocs/request\n", name, nanoseconds / static_cast<double>(count),
+                allocated / static_cast<double>(count));
+}
+
+/**
+ * @brief Builds a request the way EthereumClient did before RpcMethod: a tree written by a default StreamWriterBuilder.
+ */
+std::string treeRequest(const std::string& method, const Json::Value& params) {
+    Json::Value payload;
+    payload["jsonrpc"] = "2.0";
+    payload["method"] = method;
+    payload["params"] = params;
+    payload["id"] = 1;
+    Json::StreamWriterBuilder writer;
+    return Json::writeString(writer, payload);
+}
+}
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 200000;
+    std::cout << "eth_getBlockByNumber(\"latest\", false), " << count << " requests\n";
+
+    measure("Json::Value tree + StreamWriterBuilder", count, []() {
+        Json::Value params(Json::arrayValue);
+        params.append("latest");
+        params.append(false);
+        keep(treeRequest("eth_getBlockByNumber", params));
+    });
+
+    std::string buffer;
+    measure("RpcMethod descriptor, reused buffer", count, [&buffer]() {
+        buffer.clear();
+        kGetBlockByNumber.encode(buffer, "latest", false);
+        keep(buffer);
+    });
+
+    Json::Value params(Json::arrayValue);
+    params.append("latest");
+    params.append(false);
+    measure("appendRequest() of a prepared tree, reused", count, [&]() {
+        buffer.clear();
+        appendRequest(buffer, "eth_getBlockByNumber", params);
+        keep(buffer);
+    });
+
+    LoopbackTransport loopback;
+    loopback.setResult("eth_getBlockByNumber", "null");
+    loopback.setResult("eth_blockNumber", "\"0x10\"");
+    EthereumClient client("loopback", loopback);
+    measure("getBlockByNumber() over LoopbackTransport", count, [&client]() { client.getBlockByNumber("latest", false); });
+    measure("getBlockNumber() over LoopbackTransport", count, [&client]() { client.getBlockNumber(); });
+    return 0;
+}
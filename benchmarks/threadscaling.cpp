@@ -0,0 +1,73 @@
+/**
+ * @file threadscaling.cpp
+ * @brief Requests per second of one EthereumClient shared by 1 to 64 threads, with and without
+ *        a caller-side mutex around every call.
+ *
+ * Usage: benchmark-thread-scaling [response delay in ms, default 1]
+ */
+#include "benchnode.hpp"
+#include "ethereumclient.hpp"
+#include "networkadapter.hpp"
+#include <iostream>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Runs @p calls getBlockNumber() calls spread over @p threads threads; returns calls per second.
+ * @param serialize Holds one mutex around every call, as callers had to before the client was thread-safe.
+ */
+double throughput(EthereumClient& client, std::size_t threads, std::size_t calls, bool serialize) {
+    std::mutex global;
+    std::atomic<std::size_t> failures {0};
+    const std::size_t share = calls / threads;
+
+    const auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (std::size_t i = 0; i < share; ++i) {
+                std::optional<std::string> result;
+                if (serialize) {
+                    std::lock_guard<std::mutex> lock(global);
+                    result = client.getBlockNumber();
+                } else {
+                    result = client.getBlockNumber();
+                }
+                if (!result) {
+                    failures.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (failures.load() > 0) {
+        std::cerr << failures.load() << " calls failed" << std::endl;
+    }
+    return static_cast<double>(share * threads) / seconds;
+}
+}
+
+int main(int argc, char** argv) {
+    const std::chrono::milliseconds delay(argc > 1 ? std::atoi(argv[1]) : 1);
+    BenchNode node({}, BenchNodeOptions {.responseDelay = delay});
+
+    NetworkAdapterOptions options;
+    options.maxHandlesPerEndpoint = 64;
+    NetworkAdapter adapter(options);
+    EthereumClient client(node.url(), adapter);
+
+    std::cout << "eth_blockNumber through one EthereumClient, stand-in node answering after " << delay.count() << " ms\n";
+    std::cout << "threads  global mutex (calls/s)  concurrent (calls/s)\n";
+    for (const std::size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        const std::size_t calls = std::max<std::size_t>(1000, threads * 50);
+        const double serialized = throughput(client, threads, calls, true);
+        const double concurrent = throughput(client, threads, calls, false);
+        std::printf("%7zu  %22.0f  %20.0f\n", threads, serialized, concurrent);
+    }
+    std::cout << "connections opened: " << node.connectionsAccepted() << "\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file uringroundtrip.cpp
+ * @brief Small-call round trips to a loopback node through UringTransport and through pooled libcurl handles.
+ *
+ * Usage: benchmark-uring-roundtrip [calls, default 20000]
+ */
+#include "benchnode.hpp"
+#include "networkadapter.hpp"
+#include "uringtransport.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const std::string kRequest = R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})";
+
+double microsecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Times @p calls blocking calls one after another and prints the mean, median and 99th percentile.
+ */
+void blockingRoundTrips(const char* name, Transport& transport, const std::string& url, std::size_t calls) {
+    std::string response;
+    for (std::size_t i = 0; i < std::min<std::size_t>(calls / 10, 2000); ++i) {
+        transport.sendPostRequestInto(url, kRequest, response);
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(calls);
+    std::size_t failures = 0;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < calls; ++i) {
+        const auto sent = Clock::now();
+        failures += transport.sendPostRequestInto(url, kRequest, response) ? 0 : 1;
+        latencies.push_back(microsecondsSince(sent));
+    }
+    const double total = microsecondsSince(start);
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-9s blocking        %7.1f us/call  p50 %6.1f us  p99 %6.1f us  %8.0f calls/s  (%zu failed)\n", name,
+                total / static_cast<double>(calls), latencies[calls / 2], latencies[calls * 99 / 100],
+                static_cast<double>(calls) / total * 1e6, failures);
+}
+
+/**
+ * @brief Keeps up to @p window async calls in flight until @p calls completed and prints the rate.
+ */
+void asyncRoundTrips(const char* name, Transport& transport, const std::string& url, std::size_t calls, std::size_t window) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t inflight = 0;
+    std::size_t completed = 0;
+    std::size_t failures = 0;
+
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < calls; ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return inflight < window; });
+            ++inflight;
+        }
+        transport.sendPostRequestAsync(url, kRequest, [&](std::optional<std::string> response) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failures += response ? 0 : 1;
+            --inflight;
+            ++completed;
+            changed.notify_all();
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return completed == calls; });
+    const double total = microsecondsSince(start);
+    std::printf("%-9s async, %3zu deep  %8.0f calls/s  (%zu failed)\n", name, window, static_cast<double>(calls) / total * 1e6,
+                failures);
+}
+}
+
+int main(int argc, char** argv) {
+    const std::size_t calls = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 20000;
+    if (!UringTransport::isSupported()) {
+        std::cout << "io_uring is not available on this kernel; nothing to compare." << std::endl;
+        return 0;
+    }
+
+    BenchNode node;
+    NetworkAdapter curl;
+    UringTransport uring({}, curl);
+    if (!uring.servesEndpoint(node.url())) {
+        std::cout << "UringTransport does not serve " << node.url() << std::endl;
+        return 1;
+    }
+
+    std::cout << calls << " eth_blockNumber calls to a loopback stand-in node answering at once\n";
+    blockingRoundTrips("libcurl", curl, node.url(), calls);
+    blockingRoundTrips("io_uring", uring, node.url(), calls);
+    for (const std::size_t window : {1, 64}) {
+        asyncRoundTrips("libcurl", curl, node.url(), calls, window);
+        asyncRoundTrips("io_uring", uring, node.url(), calls, window);
+    }
+    return 0;
+}
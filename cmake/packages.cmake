@@ -28,6 +28,21 @@ if(PROJECT_ENABLE_TEMPLATE_DEPENDENCIES)
   find_package(Eigen      QUIET)
 endif()
 
+# Kernel TLS offload configures libcurl's OpenSSL sessions directly, so it links OpenSSL when available.
+option(PROJECT_ENABLE_KTLS "Build kernel TLS (kTLS) offload support for pooled HTTPS connections." ON)
+if(PROJECT_ENABLE_KTLS AND NOT PROJECT_ENABLE_TEMPLATE_DEPENDENCIES)
+  find_package(PkgConfig QUIET)
+  if(PkgConfig_FOUND)
+    pkg_search_module(KTLS_OPENSSL QUIET openssl)
+  endif()
+  if(KTLS_OPENSSL_FOUND)
+    set(USE_OPENSSL ON CACHE BOOL "TLS/SSL and crypto library." FORCE)
+    find_package(OpenSSL QUIET)
+  else()
+    message(STATUS "OpenSSL development files not found; kernel TLS offload is disabled.")
+  endif()
+endif()
+
 if (USE_CUSTOM_ENGINE)
   find_package(${ENGINE_CODE_NAME}  REQUIRED)
 endif()
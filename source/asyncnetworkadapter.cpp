@@ -0,0 +1,494 @@
+#include "asyncnetworkadapter.hpp"
+#include "logger.hpp"
+#include "responsesink.hpp"
+#include "transferresult.hpp"
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr int kMaxEvents = 256;
+}
+
+struct AsyncNetworkAdapter::Transfer {
+    std::string url;      ///< Endpoint URL, used to return the handle to its endpoint.
+    std::string data;     ///< Request body, owned until the transfer completes.
+    std::string response; ///< Response body collected through sink.
+    ResponseSink sink;    ///< Write target of the transfer.
+    Callback callback;    ///< Completion callback.
+    RequestContext* context = nullptr; ///< Optional caller-owned cancellation, deadline and size counters.
+    std::uint64_t id = 0; ///< Key of cancellation requests.
+    Scope<std::stop_callback<std::function<void()>>> onCancel; ///< Forwards cancellation to the event loop.
+};
+
+struct AsyncNetworkAdapter::Endpoint {
+    std::string url;               ///< Endpoint URL, kept alive for CURLOPT_URL.
+    curl_slist* headers = nullptr; ///< Request headers, built once per endpoint.
+    std::vector<CURL*> idle;       ///< Handles ready for the next transfer.
+};
+
+AsyncNetworkAdapter::AsyncNetworkAdapter(AsyncNetworkAdapterOptions options)
+    : options(std::move(options)) {
+    if (!CurlShare::initializeGlobals()) {
+        Logger::getInstance().log("libcurl global initialization failed.");
+        return;
+    }
+
+    multiHandle = curl_multi_init();
+    if (!multiHandle) {
+        Logger::getInstance().log("Failed to create CURL multi handle.");
+        return;
+    }
+    curl_multi_setopt(multiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(this->options.maxConnectionsPerHost));
+    if (this->options.multiplex) {
+        curl_multi_setopt(multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        curl_multi_setopt(multiHandle, CURLMOPT_MAX_CONCURRENT_STREAMS, static_cast<long>(this->options.maxStreamsPerConnection));
+        const curl_version_info_data* version = curl_version_info(CURLVERSION_NOW);
+        if (!(version->features & CURL_VERSION_HTTP2)) {
+            Logger::getInstance().log("libcurl was built without HTTP/2; multiplex mode falls back to an HTTP/1.1 pool.");
+        }
+    }
+
+#if defined(__linux__)
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        Logger::getInstance().log("Failed to create epoll event loop for async transport.");
+        curl_multi_cleanup(multiHandle);
+        multiHandle = nullptr;
+        return;
+    }
+    epoll_event wakeEvent {};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wakeEvent);
+
+    curl_multi_setopt(multiHandle, CURLMOPT_SOCKETFUNCTION, socketCallback);
+    curl_multi_setopt(multiHandle, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multiHandle, CURLMOPT_TIMERFUNCTION, timerCallback);
+    curl_multi_setopt(multiHandle, CURLMOPT_TIMERDATA, this);
+#endif
+
+    loopThread = std::thread([this]() { run(); });
+}
+
+AsyncNetworkAdapter::~AsyncNetworkAdapter() {
+    stopping = true;
+    if (loopThread.joinable()) {
+        wakeUp();
+        loopThread.join();
+    }
+
+    failAllTransfers();
+    for (auto& [url, endpoint] : endpoints) {
+        for (CURL* handle : endpoint->idle) {
+            curl_easy_cleanup(handle);
+        }
+        curl_slist_free_all(endpoint->headers);
+    }
+    endpoints.clear();
+
+    if (multiHandle) {
+        curl_multi_cleanup(multiHandle);
+        multiHandle = nullptr;
+    }
+#if defined(__linux__)
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+#endif
+}
+
+void AsyncNetworkAdapter::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                               RequestContext* context) {
+    if (!multiHandle || stopping) {
+        Logger::getInstance().log("Cannot send request: async transport is not running.");
+        if (context) {
+            context->failure = FailureKind::Other;
+        }
+        callback(std::nullopt);
+        return;
+    }
+
+    if (context) {
+        context->failure = FailureKind::None;
+    }
+    auto transfer = CreateScope<Transfer>();
+    transfer->url = url;
+    transfer->data = data;
+    transfer->callback = std::move(callback);
+    transfer->context = context;
+    transfer->id = nextTransferId.fetch_add(1, std::memory_order_relaxed);
+    if (context && context->cancellation.stop_possible()) {
+        transfer->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(context->cancellation,
+            std::function<void()>([this, id = transfer->id]() {
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    cancelled.push_back(id);
+                }
+                wakeUp();
+            }));
+    }
+
+    ++pending;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queued.push_back(std::move(transfer));
+    }
+    wakeUp();
+}
+
+std::future<std::optional<std::string>> AsyncNetworkAdapter::sendPostRequestAsync(const std::string& url, const std::string& data) {
+    auto promise = CreateRef<std::promise<std::optional<std::string>>>();
+    auto future = promise->get_future();
+    sendPostRequestAsync(url, data, [promise](std::optional<std::string> response) {
+        promise->set_value(std::move(response));
+    });
+    return future;
+}
+
+std::size_t AsyncNetworkAdapter::pendingRequests() const {
+    return pending.load();
+}
+
+ConnectionStats AsyncNetworkAdapter::connectionStats() const {
+    ConnectionStats stats;
+    stats.activeStreams = activeStreams.load();
+    stats.peakActiveStreams = peakActiveStreams.load();
+    stats.connectionsOpened = connectionsOpened.load();
+    stats.http2Transfers = http2Transfers.load();
+    stats.http1Transfers = http1Transfers.load();
+    stats.wireBytes = wireBytes.load();
+    stats.decodedBytes = decodedBytes.load();
+    return stats;
+}
+
+void AsyncNetworkAdapter::wakeUp() {
+#if defined(__linux__)
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(wakeFd, &one, sizeof(one));
+#else
+    curl_multi_wakeup(multiHandle);
+#endif
+}
+
+void AsyncNetworkAdapter::run() {
+    int running = 0;
+#if defined(__linux__)
+    std::array<epoll_event, kMaxEvents> events {};
+    while (!stopping) {
+        startQueuedTransfers();
+
+        int timeout = -1;
+        if (timerDeadline) {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(*timerDeadline - std::chrono::steady_clock::now());
+            timeout = static_cast<int>(std::clamp<std::int64_t>(remaining.count(), 0, std::numeric_limits<int>::max()));
+        }
+
+        const int count = epoll_wait(epollFd, events.data(), kMaxEvents, timeout);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::getInstance().log("epoll_wait failed in async transport: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                std::uint64_t value = 0;
+                [[maybe_unused]] const auto readBytes = read(wakeFd, &value, sizeof(value));
+                continue;
+            }
+
+            int flags = 0;
+            if (events[i].events & EPOLLIN) {
+                flags |= CURL_CSELECT_IN;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flags |= CURL_CSELECT_OUT;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                flags |= CURL_CSELECT_ERR;
+            }
+            curl_multi_socket_action(multiHandle, fd, flags, &running);
+        }
+
+        if (timerDeadline && std::chrono::steady_clock::now() >= *timerDeadline) {
+            timerDeadline.reset();
+            curl_multi_socket_action(multiHandle, CURL_SOCKET_TIMEOUT, 0, &running);
+        }
+
+        processCompletedTransfers();
+        processCancellations();
+    }
+#else
+    while (!stopping) {
+        startQueuedTransfers();
+        curl_multi_perform(multiHandle, &running);
+        processCompletedTransfers();
+        processCancellations();
+        curl_multi_poll(multiHandle, nullptr, 0, 1000, nullptr);
+    }
+#endif
+}
+
+void AsyncNetworkAdapter::startQueuedTransfers() {
+    std::vector<Scope<Transfer>> batch;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        batch.swap(queued);
+    }
+
+    for (auto& transfer : batch) {
+        if (transfer->context && transfer->context->cancellation.stop_requested()) {
+            fail(*transfer, FailureKind::Cancelled);
+            continue;
+        }
+        const std::chrono::milliseconds budget = remainingBudget(transfer->context, options.timeout);
+        if (budget.count() == 0) {
+            fail(*transfer, FailureKind::Timeout);
+            continue;
+        }
+
+        CURL* handle = acquireHandle(transfer->url);
+        if (!handle) {
+            Logger::getInstance().log("Failed to create CURL handle.");
+            fail(*transfer, FailureKind::Other);
+            continue;
+        }
+
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDS, transfer->data.c_str());
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(transfer->data.size()));
+        transfer->sink = ResponseSink {handle, &transfer->response};
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer->sink);
+        const auto connectTimeout = transfer->context && transfer->context->connectTimeout.count() > 0
+            ? transfer->context->connectTimeout : options.connectTimeout;
+        curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(budget.count()));
+        curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(connectTimeout.count()));
+
+        const CURLMcode added = curl_multi_add_handle(multiHandle, handle);
+        if (added != CURLM_OK) {
+            Logger::getInstance().log("CURL multi error: " + std::string(curl_multi_strerror(added)));
+            releaseHandle(transfer->url, handle);
+            fail(*transfer, FailureKind::Other);
+            continue;
+        }
+        if (transfer->onCancel) {
+            cancellable.emplace(transfer->id, handle);
+        }
+        active.emplace(handle, std::move(transfer));
+
+        const std::size_t streams = ++activeStreams;
+        std::size_t peak = peakActiveStreams.load();
+        while (streams > peak && !peakActiveStreams.compare_exchange_weak(peak, streams)) {
+        }
+    }
+}
+
+void AsyncNetworkAdapter::processCompletedTransfers() {
+    int remaining = 0;
+    while (CURLMsg* message = curl_multi_info_read(multiHandle, &remaining)) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL* handle = message->easy_handle;
+        const CURLcode res = message->data.result;
+        curl_multi_remove_handle(multiHandle, handle);
+
+        auto it = active.find(handle);
+        if (it == active.end()) {
+            continue;
+        }
+        Scope<Transfer> transfer = std::move(it->second);
+        active.erase(it);
+        if (transfer->onCancel) {
+            cancellable.erase(transfer->id);
+        }
+
+        --activeStreams;
+
+        long newConnections = 0;
+        curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &newConnections);
+        connectionsOpened += static_cast<std::size_t>(newConnections);
+        const FailureKind failure = classifyTransfer(handle, res, transfer->context);
+        if (res == CURLE_OK) {
+            long httpVersion = 0;
+            curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &httpVersion);
+            if (httpVersion >= CURL_HTTP_VERSION_2_0) {
+                ++http2Transfers;
+            } else {
+                ++http1Transfers;
+            }
+
+            curl_off_t received = 0;
+            curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &received);
+            wireBytes += static_cast<std::uint64_t>(received);
+            decodedBytes += transfer->response.size();
+            if (transfer->context) {
+                transfer->context->counters.wireBytes = static_cast<std::uint64_t>(received);
+                transfer->context->counters.decodedBytes = transfer->response.size();
+            }
+        }
+        releaseHandle(transfer->url, handle);
+
+        std::optional<std::string> response;
+        if (failure == FailureKind::None) {
+            response = std::move(transfer->response);
+        }
+
+        transfer->callback(std::move(response));
+        --pending;
+    }
+}
+
+void AsyncNetworkAdapter::processCancellations() {
+    std::vector<std::uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ids.swap(cancelled);
+    }
+
+    for (const std::uint64_t id : ids) {
+        // Transfers not started yet are caught by startQueuedTransfers(); finished ones are gone.
+        auto found = cancellable.find(id);
+        if (found == cancellable.end()) {
+            continue;
+        }
+        CURL* handle = found->second;
+        cancellable.erase(found);
+        auto it = active.find(handle);
+        Scope<Transfer> transfer = std::move(it->second);
+        active.erase(it);
+
+        curl_multi_remove_handle(multiHandle, handle);
+        releaseHandle(transfer->url, handle);
+        --activeStreams;
+        fail(*transfer, FailureKind::Cancelled);
+    }
+}
+
+void AsyncNetworkAdapter::failAllTransfers() {
+    for (auto& [handle, transfer] : active) {
+        --activeStreams;
+        curl_multi_remove_handle(multiHandle, handle);
+        curl_easy_cleanup(handle);
+        fail(*transfer, FailureKind::Other);
+    }
+    active.clear();
+    cancellable.clear();
+
+    std::vector<Scope<Transfer>> batch;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        batch.swap(queued);
+    }
+    for (auto& transfer : batch) {
+        fail(*transfer, FailureKind::Other);
+    }
+}
+
+void AsyncNetworkAdapter::fail(Transfer& transfer, FailureKind kind) {
+    if (transfer.context) {
+        transfer.context->failure = kind;
+    }
+    transfer.callback(std::nullopt);
+    --pending;
+}
+
+CURL* AsyncNetworkAdapter::acquireHandle(const std::string& url) {
+    auto& endpoint = endpoints[url];
+    if (!endpoint) {
+        endpoint = CreateScope<Endpoint>();
+        endpoint->url = url;
+        endpoint->headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    }
+
+    if (!endpoint->idle.empty()) {
+        CURL* handle = endpoint->idle.back();
+        endpoint->idle.pop_back();
+        return handle;
+    }
+
+    CURL* handle = curl_easy_init();
+    if (!handle || !endpoint->headers) {
+        if (handle) {
+            curl_easy_cleanup(handle);
+        }
+        return nullptr;
+    }
+
+    curl_easy_setopt(handle, CURLOPT_URL, endpoint->url.c_str());
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, endpoint->headers);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, ResponseSink::write);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (options.share && options.share->handle()) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, options.share->handle());
+    }
+    if (options.acceptEncoding) {
+        curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, options.acceptEncoding->c_str());
+    }
+    if (options.multiplex) {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    }
+    if (options.kernelTls) {
+        options.kernelTls->enable(handle);
+    }
+    return handle;
+}
+
+void AsyncNetworkAdapter::releaseHandle(const std::string& url, CURL* handle) {
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, nullptr);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, nullptr);
+    endpoints[url]->idle.push_back(handle);
+}
+
+int AsyncNetworkAdapter::socketCallback(CURL*, curl_socket_t socket, int what, void* userp, void*) {
+#if defined(__linux__)
+    auto* self = static_cast<AsyncNetworkAdapter*>(userp);
+    if (what == CURL_POLL_REMOVE) {
+        epoll_ctl(self->epollFd, EPOLL_CTL_DEL, socket, nullptr);
+        return 0;
+    }
+
+    epoll_event event {};
+    event.data.fd = socket;
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) {
+        event.events |= EPOLLIN;
+    }
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) {
+        event.events |= EPOLLOUT;
+    }
+    if (epoll_ctl(self->epollFd, EPOLL_CTL_MOD, socket, &event) != 0 && errno == ENOENT) {
+        epoll_ctl(self->epollFd, EPOLL_CTL_ADD, socket, &event);
+    }
+#else
+    (void)socket;
+    (void)what;
+    (void)userp;
+#endif
+    return 0;
+}
+
+int AsyncNetworkAdapter::timerCallback(CURLM*, long timeoutMs, void* userp) {
+    auto* self = static_cast<AsyncNetworkAdapter*>(userp);
+    if (timeoutMs < 0) {
+        self->timerDeadline.reset();
+    } else {
+        self->timerDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#ifndef ASYNCNETWORKADAPTER_HPP
+#define ASYNCNETWORKADAPTER_HPP
+
+#include "common.hpp"
+#include <curl/curl.h>
+#include "curlshare.hpp"
+#include "kerneltls.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct AsyncNetworkAdapterOptions
+ * @brief Tuning knobs for the multiplexed, non-blocking HTTP transport.
+ */
+struct AsyncNetworkAdapterOptions {
+    std::size_t maxConnectionsPerHost = 64; ///< Connections opened per host; further transfers queue inside libcurl.
+    std::chrono::milliseconds timeout = std::chrono::seconds(30); ///< Total transfer timeout; a request's deadline can only shorten it.
+    std::chrono::milliseconds connectTimeout = std::chrono::seconds(5); ///< Budget for DNS, TCP and TLS setup, so an unreachable node fails fast.
+    Ref<CurlShare> share;                   ///< Optional share object for DNS and TLS sessions.
+    bool multiplex = false;                 ///< Negotiate HTTP/2 and multiplex concurrent requests as streams on one connection.
+    std::size_t maxStreamsPerConnection = 100; ///< Concurrent HTTP/2 streams per connection in multiplex mode.
+    std::optional<std::string> acceptEncoding = std::string(); ///< Offered content encodings; empty offers all libcurl supports, std::nullopt disables compression.
+    Ref<KernelTls> kernelTls;               ///< Optional kernel TLS offload for new TLS connections.
+};
+
+/**
+ * @struct ConnectionStats
+ * @brief Counters describing how the async transport uses its connections.
+ */
+struct ConnectionStats {
+    std::size_t activeStreams = 0;      ///< Transfers currently in flight.
+    std::size_t peakActiveStreams = 0;  ///< Highest number of transfers in flight at once.
+    std::size_t connectionsOpened = 0;  ///< New connections created (including TLS handshakes).
+    std::size_t http2Transfers = 0;     ///< Completed transfers carried as HTTP/2 streams.
+    std::size_t http1Transfers = 0;     ///< Completed transfers that fell back to HTTP/1.x.
+    std::uint64_t wireBytes = 0;        ///< Response body bytes received, before decompression.
+    std::uint64_t decodedBytes = 0;     ///< Response body bytes delivered, after decompression.
+};
+
+/**
+ * @class AsyncNetworkAdapter
+ * @brief A non-blocking HTTP transport driven by curl_multi and a single event-loop thread.
+ *
+ * Requests are queued from any thread and performed by one background thread that
+ * waits on socket readiness (epoll on Linux, curl_multi_poll elsewhere). A single
+ * adapter can keep thousands of JSON-RPC calls in flight without a thread per call.
+ *
+ * With AsyncNetworkAdapterOptions::multiplex set, every transfer asks for HTTP/2
+ * (via ALPN) and waits for an existing connection to offer a free stream before
+ * opening a new one, so many JSON-RPC calls share a single TLS connection. Servers
+ * that only speak HTTP/1.1 transparently get a pool of up to maxConnectionsPerHost
+ * connections instead.
+ *
+ * A transfer whose RequestContext::cancellation is stopped is removed from the
+ * multi handle on the next loop iteration and completes with an empty response.
+ * Its timeout is shortened to RequestContext::deadline and its connect timeout
+ * to RequestContext::connectTimeout when those are set.
+ *
+ * Completion callbacks run on the event-loop thread, so they must not block.
+ */
+class PROJECT_EXPORT AsyncNetworkAdapter {
+public:
+    /**
+     * @brief Callback invoked with the response body, or an empty std::optional on failure.
+     */
+    using Callback = std::function<void(std::optional<std::string>)>;
+
+    /**
+     * @brief Constructs the adapter and starts its event-loop thread.
+     * @param options Connection limits, timeout and share object used by this adapter.
+     */
+    explicit AsyncNetworkAdapter(AsyncNetworkAdapterOptions options = {});
+
+    /**
+     * @brief Stops the event loop, failing every transfer that is still pending.
+     */
+    ~AsyncNetworkAdapter();
+
+    AsyncNetworkAdapter(const AsyncNetworkAdapter&) = delete;
+    AsyncNetworkAdapter& operator=(const AsyncNetworkAdapter&) = delete;
+    AsyncNetworkAdapter(AsyncNetworkAdapter&&) = delete;
+    AsyncNetworkAdapter& operator=(AsyncNetworkAdapter&&) = delete;
+
+    /**
+     * @brief Queues a POST request and returns immediately.
+     * @param url The URL to send the POST request to (e.g., the Ethereum node endpoint).
+     * @param data The data to send in the body of the POST request (usually a JSON-RPC request).
+     * @param callback Invoked on the event-loop thread once the transfer completes.
+     * @param context Optional; may cancel the transfer or bound it by a deadline, and receives its sizes before the callback runs.
+     */
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr);
+
+    /**
+     * @brief Queues a POST request and returns a future for its response.
+     * @param url The URL to send the POST request to.
+     * @param data The data to send in the body of the POST request.
+     * @return A future holding the response body, or an empty std::optional if an error occurs.
+     */
+    std::future<std::optional<std::string>> sendPostRequestAsync(const std::string& url, const std::string& data);
+
+    /**
+     * @brief Retrieves the number of transfers queued or in flight.
+     */
+    std::size_t pendingRequests() const;
+
+    /**
+     * @brief Retrieves stream and connection counters.
+     */
+    ConnectionStats connectionStats() const;
+
+private:
+    struct Transfer;
+    struct Endpoint;
+
+    void run();
+    void wakeUp();
+    void startQueuedTransfers();
+    void processCompletedTransfers();
+    void processCancellations();
+    void failAllTransfers();
+    void fail(Transfer& transfer, FailureKind kind);
+    CURL* acquireHandle(const std::string& url);
+    void releaseHandle(const std::string& url, CURL* handle);
+
+    static int socketCallback(CURL* easy, curl_socket_t socket, int what, void* userp, void* socketp);
+    static int timerCallback(CURLM* multi, long timeoutMs, void* userp);
+
+    AsyncNetworkAdapterOptions options; ///< Connection limits and transfer settings.
+    CURLM* multiHandle = nullptr; ///< The libcurl multi handle owned by the event loop.
+    int epollFd = -1; ///< epoll instance watching curl sockets (Linux only).
+    int wakeFd = -1; ///< eventfd used to wake the loop for new work or shutdown (Linux only).
+    std::optional<std::chrono::steady_clock::time_point> timerDeadline; ///< Deadline of the libcurl timer, if armed.
+
+    mutable std::mutex queueMutex; ///< Guards the submission queue.
+    std::vector<Scope<Transfer>> queued; ///< Transfers submitted but not yet added to the multi handle.
+    std::vector<std::uint64_t> cancelled; ///< Ids of transfers whose caller requested cancellation (guarded by queueMutex).
+    std::unordered_map<CURL*, Scope<Transfer>> active; ///< Transfers owned by the event loop.
+    std::unordered_map<std::uint64_t, CURL*> cancellable; ///< Handles of active transfers that can be cancelled, by transfer id (loop thread only).
+    std::unordered_map<std::string, Scope<Endpoint>> endpoints; ///< Reusable handles per URL (loop thread only).
+    std::atomic<std::size_t> pending {0}; ///< Queued plus in-flight transfers.
+    std::atomic<std::uint64_t> nextTransferId {1}; ///< Identifies transfers in cancellation requests.
+    std::atomic<std::size_t> activeStreams {0}; ///< Transfers added to the multi handle.
+    std::atomic<std::size_t> peakActiveStreams {0}; ///< High-water mark of activeStreams.
+    std::atomic<std::size_t> connectionsOpened {0}; ///< Sum of CURLINFO_NUM_CONNECTS.
+    std::atomic<std::size_t> http2Transfers {0}; ///< Completed transfers that used HTTP/2.
+    std::atomic<std::size_t> http1Transfers {0}; ///< Completed transfers that used HTTP/1.x.
+    std::atomic<std::uint64_t> wireBytes {0};    ///< Response body bytes received, before decompression.
+    std::atomic<std::uint64_t> decodedBytes {0}; ///< Response body bytes delivered, after decompression.
+    std::atomic<bool> stopping {false}; ///< Set when the adapter is being destroyed.
+    std::thread loopThread; ///< The event-loop thread.
+};
+
+#endif // ASYNCNETWORKADAPTER_HPP
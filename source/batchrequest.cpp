@@ -0,0 +1,18 @@
+#include "batchrequest.hpp"
+
+std::size_t BatchRequest::add(std::string method, Json::Value params) {
+    calls.push_back(Call {std::move(method), std::move(params)});
+    return calls.size() - 1;
+}
+
+std::size_t BatchRequest::size() const {
+    return calls.size();
+}
+
+bool BatchRequest::empty() const {
+    return calls.empty();
+}
+
+void BatchRequest::clear() {
+    calls.clear();
+}
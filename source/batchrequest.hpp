@@ -0,0 +1,74 @@
+#ifndef BATCHREQUEST_HPP
+#define BATCHREQUEST_HPP
+
+#include "common.hpp"
+#include <json/json.h>
+#include "transport.hpp"
+
+/**
+ * @struct RpcError
+ * @brief The "error" object of a JSON-RPC response.
+ */
+struct RpcError {
+    int code = 0;        ///< JSON-RPC error code, e.g. -32000 for a node-specific failure.
+    std::string message; ///< Human-readable description.
+    Json::Value data;    ///< Optional "data" member, e.g. revert data of eth_call; null if absent.
+};
+
+/**
+ * @struct BatchResult
+ * @brief Outcome of one call of a batch.
+ */
+struct BatchResult {
+    std::optional<Json::Value> result;       ///< The call's "result"; set exactly when failure is None.
+    std::optional<RpcError> error;           ///< The node's error for this call, when failure is RpcError.
+    FailureKind failure = FailureKind::None; ///< RpcError, or why the request carrying this call failed (Timeout, Connect, ...).
+};
+
+/**
+ * @class BatchRequest
+ * @brief Collects JSON-RPC calls to be sent together as one batch array.
+ *
+ * Calls may target any method and are answered in the order they were added;
+ * see EthereumClient::executeBatch(). A request is reusable after clear().
+ */
+class PROJECT_EXPORT BatchRequest {
+public:
+    /**
+     * @brief Queues a call.
+     * @param method The RPC method, e.g. "eth_getTransactionReceipt".
+     * @param params The parameters, usually a JSON array.
+     * @return The call's index in the results of executeBatch().
+     */
+    std::size_t add(std::string method, Json::Value params = Json::Value(Json::arrayValue));
+
+    /**
+     * @brief Retrieves the number of queued calls.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Checks whether no call is queued.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Removes every queued call.
+     */
+    void clear();
+
+private:
+    friend class EthereumClient;
+
+    /**
+     * @brief One queued call.
+     */
+    struct Call {
+        std::string method; ///< The RPC method.
+        Json::Value params; ///< Its parameters.
+    };
+
+    std::vector<Call> calls; ///< Queued calls in result order.
+};
+
+#endif // BATCHREQUEST_HPP
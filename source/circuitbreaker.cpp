@@ -0,0 +1,70 @@
+#include "circuitbreaker.hpp"
+
+namespace {
+std::int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+CircuitBreaker::CircuitBreaker(CircuitBreakerOptions options)
+    : options(options) {}
+
+bool CircuitBreaker::available() const {
+    return current.load(std::memory_order_acquire) == CircuitState::Closed || probeDue(nowNanoseconds());
+}
+
+bool CircuitBreaker::allowRequest() {
+    CircuitState state = current.load(std::memory_order_acquire);
+    if (state == CircuitState::Closed) {
+        return true;
+    }
+
+    const std::int64_t now = nowNanoseconds();
+    std::int64_t since = changedAt.load(std::memory_order_acquire);
+    // Whoever moves the timestamp forward owns the probe; everyone else is rejected.
+    if (probeDue(now) && changedAt.compare_exchange_strong(since, now, std::memory_order_acq_rel)) {
+        current.compare_exchange_strong(state, CircuitState::HalfOpen, std::memory_order_acq_rel);
+        return true;
+    }
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CircuitBreaker::recordSuccess() {
+    consecutiveFailures.store(0, std::memory_order_relaxed);
+    current.store(CircuitState::Closed, std::memory_order_release);
+}
+
+void CircuitBreaker::recordFailure() {
+    const std::size_t failures = consecutiveFailures.fetch_add(1, std::memory_order_relaxed) + 1;
+    const CircuitState state = current.load(std::memory_order_acquire);
+    if (state == CircuitState::HalfOpen) {
+        open(nowNanoseconds());
+    } else if (state == CircuitState::Closed && options.failureThreshold > 0 && failures >= options.failureThreshold) {
+        open(nowNanoseconds());
+    }
+}
+
+CircuitState CircuitBreaker::state() const {
+    return current.load(std::memory_order_acquire);
+}
+
+std::uint64_t CircuitBreaker::timesOpened() const {
+    return opened.load(std::memory_order_relaxed);
+}
+
+std::uint64_t CircuitBreaker::rejectedRequests() const {
+    return rejected.load(std::memory_order_relaxed);
+}
+
+bool CircuitBreaker::probeDue(std::int64_t now) const {
+    const auto openFor = std::chrono::duration_cast<std::chrono::nanoseconds>(options.openDuration).count();
+    return now - changedAt.load(std::memory_order_acquire) >= openFor;
+}
+
+void CircuitBreaker::open(std::int64_t now) {
+    changedAt.store(now, std::memory_order_release);
+    if (current.exchange(CircuitState::Open, std::memory_order_acq_rel) != CircuitState::Open) {
+        opened.fetch_add(1, std::memory_order_relaxed);
+    }
+}
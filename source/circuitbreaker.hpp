@@ -0,0 +1,87 @@
+#ifndef CIRCUITBREAKER_HPP
+#define CIRCUITBREAKER_HPP
+
+#include "common.hpp"
+
+/**
+ * @struct CircuitBreakerOptions
+ * @brief Thresholds of a CircuitBreaker.
+ */
+struct CircuitBreakerOptions {
+    std::size_t failureThreshold = 5; ///< Consecutive failures that open the circuit; 0 disables the breaker.
+    std::chrono::milliseconds openDuration = std::chrono::seconds(5); ///< How long an open circuit rejects requests before a probe is let through.
+};
+
+/**
+ * @enum CircuitState
+ * @brief State of a CircuitBreaker.
+ */
+enum class CircuitState {
+    Closed,   ///< Requests flow normally.
+    Open,     ///< Requests are rejected until openDuration has passed.
+    HalfOpen  ///< One probe request is in flight; its outcome closes or reopens the circuit.
+};
+
+/**
+ * @class CircuitBreaker
+ * @brief Lock-free circuit breaker guarding one endpoint.
+ *
+ * After failureThreshold consecutive failures the circuit opens and requests are
+ * rejected without touching the network. Once openDuration has passed a single
+ * probe is admitted: success closes the circuit, failure opens it for another
+ * openDuration. A probe whose outcome is never reported (e.g. it was cancelled)
+ * is replaced by a new one after openDuration.
+ */
+class PROJECT_EXPORT CircuitBreaker {
+public:
+    explicit CircuitBreaker(CircuitBreakerOptions options = {});
+
+    /**
+     * @brief Checks whether a request would be admitted, without claiming a probe.
+     */
+    bool available() const;
+
+    /**
+     * @brief Admits a request, claiming the probe slot if the circuit is due for one.
+     * @return False if the request must be rejected.
+     */
+    bool allowRequest();
+
+    /**
+     * @brief Reports a successful request.
+     */
+    void recordSuccess();
+
+    /**
+     * @brief Reports a failed request.
+     */
+    void recordFailure();
+
+    /**
+     * @brief Retrieves the current state.
+     */
+    CircuitState state() const;
+
+    /**
+     * @brief Retrieves how often the circuit has opened.
+     */
+    std::uint64_t timesOpened() const;
+
+    /**
+     * @brief Retrieves how many requests were rejected while the circuit was open.
+     */
+    std::uint64_t rejectedRequests() const;
+
+private:
+    bool probeDue(std::int64_t now) const;
+    void open(std::int64_t now);
+
+    CircuitBreakerOptions options; ///< Thresholds.
+    std::atomic<CircuitState> current {CircuitState::Closed}; ///< Current state.
+    std::atomic<std::size_t> consecutiveFailures {0}; ///< Failures since the last success.
+    std::atomic<std::int64_t> changedAt {0}; ///< steady_clock time of opening or of the last probe, in ns.
+    std::atomic<std::uint64_t> opened {0};   ///< Times the circuit opened.
+    std::atomic<std::uint64_t> rejected {0}; ///< Requests rejected while open.
+};
+
+#endif // CIRCUITBREAKER_HPP
@@ -0,0 +1,66 @@
+#include "curlshare.hpp"
+#include "logger.hpp"
+
+namespace {
+std::once_flag gCurlInitFlag;
+bool gCurlInitialized = false;
+}
+
+CurlShare::CurlShare(CurlShareOptions options) {
+    if (!initializeGlobals()) {
+        return;
+    }
+
+    shareHandle = curl_share_init();
+    if (!shareHandle) {
+        Logger::getInstance().log("Failed to create CURL share handle.");
+        return;
+    }
+
+    curl_share_setopt(shareHandle, CURLSHOPT_LOCKFUNC, lockCallback);
+    curl_share_setopt(shareHandle, CURLSHOPT_UNLOCKFUNC, unlockCallback);
+    curl_share_setopt(shareHandle, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    if (options.shareConnections && curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT) != CURLSHE_OK) {
+        Logger::getInstance().log("libcurl does not support a shared connection cache; connections are reused per handle only.");
+    }
+}
+
+CurlShare::~CurlShare() {
+    if (shareHandle) {
+        curl_share_cleanup(shareHandle);
+        shareHandle = nullptr;
+    }
+}
+
+bool CurlShare::initializeGlobals() {
+    std::call_once(gCurlInitFlag, []() {
+        const CURLcode initResult = curl_global_init(CURL_GLOBAL_DEFAULT);
+        if (initResult != CURLE_OK) {
+            Logger::getInstance().log("Failed to initialize libcurl globals: " + std::string(curl_easy_strerror(initResult)));
+            return;
+        }
+        gCurlInitialized = true;
+    });
+    return gCurlInitialized;
+}
+
+Ref<CurlShare> CurlShare::shared() {
+    static Ref<CurlShare> instance = CreateRef<CurlShare>();
+    return instance;
+}
+
+CURLSH* CurlShare::handle() const {
+    return shareHandle;
+}
+
+void CurlShare::lockCallback(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    auto* self = static_cast<CurlShare*>(userptr);
+    self->locks[static_cast<std::size_t>(data)].lock();
+}
+
+void CurlShare::unlockCallback(CURL*, curl_lock_data data, void* userptr) {
+    auto* self = static_cast<CurlShare*>(userptr);
+    self->locks[static_cast<std::size_t>(data)].unlock();
+}
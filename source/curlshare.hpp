@@ -0,0 +1,75 @@
+#ifndef CURLSHARE_HPP
+#define CURLSHARE_HPP
+
+#include "common.hpp"
+#include <curl/curl.h>
+
+/**
+ * @struct CurlShareOptions
+ * @brief What a CurlShare shares besides DNS entries and TLS sessions.
+ */
+struct CurlShareOptions {
+    bool shareConnections = false; ///< Also share the connection cache; only safe when every attached handle is used from one thread at a time, never concurrently.
+};
+
+/**
+ * @class CurlShare
+ * @brief RAII wrapper around a libcurl share object (CURLSH).
+ *
+ * A share object lets several easy handles, possibly owned by different
+ * NetworkAdapter instances and used from different threads, reuse the same
+ * DNS cache and TLS session cache. Locking is provided through one mutex per
+ * shared data kind.
+ *
+ * Connections are not shared by default: libcurl does not support using a
+ * shared connection cache from several threads at once, so each pooled handle
+ * and each multi handle keeps its own connections. A TLS session resumed from
+ * the shared cache still makes a new connection to a known host cheap.
+ */
+class PROJECT_EXPORT CurlShare {
+public:
+    /**
+     * @brief Creates a share object for DNS and TLS sessions.
+     * @param options Whether connections are shared as well.
+     */
+    explicit CurlShare(CurlShareOptions options = {});
+
+    /**
+     * @brief Releases the share object.
+     *
+     * All easy handles attached to this share must be cleaned up first.
+     */
+    ~CurlShare();
+
+    CurlShare(const CurlShare&) = delete;
+    CurlShare& operator=(const CurlShare&) = delete;
+    CurlShare(CurlShare&&) = delete;
+    CurlShare& operator=(CurlShare&&) = delete;
+
+    /**
+     * @brief Initializes libcurl globals exactly once per process.
+     * @return True if libcurl is ready for use.
+     */
+    static bool initializeGlobals();
+
+    /**
+     * @brief Returns the process-wide share object used by default.
+     * @return A shared reference that keeps the share alive while in use.
+     */
+    static Ref<CurlShare> shared();
+
+    /**
+     * @brief Retrieves the raw libcurl share handle.
+     * @return The CURLSH pointer, or nullptr if creation failed.
+     */
+    CURLSH* handle() const;
+
+private:
+    static void lockCallback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlockCallback(CURL* handle, curl_lock_data data, void* userptr);
+
+    CURLSH* shareHandle = nullptr; ///< The libcurl share handle.
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> locks; ///< One lock per shared data kind.
+};
+
+#endif // CURLSHARE_HPP
@@ -1,44 +1,514 @@
 #include "ethereumclient.hpp"
 #include <iostream>
-#include <sstream>
 #include "logger.hpp"
+#include "rpcmethod.hpp"
 
 namespace {
+constexpr std::size_t kMaxPooledBuffers = 4;
+constexpr std::size_t kMaxPooledCapacity = 32 * 1024 * 1024;
+
+constexpr RpcMethod<"eth_blockNumber"> kBlockNumber;
+constexpr RpcMethod<"eth_getBlockByNumber", StringParam, BoolParam> kGetBlockByNumber;
+constexpr RpcMethod<"eth_getBlockByHash", StringParam, BoolParam> kGetBlockByHash;
+constexpr RpcMethod<"eth_getTransactionByHash", StringParam> kGetTransactionByHash;
+constexpr RpcMethod<"eth_getTransactionReceipt", StringParam> kGetTransactionReceipt;
+constexpr RpcMethod<"eth_getTransactionCount", StringParam, StringParam> kGetTransactionCount;
+constexpr RpcMethod<"eth_estimateGas", CallObjectParam> kEstimateGas;
+constexpr RpcMethod<"eth_gasPrice"> kGasPrice;
+constexpr RpcMethod<"eth_sendRawTransaction", StringParam> kSendRawTransaction;
+constexpr RpcMethod<"eth_getLogs", JsonParam> kGetLogs;
+constexpr RpcMethod<"eth_chainId"> kChainId;
+constexpr RpcMethod<"net_version"> kNetVersion;
+constexpr RpcMethod<"eth_syncing"> kSyncing;
+
 std::string toCompactJson(const Json::Value& value) {
     Json::StreamWriterBuilder writer;
     writer["indentation"] = "";
     return Json::writeString(writer, value);
 }
+
+/**
+ * @brief Response buffer borrowed from a per-thread free list and returned on destruction.
+ *
+ * Buffers keep their capacity between requests, so steady-state calls receive
+ * their response without allocating. Oversized buffers are released instead of pooled.
+ */
+class PooledBuffer {
+public:
+    PooledBuffer() {
+        auto& pool = freeList();
+        if (!pool.empty()) {
+            buffer = std::move(pool.back());
+            pool.pop_back();
+        }
+    }
+
+    ~PooledBuffer() {
+        auto& pool = freeList();
+        if (buffer.capacity() <= kMaxPooledCapacity && pool.size() < kMaxPooledBuffers) {
+            buffer.clear();
+            pool.push_back(std::move(buffer));
+        }
+    }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    std::string& get() { return buffer; }
+
+private:
+    static std::vector<std::string>& freeList() {
+        thread_local std::vector<std::string> pool;
+        return pool;
+    }
+
+    std::string buffer;
+};
+
+/**
+ * @brief Copies a call's budget and stop token into the transport's request context.
+ */
+void applyCallOptions(RequestContext& context, const CallOptions& callOptions) {
+    context.cancellation = callOptions.cancellation;
+    context.connectTimeout = callOptions.connectTimeout;
+    context.deadline = callOptions.deadline;
+    if (callOptions.timeout.count() > 0) {
+        context.deadline = std::min(context.deadline, std::chrono::steady_clock::now() + callOptions.timeout);
+    }
+}
+
+/**
+ * @brief Logs a failed call together with the reason the transport reported.
+ */
+void logFailure(std::string_view method, const RequestContext& context) {
+    const FailureKind kind = context.failure == FailureKind::None ? FailureKind::Other : context.failure;
+    Logger::getInstance().log("Failed to get response for method: " + std::string(method) + " (" + std::string(failureKindName(kind)) + ")");
 }
 
-EthereumClient::EthereumClient(const std::string& nodeUrl, NetworkAdapter& networkAdapter)
-    : nodeUrl(nodeUrl), networkAdapter(networkAdapter) {}
+/**
+ * @brief Awaiter that sends a request through the async transport and resumes on an executor.
+ */
+class TransportAwaiter {
+public:
+    TransportAwaiter(Transport& transport, const std::string& url, std::string data, Ref<Executor> executor,
+                     const CallOptions& callOptions)
+        : transport(transport), url(url), data(std::move(data)), executor(std::move(executor)), callOptions(callOptions) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // The budget starts when the request is sent, not when the lazy task was created.
+        applyCallOptions(context, callOptions);
+        // The callback may resume the coroutine on another thread before this
+        // function returns, so no member may be touched after the call.
+        transport.sendPostRequestAsync(url, data, [this, handle](std::optional<std::string> result) {
+            response = std::move(result);
+            executor->post([handle]() { handle.resume(); });
+        }, &context);
+    }
 
-std::optional<std::string> EthereumClient::executeCommand(const std::string& method, const Json::Value& params) {
-    Json::Value payload;
-    payload["jsonrpc"] = "2.0";
-    payload["method"] = method;
-    payload["params"] = params;
-    payload["id"] = 1;
+    std::optional<std::string> await_resume() { return std::move(response); }
+
+    const RequestContext& requestContext() const { return context; }
+
+private:
+    Transport& transport;
+    const std::string& url;
+    std::string data;
+    Ref<Executor> executor;
+    const CallOptions& callOptions;
+    std::optional<std::string> response;
+    RequestContext context;
+};
+
+/**
+ * @brief Awaiter that sends several requests through the async transport at once and resumes when all are answered.
+ */
+class MultiTransportAwaiter {
+public:
+    MultiTransportAwaiter(Transport& transport, const std::string& url, std::vector<std::string> payloads,
+                          Ref<Executor> executor, const CallOptions& callOptions)
+        : transport(transport), url(url), payloads(std::move(payloads)), executor(std::move(executor)),
+          callOptions(callOptions), responses(this->payloads.size()), contexts(this->payloads.size()),
+          remaining(this->payloads.size()) {}
+
+    bool await_ready() const noexcept { return payloads.empty(); }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        const std::size_t count = payloads.size();
+        for (RequestContext& context : contexts) {
+            applyCallOptions(context, callOptions);
+        }
+        // The last callback may resume the coroutine before the loop ends, so it only reads locals.
+        Transport& target = transport;
+        const std::string& endpoint = url;
+        for (std::size_t i = 0; i < count; ++i) {
+            target.sendPostRequestAsync(endpoint, payloads[i], [this, handle, i](std::optional<std::string> result) {
+                responses[i] = std::move(result);
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    executor->post([handle]() { handle.resume(); });
+                }
+            }, &contexts[i]);
+        }
+    }
 
-    Json::StreamWriterBuilder writer;
-    std::string requestData = Json::writeString(writer, payload);
+    void await_resume() const noexcept {}
+
+    std::optional<std::string>& response(std::size_t index) { return responses[index]; }
+
+    const RequestContext& requestContext(std::size_t index) const { return contexts[index]; }
+
+private:
+    Transport& transport;
+    const std::string& url;
+    std::vector<std::string> payloads;
+    Ref<Executor> executor;
+    const CallOptions& callOptions;
+    std::vector<std::optional<std::string>> responses;
+    std::vector<RequestContext> contexts;
+    std::atomic<std::size_t> remaining;
+};
+
+/**
+ * @brief Converts the "error" member of a response to an RpcError.
+ */
+RpcError toRpcError(const Json::Value& error) {
+    RpcError converted;
+    if (!error.isObject()) {
+        converted.message = "Unknown RPC error";
+        return converted;
+    }
+    converted.code = error["code"].isInt() ? error["code"].asInt() : 0;
+    converted.message = error["message"].isString() ? error["message"].asString() : "Unknown RPC error";
+    converted.data = error["data"];
+    return converted;
+}
 
-    auto response = networkAdapter.sendPostRequest(nodeUrl, requestData);
+/**
+ * @brief Marks calls [first, first + count) of a batch as failed for the given reason.
+ */
+void failCalls(std::vector<BatchResult>& results, std::size_t first, std::size_t count, FailureKind kind) {
+    for (std::size_t i = first; i < first + count; ++i) {
+        results[i].failure = kind == FailureKind::None ? FailureKind::Other : kind;
+    }
+}
+}
+
+EthereumClient::EthereumClient(const std::string& nodeUrl, Transport& transport)
+    : nodeUrl(nodeUrl), transport(transport), executor(InlineExecutor::shared()), jsonBackend(JsoncppBackend::shared()) {}
+
+std::optional<std::string> EthereumClient::executeCommand(const std::string& method, const Json::Value& params,
+                                                          const CallOptions& callOptions) {
+    PooledBuffer request;
+    appendRequest(request.get(), method, params);
+    std::string response;
+    if (!sendRequestInto(method, request.get(), response, callOptions)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+Task<std::optional<std::string>> EthereumClient::executeCommandAsync(std::string method, Json::Value params, CallOptions callOptions) {
+    std::string request;
+    appendRequest(request, method, params);
+    co_return co_await sendRequestAsync(method, std::move(request), std::move(callOptions));
+}
+
+std::optional<LazyResult> EthereumClient::executeLazy(const std::string& method, const Json::Value& params,
+                                                     const CallOptions& callOptions) {
+    PooledBuffer request;
+    appendRequest(request.get(), method, params);
+    std::string response;
+    if (!sendRequestInto(method, request.get(), response, callOptions)) {
+        return std::nullopt;
+    }
+    const std::optional<JsonSpan> span = locateResult(method, response);
+    if (!span) {
+        return std::nullopt;
+    }
+    return LazyResult(std::move(response), *span, jsonBackend);
+}
+
+Task<std::optional<LazyResult>> EthereumClient::executeLazyAsync(std::string method, Json::Value params, CallOptions callOptions) {
+    std::string request;
+    appendRequest(request, method, params);
+    auto response = co_await sendRequestAsync(method, std::move(request), std::move(callOptions));
     if (!response) {
-        Logger::getInstance().log("Failed to get response for method: " + method);
+        co_return std::nullopt;
+    }
+    const std::optional<JsonSpan> span = locateResult(method, *response);
+    if (!span) {
+        co_return std::nullopt;
+    }
+    co_return LazyResult(std::move(*response), *span, jsonBackend);
+}
+
+std::optional<Json::Value> EthereumClient::executeStreaming(const std::string& method, const Json::Value& params,
+                                                            std::vector<std::string> path,
+                                                            const JsonStreamParser::ElementCallback& onElement,
+                                                            const CallOptions& callOptions) {
+    PooledBuffer request;
+    appendRequest(request.get(), method, params);
+    std::size_t delivered = 0;
+    return streamRequest(method, request.get(), std::move(path), onElement, callOptions, delivered);
+}
+
+std::optional<Json::Value> EthereumClient::streamRequest(std::string_view method, const std::string& request,
+                                                         std::vector<std::string> path,
+                                                         const JsonStreamParser::ElementCallback& onElement,
+                                                         const CallOptions& callOptions, std::size_t& delivered) {
+    JsonStreamParser parser(std::move(path), onElement, jsonBackend);
+    RequestContext context;
+    applyCallOptions(context, callOptions);
+    const bool received = transport.sendPostRequestStreaming(nodeUrl, request, [&parser](std::string_view chunk) {
+        return parser.feed(chunk);
+    }, &context);
+    delivered = parser.elementCount();
+
+    if (!received || !parser.finish()) {
+        if (!parser.error().empty()) {
+            Logger::getInstance().log("Malformed streamed response for method '" + std::string(method) + "': " + parser.error());
+        } else if (!parser.stopped()) {
+            logFailure(method, context);
+        }
         return std::nullopt;
     }
-    return *response;
+    recordTraffic(method, context.counters);
+    return extractResult(method, parser.remainder());
+}
+
+bool EthereumClient::sendRequestInto(std::string_view method, const std::string& request, std::string& response,
+                                     const CallOptions& callOptions) {
+    RequestContext context;
+    applyCallOptions(context, callOptions);
+    if (!callTransport().sendPostRequestInto(nodeUrl, request, response, &context)) {
+        logFailure(method, context);
+        return false;
+    }
+    recordTraffic(method, context.counters);
+    return true;
+}
+
+Task<std::optional<std::string>> EthereumClient::sendRequestAsync(std::string_view method, std::string request, CallOptions callOptions) {
+    TransportAwaiter awaiter(callTransport(), nodeUrl, std::move(request), executor, callOptions);
+    auto response = co_await awaiter;
+    if (!response) {
+        logFailure(method, awaiter.requestContext());
+    } else {
+        recordTraffic(method, awaiter.requestContext().counters);
+    }
+    co_return response;
+}
+
+std::string EthereumClient::buildBatch(const BatchRequest& batch, std::size_t first, std::size_t count,
+                                      std::uint64_t firstId) const {
+    std::string payload;
+    payload.push_back('[');
+    for (std::size_t i = 0; i < count; ++i) {
+        const BatchRequest::Call& call = batch.calls[first + i];
+        if (i > 0) {
+            payload.push_back(',');
+        }
+        appendRequest(payload, call.method, call.params, firstId + i);
+    }
+    payload.push_back(']');
+    return payload;
+}
+
+void EthereumClient::distributeBatch(std::string_view response, std::size_t first, std::size_t count, std::uint64_t firstId,
+                                     std::vector<BatchResult>& results) {
+    auto parsed = parseResponseView(response);
+    if (!parsed) {
+        failCalls(results, first, count, FailureKind::Other);
+        return;
+    }
+
+    // A node that rejects the batch as a whole (e.g. over its size limit) answers with one error object.
+    if (!parsed->isArray()) {
+        const RpcError error = toRpcError(parsed->isObject() ? (*parsed)["error"] : Json::Value());
+        Logger::getInstance().log("Batch request of " + std::to_string(count) + " calls rejected: " + error.message);
+        for (std::size_t i = first; i < first + count; ++i) {
+            results[i].error = error;
+        }
+        failCalls(results, first, count, FailureKind::RpcError);
+        return;
+    }
+
+    std::size_t answered = 0;
+    for (Json::Value& element : *parsed) {
+        if (!element.isObject() || !element["id"].isUInt64()) {
+            continue;
+        }
+        const std::uint64_t id = element["id"].asUInt64();
+        if (id < firstId || id - firstId >= count) {
+            continue;
+        }
+        BatchResult& slot = results[first + static_cast<std::size_t>(id - firstId)];
+        if (slot.result || slot.error) {
+            continue;
+        }
+        if (element.isMember("error")) {
+            slot.error = toRpcError(element["error"]);
+            slot.failure = FailureKind::RpcError;
+        } else if (element.isMember("result")) {
+            // Results such as receipts can be large; take them out of the parsed array instead of copying.
+            slot.result.emplace();
+            slot.result->swap(element["result"]);
+        } else {
+            continue;
+        }
+        ++answered;
+    }
+
+    if (answered < count) {
+        Logger::getInstance().log("Batch response answered " + std::to_string(answered) + " of " + std::to_string(count) + " calls.");
+        for (std::size_t i = first; i < first + count; ++i) {
+            if (!results[i].result && !results[i].error) {
+                results[i].failure = FailureKind::Other;
+            }
+        }
+    }
+}
+
+std::vector<BatchResult> EthereumClient::executeBatch(const BatchRequest& batch, const CallOptions& callOptions) {
+    std::vector<BatchResult> results(batch.size());
+    // Every part of a split batch shares the budget, counted from now.
+    CallOptions partOptions = callOptions;
+    if (callOptions.timeout.count() > 0) {
+        partOptions.deadline = std::min(callOptions.deadline, std::chrono::steady_clock::now() + callOptions.timeout);
+        partOptions.timeout = std::chrono::milliseconds(0);
+    }
+
+    PooledBuffer response;
+    for (std::size_t first = 0; first < batch.size(); first += maxBatchSize) {
+        const std::size_t count = std::min(maxBatchSize, batch.size() - first);
+        const std::uint64_t firstId = nextBatchId.fetch_add(count, std::memory_order_relaxed);
+        RequestContext context;
+        applyCallOptions(context, partOptions);
+        if (!transport.sendPostRequestInto(nodeUrl, buildBatch(batch, first, count, firstId), response.get(), &context)) {
+            logFailure("batch", context);
+            failCalls(results, first, count, context.failure);
+            continue;
+        }
+        recordTraffic("batch", context.counters);
+        distributeBatch(response.get(), first, count, firstId, results);
+    }
+    return results;
+}
+
+Task<std::vector<BatchResult>> EthereumClient::executeBatchAsync(BatchRequest batch, CallOptions callOptions) {
+    std::vector<BatchResult> results(batch.size());
+    const std::size_t partSize = maxBatchSize;
+    std::vector<std::string> payloads;
+    std::vector<std::uint64_t> firstIds;
+    for (std::size_t first = 0; first < batch.size(); first += partSize) {
+        const std::size_t count = std::min(partSize, batch.size() - first);
+        firstIds.push_back(nextBatchId.fetch_add(count, std::memory_order_relaxed));
+        payloads.push_back(buildBatch(batch, first, count, firstIds.back()));
+    }
+
+    MultiTransportAwaiter awaiter(transport, nodeUrl, std::move(payloads), executor, callOptions);
+    co_await awaiter;
+    for (std::size_t part = 0; part < firstIds.size(); ++part) {
+        const std::size_t first = part * partSize;
+        const std::size_t count = std::min(partSize, batch.size() - first);
+        const RequestContext& context = awaiter.requestContext(part);
+        std::optional<std::string>& response = awaiter.response(part);
+        if (!response) {
+            logFailure("batch", context);
+            failCalls(results, first, count, context.failure);
+            continue;
+        }
+        recordTraffic("batch", context.counters);
+        distributeBatch(*response, first, count, firstIds[part], results);
+    }
+    co_return results;
+}
+
+void EthereumClient::setMaxBatchSize(std::size_t size) {
+    maxBatchSize = std::max<std::size_t>(size, 1);
+}
+
+void EthereumClient::enableMicroBatching(MicroBatchOptions options) {
+    // The deduplication layer sends through the micro-batcher; rebuild it on top of the new one.
+    const bool deduplicate = static_cast<bool>(singleFlight);
+    singleFlight.reset();
+    microBatcher = CreateScope<MicroBatchTransport>(std::move(options), transport);
+    if (deduplicate) {
+        enableSingleFlight();
+    }
+}
+
+MicroBatchStats EthereumClient::microBatchStats() const {
+    return microBatcher ? microBatcher->stats() : MicroBatchStats {};
+}
+
+void EthereumClient::enableSingleFlight() {
+    singleFlight = CreateScope<SingleFlightTransport>(microBatcher ? static_cast<Transport&>(*microBatcher) : transport);
+}
+
+SingleFlightStats EthereumClient::singleFlightStats() const {
+    return singleFlight ? singleFlight->stats() : SingleFlightStats {};
+}
+
+Transport& EthereumClient::callTransport() {
+    if (singleFlight) {
+        return *singleFlight;
+    }
+    return microBatcher ? static_cast<Transport&>(*microBatcher) : transport;
+}
+
+void EthereumClient::recordTraffic(std::string_view method, const TransferCounters& counters) {
+    TrafficCounter* counter = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(trafficMutex);
+        auto it = traffic.find(method);
+        if (it != traffic.end()) {
+            counter = it->second.get();
+        }
+    }
+    if (!counter) {
+        std::unique_lock<std::shared_mutex> lock(trafficMutex);
+        auto& slot = traffic.try_emplace(std::string(method)).first->second;
+        if (!slot) {
+            slot = CreateScope<TrafficCounter>();
+        }
+        counter = slot.get();
+    }
+    counter->calls.fetch_add(1, std::memory_order_relaxed);
+    counter->wireBytes.fetch_add(counters.wireBytes, std::memory_order_relaxed);
+    counter->decodedBytes.fetch_add(counters.decodedBytes, std::memory_order_relaxed);
+}
+
+std::map<std::string, MethodTrafficStats> EthereumClient::trafficStats() const {
+    std::map<std::string, MethodTrafficStats> stats;
+    std::shared_lock<std::shared_mutex> lock(trafficMutex);
+    for (const auto& [method, counter] : traffic) {
+        MethodTrafficStats& entry = stats[method];
+        entry.calls = counter->calls.load(std::memory_order_relaxed);
+        entry.wireBytes = counter->wireBytes.load(std::memory_order_relaxed);
+        entry.decodedBytes = counter->decodedBytes.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void EthereumClient::setExecutor(Ref<Executor> executor) {
+    this->executor = executor ? std::move(executor) : InlineExecutor::shared();
+}
+
+void EthereumClient::setJsonBackend(Ref<JsonBackend> backend) {
+    jsonBackend = backend ? std::move(backend) : JsoncppBackend::shared();
 }
 
 std::optional<Json::Value> EthereumClient::parseResponse(const std::string& response) {
+    return parseResponseView(response);
+}
+
+std::optional<Json::Value> EthereumClient::parseResponseView(std::string_view response) {
     Json::Value jsonResponse;
-    Json::CharReaderBuilder reader;
     std::string errs;
 
-    std::istringstream stream(response);
-    if (!Json::parseFromStream(reader, stream, &jsonResponse, &errs)) {
+    if (!jsonBackend->parse(response, jsonResponse, &errs)) {
         Logger::getInstance().log("Error parsing response: " + errs);
         return std::nullopt;
     }
@@ -61,34 +531,89 @@ void EthereumClient::processResult(const Json::Value& jsonResponse) {
     }
 }
 
-std::optional<Json::Value> EthereumClient::executeAndExtractResult(const std::string& method, const Json::Value& params) {
-    auto response = executeCommand(method, params);
-    if (!response) {
+std::optional<Json::Value> EthereumClient::requestResult(std::string_view method, const std::string& request,
+                                                        const CallOptions& callOptions) {
+    PooledBuffer response;
+    if (!sendRequestInto(method, request, response.get(), callOptions)) {
         return std::nullopt;
     }
+    return extractResult(method, response.get());
+}
 
-    auto jsonResponse = parseResponse(*response);
-    if (!jsonResponse) {
+std::optional<std::string> EthereumClient::requestStringResult(std::string_view method, const std::string& request,
+                                                              const CallOptions& callOptions) {
+    PooledBuffer response;
+    if (!sendRequestInto(method, request, response.get(), callOptions)) {
         return std::nullopt;
     }
+    return extractStringResult(method, response.get());
+}
 
-    if (jsonResponse->isMember("error")) {
-        const Json::Value& error = (*jsonResponse)["error"];
-        const std::string message = error.isMember("message") ? error["message"].asString() : "Unknown RPC error";
-        Logger::getInstance().log("RPC method '" + method + "' failed: " + message);
+Task<std::optional<Json::Value>> EthereumClient::requestResultAsync(std::string_view method, std::string request,
+                                                                    CallOptions callOptions) {
+    auto response = co_await sendRequestAsync(method, std::move(request), std::move(callOptions));
+    if (!response) {
+        co_return std::nullopt;
+    }
+    co_return extractResult(method, *response);
+}
+
+Task<std::optional<std::string>> EthereumClient::requestStringResultAsync(std::string_view method, std::string request,
+                                                                          CallOptions callOptions) {
+    auto response = co_await sendRequestAsync(method, std::move(request), std::move(callOptions));
+    if (!response) {
+        co_return std::nullopt;
+    }
+    co_return extractStringResult(method, *response);
+}
+
+std::optional<JsonSpan> EthereumClient::locateResult(std::string_view method, std::string_view response) {
+    const std::optional<ResponseSpans> spans = findResponseSpans(response);
+    if (!spans) {
+        // Not a response object; a full parse reports what is wrong with it.
+        if (parseResponseView(response)) {
+            Logger::getInstance().log("RPC method '" + std::string(method) + "' returned no 'result' field.");
+        }
         return std::nullopt;
     }
 
-    if (!jsonResponse->isMember("result")) {
-        Logger::getInstance().log("RPC method '" + method + "' returned no 'result' field.");
+    if (spans->error) {
+        const std::string_view text = response.substr(spans->error->begin, spans->error->end - spans->error->begin);
+        const std::optional<Json::Value> error = parseResponseView(text);
+        const std::string message = error && error->isObject() && error->isMember("message")
+            ? (*error)["message"].asString() : "Unknown RPC error";
+        Logger::getInstance().log("RPC method '" + std::string(method) + "' failed: " + message);
         return std::nullopt;
     }
 
-    return (*jsonResponse)["result"];
+    if (!spans->result) {
+        Logger::getInstance().log("RPC method '" + std::string(method) + "' returned no 'result' field.");
+        return std::nullopt;
+    }
+
+    return spans->result;
+}
+
+std::optional<Json::Value> EthereumClient::extractResult(std::string_view method, std::string_view response) {
+    const std::optional<JsonSpan> span = locateResult(method, response);
+    if (!span) {
+        return std::nullopt;
+    }
+    return parseResponseView(response.substr(span->begin, span->end - span->begin));
 }
 
-std::optional<std::string> EthereumClient::executeAndExtractStringResult(const std::string& method, const Json::Value& params) {
-    auto result = executeAndExtractResult(method, params);
+std::optional<std::string> EthereumClient::extractStringResult(std::string_view method, std::string_view response) {
+    const std::optional<JsonSpan> span = locateResult(method, response);
+    if (!span) {
+        return std::nullopt;
+    }
+
+    const std::string_view text = response.substr(span->begin, span->end - span->begin);
+    if (const std::optional<std::string_view> plain = findPlainString(text)) {
+        return std::string(*plain);
+    }
+
+    auto result = parseResponseView(text);
     if (!result) {
         return std::nullopt;
     }
@@ -100,95 +625,190 @@ std::optional<std::string> EthereumClient::executeAndExtractStringResult(const s
     return toCompactJson(*result);
 }
 
-std::optional<std::string> EthereumClient::getTransactionCount(const std::string& address, const std::string& blockTag) {
-    Json::Value params;
-    params[0] = address;
-    params[1] = blockTag;
+std::optional<std::string> EthereumClient::getTransactionCount(const std::string& address, const std::string& blockTag, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGetTransactionCount.encode(request.get(), address, blockTag);
+    return requestStringResult(kGetTransactionCount.name, request.get(), callOptions);
+}
+
+std::optional<std::string> EthereumClient::getChainId(const CallOptions& callOptions) {
+    PooledBuffer request;
+    kChainId.encode(request.get());
+    return requestStringResult(kChainId.name, request.get(), callOptions);
+}
+
+std::optional<std::string> EthereumClient::getNetworkVersion(const CallOptions& callOptions) {
+    PooledBuffer request;
+    kNetVersion.encode(request.get());
+    return requestStringResult(kNetVersion.name, request.get(), callOptions);
+}
+
+std::optional<Json::Value> EthereumClient::getSyncingStatus(const CallOptions& callOptions) {
+    PooledBuffer request;
+    kSyncing.encode(request.get());
+    return requestResult(kSyncing.name, request.get(), callOptions);
+}
+
+std::optional<std::string> EthereumClient::getBlockNumber(const CallOptions& callOptions) {
+    PooledBuffer request;
+    kBlockNumber.encode(request.get());
+    return requestStringResult(kBlockNumber.name, request.get(), callOptions);
+}
+
+std::optional<Json::Value> EthereumClient::getBlockByNumber(const std::string& blockNumber, bool fullTransactionData, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGetBlockByNumber.encode(request.get(), blockNumber, fullTransactionData);
+    return requestResult(kGetBlockByNumber.name, request.get(), callOptions);
+}
 
-    return executeAndExtractStringResult("eth_getTransactionCount", params);
+std::optional<Json::Value> EthereumClient::getBlockByHash(const std::string& blockHash, bool fullTransactionData, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGetBlockByHash.encode(request.get(), blockHash, fullTransactionData);
+    return requestResult(kGetBlockByHash.name, request.get(), callOptions);
 }
 
-std::optional<std::string> EthereumClient::getChainId() {
-    Json::Value params;
-    return executeAndExtractStringResult("eth_chainId", params);
+std::optional<Json::Value> EthereumClient::getTransactionByHash(const std::string& txHash, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGetTransactionByHash.encode(request.get(), txHash);
+    return requestResult(kGetTransactionByHash.name, request.get(), callOptions);
 }
 
-std::optional<std::string> EthereumClient::getNetworkVersion() {
-    Json::Value params;
-    return executeAndExtractStringResult("net_version", params);
+std::optional<std::string> EthereumClient::estimateGas(const std::string& from, const std::string& to, const std::string& value, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kEstimateGas.encode(request.get(), {from, to, value});
+    return requestStringResult(kEstimateGas.name, request.get(), callOptions);
 }
 
-std::optional<Json::Value> EthereumClient::getSyncingStatus() {
-    Json::Value params;
-    return executeAndExtractResult("eth_syncing", params);
+std::optional<std::string> EthereumClient::getGasPrice(const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGasPrice.encode(request.get());
+    return requestStringResult(kGasPrice.name, request.get(), callOptions);
 }
 
-std::optional<std::string> EthereumClient::getBlockNumber() {
-    Json::Value params;
-    return executeAndExtractStringResult("eth_blockNumber", params);
+std::optional<std::string> EthereumClient::sendTransaction(const std::string& rawTransaction, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kSendRawTransaction.encode(request.get(), rawTransaction);
+    return requestStringResult(kSendRawTransaction.name, request.get(), callOptions);
 }
 
-std::optional<Json::Value> EthereumClient::getBlockByNumber(const std::string& blockNumber, bool fullTransactionData) {
-    Json::Value params;
-    params[0] = blockNumber;
-    params[1] = fullTransactionData;
+std::optional<Json::Value> EthereumClient::getLogs(const Json::Value& params, const CallOptions& callOptions) {
+    PooledBuffer request;
+    if (params.isArray()) {
+        appendRequest(request.get(), kGetLogs.name, params);
+    } else {
+        kGetLogs.encode(request.get(), params);
+    }
+    return requestResult(kGetLogs.name, request.get(), callOptions);
+}
 
-    return executeAndExtractResult("eth_getBlockByNumber", params);
+std::optional<Json::Value> EthereumClient::getTransactionReceipt(const std::string& txHash, const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGetTransactionReceipt.encode(request.get(), txHash);
+    return requestResult(kGetTransactionReceipt.name, request.get(), callOptions);
 }
 
-std::optional<Json::Value> EthereumClient::getBlockByHash(const std::string& blockHash, bool fullTransactionData) {
-    Json::Value params;
-    params[0] = blockHash;
-    params[1] = fullTransactionData;
+std::optional<std::size_t> EthereumClient::streamLogs(const Json::Value& params, const JsonStreamParser::ElementCallback& onLog,
+                                                      const CallOptions& callOptions) {
+    PooledBuffer request;
+    if (params.isArray()) {
+        appendRequest(request.get(), kGetLogs.name, params);
+    } else {
+        kGetLogs.encode(request.get(), params);
+    }
+    std::size_t delivered = 0;
+    if (!streamRequest(kGetLogs.name, request.get(), {"result"}, onLog, callOptions, delivered)) {
+        return std::nullopt;
+    }
+    return delivered;
+}
 
-    return executeAndExtractResult("eth_getBlockByHash", params);
+std::optional<Json::Value> EthereumClient::streamBlockByNumber(const std::string& blockNumber,
+                                                               const JsonStreamParser::ElementCallback& onTransaction,
+                                                               const CallOptions& callOptions) {
+    PooledBuffer request;
+    kGetBlockByNumber.encode(request.get(), blockNumber, true);
+    std::size_t delivered = 0;
+    return streamRequest(kGetBlockByNumber.name, request.get(), {"result", "transactions"}, onTransaction, callOptions, delivered);
 }
 
-std::optional<Json::Value> EthereumClient::getTransactionByHash(const std::string& txHash) {
-    Json::Value params;
-    params[0] = txHash;
+Task<std::optional<std::string>> EthereumClient::getBlockNumberAsync(const CallOptions& callOptions) {
+    std::string request;
+    kBlockNumber.encode(request);
+    return requestStringResultAsync(kBlockNumber.name, std::move(request), callOptions);
+}
 
-    return executeAndExtractResult("eth_getTransactionByHash", params);
+Task<std::optional<Json::Value>> EthereumClient::getBlockByNumberAsync(const std::string& blockNumber, bool fullTransactionData, const CallOptions& callOptions) {
+    std::string request;
+    kGetBlockByNumber.encode(request, blockNumber, fullTransactionData);
+    return requestResultAsync(kGetBlockByNumber.name, std::move(request), callOptions);
 }
 
-std::optional<std::string> EthereumClient::estimateGas(const std::string& from, const std::string& to, const std::string& value) {
-    Json::Value params;
-    Json::Value txData;
-    txData["from"] = from;
-    txData["to"] = to;
-    txData["value"] = value;
-    params[0] = txData;
+Task<std::optional<Json::Value>> EthereumClient::getBlockByHashAsync(const std::string& blockHash, bool fullTransactionData, const CallOptions& callOptions) {
+    std::string request;
+    kGetBlockByHash.encode(request, blockHash, fullTransactionData);
+    return requestResultAsync(kGetBlockByHash.name, std::move(request), callOptions);
+}
 
-    return executeAndExtractStringResult("eth_estimateGas", params);
+Task<std::optional<Json::Value>> EthereumClient::getTransactionByHashAsync(const std::string& txHash, const CallOptions& callOptions) {
+    std::string request;
+    kGetTransactionByHash.encode(request, txHash);
+    return requestResultAsync(kGetTransactionByHash.name, std::move(request), callOptions);
 }
 
-std::optional<std::string> EthereumClient::getGasPrice() {
-    Json::Value params;
-    return executeAndExtractStringResult("eth_gasPrice", params);
+Task<std::optional<std::string>> EthereumClient::estimateGasAsync(const std::string& from, const std::string& to, const std::string& value, const CallOptions& callOptions) {
+    std::string request;
+    kEstimateGas.encode(request, {from, to, value});
+    return requestStringResultAsync(kEstimateGas.name, std::move(request), callOptions);
 }
 
-std::optional<std::string> EthereumClient::sendTransaction(const std::string& rawTransaction) {
-    Json::Value params;
-    params[0] = rawTransaction;
+Task<std::optional<std::string>> EthereumClient::getGasPriceAsync(const CallOptions& callOptions) {
+    std::string request;
+    kGasPrice.encode(request);
+    return requestStringResultAsync(kGasPrice.name, std::move(request), callOptions);
+}
 
-    return executeAndExtractStringResult("eth_sendRawTransaction", params);
+Task<std::optional<std::string>> EthereumClient::sendTransactionAsync(const std::string& rawTransaction, const CallOptions& callOptions) {
+    std::string request;
+    kSendRawTransaction.encode(request, rawTransaction);
+    return requestStringResultAsync(kSendRawTransaction.name, std::move(request), callOptions);
 }
 
-std::optional<Json::Value> EthereumClient::getLogs(const Json::Value& params) {
-    Json::Value rpcParams;
+Task<std::optional<Json::Value>> EthereumClient::getLogsAsync(const Json::Value& params, const CallOptions& callOptions) {
+    std::string request;
     if (params.isArray()) {
-        rpcParams = params;
+        appendRequest(request, kGetLogs.name, params);
     } else {
-        rpcParams = Json::arrayValue;
-        rpcParams.append(params);
+        kGetLogs.encode(request, params);
     }
+    return requestResultAsync(kGetLogs.name, std::move(request), callOptions);
+}
 
-    return executeAndExtractResult("eth_getLogs", rpcParams);
+Task<std::optional<Json::Value>> EthereumClient::getTransactionReceiptAsync(const std::string& txHash, const CallOptions& callOptions) {
+    std::string request;
+    kGetTransactionReceipt.encode(request, txHash);
+    return requestResultAsync(kGetTransactionReceipt.name, std::move(request), callOptions);
 }
 
-std::optional<Json::Value> EthereumClient::getTransactionReceipt(const std::string& txHash) {
-    Json::Value params;
-    params[0] = txHash;
+Task<std::optional<std::string>> EthereumClient::getTransactionCountAsync(const std::string& address, const std::string& blockTag, const CallOptions& callOptions) {
+    std::string request;
+    kGetTransactionCount.encode(request, address, blockTag);
+    return requestStringResultAsync(kGetTransactionCount.name, std::move(request), callOptions);
+}
+
+Task<std::optional<std::string>> EthereumClient::getChainIdAsync(const CallOptions& callOptions) {
+    std::string request;
+    kChainId.encode(request);
+    return requestStringResultAsync(kChainId.name, std::move(request), callOptions);
+}
+
+Task<std::optional<std::string>> EthereumClient::getNetworkVersionAsync(const CallOptions& callOptions) {
+    std::string request;
+    kNetVersion.encode(request);
+    return requestStringResultAsync(kNetVersion.name, std::move(request), callOptions);
+}
 
-    return executeAndExtractResult("eth_getTransactionReceipt", params);
+Task<std::optional<Json::Value>> EthereumClient::getSyncingStatusAsync(const CallOptions& callOptions) {
+    std::string request;
+    kSyncing.encode(request);
+    return requestResultAsync(kSyncing.name, std::move(request), callOptions);
 }
@@ -4,6 +4,38 @@
 #include "common.hpp"
 #include <json/json.h>
 #include "networkadapter.hpp"
+#include "batchrequest.hpp"
+#include "jsonbackend.hpp"
+#include "jsonstreamparser.hpp"
+#include "lazyresult.hpp"
+#include "microbatchtransport.hpp"
+#include "singleflighttransport.hpp"
+#include "executor.hpp"
+#include "task.hpp"
+
+/**
+ * @struct MethodTrafficStats
+ * @brief Response traffic of one RPC method, before and after content decoding.
+ */
+struct MethodTrafficStats {
+    std::uint64_t calls = 0;        ///< Successful calls of the method.
+    std::uint64_t wireBytes = 0;    ///< Response body bytes received on the wire.
+    std::uint64_t decodedBytes = 0; ///< Response body bytes after decompression.
+};
+
+/**
+ * @struct CallOptions
+ * @brief Time budget and cancellation of a single EthereumClient call.
+ *
+ * Both reach the transport: the transfer timeout is cut to the budget, and a
+ * cancelled or expired call aborts its transfer and frees the connection.
+ */
+struct CallOptions {
+    std::chrono::milliseconds timeout {0}; ///< Total budget of the call, counted from when it is sent; 0 leaves only the transport's timeout.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(); ///< Absolute deadline, e.g. shared by several calls; the earlier of this and timeout applies.
+    std::chrono::milliseconds connectTimeout {0}; ///< Budget for connection setup; 0 keeps the transport's default.
+    std::stop_token cancellation; ///< Requesting stop abandons the call.
+};
 
 /**
  * @class EthereumClient
@@ -12,23 +44,170 @@
  * This class provides methods to send RPC requests to an Ethereum node,
  * parse the responses, and process the results. It supports common Ethereum RPC methods
  * such as retrieving block data, transaction details, estimating gas, and more.
+ *
+ * Every RPC method also has an awaitable counterpart (e.g. getBlockNumberAsync())
+ * returning a lazy Task. Awaiting it sends the request through the non-blocking
+ * transport and resumes the coroutine on the client's executor. The client must
+ * outlive every task it returns.
+ *
+ * All RPC methods may be called concurrently from any number of threads; the
+ * client keeps no per-call state and the NetworkAdapter hands each call its own
+ * pooled transfer handle. Configure the executor before sharing the client.
+ *
+ * Every method takes an optional CallOptions with a deadline and a stop token,
+ * e.g. client.getBlockNumber({.timeout = 200ms}). A call that runs out of time or
+ * is cancelled returns an empty std::optional.
+ *
+ * The client talks through the abstract Transport interface; besides a
+ * NetworkAdapter it accepts, for example, a LoopbackTransport to measure request
+ * serialization and response parsing without any I/O.
  */
 class PROJECT_EXPORT EthereumClient {
 public:
     /**
      * @brief Constructs an EthereumClient instance.
      * @param nodeUrl The URL of the Ethereum node (e.g., Infura, local node).
-     * @param networkAdapter A reference to the NetworkAdapter used for sending requests.
+     * @param transport The transport used for sending requests, e.g. a NetworkAdapter.
      */
-    EthereumClient(const std::string& nodeUrl, NetworkAdapter& networkAdapter);
+    EthereumClient(const std::string& nodeUrl, Transport& transport);
 
     /**
      * @brief General method to send RPC requests.
      * @param method The name of the RPC method to call (e.g., "eth_blockNumber").
      * @param params The parameters for the RPC method (as a JSON object).
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The raw JSON response as a string, wrapped in std::optional.
      */
-    std::optional<std::string> executeCommand(const std::string& method, const Json::Value& params);
+    std::optional<std::string> executeCommand(const std::string& method, const Json::Value& params, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of executeCommand().
+     * @param method The name of the RPC method to call.
+     * @param params The parameters for the RPC method.
+     * @param callOptions Optional deadline and cancellation; the timeout counts from when the task is awaited.
+     * @return A task producing the raw JSON response, or an empty std::optional on failure.
+     */
+    Task<std::optional<std::string>> executeCommandAsync(std::string method, Json::Value params, CallOptions callOptions = {});
+
+    /**
+     * @brief Sends an RPC request and returns its result without parsing it.
+     * @param method The name of the RPC method to call.
+     * @param params The parameters for the RPC method.
+     * @param callOptions Optional deadline and cancellation of the call.
+     * @return The result, parsed only when accessed; an empty std::optional if the call failed or the node returned an error.
+     *
+     * The response is scanned for its "result" and "error" members without building
+     * a JSON tree, so a caller that reads a scalar or forwards the raw text never pays
+     * for a parse, and a caller that needs the tree parses only the result.
+     */
+    std::optional<LazyResult> executeLazy(const std::string& method, const Json::Value& params, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of executeLazy().
+     */
+    Task<std::optional<LazyResult>> executeLazyAsync(std::string method, Json::Value params, CallOptions callOptions = {});
+
+    /**
+     * @brief Sends an RPC request and hands out the elements of one array of the response while it arrives.
+     * @param method The name of the RPC method to call.
+     * @param params The parameters for the RPC method.
+     * @param path Keys from the response object to the array, e.g. {"result"} or {"result", "transactions"}.
+     * @param onElement Receives each element as soon as it is complete, on the calling thread; returning false stops the call.
+     * @param callOptions Optional deadline and cancellation of the call.
+     * @return The result with the streamed array left empty; an empty std::optional if the call failed,
+     *         the node returned an error or @p onElement stopped the call.
+     *
+     * The response is parsed as the transport receives it (see Transport::sendPostRequestStreaming)
+     * and is never held in full: memory stays bounded by the largest element, however
+     * long the array. Elements delivered before a failure stay delivered. Streamed calls
+     * bypass micro-batching and deduplication.
+     */
+    std::optional<Json::Value> executeStreaming(const std::string& method, const Json::Value& params, std::vector<std::string> path,
+                                                const JsonStreamParser::ElementCallback& onElement, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Sends queued calls as JSON-RPC batches and returns one result per call.
+     * @param batch The calls; results are returned in the order they were added.
+     * @param callOptions Optional deadline and cancellation shared by the whole batch.
+     * @return One BatchResult per call; an empty batch sends nothing.
+     *
+     * Each call is given an id unique within this client, and answers are matched
+     * back by id, so nodes may return batch elements in any order. Batches larger
+     * than the limit set with setMaxBatchSize() are split and sent one after another
+     * over the blocking transport. A failed request fails only the calls it carried.
+     */
+    std::vector<BatchResult> executeBatch(const BatchRequest& batch, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of executeBatch().
+     *
+     * The parts of a split batch are sent concurrently through the async transport,
+     * and the task completes once every part has been answered.
+     */
+    Task<std::vector<BatchResult>> executeBatchAsync(BatchRequest batch, CallOptions callOptions = {});
+
+    /**
+     * @brief Sets how many calls one batch request may carry.
+     * @param size The node's batch limit (e.g. 1000 for geth, often 100 or less for hosted providers); 0 is treated as 1.
+     *
+     * Defaults to 100. Configure it before sharing the client between threads.
+     */
+    void setMaxBatchSize(std::size_t size);
+
+    /**
+     * @brief Turns on micro-batching: concurrent calls are held briefly and sent together as one batch.
+     * @param options The hold window and the batch size cap.
+     *
+     * Every single call, blocking or awaitable, then goes through a MicroBatchTransport
+     * in front of the client's transport; executeBatch() is unaffected. Each caller still
+     * receives its own response and keeps its own deadline and cancellation. Call this
+     * before sharing the client between threads.
+     */
+    void enableMicroBatching(MicroBatchOptions options = {});
+
+    /**
+     * @brief Turns on deduplication: identical calls in flight at the same time are sent only once.
+     *
+     * Calls with the same method and parameters (serialized canonically) that overlap
+     * share one request through a SingleFlightTransport, and every caller receives
+     * the shared result; only idempotent methods qualify. Deduplication happens before
+     * micro-batching. Call this before sharing the client between threads.
+     */
+    void enableSingleFlight();
+
+    /**
+     * @brief Retrieves how many calls were collapsed into another caller's request.
+     * @return All-zero counters if deduplication is off.
+     */
+    SingleFlightStats singleFlightStats() const;
+
+    /**
+     * @brief Retrieves batch sizes and hold times of micro-batching.
+     * @return All-zero statistics if micro-batching is off.
+     */
+    MicroBatchStats microBatchStats() const;
+
+    /**
+     * @brief Sets the executor on which awaiting coroutines are resumed.
+     * @param executor The executor to use; the inline executor is used when null.
+     *
+     * The default inline executor resumes coroutines on the transport's event-loop thread.
+     */
+    void setExecutor(Ref<Executor> executor);
+
+    /**
+     * @brief Sets the parser responses are read with.
+     * @param backend The parser, e.g. a SimdJsonBackend for large blocks and log pages; jsoncpp is used when null.
+     */
+    void setJsonBackend(Ref<JsonBackend> backend);
+
+    /**
+     * @brief Retrieves response traffic per RPC method since the client was created.
+     * @return Counters keyed by method name; compare wireBytes and decodedBytes to see compression savings.
+     *
+     * Batch requests are counted under the name "batch", one call per request sent.
+     */
+    std::map<std::string, MethodTrafficStats> trafficStats() const;
 
     /**
      * @brief Parses the response from the Ethereum node.
@@ -47,68 +226,77 @@ public:
 
     /**
      * @brief Retrieves the latest block number.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The block number as a string in hexadecimal format, or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> getBlockNumber();
+    std::optional<std::string> getBlockNumber(const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves block information by block number.
      * @param blockNumber The block number (hexadecimal).
      * @param fullTransactionData Flag to determine whether to fetch full transaction data.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The block data in JSON format, or an empty std::optional if an error occurs.
      */
-    std::optional<Json::Value> getBlockByNumber(const std::string& blockNumber, bool fullTransactionData);
+    std::optional<Json::Value> getBlockByNumber(const std::string& blockNumber, bool fullTransactionData, const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves block information by block hash.
      * @param blockHash The block hash (hexadecimal).
      * @param fullTransactionData Flag to determine whether to fetch full transaction data.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The block data in JSON format, or an empty std::optional if an error occurs.
      */
-    std::optional<Json::Value> getBlockByHash(const std::string& blockHash, bool fullTransactionData);
+    std::optional<Json::Value> getBlockByHash(const std::string& blockHash, bool fullTransactionData, const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves transaction information by transaction hash.
      * @param txHash The transaction hash.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The transaction data in JSON format, or an empty std::optional if an error occurs.
      */
-    std::optional<Json::Value> getTransactionByHash(const std::string& txHash);
+    std::optional<Json::Value> getTransactionByHash(const std::string& txHash, const CallOptions& callOptions = {});
 
     /**
      * @brief Estimates the gas required for a transaction.
      * @param from The sender address.
      * @param to The recipient address.
      * @param value The value to be sent (in hexadecimal).
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The estimated gas (in hexadecimal), or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> estimateGas(const std::string& from, const std::string& to, const std::string& value);
+    std::optional<std::string> estimateGas(const std::string& from, const std::string& to, const std::string& value, const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves the current gas price.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The current gas price in hexadecimal format, or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> getGasPrice();
+    std::optional<std::string> getGasPrice(const CallOptions& callOptions = {});
 
     /**
      * @brief Sends a signed raw transaction.
      * @param rawTransaction The signed raw transaction bytes encoded as a hex string.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The transaction hash (if successful), or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> sendTransaction(const std::string& rawTransaction);
+    std::optional<std::string> sendTransaction(const std::string& rawTransaction, const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves logs based on filter parameters.
      * @param params The filter parameters for fetching logs.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The logs in JSON format, or an empty std::optional if an error occurs.
      */
-    std::optional<Json::Value> getLogs(const Json::Value& params);
+    std::optional<Json::Value> getLogs(const Json::Value& params, const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves the transaction receipt by transaction hash.
      * @param txHash The transaction hash.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The transaction receipt data in JSON format, or an empty std::optional if an error occurs.
      */
-    std::optional<Json::Value> getTransactionReceipt(const std::string& txHash);
+    std::optional<Json::Value> getTransactionReceipt(const std::string& txHash, const CallOptions& callOptions = {});
 
            // Additional Methods
 
@@ -116,42 +304,237 @@ public:
      * @brief Retrieves the transaction count (nonce) for an address.
      * @param address The address for which to fetch the transaction count.
      * @param blockTag The block parameter (e.g., "latest", "pending", or a block number in hex).
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The transaction count (nonce) as a string, or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> getTransactionCount(const std::string& address, const std::string& blockTag = "latest");
+    std::optional<std::string> getTransactionCount(const std::string& address, const std::string& blockTag = "latest", const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves the chain ID of the connected Ethereum network.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The chain ID as a string, or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> getChainId();
+    std::optional<std::string> getChainId(const CallOptions& callOptions = {});
 
     /**
      * @brief Retrieves the version of the connected Ethereum network.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return The network version as a string, or an empty std::optional if an error occurs.
      */
-    std::optional<std::string> getNetworkVersion();
+    std::optional<std::string> getNetworkVersion(const CallOptions& callOptions = {});
 
     /**
      * @brief Checks if the Ethereum node is syncing.
+     * @param callOptions Optional deadline and cancellation of the call.
      * @return Syncing status in JSON format, or an empty std::optional if an error occurs.
      */
-    std::optional<Json::Value> getSyncingStatus();
+    std::optional<Json::Value> getSyncingStatus(const CallOptions& callOptions = {});
+
+           // Streaming RPC Methods
+
+    /**
+     * @brief Retrieves logs based on filter parameters, handing out each log as soon as it is received.
+     * @param params The filter parameters for fetching logs.
+     * @param onLog Receives each log entry; returning false stops the call.
+     * @param callOptions Optional deadline and cancellation of the call.
+     * @return The number of logs delivered, or an empty std::optional if an error occurs or @p onLog stopped the call.
+     *
+     * Suited to wide filters whose responses run to hundreds of megabytes; see executeStreaming().
+     */
+    std::optional<std::size_t> streamLogs(const Json::Value& params, const JsonStreamParser::ElementCallback& onLog, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Retrieves a block with full transaction data, handing out each transaction as soon as it is received.
+     * @param blockNumber The block number (hexadecimal) or tag.
+     * @param onTransaction Receives each transaction object; returning false stops the call.
+     * @param callOptions Optional deadline and cancellation of the call.
+     * @return The block with an empty "transactions" array; null if the block does not exist;
+     *         an empty std::optional if an error occurs or @p onTransaction stopped the call.
+     */
+    std::optional<Json::Value> streamBlockByNumber(const std::string& blockNumber, const JsonStreamParser::ElementCallback& onTransaction,
+                                                   const CallOptions& callOptions = {});
+
+           // Awaitable RPC Methods
+
+    /**
+     * @brief Awaitable form of getBlockNumber().
+     */
+    Task<std::optional<std::string>> getBlockNumberAsync(const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getBlockByNumber().
+     */
+    Task<std::optional<Json::Value>> getBlockByNumberAsync(const std::string& blockNumber, bool fullTransactionData, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getBlockByHash().
+     */
+    Task<std::optional<Json::Value>> getBlockByHashAsync(const std::string& blockHash, bool fullTransactionData, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getTransactionByHash().
+     */
+    Task<std::optional<Json::Value>> getTransactionByHashAsync(const std::string& txHash, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of estimateGas().
+     */
+    Task<std::optional<std::string>> estimateGasAsync(const std::string& from, const std::string& to, const std::string& value, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getGasPrice().
+     */
+    Task<std::optional<std::string>> getGasPriceAsync(const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of sendTransaction().
+     */
+    Task<std::optional<std::string>> sendTransactionAsync(const std::string& rawTransaction, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getLogs().
+     */
+    Task<std::optional<Json::Value>> getLogsAsync(const Json::Value& params, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getTransactionReceipt().
+     */
+    Task<std::optional<Json::Value>> getTransactionReceiptAsync(const std::string& txHash, const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getTransactionCount().
+     */
+    Task<std::optional<std::string>> getTransactionCountAsync(const std::string& address, const std::string& blockTag = "latest", const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getChainId().
+     */
+    Task<std::optional<std::string>> getChainIdAsync(const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getNetworkVersion().
+     */
+    Task<std::optional<std::string>> getNetworkVersionAsync(const CallOptions& callOptions = {});
+
+    /**
+     * @brief Awaitable form of getSyncingStatus().
+     */
+    Task<std::optional<Json::Value>> getSyncingStatusAsync(const CallOptions& callOptions = {});
 
 private:
     /**
-     * @brief Executes an RPC method and extracts the "result" field from the response.
+     * @brief Sends an encoded request and extracts the "result" field from the response.
+     * @param method The request's method, for logs and traffic counters.
      */
-    std::optional<Json::Value> executeAndExtractResult(const std::string& method, const Json::Value& params);
+    std::optional<Json::Value> requestResult(std::string_view method, const std::string& request, const CallOptions& callOptions);
 
     /**
-     * @brief Executes an RPC method and extracts the "result" field as a string.
+     * @brief Sends an encoded request and extracts the "result" field as a string.
      * If the result is not a JSON string, it is serialized as compact JSON.
      */
-    std::optional<std::string> executeAndExtractStringResult(const std::string& method, const Json::Value& params);
+    std::optional<std::string> requestStringResult(std::string_view method, const std::string& request, const CallOptions& callOptions);
+
+    /**
+     * @brief Awaitable form of requestResult(); @p method must outlive the task, e.g. an RpcMethod name.
+     */
+    Task<std::optional<Json::Value>> requestResultAsync(std::string_view method, std::string request, CallOptions callOptions);
+
+    /**
+     * @brief Awaitable form of requestStringResult(); @p method must outlive the task.
+     */
+    Task<std::optional<std::string>> requestStringResultAsync(std::string_view method, std::string request, CallOptions callOptions);
+
+    /**
+     * @brief Sends an encoded request and writes the raw response into a caller-owned buffer.
+     * @return True on success; failures are logged with their FailureKind.
+     */
+    bool sendRequestInto(std::string_view method, const std::string& request, std::string& response, const CallOptions& callOptions);
+
+    /**
+     * @brief Awaitable form of sendRequestInto(); @p method must outlive the task.
+     */
+    Task<std::optional<std::string>> sendRequestAsync(std::string_view method, std::string request, CallOptions callOptions);
+
+    /**
+     * @brief Sends an encoded request through the streaming transport and parses the response as it arrives.
+     * @param delivered Receives the number of elements passed to @p onElement.
+     * @return The remainder's result; see executeStreaming().
+     */
+    std::optional<Json::Value> streamRequest(std::string_view method, const std::string& request, std::vector<std::string> path,
+                                             const JsonStreamParser::ElementCallback& onElement, const CallOptions& callOptions,
+                                             std::size_t& delivered);
+
+    /**
+     * @brief Returns the transport single calls are sent through: deduplication, then micro-batching, if enabled.
+     */
+    Transport& callTransport();
+
+    /**
+     * @brief Serializes calls [first, first + count) of a batch as a JSON array with ids from firstId.
+     */
+    std::string buildBatch(const BatchRequest& batch, std::size_t first, std::size_t count, std::uint64_t firstId) const;
+
+    /**
+     * @brief Matches a batch response to calls [first, first + count) by id and stores their results.
+     */
+    void distributeBatch(std::string_view response, std::size_t first, std::size_t count, std::uint64_t firstId,
+                         std::vector<BatchResult>& results);
+
+    /**
+     * @brief Adds one response to the traffic counters of a method.
+     */
+    void recordTraffic(std::string_view method, const TransferCounters& counters);
+
+    /**
+     * @brief Parses a response in place, without copying it.
+     */
+    std::optional<Json::Value> parseResponseView(std::string_view response);
+
+    /**
+     * @brief Locates the "result" of a raw response without parsing it, logging RPC errors and malformed responses.
+     */
+    std::optional<JsonSpan> locateResult(std::string_view method, std::string_view response);
+
+    /**
+     * @brief Parses the "result" field of a raw response, and nothing else of it; RPC errors are logged.
+     */
+    std::optional<Json::Value> extractResult(std::string_view method, std::string_view response);
+
+    /**
+     * @brief Extracts the "result" field as a string, serializing non-string results as compact JSON.
+     *
+     * Strings without escapes, i.e. quantities and hashes, are copied out of the response without parsing.
+     */
+    std::optional<std::string> extractStringResult(std::string_view method, std::string_view response);
 
     std::string nodeUrl; ///< The URL of the Ethereum node.
-    NetworkAdapter& networkAdapter; ///< Reference to the network adapter used for sending requests.
+    Transport& transport; ///< Transport used for sending requests.
+    Ref<Executor> executor; ///< Executor on which awaiting coroutines resume.
+    Ref<JsonBackend> jsonBackend; ///< Parser of responses.
+    std::size_t maxBatchSize = 100; ///< Calls per batch request; larger batches are split.
+    Scope<MicroBatchTransport> microBatcher; ///< Coalesces single calls when micro-batching is on.
+    Scope<SingleFlightTransport> singleFlight; ///< Deduplicates identical calls in flight; sends through microBatcher if set.
+    std::atomic<std::uint64_t> nextBatchId {2}; ///< Next JSON-RPC id of a batch call; single calls use id 1.
+
+    /**
+     * @brief Lock-free counters behind MethodTrafficStats.
+     */
+    struct TrafficCounter {
+        std::atomic<std::uint64_t> calls {0};
+        std::atomic<std::uint64_t> wireBytes {0};
+        std::atomic<std::uint64_t> decodedBytes {0};
+    };
+
+    /**
+     * @brief Hashes method names as views, so counters are found without copying the name.
+     */
+    struct TrafficKeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view method) const noexcept { return std::hash<std::string_view> {}(method); }
+    };
+
+    mutable std::shared_mutex trafficMutex; ///< Guards the traffic map; updates of existing methods take it shared.
+    std::unordered_map<std::string, Scope<TrafficCounter>, TrafficKeyHash, std::equal_to<>> traffic; ///< Traffic counters keyed by method.
 };
 
 #endif // ETHEREUM_CLIENT_HPP
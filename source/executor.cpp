@@ -0,0 +1,12 @@
+#include "executor.hpp"
+
+Executor::~Executor() = default;
+
+Ref<InlineExecutor> InlineExecutor::shared() {
+    static Ref<InlineExecutor> instance = CreateRef<InlineExecutor>();
+    return instance;
+}
+
+void InlineExecutor::post(std::function<void()> work) {
+    work();
+}
@@ -0,0 +1,40 @@
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include "common.hpp"
+
+/**
+ * @class Executor
+ * @brief Abstract scheduler used to resume coroutines after a transport completes.
+ *
+ * Implement this interface to resume awaiting coroutines on threads you control,
+ * e.g. a thread pool or an application event loop.
+ */
+class PROJECT_EXPORT Executor {
+public:
+    virtual ~Executor();
+
+    /**
+     * @brief Schedules work for execution.
+     * @param work The function to run; must be invoked exactly once.
+     */
+    virtual void post(std::function<void()> work) = 0;
+};
+
+/**
+ * @class InlineExecutor
+ * @brief Runs posted work immediately on the calling thread.
+ *
+ * When used with the async transport, coroutines resume on its event-loop thread.
+ */
+class PROJECT_EXPORT InlineExecutor final : public Executor {
+public:
+    /**
+     * @brief Returns the process-wide inline executor.
+     */
+    static Ref<InlineExecutor> shared();
+
+    void post(std::function<void()> work) override;
+};
+
+#endif // EXECUTOR_HPP
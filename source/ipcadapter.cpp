@@ -0,0 +1,451 @@
+#include "ipcadapter.hpp"
+#include "logger.hpp"
+#include "jsonscan.hpp"
+#include <charconv>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr std::string_view kIpcScheme = "ipc://";
+constexpr std::size_t kReadChunkSize = 64 * 1024;
+}
+
+struct IpcAdapter::Pending {
+    Callback callback; ///< Completion callback.
+    std::unordered_map<std::uint64_t, std::string> originalIds; ///< Caller's id text for each wire id.
+    std::optional<Deadlines::iterator> deadline; ///< Position in deadlines while pending, if the request has one.
+    std::uint64_t connection = 0; ///< Connection the request was sent on.
+    Scope<std::stop_callback<std::function<void()>>> onCancel; ///< Fails the request when its caller requests stop.
+};
+
+IpcAdapter::IpcAdapter(std::string socketPath, std::chrono::milliseconds timeout)
+    : socketPath(std::move(socketPath)), timeout(timeout) {
+#if !defined(_WIN32)
+    if (pipe2(wakePipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        Logger::getInstance().log("Failed to create wake pipe for IPC transport: " + std::string(std::strerror(errno)));
+    }
+#endif
+}
+
+IpcAdapter::~IpcAdapter() {
+    stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+#if !defined(_WIN32)
+        if (socketFd >= 0) {
+            shutdown(socketFd, SHUT_RDWR);
+        }
+#endif
+    }
+    if (readerThread.joinable()) {
+        if (readerThread.get_id() == std::this_thread::get_id()) {
+            readerThread.detach();
+        } else {
+            readerThread.join();
+        }
+    }
+    disconnect();
+    failPending();
+#if !defined(_WIN32)
+    for (int& fd : wakePipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+#endif
+}
+
+bool IpcAdapter::isIpcEndpoint(std::string_view url) {
+    return url.starts_with(kIpcScheme) || (url.ends_with(".ipc") && url.find("://") == std::string_view::npos);
+}
+
+std::string IpcAdapter::socketPathFromEndpoint(std::string_view url) {
+    if (url.starts_with(kIpcScheme)) {
+        url.remove_prefix(kIpcScheme.size());
+    }
+    return std::string(url);
+}
+
+std::optional<std::string> IpcAdapter::sendRequest(const std::string& data) {
+    return sendRequest(data, timeout);
+}
+
+std::optional<std::string> IpcAdapter::sendRequest(const std::string& data, std::chrono::milliseconds timeout,
+                                                   std::stop_token cancellation) {
+    auto promise = CreateRef<std::promise<std::optional<std::string>>>();
+    auto future = promise->get_future();
+    Ref<Pending> entry = submit(data, [promise](std::optional<std::string> response) {
+        promise->set_value(std::move(response));
+    }, std::chrono::steady_clock::time_point::max(), std::move(cancellation));
+
+    if (future.wait_for(timeout) != std::future_status::ready) {
+        if (entry && removePending(entry)) {
+            Logger::getInstance().log("IPC request timed out on socket: " + socketPath);
+            return std::nullopt;
+        }
+        // The response raced the timeout and its callback has already claimed the entry.
+    }
+    return future.get();
+}
+
+void IpcAdapter::sendRequestAsync(const std::string& data, Callback callback, std::chrono::steady_clock::time_point deadline,
+                                  std::stop_token cancellation) {
+    submit(data, std::move(callback), deadline, std::move(cancellation));
+}
+
+Ref<IpcAdapter::Pending> IpcAdapter::submit(const std::string& data, Callback callback,
+                                            std::chrono::steady_clock::time_point deadline, std::stop_token cancellation) {
+    const std::vector<JsonSpan> spans = findIdSpans(data);
+    if (spans.empty()) {
+        Logger::getInstance().log("IPC request has no 'id'; responses could not be matched.");
+        callback(std::nullopt);
+        return nullptr;
+    }
+
+    auto entry = CreateRef<Pending>();
+    entry->callback = std::move(callback);
+
+    std::string wire;
+    wire.reserve(data.size() + spans.size() * 8 + 1);
+    std::size_t last = 0;
+    for (const JsonSpan& span : spans) {
+        const std::uint64_t wireId = nextId.fetch_add(1, std::memory_order_relaxed);
+        entry->originalIds.emplace(wireId, data.substr(span.begin, span.end - span.begin));
+        wire.append(data, last, span.begin - last);
+        wire += std::to_string(wireId);
+        last = span.end;
+    }
+    wire.append(data, last, std::string::npos);
+    // Raw line breaks can only be insignificant whitespace in valid JSON; drop them to keep framing intact.
+    std::replace(wire.begin(), wire.end(), '\n', ' ');
+    std::replace(wire.begin(), wire.end(), '\r', ' ');
+    wire.push_back('\n');
+
+    bool registered = false;
+    bool written = false;
+    {
+        std::unique_lock<std::mutex> lock(writeMutex);
+        // Register only once connected, tagged with the connection whose reader will fail it if the socket drops.
+        if (ensureConnected(lock)) {
+            bool earliest = false;
+            entry->connection = liveConnection;
+            {
+                std::lock_guard<std::mutex> pendingLock(pendingMutex);
+                for (const auto& [wireId, originalId] : entry->originalIds) {
+                    pending.emplace(wireId, entry);
+                }
+                if (deadline != std::chrono::steady_clock::time_point::max()) {
+                    entry->deadline = deadlines.emplace(deadline, entry);
+                    earliest = *entry->deadline == deadlines.begin();
+                }
+            }
+            registered = true;
+            // The reader sleeps until the earliest deadline it knows of.
+            if (earliest) {
+                wakeUp();
+            }
+#if !defined(_WIN32)
+            std::size_t offset = 0;
+            while (offset < wire.size()) {
+                const ssize_t sent = send(socketFd, wire.data() + offset, wire.size() - offset, MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (sent <= 0) {
+                    Logger::getInstance().log("IPC write failed on socket '" + socketPath + "': " + std::strerror(errno));
+                    liveConnection = 0;
+                    shutdown(socketFd, SHUT_RDWR);
+                    break;
+                }
+                offset += static_cast<std::size_t>(sent);
+            }
+            written = offset == wire.size();
+#endif
+        }
+    }
+
+    if (!written) {
+        if (!registered || removePending(entry)) {
+            entry->callback(std::nullopt);
+        }
+        return nullptr;
+    }
+
+    // Registered outside the write lock: if stop was already requested the callback runs right here.
+    if (cancellation.stop_possible()) {
+        entry->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(
+            std::move(cancellation), [this, weak = std::weak_ptr<Pending>(entry)]() {
+                if (Ref<Pending> cancelled = weak.lock(); cancelled && removePending(cancelled)) {
+                    cancelled->callback(std::nullopt);
+                }
+            });
+    }
+    return entry;
+}
+
+bool IpcAdapter::ensureConnected(std::unique_lock<std::mutex>& writeLock) {
+    if (liveConnection != 0) {
+        return true;
+    }
+    if (stopping) {
+        return false;
+    }
+
+#if defined(_WIN32)
+    (void)writeLock;
+    Logger::getInstance().log("IPC transport is not supported on this platform.");
+    return false;
+#else
+    if (readerThread.joinable()) {
+        std::thread oldReader = std::move(readerThread);
+        const int oldFd = std::exchange(socketFd, -1);
+        if (oldReader.get_id() == std::this_thread::get_id()) {
+            oldReader.detach();
+        } else {
+            // The old reader runs failed requests' callbacks, which may send again; join it without the write lock.
+            writeLock.unlock();
+            oldReader.join();
+            writeLock.lock();
+        }
+        // The old reader only read from its own socket, so it can be closed now that it is gone.
+        if (oldFd >= 0) {
+            close(oldFd);
+        }
+        // Another caller may have reconnected while the lock was released.
+        if (liveConnection != 0) {
+            return true;
+        }
+        if (stopping) {
+            return false;
+        }
+    }
+    disconnect();
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        Logger::getInstance().log("IPC socket path is too long: " + socketPath);
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        Logger::getInstance().log("Failed to create IPC socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        Logger::getInstance().log("Failed to connect to IPC socket '" + socketPath + "': " + std::strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    socketFd = fd;
+    const std::uint64_t connection = ++connections;
+    liveConnection = connection;
+    readerThread = std::thread([this, fd, connection]() { readLoop(fd, connection); });
+    return true;
+#endif
+}
+
+void IpcAdapter::readLoop(int fd, std::uint64_t connection) {
+#if !defined(_WIN32)
+    std::string buffer;
+    std::size_t consumed = 0;
+    std::array<char, kReadChunkSize> chunk {};
+
+    while (true) {
+        std::array<pollfd, 2> fds {};
+        fds[0].fd = fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = wakePipe[0];
+        fds[1].events = POLLIN;
+        if (poll(fds.data(), fds.size(), expireRequests()) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::getInstance().log("poll failed on IPC socket '" + socketPath + "': " + std::strerror(errno));
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+        }
+        if (!(fds[0].revents & (POLLIN | POLLERR | POLLHUP))) {
+            continue;
+        }
+
+        const ssize_t received = recv(fd, chunk.data(), chunk.size(), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            if (!stopping) {
+                Logger::getInstance().log("IPC connection closed on socket: " + socketPath);
+            }
+            break;
+        }
+
+        buffer.append(chunk.data(), static_cast<std::size_t>(received));
+        std::size_t newline = buffer.find('\n', consumed);
+        while (newline != std::string::npos) {
+            const std::string_view message(buffer.data() + consumed, newline - consumed);
+            if (message.find_first_not_of(" \t\r") != std::string_view::npos) {
+                dispatch(message);
+            }
+            consumed = newline + 1;
+            newline = buffer.find('\n', consumed);
+        }
+        if (consumed > 0) {
+            buffer.erase(0, consumed);
+            consumed = 0;
+        }
+    }
+
+    // A newer connection may already be live; leave it and its requests alone.
+    std::uint64_t expected = connection;
+    liveConnection.compare_exchange_strong(expected, 0);
+    failPending(connection);
+#else
+    (void)fd;
+    (void)connection;
+#endif
+}
+
+void IpcAdapter::dispatch(std::string_view message) {
+    const std::vector<JsonSpan> spans = findIdSpans(message);
+    if (spans.empty()) {
+        Logger::getInstance().log("Ignoring IPC message without 'id'.");
+        return;
+    }
+
+    Ref<Pending> entry;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        for (const JsonSpan& span : spans) {
+            std::uint64_t wireId = 0;
+            const auto [ptr, ec] = std::from_chars(message.data() + span.begin, message.data() + span.end, wireId);
+            if (ec != std::errc()) {
+                continue;
+            }
+            auto it = pending.find(wireId);
+            if (it != pending.end()) {
+                entry = it->second;
+                break;
+            }
+        }
+        if (entry) {
+            forgetLocked(*entry);
+        }
+    }
+    if (!entry) {
+        return;
+    }
+
+    std::string response;
+    response.reserve(message.size());
+    std::size_t last = 0;
+    for (const JsonSpan& span : spans) {
+        std::uint64_t wireId = 0;
+        std::from_chars(message.data() + span.begin, message.data() + span.end, wireId);
+        auto original = entry->originalIds.find(wireId);
+        response.append(message.substr(last, span.begin - last));
+        response.append(original != entry->originalIds.end() ? std::string_view(original->second) : message.substr(span.begin, span.end - span.begin));
+        last = span.end;
+    }
+    response.append(message.substr(last));
+
+    entry->callback(std::move(response));
+}
+
+void IpcAdapter::disconnect() {
+#if !defined(_WIN32)
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+#endif
+    liveConnection = 0;
+}
+
+void IpcAdapter::failPending(std::optional<std::uint64_t> connection) {
+    std::unordered_map<std::uint64_t, Ref<Pending>> failed;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (connection && it->second->connection != *connection) {
+                ++it;
+                continue;
+            }
+            if (it->second->deadline) {
+                deadlines.erase(*it->second->deadline);
+                it->second->deadline.reset();
+            }
+            failed.insert(pending.extract(it++));
+        }
+    }
+
+    std::unordered_set<Pending*> notified;
+    for (auto& [wireId, entry] : failed) {
+        if (notified.insert(entry.get()).second) {
+            entry->callback(std::nullopt);
+        }
+    }
+}
+
+bool IpcAdapter::removePending(const Ref<Pending>& entry) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return forgetLocked(*entry);
+}
+
+bool IpcAdapter::forgetLocked(Pending& entry) {
+    bool removed = false;
+    for (const auto& [wireId, originalId] : entry.originalIds) {
+        removed = pending.erase(wireId) > 0 || removed;
+    }
+    if (entry.deadline) {
+        deadlines.erase(*entry.deadline);
+        entry.deadline.reset();
+    }
+    return removed;
+}
+
+int IpcAdapter::expireRequests() {
+    std::vector<Ref<Pending>> expired;
+    int wait = -1;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        const auto now = std::chrono::steady_clock::now();
+        while (!deadlines.empty() && deadlines.begin()->first <= now) {
+            Ref<Pending> entry = deadlines.begin()->second;
+            forgetLocked(*entry);
+            expired.push_back(std::move(entry));
+        }
+        if (!deadlines.empty()) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadlines.begin()->first - now);
+            wait = static_cast<int>(std::min<std::chrono::milliseconds::rep>(left.count(), std::numeric_limits<int>::max()));
+        }
+    }
+
+    for (const Ref<Pending>& entry : expired) {
+        Logger::getInstance().log("IPC request timed out on socket: " + socketPath);
+        entry->callback(std::nullopt);
+    }
+    return wait;
+}
+
+void IpcAdapter::wakeUp() {
+#if !defined(_WIN32)
+    if (wakePipe[1] >= 0) {
+        const char byte = 1;
+        [[maybe_unused]] const ssize_t written = write(wakePipe[1], &byte, 1);
+    }
+#endif
+}
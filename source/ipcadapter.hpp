@@ -0,0 +1,127 @@
+#ifndef IPCADAPTER_HPP
+#define IPCADAPTER_HPP
+
+#include "common.hpp"
+#include <stop_token>
+
+/**
+ * @class IpcAdapter
+ * @brief JSON-RPC transport over a node's Unix domain socket (e.g. geth.ipc).
+ *
+ * Requests are written as newline-delimited JSON on one persistent socket and
+ * any number of them may be in flight at once. A reader thread matches each
+ * response to its request by "id". Request ids are rewritten to connection-unique
+ * values on the wire and restored in the response, so callers sharing the socket
+ * may reuse ids freely. Batch requests (JSON arrays) are supported.
+ *
+ * The socket is connected lazily and reconnected on the next request after a failure.
+ * Requests may carry a deadline and a stop_token; the reader thread fails requests
+ * whose deadline passed, and requesting stop fails a request at once. A late
+ * response to such a request is discarded. Callbacks may send further requests,
+ * including the failure callbacks run when the connection drops.
+ */
+class PROJECT_EXPORT IpcAdapter {
+public:
+    /**
+     * @brief Callback invoked with the response, or an empty std::optional on failure.
+     */
+    using Callback = std::function<void(std::optional<std::string>)>;
+
+    /**
+     * @brief Constructs an adapter for the given socket.
+     * @param socketPath Filesystem path of the node's IPC socket.
+     * @param timeout How long sendRequest() waits for a response.
+     */
+    explicit IpcAdapter(std::string socketPath, std::chrono::milliseconds timeout = std::chrono::seconds(30));
+
+    /**
+     * @brief Closes the socket, failing every request still in flight.
+     */
+    ~IpcAdapter();
+
+    IpcAdapter(const IpcAdapter&) = delete;
+    IpcAdapter& operator=(const IpcAdapter&) = delete;
+    IpcAdapter(IpcAdapter&&) = delete;
+    IpcAdapter& operator=(IpcAdapter&&) = delete;
+
+    /**
+     * @brief Checks whether an endpoint string designates an IPC socket.
+     * @param url The endpoint, e.g. "ipc:///data/geth.ipc" or "/data/geth.ipc".
+     * @return True for the "ipc://" scheme and for paths ending in ".ipc".
+     */
+    static bool isIpcEndpoint(std::string_view url);
+
+    /**
+     * @brief Extracts the socket path from an IPC endpoint string.
+     */
+    static std::string socketPathFromEndpoint(std::string_view url);
+
+    /**
+     * @brief Sends a JSON-RPC request and waits for its response.
+     * @param data The JSON-RPC request (object or batch array).
+     * @return The response, or an empty std::optional on failure or timeout.
+     */
+    std::optional<std::string> sendRequest(const std::string& data);
+
+    /**
+     * @brief Sends a JSON-RPC request and waits at most the given time for its response.
+     * @param data The JSON-RPC request (object or batch array).
+     * @param timeout How long to wait, e.g. what is left of the caller's deadline.
+     * @param cancellation Requesting stop abandons the request.
+     * @return The response, or an empty std::optional on failure, timeout or cancellation.
+     */
+    std::optional<std::string> sendRequest(const std::string& data, std::chrono::milliseconds timeout,
+                                           std::stop_token cancellation = {});
+
+    /**
+     * @brief Sends a JSON-RPC request without waiting for its response.
+     * @param data The JSON-RPC request (object or batch array).
+     * @param callback Invoked once the response arrives, usually on the reader thread. It receives an empty
+     *        std::optional on failure, once @p deadline passes, or on the stopping thread once stop is requested.
+     * @param deadline When to give up on the response.
+     * @param cancellation Requesting stop abandons the request.
+     */
+    void sendRequestAsync(const std::string& data, Callback callback,
+                          std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(),
+                          std::stop_token cancellation = {});
+
+private:
+    struct Pending;
+
+    /**
+     * @brief In-flight requests with a deadline, earliest first.
+     */
+    using Deadlines = std::multimap<std::chrono::steady_clock::time_point, Ref<Pending>>;
+
+    Ref<Pending> submit(const std::string& data, Callback callback, std::chrono::steady_clock::time_point deadline,
+                        std::stop_token cancellation);
+    bool ensureConnected(std::unique_lock<std::mutex>& writeLock);
+    void readLoop(int fd, std::uint64_t connection);
+    void dispatch(std::string_view message);
+    void disconnect();
+
+    /**
+     * @brief Fails the requests sent on one connection, or every pending request if none is given.
+     */
+    void failPending(std::optional<std::uint64_t> connection = std::nullopt);
+    bool removePending(const Ref<Pending>& entry);
+    bool forgetLocked(Pending& entry);
+    int expireRequests();
+    void wakeUp();
+
+    std::string socketPath; ///< Filesystem path of the IPC socket.
+    std::chrono::milliseconds timeout; ///< Timeout applied by sendRequest().
+    std::mutex writeMutex; ///< Serializes connects and writes to the socket.
+    int socketFd = -1; ///< The connected socket, or -1.
+    std::atomic<std::uint64_t> liveConnection {0}; ///< Number of the usable connection, or 0; cleared when it drops.
+    std::uint64_t connections = 0; ///< Connections made so far; guarded by writeMutex.
+    std::atomic<bool> stopping {false}; ///< Set when the adapter is being destroyed.
+    std::thread readerThread; ///< Reads and dispatches responses.
+    std::mutex pendingMutex; ///< Guards pending.
+    std::unordered_map<std::uint64_t, Ref<Pending>> pending; ///< In-flight requests keyed by wire id.
+    Deadlines deadlines; ///< In-flight requests with a deadline; guarded by pendingMutex.
+    int wakePipe[2] = {-1, -1}; ///< Self-pipe that interrupts the reader's poll when an earlier deadline is added.
+    std::atomic<std::uint64_t> nextId {1}; ///< Next wire id.
+};
+
+#endif // IPCADAPTER_HPP
@@ -0,0 +1,18 @@
+#include "jsonbackend.hpp"
+
+JsonBackend::~JsonBackend() = default;
+
+Ref<JsoncppBackend> JsoncppBackend::shared() {
+    static Ref<JsoncppBackend> instance = CreateRef<JsoncppBackend>();
+    return instance;
+}
+
+bool JsoncppBackend::parse(std::string_view text, Json::Value& value, std::string* errors) {
+    // Readers are stateless between parses but not thread-safe.
+    thread_local const Scope<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+    return reader->parse(text.data(), text.data() + text.size(), &value, errors);
+}
+
+std::string JsoncppBackend::name() const {
+    return "jsoncpp";
+}
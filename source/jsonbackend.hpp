@@ -0,0 +1,50 @@
+#ifndef JSONBACKEND_HPP
+#define JSONBACKEND_HPP
+
+#include "common.hpp"
+#include <json/json.h>
+
+/**
+ * @class JsonBackend
+ * @brief Abstract parser that turns JSON text into a Json::Value.
+ *
+ * EthereumClient parses responses through a backend, so jsoncpp's reader can be
+ * swapped for a faster parser without changing the types callers receive.
+ * Implementations must be safe to call from several threads at once.
+ */
+class PROJECT_EXPORT JsonBackend {
+public:
+    virtual ~JsonBackend();
+
+    /**
+     * @brief Parses a complete JSON text.
+     * @param text The JSON text.
+     * @param value Receives the parsed value.
+     * @param errors Optional; receives a description of why parsing failed.
+     * @return True if @p text is valid JSON.
+     */
+    virtual bool parse(std::string_view text, Json::Value& value, std::string* errors) = 0;
+
+    /**
+     * @brief Retrieves a short name of the backend for logs and benchmarks, e.g. "jsoncpp".
+     */
+    virtual std::string name() const = 0;
+};
+
+/**
+ * @class JsoncppBackend
+ * @brief Parses with jsoncpp's CharReader, one reader per thread.
+ */
+class PROJECT_EXPORT JsoncppBackend final : public JsonBackend {
+public:
+    /**
+     * @brief Returns the process-wide jsoncpp backend, the default of EthereumClient.
+     */
+    static Ref<JsoncppBackend> shared();
+
+    bool parse(std::string_view text, Json::Value& value, std::string* errors) override;
+
+    std::string name() const override;
+};
+
+#endif // JSONBACKEND_HPP
@@ -0,0 +1,281 @@
+#include "jsonscan.hpp"
+#include <charconv>
+
+namespace {
+/**
+ * @brief Returns the index of the quote closing the string that starts at @p open.
+ */
+std::size_t skipString(std::string_view json, std::size_t open) {
+    for (std::size_t i = open + 1; i < json.size(); ++i) {
+        if (json[i] == '\\') {
+            ++i;
+        } else if (json[i] == '"') {
+            return i;
+        }
+    }
+    return json.size();
+}
+
+std::size_t skipWhitespace(std::string_view json, std::size_t pos) {
+    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r')) {
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+ * @brief Returns the index one past the value that starts at @p pos.
+ */
+std::size_t skipValue(std::string_view json, std::size_t pos) {
+    if (pos >= json.size()) {
+        return pos;
+    }
+    if (json[pos] == '"') {
+        return std::min(skipString(json, pos) + 1, json.size());
+    }
+    if (json[pos] == '{' || json[pos] == '[') {
+        std::size_t depth = 0;
+        for (std::size_t i = pos; i < json.size(); ++i) {
+            const char c = json[i];
+            if (c == '"') {
+                i = skipString(json, i);
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return i + 1;
+            }
+        }
+        return json.size();
+    }
+    while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' && json[pos] != ' '
+           && json[pos] != '\t' && json[pos] != '\n' && json[pos] != '\r') {
+        ++pos;
+    }
+    return pos;
+}
+}
+
+std::vector<JsonSpan> findIdSpans(std::string_view json) {
+    std::vector<JsonSpan> spans;
+    std::vector<char> containers;
+    bool expectKey = false;
+
+    for (std::size_t i = 0; i < json.size(); ++i) {
+        const char c = json[i];
+        if (c == '"') {
+            const std::size_t close = skipString(json, i);
+            const bool messageLevel = !containers.empty() && containers.back() == '{'
+                && (containers.size() == 1 || (containers.size() == 2 && containers.front() == '['));
+            if (expectKey && messageLevel && json.substr(i + 1, close - i - 1) == "id") {
+                std::size_t pos = skipWhitespace(json, close + 1);
+                if (pos < json.size() && json[pos] == ':') {
+                    pos = skipWhitespace(json, pos + 1);
+                    std::size_t end = pos;
+                    if (end < json.size() && json[end] == '"') {
+                        end = skipString(json, end) + 1;
+                    } else {
+                        while (end < json.size() && json[end] != ',' && json[end] != '}' && json[end] != ' '
+                               && json[end] != '\t' && json[end] != '\n' && json[end] != '\r') {
+                            ++end;
+                        }
+                    }
+                    // A message-level id is followed by ',' or '}'; one cut off by the end of the text is not reported.
+                    if (end >= json.size()) {
+                        break;
+                    }
+                    spans.push_back({pos, end});
+                    i = end - 1;
+                    expectKey = false;
+                    continue;
+                }
+            }
+            expectKey = false;
+            i = close;
+        } else if (c == '{') {
+            containers.push_back('{');
+            expectKey = true;
+        } else if (c == '[') {
+            containers.push_back('[');
+            expectKey = false;
+        } else if (c == '}' || c == ']') {
+            if (!containers.empty()) {
+                containers.pop_back();
+            }
+        } else if (c == ',') {
+            expectKey = !containers.empty() && containers.back() == '{';
+        }
+    }
+    return spans;
+}
+
+std::optional<JsonSpan> findMemberSpan(std::string_view json, std::string_view key) {
+    std::size_t pos = skipWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '{') {
+        return std::nullopt;
+    }
+    pos = skipWhitespace(json, pos + 1);
+    while (pos < json.size() && json[pos] == '"') {
+        const std::size_t close = skipString(json, pos);
+        const std::string_view name = json.substr(pos + 1, close - pos - 1);
+        pos = skipWhitespace(json, close + 1);
+        if (pos >= json.size() || json[pos] != ':') {
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, pos + 1);
+        const std::size_t end = skipValue(json, pos);
+        if (end >= json.size()) {
+            // The object is cut off before its closing brace, possibly inside this value.
+            return std::nullopt;
+        }
+        if (name == key) {
+            return JsonSpan {pos, end};
+        }
+        pos = skipWhitespace(json, end);
+        if (pos >= json.size() || json[pos] != ',') {
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, pos + 1);
+    }
+    return std::nullopt;
+}
+
+std::string_view findMethod(std::string_view json) {
+    const std::optional<JsonSpan> span = findMemberSpan(json, "method");
+    if (!span || span->end - span->begin < 2 || json[span->begin] != '"') {
+        return {};
+    }
+    return json.substr(span->begin + 1, span->end - span->begin - 2);
+}
+
+std::vector<JsonSpan> findElementSpans(std::string_view json) {
+    std::vector<JsonSpan> spans;
+    std::size_t pos = skipWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '[') {
+        return spans;
+    }
+    pos = skipWhitespace(json, pos + 1);
+    while (pos < json.size() && json[pos] != ']') {
+        const std::size_t end = skipValue(json, pos);
+        if (end >= json.size()) {
+            // The array is cut off before its closing bracket, possibly inside this element.
+            break;
+        }
+        spans.push_back({pos, end});
+        pos = skipWhitespace(json, end);
+        if (pos >= json.size() || json[pos] != ',') {
+            break;
+        }
+        pos = skipWhitespace(json, pos + 1);
+    }
+    return spans;
+}
+
+std::vector<std::string_view> findMethods(std::string_view json) {
+    const std::size_t pos = skipWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '[') {
+        return {findMethod(json)};
+    }
+    std::vector<std::string_view> methods;
+    for (const JsonSpan& span : findElementSpans(json)) {
+        methods.push_back(findMethod(json.substr(span.begin, span.end - span.begin)));
+    }
+    return methods;
+}
+
+std::optional<int> findErrorCode(std::string_view json) {
+    std::size_t pos = skipWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '{') {
+        return std::nullopt;
+    }
+    pos = skipWhitespace(json, pos + 1);
+    while (pos < json.size() && json[pos] == '"') {
+        const std::size_t close = skipString(json, pos);
+        const std::string_view name = json.substr(pos + 1, close - pos - 1);
+        if (name == "result") {
+            // Stop before skipping over what may be a large result.
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, close + 1);
+        if (pos >= json.size() || json[pos] != ':') {
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, pos + 1);
+        const std::size_t end = skipValue(json, pos);
+        if (end >= json.size()) {
+            return std::nullopt;
+        }
+        if (name == "error") {
+            if (pos >= json.size() || json[pos] != '{') {
+                return std::nullopt;
+            }
+            const std::string_view object = json.substr(pos, end - pos);
+            const std::optional<JsonSpan> code = findMemberSpan(object, "code");
+            int value = 0;
+            if (!code || std::from_chars(object.data() + code->begin, object.data() + code->end, value).ec != std::errc()) {
+                return std::nullopt;
+            }
+            return value;
+        }
+        pos = skipWhitespace(json, end);
+        if (pos >= json.size() || json[pos] != ',') {
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, pos + 1);
+    }
+    return std::nullopt;
+}
+
+std::optional<ResponseSpans> findResponseSpans(std::string_view json) {
+    std::size_t pos = skipWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '{') {
+        return std::nullopt;
+    }
+    ResponseSpans spans;
+    pos = skipWhitespace(json, pos + 1);
+    if (pos < json.size() && json[pos] == '}') {
+        return spans;
+    }
+    while (pos < json.size() && json[pos] == '"') {
+        const std::size_t close = skipString(json, pos);
+        if (close >= json.size()) {
+            return std::nullopt;
+        }
+        const std::string_view name = json.substr(pos + 1, close - pos - 1);
+        pos = skipWhitespace(json, close + 1);
+        if (pos >= json.size() || json[pos] != ':') {
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, pos + 1);
+        const std::size_t end = skipValue(json, pos);
+        if (end == pos || end > json.size() || (json[pos] == '"' && json[end - 1] != '"')) {
+            return std::nullopt;
+        }
+        if (name == "result") {
+            spans.result = JsonSpan {pos, end};
+        } else if (name == "error") {
+            spans.error = JsonSpan {pos, end};
+        }
+        pos = skipWhitespace(json, end);
+        if (pos < json.size() && json[pos] == '}') {
+            return spans;
+        }
+        if (pos >= json.size() || json[pos] != ',') {
+            return std::nullopt;
+        }
+        pos = skipWhitespace(json, pos + 1);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string_view> findPlainString(std::string_view json) {
+    if (json.size() < 2 || json.front() != '"' || json.back() != '"') {
+        return std::nullopt;
+    }
+    const std::string_view text = json.substr(1, json.size() - 2);
+    for (const char c : text) {
+        if (c == '\\' || c == '"' || static_cast<unsigned char>(c) < 0x20) {
+            return std::nullopt;
+        }
+    }
+    return text;
+}
@@ -0,0 +1,91 @@
+#ifndef JSONSCAN_HPP
+#define JSONSCAN_HPP
+
+#include "common.hpp"
+
+/**
+ * @file jsonscan.hpp
+ * @brief Locates fields of JSON-RPC messages without building a document.
+ *
+ * Transports use these scanners on the hot path to route and rewrite messages
+ * by "id" or "method" while leaving the full parse to the client. Values are
+ * skipped, not validated, but a value cut off by the end of a truncated text is
+ * never reported.
+ */
+
+/**
+ * @struct JsonSpan
+ * @brief Byte range [begin, end) of a value inside a JSON text.
+ */
+struct JsonSpan {
+    std::size_t begin = 0; ///< Offset of the first byte of the value.
+    std::size_t end = 0;   ///< Offset one past the last byte of the value.
+};
+
+/**
+ * @brief Locates the "id" values of a JSON-RPC message.
+ * @param json A single message object or a batch array of message objects.
+ * @return The span of each message's "id" value, in document order.
+ */
+std::vector<JsonSpan> findIdSpans(std::string_view json);
+
+/**
+ * @brief Locates the value of a member of the top-level JSON object.
+ * @param json A JSON object.
+ * @param key The member name (compared without unescaping).
+ * @return The span of the raw value text (strings include their quotes), or an empty std::optional.
+ */
+std::optional<JsonSpan> findMemberSpan(std::string_view json, std::string_view key);
+
+/**
+ * @brief Extracts the "method" of a JSON-RPC request object.
+ * @return The method name without quotes, or an empty view if there is none.
+ */
+std::string_view findMethod(std::string_view json);
+
+/**
+ * @brief Locates the elements of a top-level JSON array, e.g. the messages of a batch.
+ * @return The span of each element, in document order; empty if @p json is not an array.
+ */
+std::vector<JsonSpan> findElementSpans(std::string_view json);
+
+/**
+ * @brief Extracts the "method" of every request in a JSON-RPC message.
+ * @param json A single request object or a batch array of request objects.
+ * @return One method name per request, in document order; empty views for requests without one.
+ */
+std::vector<std::string_view> findMethods(std::string_view json);
+
+/**
+ * @brief Extracts the "error" code of a JSON-RPC response object.
+ * @return The code, or an empty std::optional if the response carries no error object.
+ *
+ * Scanning stops at a "result" member, so successful responses cost only a few bytes.
+ */
+std::optional<int> findErrorCode(std::string_view json);
+
+/**
+ * @struct ResponseSpans
+ * @brief Locations of the "result" and "error" members of a JSON-RPC response object.
+ */
+struct ResponseSpans {
+    std::optional<JsonSpan> result; ///< Span of the "result" value, if present.
+    std::optional<JsonSpan> error;  ///< Span of the "error" value, if present.
+};
+
+/**
+ * @brief Locates the "result" and "error" members of a JSON-RPC response in one pass over its top-level object.
+ * @return The spans, or an empty std::optional if @p json is not a well-formed object at the top level.
+ *
+ * Member values are skipped, not validated; parse a span to validate it.
+ */
+std::optional<ResponseSpans> findResponseSpans(std::string_view json);
+
+/**
+ * @brief Reads a JSON string value that needs no unescaping.
+ * @param json The value text, including its quotes.
+ * @return The characters between the quotes, or an empty std::optional if @p json is not a string or contains escapes.
+ */
+std::optional<std::string_view> findPlainString(std::string_view json);
+
+#endif // JSONSCAN_HPP
@@ -0,0 +1,246 @@
+#include "jsonstreamparser.hpp"
+#include <cstring>
+
+namespace {
+/**
+ * @brief Deepest nesting accepted, matching jsoncpp's default stack limit.
+ */
+constexpr std::size_t kMaxDepth = 1000;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool isScalarKind(char kind) {
+    return kind != '{' && kind != '[' && kind != '"';
+}
+}
+
+JsonStreamParser::JsonStreamParser(std::vector<std::string> path, ElementCallback onElement, Ref<JsonBackend> backend)
+    : path(std::move(path)), onElement(std::move(onElement)),
+      backend(backend ? std::move(backend) : JsoncppBackend::shared()) {}
+
+bool JsonStreamParser::feed(std::string_view chunk) {
+    if (halted || !failure.empty()) {
+        return false;
+    }
+
+    const std::size_t size = chunk.size();
+    std::size_t i = 0;
+    mark = 0;
+    while (i < size) {
+        if (!inString) {
+            if (!scan(chunk, i)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (escaped) {
+            // Path keys are plain names, so a key with an escape never matches.
+            escaped = false;
+            keyMatches = false;
+            ++keyLength;
+            ++i;
+            continue;
+        }
+        if (!keyOnPath) {
+            // Nothing inside other strings matters: jump to the next quote or backslash.
+            const char* begin = chunk.data() + i;
+            const auto* quote = static_cast<const char*>(std::memchr(begin, '"', size - i));
+            const std::size_t limit = quote ? static_cast<std::size_t>(quote - chunk.data()) : size;
+            const auto* backslash = static_cast<const char*>(std::memchr(begin, '\\', limit - i));
+            i = backslash ? static_cast<std::size_t>(backslash - chunk.data()) : limit;
+            if (i == size) {
+                break;
+            }
+        }
+
+        const char c = chunk[i];
+        if (c == '\\') {
+            escaped = true;
+        } else if (c != '"') {
+            const std::string& key = path[matched];
+            keyMatches = keyMatches && keyLength < key.size() && key[keyLength] == c;
+            ++keyLength;
+        } else {
+            inString = false;
+            if (keyOnPath) {
+                keyOnPath = false;
+                valueOnPath = keyMatches && keyLength == path[matched].size();
+            } else if (target == Target::Element && elementKind == '"' && containers.size() == streamDepth
+                       && !emitElement(chunk, i + 1)) {
+                return false;
+            }
+        }
+        ++i;
+    }
+
+    flush(chunk, size);
+    return true;
+}
+
+bool JsonStreamParser::finish() {
+    if (halted || !failure.empty()) {
+        return false;
+    }
+    if (inString || !containers.empty()) {
+        return fail("The text ends inside a " + std::string(inString ? "string." : "container."));
+    }
+    return true;
+}
+
+const std::string& JsonStreamParser::remainder() const {
+    return rest;
+}
+
+std::size_t JsonStreamParser::elementCount() const {
+    return elements;
+}
+
+std::size_t JsonStreamParser::peakBufferedBytes() const {
+    return peak;
+}
+
+bool JsonStreamParser::stopped() const {
+    return halted;
+}
+
+const std::string& JsonStreamParser::error() const {
+    return failure;
+}
+
+bool JsonStreamParser::scan(std::string_view chunk, std::size_t& i) {
+    const char c = chunk[i];
+
+    if (streamDepth != 0 && containers.size() == streamDepth) {
+        const bool delimiter = c == ',' || c == ']' || isSpace(c);
+        if (target == Target::Element && isScalarKind(elementKind) && delimiter && !emitElement(chunk, i)) {
+            return false;
+        }
+        if (target == Target::Gap) {
+            if (c == ',' || isSpace(c)) {
+                ++i;
+                return true;
+            }
+            flush(chunk, i);
+            if (c == ']') {
+                target = Target::Remainder;
+            } else {
+                target = Target::Element;
+                elementKind = c;
+            }
+        }
+    }
+
+    switch (c) {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\t':
+        break;
+    case '{':
+    case '[': {
+        const bool opensStream = beginValue(c);
+        if (containers.size() >= kMaxDepth) {
+            return fail("The text is nested too deeply.");
+        }
+        containers.push_back(c);
+        expectKey = c == '{';
+        if (opensStream) {
+            streamDepth = containers.size();
+            flush(chunk, i + 1);
+            target = Target::Gap;
+        }
+        break;
+    }
+    case '}':
+    case ']':
+        if (containers.empty() || containers.back() != (c == '}' ? '{' : '[')) {
+            return fail(std::string("Unexpected '") + c + "'.");
+        }
+        if (containers.size() == streamDepth) {
+            streamDepth = 0;
+        }
+        containers.pop_back();
+        expectKey = false;
+        valueOnPath = false;
+        if (matched > 0 && containers.size() == matched) {
+            --matched;
+        }
+        if (target == Target::Element && containers.size() == streamDepth && !emitElement(chunk, i + 1)) {
+            return false;
+        }
+        break;
+    case ':':
+        expectKey = false;
+        break;
+    case ',':
+        expectKey = !containers.empty() && containers.back() == '{';
+        valueOnPath = false;
+        break;
+    case '"':
+        inString = true;
+        if (expectKey && containers.back() == '{') {
+            keyOnPath = streamDepth == 0 && matched < path.size() && containers.size() == matched + 1;
+            keyMatches = true;
+            keyLength = 0;
+            valueOnPath = false;
+        } else {
+            beginValue(c);
+        }
+        break;
+    default:
+        beginValue(c);
+        break;
+    }
+    ++i;
+    return true;
+}
+
+void JsonStreamParser::flush(std::string_view chunk, std::size_t end) {
+    if (end > mark) {
+        if (target == Target::Remainder) {
+            rest.append(chunk.data() + mark, end - mark);
+        } else if (target == Target::Element) {
+            element.append(chunk.data() + mark, end - mark);
+        }
+        peak = std::max(peak, rest.size() + element.size());
+    }
+    mark = end;
+}
+
+bool JsonStreamParser::emitElement(std::string_view chunk, std::size_t end) {
+    flush(chunk, end);
+    target = Target::Gap;
+
+    Json::Value value;
+    std::string errors;
+    if (!backend->parse(element, value, &errors)) {
+        return fail("Element " + std::to_string(elements) + " is not valid JSON: " + errors);
+    }
+    element.clear();
+    ++elements;
+    if (!onElement(value)) {
+        halted = true;
+        return false;
+    }
+    return true;
+}
+
+bool JsonStreamParser::beginValue(char first) {
+    if (!valueOnPath) {
+        return false;
+    }
+    valueOnPath = false;
+    if (first == '{' && matched + 1 < path.size()) {
+        ++matched;
+        return false;
+    }
+    return first == '[' && matched + 1 == path.size();
+}
+
+bool JsonStreamParser::fail(std::string message) {
+    failure = std::move(message);
+    return false;
+}
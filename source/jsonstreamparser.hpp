@@ -0,0 +1,138 @@
+#ifndef JSONSTREAMPARSER_HPP
+#define JSONSTREAMPARSER_HPP
+
+#include "common.hpp"
+#include <json/json.h>
+#include "jsonbackend.hpp"
+
+/**
+ * @class JsonStreamParser
+ * @brief Incremental parser that hands out the elements of one array of a JSON text while the text arrives.
+ *
+ * The array is named by a path of object keys from the root, e.g. {"result"} for
+ * the logs of an eth_getLogs response or {"result", "transactions"} for the
+ * transactions of a block. Text is fed in chunks of any size; as soon as an
+ * element of that array is complete it is parsed on its own and passed to the
+ * callback, and its bytes are dropped. Everything else is kept as the
+ * remainder: the document with the array emptied, e.g. the response envelope
+ * and block header. Memory is thus bounded by the largest element plus the
+ * remainder, no matter how long the array is.
+ *
+ * Chunks are only scanned for string and container boundaries; elements are
+ * validated when they are parsed and the remainder when the caller parses it.
+ * If the path does not lead to an array, e.g. because the node returned an
+ * error, nothing is streamed and the whole text ends up in the remainder.
+ */
+class PROJECT_EXPORT JsonStreamParser {
+public:
+    /**
+     * @brief Receives one element of the streamed array; returning false stops parsing.
+     */
+    using ElementCallback = std::function<bool(Json::Value& element)>;
+
+    /**
+     * @brief Constructs a parser.
+     * @param path Keys leading from the root object to the array to stream; empty streams nothing.
+     * @param onElement Invoked with each element, in document order.
+     * @param backend Parses the elements; jsoncpp is used when null.
+     */
+    JsonStreamParser(std::vector<std::string> path, ElementCallback onElement, Ref<JsonBackend> backend = nullptr);
+
+    /**
+     * @brief Consumes the next chunk of the text, invoking the callback for every element it completes.
+     * @return False once the text turned out malformed or the callback stopped parsing; later chunks are ignored.
+     */
+    bool feed(std::string_view chunk);
+
+    /**
+     * @brief Checks that the text fed so far is complete.
+     * @return False if parsing failed or stopped, or the text ends inside a string or container.
+     */
+    bool finish();
+
+    /**
+     * @brief Retrieves the text without the streamed elements, e.g. {"jsonrpc":"2.0","id":1,"result":[]}.
+     */
+    const std::string& remainder() const;
+
+    /**
+     * @brief Retrieves the number of elements passed to the callback.
+     */
+    std::size_t elementCount() const;
+
+    /**
+     * @brief Retrieves the most bytes held at once, remainder and pending element together.
+     */
+    std::size_t peakBufferedBytes() const;
+
+    /**
+     * @brief Checks whether the callback stopped parsing.
+     */
+    bool stopped() const;
+
+    /**
+     * @brief Describes why the text was rejected; empty if it was not.
+     */
+    const std::string& error() const;
+
+private:
+    /**
+     * @brief What the byte being scanned belongs to.
+     */
+    enum class Target {
+        Remainder, ///< Kept in the remainder.
+        Gap,       ///< Whitespace and commas between streamed elements; dropped.
+        Element    ///< Part of the element being received.
+    };
+
+    /**
+     * @brief Handles the byte at @p i, outside any string, and advances past it; returns false to stop parsing.
+     */
+    bool scan(std::string_view chunk, std::size_t& i);
+
+    /**
+     * @brief Moves chunk[mark, end) to the current target and continues from @p end.
+     */
+    void flush(std::string_view chunk, std::size_t end);
+
+    /**
+     * @brief Completes the pending element at chunk offset @p end, parses it and invokes the callback.
+     */
+    bool emitElement(std::string_view chunk, std::size_t end);
+
+    /**
+     * @brief Applies a value starting with @p first to path matching.
+     * @return True if the value is the array to stream.
+     */
+    bool beginValue(char first);
+
+    /**
+     * @brief Records a malformed text and returns false.
+     */
+    bool fail(std::string message);
+
+    std::vector<std::string> path;  ///< Keys leading to the streamed array.
+    ElementCallback onElement;      ///< Receives complete elements.
+    Ref<JsonBackend> backend;       ///< Parser of single elements.
+    std::string rest;               ///< The text outside streamed elements.
+    std::string element;            ///< Bytes of the element being received.
+    std::vector<char> containers;   ///< Open '{' and '[' from the root down.
+    Target target = Target::Remainder; ///< Where the bytes being scanned go.
+    std::size_t mark = 0;           ///< Offset in the current chunk from which bytes are not yet moved to the target.
+    char elementKind = 0;           ///< First byte of the pending element: '{', '[', '"' or a scalar's.
+    bool inString = false;          ///< Inside a string.
+    bool escaped = false;           ///< The previous string byte was a backslash.
+    bool expectKey = false;         ///< The next string of the innermost object is a key.
+    bool keyOnPath = false;         ///< The string being scanned is a key that may continue the path.
+    bool keyMatches = false;        ///< The key scanned so far equals path[matched].
+    std::size_t keyLength = 0;      ///< Bytes of the key scanned so far.
+    bool valueOnPath = false;       ///< The next value is the member named by path[matched].
+    std::size_t matched = 0;        ///< Path keys matched by the enclosing objects.
+    std::size_t streamDepth = 0;    ///< Nesting depth of the streamed array while inside it; 0 otherwise.
+    std::size_t elements = 0;       ///< Elements passed to the callback.
+    std::size_t peak = 0;           ///< Most bytes held at once.
+    bool halted = false;            ///< The callback stopped parsing.
+    std::string failure;            ///< Why the text was rejected.
+};
+
+#endif // JSONSTREAMPARSER_HPP
@@ -0,0 +1,89 @@
+#include "kerneltls.hpp"
+#include <cstring>
+
+#if defined(USE_OPENSSL) && __has_include(<openssl/ssl.h>)
+#include <openssl/bio.h>
+#include <openssl/ssl.h>
+#define KERNEL_TLS_AVAILABLE 1
+#endif
+
+#ifdef KERNEL_TLS_AVAILABLE
+namespace {
+/**
+ * @brief SSL_CTX ex-data slot that holds the owning KernelTls object.
+ */
+int contextIndex() {
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+/**
+ * @brief Checks whether libcurl's TLS backend is the OpenSSL 3 this file was compiled against.
+ *
+ * The callback receives libcurl's SSL_CTX; interpreting another backend's context as one would be fatal.
+ */
+bool curlUsesOpenSsl3() {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    return info && info->ssl_version && std::strncmp(info->ssl_version, "OpenSSL/3", 9) == 0
+           && OPENSSL_VERSION_MAJOR == 3;
+}
+}
+
+bool KernelTls::isSupported() {
+    static const bool supported = curlUsesOpenSsl3() && contextIndex() >= 0;
+    return supported;
+}
+
+bool KernelTls::enable(CURL* handle) {
+    if (!handle || !isSupported()) {
+        return false;
+    }
+    return curl_easy_setopt(handle, CURLOPT_SSL_CTX_FUNCTION, configureContext) == CURLE_OK
+           && curl_easy_setopt(handle, CURLOPT_SSL_CTX_DATA, this) == CURLE_OK;
+}
+
+CURLcode KernelTls::configureContext(CURL*, void* sslContext, void* userptr) {
+    auto* context = static_cast<SSL_CTX*>(sslContext);
+    SSL_CTX_set_options(context, SSL_OP_ENABLE_KTLS);
+    SSL_CTX_set_ex_data(context, contextIndex(), userptr);
+
+    // OpenSSL decides per direction after the handshake; the BIOs report what it chose.
+    SSL_CTX_set_info_callback(context, [](const SSL* ssl, int where, int) {
+        if (!(where & SSL_CB_HANDSHAKE_DONE)) {
+            return;
+        }
+        auto* self = static_cast<KernelTls*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex()));
+        if (!self) {
+            return;
+        }
+        self->tlsConnections.fetch_add(1, std::memory_order_relaxed);
+        if (BIO_get_ktls_recv(SSL_get_rbio(ssl))) {
+            self->kernelReceive.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (BIO_get_ktls_send(SSL_get_wbio(ssl))) {
+            self->kernelSend.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    return CURLE_OK;
+}
+#else
+bool KernelTls::isSupported() {
+    return false;
+}
+
+bool KernelTls::enable(CURL*) {
+    return false;
+}
+
+CURLcode KernelTls::configureContext(CURL*, void*, void*) {
+    return CURLE_OK;
+}
+#endif
+
+TlsOffloadStats KernelTls::stats() const {
+    return TlsOffloadStats {
+        tlsConnections.load(std::memory_order_relaxed),
+        kernelReceive.load(std::memory_order_relaxed),
+        kernelSend.load(std::memory_order_relaxed),
+    };
+}
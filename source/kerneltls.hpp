@@ -0,0 +1,72 @@
+#ifndef KERNELTLS_HPP
+#define KERNELTLS_HPP
+
+#include "common.hpp"
+#include <curl/curl.h>
+
+/**
+ * @struct TlsOffloadStats
+ * @brief Counters describing how many TLS connections were handed to the kernel.
+ */
+struct TlsOffloadStats {
+    std::size_t tlsConnections = 0; ///< TLS handshakes completed on connections configured for offload.
+    std::size_t kernelReceive = 0;  ///< Connections whose receive path was offloaded to kernel TLS.
+    std::size_t kernelSend = 0;     ///< Connections whose send path was offloaded to kernel TLS.
+};
+
+/**
+ * @class KernelTls
+ * @brief Hands established TLS sessions of libcurl handles to kernel TLS (kTLS).
+ *
+ * Once the handshake of a connection completes, OpenSSL installs the session
+ * keys into the socket (setsockopt TCP_ULP "tls"), so records are encrypted and
+ * decrypted by the kernel. Reads of a large response then come out of the
+ * socket as plaintext, skipping the userspace decrypt and its extra copy, and
+ * the connection keeps the offload for as long as libcurl keeps it pooled.
+ *
+ * Offload is negotiated per connection and per direction. When the kernel
+ * lacks the tls module, or the negotiated cipher or protocol version is not
+ * one the kernel implements, OpenSSL silently keeps that direction in
+ * userspace, so enabling it never breaks a connection; stats() tells how
+ * many connections were actually offloaded.
+ *
+ * Requires libcurl built against OpenSSL 3 and a build with OpenSSL headers
+ * (PROJECT_ENABLE_KTLS); otherwise enable() reports failure and handles are
+ * left unchanged.
+ */
+class PROJECT_EXPORT KernelTls {
+public:
+    KernelTls() = default;
+
+    KernelTls(const KernelTls&) = delete;
+    KernelTls& operator=(const KernelTls&) = delete;
+
+    /**
+     * @brief Checks whether kTLS support was compiled in and libcurl uses a compatible OpenSSL.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Requests kTLS for every TLS connection the handle opens from now on.
+     * @param handle The easy handle to configure; it must not outlive this object.
+     * @return False if kTLS is unsupported (see isSupported) or libcurl rejected the callback.
+     */
+    bool enable(CURL* handle);
+
+    /**
+     * @brief Retrieves the offload counters.
+     */
+    TlsOffloadStats stats() const;
+
+private:
+    /**
+     * @brief CURLOPT_SSL_CTX_FUNCTION callback; enables kTLS on the connection's SSL_CTX.
+     */
+    static CURLcode configureContext(CURL* handle, void* sslContext, void* userptr);
+
+    std::atomic<std::size_t> tlsConnections {0}; ///< Handshakes completed.
+    std::atomic<std::size_t> kernelReceive {0};  ///< Connections with kernel receive.
+    std::atomic<std::size_t> kernelSend {0};     ///< Connections with kernel send.
+};
+
+#endif // KERNELTLS_HPP
@@ -0,0 +1,69 @@
+#include "latencyhistogram.hpp"
+#include <cmath>
+
+namespace {
+constexpr double kFirstBucketNanoseconds = 10'000.0;
+constexpr double kGrowth = 1.1;
+}
+
+LatencyHistogram::LatencyHistogram(std::uint64_t window)
+    : window(std::max<std::uint64_t>(window, 2)) {}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    buckets[bucketFor(latency)].fetch_add(1, std::memory_order_relaxed);
+    if (total.fetch_add(1, std::memory_order_relaxed) + 1 < window) {
+        return;
+    }
+
+    bool expected = false;
+    if (!decaying.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return;
+    }
+    std::uint64_t kept = 0;
+    for (auto& bucket : buckets) {
+        const std::uint64_t value = bucket.load(std::memory_order_relaxed);
+        bucket.fetch_sub(value / 2, std::memory_order_relaxed);
+        kept += value - value / 2;
+    }
+    total.store(kept, std::memory_order_relaxed);
+    decaying.store(false, std::memory_order_release);
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double quantile) const {
+    std::array<std::uint64_t, kBuckets> snapshot {};
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+        sum += snapshot[i];
+    }
+    if (sum == 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    const auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(sum)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += snapshot[i];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) {
+            return upperBound(i);
+        }
+    }
+    return upperBound(kBuckets - 1);
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+std::size_t LatencyHistogram::bucketFor(std::chrono::nanoseconds latency) {
+    const double nanoseconds = static_cast<double>(latency.count());
+    if (nanoseconds <= kFirstBucketNanoseconds) {
+        return 0;
+    }
+    const auto bucket = static_cast<std::size_t>(std::ceil(std::log(nanoseconds / kFirstBucketNanoseconds) / std::log(kGrowth)));
+    return std::min(bucket, kBuckets - 1);
+}
+
+std::chrono::nanoseconds LatencyHistogram::upperBound(std::size_t bucket) {
+    return std::chrono::nanoseconds(static_cast<std::int64_t>(kFirstBucketNanoseconds * std::pow(kGrowth, static_cast<double>(bucket))));
+}
@@ -0,0 +1,51 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include "common.hpp"
+
+/**
+ * @class LatencyHistogram
+ * @brief Lock-free, log-bucketed latency histogram over a sliding window of samples.
+ *
+ * Buckets grow by 10% from 10 microseconds up to about 15 minutes, so percentiles
+ * are accurate to within one bucket. Once the window is full every bucket is halved,
+ * which lets the distribution follow changes in the node's behaviour.
+ */
+class PROJECT_EXPORT LatencyHistogram {
+public:
+    /**
+     * @brief Constructs an empty histogram.
+     * @param window Number of samples after which older samples are decayed.
+     */
+    explicit LatencyHistogram(std::uint64_t window = 2048);
+
+    /**
+     * @brief Adds a sample.
+     */
+    void record(std::chrono::nanoseconds latency);
+
+    /**
+     * @brief Estimates a percentile.
+     * @param quantile The quantile in [0, 1], e.g. 0.95.
+     * @return The upper bound of the bucket holding the quantile, or zero without samples.
+     */
+    std::chrono::nanoseconds percentile(double quantile) const;
+
+    /**
+     * @brief Retrieves the number of samples currently in the window.
+     */
+    std::uint64_t count() const;
+
+private:
+    static constexpr std::size_t kBuckets = 200;
+
+    static std::size_t bucketFor(std::chrono::nanoseconds latency);
+    static std::chrono::nanoseconds upperBound(std::size_t bucket);
+
+    std::uint64_t window; ///< Samples kept before decaying.
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets {}; ///< Sample counts per bucket.
+    std::atomic<std::uint64_t> total {0}; ///< Sum of all buckets.
+    std::atomic<bool> decaying {false}; ///< Set while one thread halves the buckets.
+};
+
+#endif // LATENCYHISTOGRAM_HPP
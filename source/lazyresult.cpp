@@ -0,0 +1,46 @@
+#include "lazyresult.hpp"
+
+LazyResult::LazyResult(std::string body, JsonSpan span, Ref<JsonBackend> backend)
+    : body(std::move(body)), span(span), backend(backend ? std::move(backend) : JsoncppBackend::shared()) {}
+
+std::string_view LazyResult::raw() const {
+    return std::string_view(body).substr(span.begin, span.end - span.begin);
+}
+
+bool LazyResult::isNull() const {
+    return raw() == "null";
+}
+
+bool LazyResult::isString() const {
+    const std::string_view text = raw();
+    return !text.empty() && text.front() == '"';
+}
+
+std::optional<std::string> LazyResult::asString() const {
+    if (const std::optional<std::string_view> plain = findPlainString(raw())) {
+        return std::string(*plain);
+    }
+    const Json::Value* result = json();
+    if (!result || !result->isString()) {
+        return std::nullopt;
+    }
+    return result->asString();
+}
+
+const Json::Value* LazyResult::json() const {
+    if (!parsed) {
+        parsed = true;
+        Json::Value result;
+        if (backend->parse(raw(), result, nullptr)) {
+            value = std::move(result);
+        }
+    }
+    return value ? &*value : nullptr;
+}
+
+std::optional<Json::Value> LazyResult::take() {
+    json();
+    // A later access parses the text again.
+    parsed = false;
+    return std::exchange(value, std::nullopt);
+}
@@ -0,0 +1,69 @@
+#ifndef LAZYRESULT_HPP
+#define LAZYRESULT_HPP
+
+#include "common.hpp"
+#include <json/json.h>
+#include "jsonbackend.hpp"
+#include "jsonscan.hpp"
+
+/**
+ * @class LazyResult
+ * @brief The "result" of a JSON-RPC response, kept as raw text until it is accessed.
+ *
+ * Holds the response body and the location of its result member. Scalars such
+ * as quantities and hashes are read straight from the text; a Json::Value is
+ * built only on the first call to json(), and only for the result, not for the
+ * rest of the response. Not thread-safe: json() caches the tree it builds.
+ */
+class PROJECT_EXPORT LazyResult {
+public:
+    /**
+     * @brief Wraps a response body.
+     * @param body The complete JSON-RPC response.
+     * @param span Location of the "result" value in @p body.
+     * @param backend Parses the result when it is accessed; jsoncpp is used when null.
+     */
+    LazyResult(std::string body, JsonSpan span, Ref<JsonBackend> backend = nullptr);
+
+    /**
+     * @brief Retrieves the result's JSON text as the node sent it; strings include their quotes.
+     */
+    std::string_view raw() const;
+
+    /**
+     * @brief Checks whether the result is null, e.g. for an unknown transaction hash.
+     */
+    bool isNull() const;
+
+    /**
+     * @brief Checks whether the result is a JSON string.
+     */
+    bool isString() const;
+
+    /**
+     * @brief Reads a string result, unescaping it only if it contains escapes.
+     * @return The string, or an empty std::optional if the result is not a string.
+     */
+    std::optional<std::string> asString() const;
+
+    /**
+     * @brief Parses the result on first access.
+     * @return The result tree, or nullptr if its text is not valid JSON.
+     */
+    const Json::Value* json() const;
+
+    /**
+     * @brief Moves the result tree out, parsing it if it was not accessed yet.
+     * @return The result, or an empty std::optional if its text is not valid JSON.
+     */
+    std::optional<Json::Value> take();
+
+private:
+    std::string body; ///< The response body.
+    JsonSpan span;    ///< Location of the result in body.
+    Ref<JsonBackend> backend; ///< Parser of the result.
+    mutable std::optional<Json::Value> value; ///< The parsed result, once json() was called.
+    mutable bool parsed = false; ///< Whether parsing was attempted.
+};
+
+#endif // LAZYRESULT_HPP
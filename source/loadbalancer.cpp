@@ -0,0 +1,464 @@
+#include "loadbalancer.hpp"
+#include "jsonscan.hpp"
+#include "logger.hpp"
+#include <cmath>
+
+namespace {
+/**
+ * @brief Latency floor in milliseconds, so unmeasured or very fast endpoints still compare by load.
+ */
+constexpr double kMinLatencyMs = 0.05;
+
+std::int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Method prefixes that change node or filter state and must reach exactly one endpoint.
+ */
+constexpr std::array<std::string_view, 11> kStatefulPrefixes {
+    "eth_send", "eth_sign", "eth_submit", "eth_new", "eth_uninstall", "eth_getFilterChanges",
+    "eth_subscribe", "eth_unsubscribe", "personal_", "admin_", "miner_"};
+
+/**
+ * @brief Returns the failure recorded for a request the transport reported as failed.
+ */
+FailureKind failureOf(const RequestContext& context) {
+    return context.failure == FailureKind::None ? FailureKind::Other : context.failure;
+}
+
+/**
+ * @brief Returns the failure to charge to the endpoint; running out of the caller's deadline counts as a cancellation.
+ */
+FailureKind endpointFailure(const RequestContext& context) {
+    return deadlineExceeded(context) ? FailureKind::Cancelled : failureOf(context);
+}
+
+/**
+ * @brief Checks whether a failure says something about the endpoint's health.
+ */
+bool blamesEndpoint(FailureKind kind) {
+    switch (kind) {
+    case FailureKind::Connect:
+    case FailureKind::Timeout:
+    case FailureKind::Network:
+    case FailureKind::RateLimited:
+    case FailureKind::ServerError:
+    case FailureKind::Other:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+struct LoadBalancer::Endpoint {
+    explicit Endpoint(const CircuitBreakerOptions& breakerOptions)
+        : breaker(breakerOptions) {}
+
+    std::string url;                          ///< Endpoint URL.
+    double weight = 1.0;                      ///< Configured weight (always positive).
+    std::atomic<double> latencyMs {0.0};      ///< Latency EWMA; updates may race, which only loses a sample.
+    std::atomic<double> errorRate {0.0};      ///< Error-rate EWMA as of lastSample.
+    std::atomic<std::int64_t> lastSample {0}; ///< steady_clock time of the last completed request, in ns.
+    std::atomic<std::size_t> inFlight {0};    ///< Outstanding requests.
+    std::atomic<std::uint64_t> requests {0};  ///< Requests routed here.
+    std::atomic<std::uint64_t> failures {0};  ///< Failed requests.
+    std::atomic<std::uint64_t> skipped {0};   ///< Times the endpoint was passed over because its circuit was open.
+    CircuitBreaker breaker;                   ///< Fails fast while the endpoint is unhealthy.
+};
+
+struct LoadBalancer::HedgedCall {
+    std::string data;                           ///< The request, shared by both attempts.
+    LatencyHistogram* histogram = nullptr;      ///< Latency of the method's primary attempts.
+    Callback callback;                          ///< The caller's callback; moved out when the call finishes.
+    RequestContext* caller = nullptr;           ///< The caller's context, if any; not touched after the callback.
+    std::array<std::size_t, 2> endpoint {};     ///< Endpoint of the primary and the hedge.
+    std::array<std::chrono::steady_clock::time_point, 2> started {}; ///< Start of each attempt.
+    std::array<std::stop_source, 2> stop;       ///< Cancels each attempt.
+    std::array<RequestContext, 2> attempts;     ///< Context handed to the transport per attempt.
+    Scope<std::stop_callback<std::function<void()>>> onCallerCancel; ///< Forwards the caller's cancellation to both attempts.
+
+    std::mutex mutex;          ///< Guards the state below.
+    std::size_t outstanding = 0; ///< Attempts in flight.
+    bool hedgePending = true;  ///< Whether the hedge timer may still send the second attempt.
+    bool finished = false;     ///< Whether the callback has been (or is being) invoked.
+};
+
+LoadBalancer::LoadBalancer(LoadBalancerOptions options, Transport& transport)
+    : options(std::move(options)), transport(transport) {
+    for (const EndpointConfig& config : this->options.endpoints) {
+        auto endpoint = CreateScope<Endpoint>(this->options.circuitBreaker);
+        endpoint->url = config.url;
+        endpoint->weight = config.weight > 0.0 ? config.weight : 1.0;
+        endpoints.push_back(std::move(endpoint));
+    }
+    if (endpoints.empty()) {
+        Logger::getInstance().log("LoadBalancer has no endpoints configured; every request will fail.");
+    }
+    stickyEndpoint = endpoints.size();
+
+    if (this->options.hedging) {
+        for (const std::string& method : this->options.hedgeMethods) {
+            if (!isIdempotent(method) || this->options.stickyMethods.contains(method)) {
+                Logger::getInstance().log("LoadBalancer will not hedge " + method + ": it is not a stateless read.");
+                continue;
+            }
+            hedgeLatency.emplace(method, CreateScope<LatencyHistogram>());
+        }
+    }
+}
+
+LoadBalancer::~LoadBalancer() = default;
+
+std::optional<std::string> LoadBalancer::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool LoadBalancer::sendPostRequestInto(const std::string&, const std::string& data, std::string& response,
+                                       RequestContext* context) {
+    const std::string_view method = findMethod(data);
+    if (hedgeHistogram(method)) {
+        std::promise<std::optional<std::string>> result;
+        std::future<std::optional<std::string>> answer = result.get_future();
+        sendHedged(method, data, [&result](std::optional<std::string> body) {
+            result.set_value(std::move(body));
+        }, context);
+        std::optional<std::string> body = answer.get();
+        if (!body) {
+            return false;
+        }
+        response = std::move(*body);
+        return true;
+    }
+
+    RequestContext local;
+    RequestContext& attempt = context ? *context : local;
+    const std::size_t index = selectEndpoint(method);
+    if (index >= endpoints.size()) {
+        attempt.failure = FailureKind::CircuitOpen;
+        return false;
+    }
+
+    begin(index);
+    const auto started = std::chrono::steady_clock::now();
+    const bool succeeded = transport.sendPostRequestInto(endpoints[index]->url, data, response, &attempt);
+    complete(index, started, succeeded ? FailureKind::None : endpointFailure(attempt));
+    return succeeded;
+}
+
+bool LoadBalancer::sendPostRequestStreaming(const std::string&, const std::string& data, const ChunkCallback& onChunk,
+                                            RequestContext* context) {
+    RequestContext local;
+    RequestContext& attempt = context ? *context : local;
+    const std::size_t index = selectEndpoint(findMethod(data));
+    if (index >= endpoints.size()) {
+        attempt.failure = FailureKind::CircuitOpen;
+        return false;
+    }
+
+    begin(index);
+    const auto started = std::chrono::steady_clock::now();
+    const bool succeeded = transport.sendPostRequestStreaming(endpoints[index]->url, data, onChunk, &attempt);
+    complete(index, started, succeeded ? FailureKind::None : endpointFailure(attempt));
+    return succeeded;
+}
+
+void LoadBalancer::sendPostRequestAsync(const std::string&, const std::string& data, Callback callback,
+                                        RequestContext* context) {
+    const std::string_view method = findMethod(data);
+    if (hedgeHistogram(method)) {
+        sendHedged(method, data, std::move(callback), context);
+        return;
+    }
+
+    const std::size_t index = selectEndpoint(method);
+    if (index >= endpoints.size()) {
+        if (context) {
+            context->failure = FailureKind::CircuitOpen;
+        }
+        callback(std::nullopt);
+        return;
+    }
+
+    // The failure kind feeds the circuit breaker, so a context is needed even if the caller has none.
+    Ref<RequestContext> local = context ? nullptr : CreateRef<RequestContext>();
+    RequestContext* attempt = context ? context : local.get();
+    begin(index);
+    const auto started = std::chrono::steady_clock::now();
+    transport.sendPostRequestAsync(endpoints[index]->url, data,
+        [this, index, started, attempt, local, callback = std::move(callback)](std::optional<std::string> response) {
+            complete(index, started, response ? FailureKind::None : endpointFailure(*attempt));
+            callback(std::move(response));
+        }, attempt);
+}
+
+std::vector<EndpointStats> LoadBalancer::endpointStats() const {
+    const std::int64_t now = nowNanoseconds();
+    std::vector<EndpointStats> stats;
+    stats.reserve(endpoints.size());
+    for (const auto& endpoint : endpoints) {
+        EndpointStats entry;
+        entry.url = endpoint->url;
+        entry.weight = endpoint->weight;
+        entry.latencyMs = endpoint->latencyMs.load(std::memory_order_relaxed);
+        entry.errorRate = errorRate(*endpoint, now);
+        entry.inFlight = endpoint->inFlight.load(std::memory_order_relaxed);
+        entry.requests = endpoint->requests.load(std::memory_order_relaxed);
+        entry.failures = endpoint->failures.load(std::memory_order_relaxed);
+        entry.circuit = endpoint->breaker.state();
+        entry.circuitOpens = endpoint->breaker.timesOpened();
+        entry.rerouted = endpoint->skipped.load(std::memory_order_relaxed);
+        stats.push_back(std::move(entry));
+    }
+    return stats;
+}
+
+std::uint64_t LoadBalancer::rejectedRequests() const {
+    return rejected.load(std::memory_order_relaxed);
+}
+
+HedgeStats LoadBalancer::hedgeStats() const {
+    HedgeStats stats;
+    stats.hedgedCalls = hedgedCalls.load(std::memory_order_relaxed);
+    stats.hedgesSent = hedgesSent.load(std::memory_order_relaxed);
+    stats.hedgeWins = hedgeWins.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool LoadBalancer::isIdempotent(std::string_view method) {
+    return std::none_of(kStatefulPrefixes.begin(), kStatefulPrefixes.end(),
+                        [method](std::string_view prefix) { return method.starts_with(prefix); });
+}
+
+std::size_t LoadBalancer::selectEndpoint(std::string_view method) {
+    if (endpoints.size() <= 1 || options.stickyMethods.empty() || !options.stickyMethods.contains(method)) {
+        return pickEndpoint();
+    }
+
+    std::size_t pinned = stickyEndpoint.load(std::memory_order_acquire);
+    if (pinned < endpoints.size()) {
+        if (endpoints[pinned]->breaker.allowRequest()) {
+            return pinned;
+        }
+        // The pinned endpoint is unhealthy; release the pin so the next one can be chosen.
+        stickyEndpoint.compare_exchange_strong(pinned, endpoints.size(), std::memory_order_acq_rel);
+        pinned = endpoints.size();
+    }
+    const std::size_t best = pickEndpoint();
+    if (best >= endpoints.size()) {
+        return best;
+    }
+    // Concurrent first sticky calls agree on whichever endpoint was pinned first.
+    return stickyEndpoint.compare_exchange_strong(pinned, best, std::memory_order_acq_rel) ? best : pinned;
+}
+
+std::size_t LoadBalancer::pickEndpoint(std::size_t excluded) {
+    const std::size_t best = bestEndpoint(excluded);
+    if (best < endpoints.size() && endpoints[best]->breaker.allowRequest()) {
+        return best;
+    }
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return endpoints.size();
+}
+
+std::size_t LoadBalancer::bestEndpoint(std::size_t excluded) const {
+    const std::int64_t now = nowNanoseconds();
+    std::size_t best = endpoints.size();
+    double bestScore = 0.0;
+    for (std::size_t i = 0; i < endpoints.size(); ++i) {
+        if (i == excluded) {
+            continue;
+        }
+        if (!endpoints[i]->breaker.available()) {
+            endpoints[i]->skipped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        const double candidate = score(*endpoints[i], now);
+        if (best == endpoints.size() || candidate < bestScore) {
+            best = i;
+            bestScore = candidate;
+        }
+    }
+    return best;
+}
+
+double LoadBalancer::score(const Endpoint& endpoint, std::int64_t now) const {
+    const double latency = std::max(endpoint.latencyMs.load(std::memory_order_relaxed), kMinLatencyMs);
+    const double load = 1.0 + static_cast<double>(endpoint.inFlight.load(std::memory_order_relaxed));
+    const double errors = 1.0 + options.errorPenalty * errorRate(endpoint, now);
+    return latency * load * errors / endpoint.weight;
+}
+
+double LoadBalancer::errorRate(const Endpoint& endpoint, std::int64_t now) const {
+    const double rate = endpoint.errorRate.load(std::memory_order_relaxed);
+    if (rate <= 0.0 || options.errorHalfLife.count() <= 0) {
+        return rate;
+    }
+    const double idle = static_cast<double>(now - endpoint.lastSample.load(std::memory_order_relaxed));
+    const double halfLife = static_cast<double>(std::chrono::nanoseconds(options.errorHalfLife).count());
+    return rate * std::exp2(-std::max(idle, 0.0) / halfLife);
+}
+
+void LoadBalancer::begin(std::size_t index) {
+    Endpoint& endpoint = *endpoints[index];
+    endpoint.inFlight.fetch_add(1, std::memory_order_relaxed);
+    endpoint.requests.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadBalancer::complete(std::size_t index, std::chrono::steady_clock::time_point started, FailureKind failure) {
+    Endpoint& endpoint = *endpoints[index];
+    // A cancelled request says nothing about the endpoint; its elapsed time still bounds the latency from below.
+    const bool succeeded = failure == FailureKind::None || failure == FailureKind::Cancelled;
+    if (failure == FailureKind::None) {
+        endpoint.breaker.recordSuccess();
+    } else if (blamesEndpoint(failure)) {
+        endpoint.breaker.recordFailure();
+    }
+    const std::int64_t now = nowNanoseconds();
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    const double latency = endpoint.latencyMs.load(std::memory_order_relaxed);
+    endpoint.latencyMs.store(latency == 0.0 ? elapsedMs : latency + options.latencyAlpha * (elapsedMs - latency),
+                             std::memory_order_relaxed);
+    const double errors = errorRate(endpoint, now);
+    endpoint.errorRate.store(errors + options.errorAlpha * ((succeeded ? 0.0 : 1.0) - errors), std::memory_order_relaxed);
+    endpoint.lastSample.store(now, std::memory_order_relaxed);
+    endpoint.inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+    if (!succeeded) {
+        endpoint.failures.fetch_add(1, std::memory_order_relaxed);
+        std::size_t pinned = index;
+        stickyEndpoint.compare_exchange_strong(pinned, endpoints.size(), std::memory_order_acq_rel);
+    }
+}
+
+LatencyHistogram* LoadBalancer::hedgeHistogram(std::string_view method) const {
+    if (hedgeLatency.empty() || endpoints.size() < 2) {
+        return nullptr;
+    }
+    const auto it = hedgeLatency.find(method);
+    return it != hedgeLatency.end() ? it->second.get() : nullptr;
+}
+
+std::chrono::nanoseconds LoadBalancer::hedgeDelay(const LatencyHistogram& histogram) const {
+    if (histogram.count() < options.hedgeMinSamples) {
+        return options.initialHedgeDelay;
+    }
+    return std::max<std::chrono::nanoseconds>(histogram.percentile(options.hedgePercentile), options.minHedgeDelay);
+}
+
+void LoadBalancer::sendHedged(std::string_view method, const std::string& data, Callback callback, RequestContext* context) {
+    auto call = CreateRef<HedgedCall>();
+    call->data = data;
+    call->histogram = hedgeHistogram(method);
+    call->callback = std::move(callback);
+    call->caller = context;
+    call->outstanding = 1;
+    if (context) {
+        for (RequestContext& attempt : call->attempts) {
+            attempt.deadline = context->deadline;
+            attempt.connectTimeout = context->connectTimeout;
+        }
+    }
+    call->endpoint[0] = pickEndpoint();
+    if (call->endpoint[0] >= endpoints.size()) {
+        if (context) {
+            context->failure = FailureKind::CircuitOpen;
+        }
+        call->callback(std::nullopt);
+        return;
+    }
+    hedgedCalls.fetch_add(1, std::memory_order_relaxed);
+
+    if (context && context->cancellation.stop_possible()) {
+        // The callback is owned by the call, so the raw pointer cannot dangle while it runs.
+        call->onCallerCancel = CreateScope<std::stop_callback<std::function<void()>>>(context->cancellation,
+            std::function<void()>([raw = call.get()] {
+                raw->stop[0].request_stop();
+                raw->stop[1].request_stop();
+            }));
+    }
+
+    const auto fireAt = std::chrono::steady_clock::now() + hedgeDelay(*call->histogram);
+    startAttempt(call, 0);
+    timers.schedule(fireAt, [this, weak = std::weak_ptr<HedgedCall>(call)] {
+        const Ref<HedgedCall> call = weak.lock();
+        if (!call) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            if (call->finished || !call->hedgePending) {
+                return;
+            }
+            call->hedgePending = false;
+            call->endpoint[1] = pickEndpoint(call->endpoint[0]);
+            if (call->endpoint[1] >= endpoints.size()) {
+                return;
+            }
+            ++call->outstanding;
+        }
+        hedgesSent.fetch_add(1, std::memory_order_relaxed);
+        startAttempt(call, 1);
+    });
+}
+
+void LoadBalancer::startAttempt(const Ref<HedgedCall>& call, std::size_t attempt) {
+    const std::size_t index = call->endpoint[attempt];
+    begin(index);
+    call->started[attempt] = std::chrono::steady_clock::now();
+    call->attempts[attempt].cancellation = call->stop[attempt].get_token();
+    transport.sendPostRequestAsync(endpoints[index]->url, call->data,
+        [this, call, attempt](std::optional<std::string> response) {
+            finishAttempt(call, attempt, std::move(response));
+        }, &call->attempts[attempt]);
+}
+
+void LoadBalancer::finishAttempt(const Ref<HedgedCall>& call, std::size_t attempt, std::optional<std::string> response) {
+    const auto now = std::chrono::steady_clock::now();
+    Callback callback;
+    bool lost = false;
+    {
+        std::lock_guard<std::mutex> lock(call->mutex);
+        --call->outstanding;
+        lost = call->finished;
+        // A failure only ends the call once no attempt is left; a hedge not sent yet is dropped.
+        if (!call->finished && (response || call->outstanding == 0)) {
+            call->finished = true;
+            call->hedgePending = false;
+            callback = std::move(call->callback);
+        }
+    }
+
+    const FailureKind failure = response ? FailureKind::None : failureOf(call->attempts[attempt]);
+    const FailureKind charged = lost ? FailureKind::Cancelled
+        : response ? FailureKind::None
+        : endpointFailure(call->attempts[attempt]);
+    complete(call->endpoint[attempt], call->started[attempt], charged);
+    if (attempt == 0 && (response || lost)) {
+        call->histogram->record(now - call->started[0]);
+    }
+    if (!callback) {
+        return;
+    }
+
+    if (response) {
+        call->stop[1 - attempt].request_stop();
+        if (attempt == 1) {
+            hedgeWins.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (call->caller) {
+        const RequestContext& winner = call->attempts[attempt];
+        call->caller->counters = winner.counters;
+        call->caller->failure = failure;
+        call->caller->httpStatus = winner.httpStatus;
+        call->caller->retryAfter = winner.retryAfter;
+    }
+    callback(std::move(response));
+}
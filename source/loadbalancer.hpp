@@ -0,0 +1,194 @@
+#ifndef LOADBALANCER_HPP
+#define LOADBALANCER_HPP
+
+#include "common.hpp"
+#include "circuitbreaker.hpp"
+#include "latencyhistogram.hpp"
+#include "timerqueue.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct EndpointConfig
+ * @brief One node endpoint served by a LoadBalancer.
+ */
+struct EndpointConfig {
+    std::string url;     ///< Endpoint URL (any URL the inner transport accepts).
+    double weight = 1.0; ///< Relative capacity; an endpoint of weight 2 tolerates twice the load before losing traffic.
+};
+
+/**
+ * @struct LoadBalancerOptions
+ * @brief Endpoints and scoring parameters of a LoadBalancer.
+ */
+struct LoadBalancerOptions {
+    std::vector<EndpointConfig> endpoints; ///< Endpoints to route between.
+    std::set<std::string, std::less<>> stickyMethods {
+        "eth_getTransactionCount", "eth_sendRawTransaction", "eth_sendTransaction"}; ///< Methods pinned to one endpoint for consistency.
+    double latencyAlpha = 0.2;  ///< Smoothing factor of the latency EWMA (weight of the newest sample).
+    double errorAlpha = 0.1;    ///< Smoothing factor of the error-rate EWMA.
+    double errorPenalty = 10.0; ///< Score multiplier per unit of error rate.
+    std::chrono::milliseconds errorHalfLife = std::chrono::seconds(10); ///< Idle time after which an endpoint's error rate halves, so failed endpoints get probed again.
+    CircuitBreakerOptions circuitBreaker; ///< Per-endpoint breaker; connect failures, timeouts, 429 and 5xx count against it.
+
+    bool hedging = false; ///< Send a second copy of slow idempotent reads to another endpoint.
+    std::set<std::string, std::less<>> hedgeMethods {
+        "eth_blockNumber", "eth_call", "eth_chainId", "eth_estimateGas", "eth_gasPrice", "eth_getBalance",
+        "eth_getBlockByHash", "eth_getBlockByNumber", "eth_getCode", "eth_getLogs", "eth_getStorageAt",
+        "eth_getTransactionByHash", "eth_getTransactionReceipt"}; ///< Methods that may be hedged; state-changing methods are always refused.
+    double hedgePercentile = 0.95; ///< Latency percentile of a method after which the hedge is sent.
+    std::chrono::milliseconds initialHedgeDelay = std::chrono::milliseconds(100); ///< Hedge delay until a method has hedgeMinSamples samples.
+    std::chrono::milliseconds minHedgeDelay = std::chrono::milliseconds(1); ///< Lower bound of the hedge delay.
+    std::uint64_t hedgeMinSamples = 20; ///< Samples required before the percentile is trusted.
+};
+
+/**
+ * @struct HedgeStats
+ * @brief Counters of hedged requests.
+ */
+struct HedgeStats {
+    std::uint64_t hedgedCalls = 0; ///< Calls eligible for hedging.
+    std::uint64_t hedgesSent = 0;  ///< Calls whose primary was slow enough to send a hedge.
+    std::uint64_t hedgeWins = 0;   ///< Calls answered by the hedge rather than the primary.
+};
+
+/**
+ * @struct EndpointStats
+ * @brief Live routing state of one endpoint.
+ */
+struct EndpointStats {
+    std::string url;             ///< Endpoint URL.
+    double weight = 1.0;         ///< Configured weight.
+    double latencyMs = 0.0;      ///< EWMA of request latency in milliseconds (0 until the first sample).
+    double errorRate = 0.0;      ///< EWMA of the failure rate, decayed by idle time.
+    std::size_t inFlight = 0;    ///< Requests currently outstanding.
+    std::uint64_t requests = 0;  ///< Requests routed to the endpoint.
+    std::uint64_t failures = 0;  ///< Requests that failed at the transport level.
+    CircuitState circuit = CircuitState::Closed; ///< State of the endpoint's circuit breaker.
+    std::uint64_t circuitOpens = 0; ///< Times the circuit opened.
+    std::uint64_t rerouted = 0;  ///< Routing decisions that skipped the endpoint because its circuit was open.
+};
+
+/**
+ * @class LoadBalancer
+ * @brief Transport that spreads requests over several endpoints by live scoring.
+ *
+ * Each request goes to the endpoint with the lowest score, where
+ * score = latency EWMA * (1 + in-flight requests) * (1 + errorPenalty * error rate) / weight.
+ * A slow or failing provider therefore loses traffic within a few requests and
+ * regains it once its error rate has decayed. Endpoints without samples are tried first.
+ *
+ * Each endpoint also has a CircuitBreaker. While it is open the endpoint receives no
+ * traffic at all, apart from a single probe per openDuration; if every endpoint is
+ * open, requests fail immediately with FailureKind::CircuitOpen.
+ *
+ * Methods listed in stickyMethods all go to one pinned endpoint, so that e.g. nonces
+ * read with eth_getTransactionCount match the node transactions are sent to. The pin
+ * moves only when the pinned endpoint fails.
+ *
+ * With hedging enabled, a call to one of hedgeMethods that has not been answered
+ * within the method's hedgePercentile latency is sent again to the next-best
+ * endpoint. The first successful response wins and the other transfer is cancelled
+ * through its RequestContext, so hedging costs only the extra requests of the slow
+ * tail. Sticky and state-changing methods (eth_send*, eth_sign*, filter management,
+ * personal_*) are never hedged, whatever hedgeMethods contains.
+ *
+ * Requests are delivered through an inner transport, typically a NetworkAdapter;
+ * the url passed by the caller is ignored. Routing takes no lock. The balancer must
+ * outlive every request still in flight.
+ */
+class PROJECT_EXPORT LoadBalancer final : public Transport {
+public:
+    /**
+     * @brief Constructs a balancer over the configured endpoints.
+     * @param options Endpoints and scoring parameters; at least one endpoint is required.
+     * @param transport The transport that performs the requests; must outlive the balancer.
+     */
+    LoadBalancer(LoadBalancerOptions options, Transport& transport);
+
+    ~LoadBalancer() override;
+
+    LoadBalancer(const LoadBalancer&) = delete;
+    LoadBalancer& operator=(const LoadBalancer&) = delete;
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestStreaming
+     *
+     * Routed like sendPostRequestInto(), but never hedged: two streams of the same
+     * response cannot both be handed to @p onChunk.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Retrieves the routing state of every endpoint.
+     */
+    std::vector<EndpointStats> endpointStats() const;
+
+    /**
+     * @brief Retrieves how many requests failed fast because no endpoint's circuit admitted them.
+     */
+    std::uint64_t rejectedRequests() const;
+
+    /**
+     * @brief Retrieves the hedging counters.
+     */
+    HedgeStats hedgeStats() const;
+
+    /**
+     * @brief Checks whether a method is ever sent to more than one endpoint at once.
+     * @return False for methods that change node state, whatever the configuration says.
+     */
+    static bool isIdempotent(std::string_view method);
+
+private:
+    struct Endpoint;
+    struct HedgedCall;
+
+    /**
+     * @brief Picks the endpoint for a request, honouring sticky methods.
+     * @param method The JSON-RPC method of the request.
+     * @return The endpoint index, or the endpoint count if none is configured.
+     */
+    std::size_t selectEndpoint(std::string_view method);
+    /**
+     * @brief Picks the best-scored endpoint whose circuit admits the request.
+     * @return The endpoint index, or the endpoint count if every circuit is open.
+     */
+    std::size_t pickEndpoint(std::size_t excluded = SIZE_MAX);
+    std::size_t bestEndpoint(std::size_t excluded = SIZE_MAX) const;
+    double score(const Endpoint& endpoint, std::int64_t now) const;
+    double errorRate(const Endpoint& endpoint, std::int64_t now) const;
+    void begin(std::size_t index);
+    void complete(std::size_t index, std::chrono::steady_clock::time_point started, FailureKind failure);
+
+    /**
+     * @brief Returns the latency histogram of a hedged method, or nullptr if the call must not be hedged.
+     */
+    LatencyHistogram* hedgeHistogram(std::string_view method) const;
+    std::chrono::nanoseconds hedgeDelay(const LatencyHistogram& histogram) const;
+    void sendHedged(std::string_view method, const std::string& data, Callback callback, RequestContext* context);
+    void startAttempt(const Ref<HedgedCall>& call, std::size_t attempt);
+    void finishAttempt(const Ref<HedgedCall>& call, std::size_t attempt, std::optional<std::string> response);
+
+    LoadBalancerOptions options; ///< Endpoints and scoring parameters.
+    Transport& transport; ///< Transport performing the requests.
+    std::vector<Scope<Endpoint>> endpoints; ///< Per-endpoint routing state.
+    std::atomic<std::size_t> stickyEndpoint; ///< Endpoint serving sticky methods, or endpoints.size() if unpinned.
+
+    std::map<std::string, Scope<LatencyHistogram>, std::less<>> hedgeLatency; ///< Latency per hedged method; fixed after construction.
+    std::atomic<std::uint64_t> rejected {0};    ///< Requests failed fast with every circuit open.
+    std::atomic<std::uint64_t> hedgedCalls {0}; ///< Calls eligible for hedging.
+    std::atomic<std::uint64_t> hedgesSent {0};  ///< Hedges sent.
+    std::atomic<std::uint64_t> hedgeWins {0};   ///< Calls answered by the hedge.
+    TimerQueue timers; ///< Fires hedge timers.
+};
+
+#endif // LOADBALANCER_HPP
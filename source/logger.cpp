@@ -1,5 +1,9 @@
 #include "logger.hpp"
+#if __has_include(<print>)
 #include <print>
+#else
+#include <cstdio>
+#endif
 
 Logger& Logger::getInstance() {
     static Logger instance;
@@ -8,5 +12,9 @@ Logger& Logger::getInstance() {
 
 void Logger::log(const std::string& message) {
     std::lock_guard<std::mutex> lock(m_mutex);
+#if __has_include(<print>)
     std::print("[LOG]: {}", message);
+#else
+    std::fputs(("[LOG]: " + message).c_str(), stdout);
+#endif
 }
@@ -0,0 +1,80 @@
+#include "loopbacktransport.hpp"
+#include "jsonscan.hpp"
+#include "logger.hpp"
+
+void LoopbackTransport::setResult(const std::string& method, std::string result) {
+    generators[method] = [result = std::move(result)](std::string_view) { return result; };
+}
+
+void LoopbackTransport::setGenerator(const std::string& method, Generator generator) {
+    generators[method] = std::move(generator);
+}
+
+std::optional<std::string> LoopbackTransport::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool LoopbackTransport::sendPostRequestInto(const std::string&, const std::string& data, std::string& response,
+                                            RequestContext* context) {
+    if (context) {
+        context->failure = FailureKind::None;
+        if (context->cancellation.stop_requested()) {
+            context->failure = FailureKind::Cancelled;
+            return false;
+        }
+        if (context->deadline <= std::chrono::steady_clock::now()) {
+            context->failure = FailureKind::Timeout;
+            return false;
+        }
+    }
+    const std::string_view request(data);
+    const std::string_view method = findMethod(request);
+    if (method.empty()) {
+        Logger::getInstance().log("Loopback request has no method.");
+        if (context) {
+            context->failure = FailureKind::Other;
+        }
+        return false;
+    }
+    const std::optional<JsonSpan> idSpan = findMemberSpan(request, "id");
+    const std::string_view id = idSpan ? request.substr(idSpan->begin, idSpan->end - idSpan->begin) : std::string_view("null");
+
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    response.clear();
+    auto it = generators.find(method);
+    if (it == generators.end()) {
+        response.reserve(96 + id.size() + method.size());
+        response.append(R"({"jsonrpc":"2.0","id":)").append(id);
+        response.append(R"(,"error":{"code":-32601,"message":"the method )").append(method);
+        response.append(R"( does not exist/is not available"}})");
+    } else {
+        const std::string result = it->second(request);
+        response.reserve(32 + id.size() + result.size());
+        response.append(R"({"jsonrpc":"2.0","id":)").append(id);
+        response.append(R"(,"result":)").append(result).push_back('}');
+    }
+
+    if (context) {
+        context->counters.wireBytes = context->counters.decodedBytes = response.size();
+    }
+    return true;
+}
+
+void LoopbackTransport::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                             RequestContext* context) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response, context)) {
+        callback(std::nullopt);
+        return;
+    }
+    callback(std::move(response));
+}
+
+std::uint64_t LoopbackTransport::requestCount() const {
+    return requests.load(std::memory_order_relaxed);
+}
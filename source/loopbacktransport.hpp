@@ -0,0 +1,71 @@
+#ifndef LOOPBACKTRANSPORT_HPP
+#define LOOPBACKTRANSPORT_HPP
+
+#include "common.hpp"
+#include "transport.hpp"
+
+/**
+ * @class LoopbackTransport
+ * @brief In-process transport that answers JSON-RPC requests from registered results.
+ *
+ * Requests never leave the process: the method and id are located by scanning
+ * the request text and the response is assembled from the registered result, so
+ * a round trip costs no system calls and no JSON parse. This isolates the
+ * client's own serialization and parsing cost in tests and benchmarks.
+ *
+ * Register results before sending requests; lookups take no lock. Asynchronous
+ * requests complete inline, before sendPostRequestAsync() returns.
+ */
+class PROJECT_EXPORT LoopbackTransport final : public Transport {
+public:
+    /**
+     * @brief Produces the "result" JSON text for a request.
+     * @param request The raw JSON-RPC request.
+     */
+    using Generator = std::function<std::string(std::string_view request)>;
+
+    /**
+     * @brief Answers every call of a method with a fixed result.
+     * @param method The RPC method name, e.g. "eth_blockNumber".
+     * @param result The result as JSON text, e.g. "\"0x10\"".
+     */
+    void setResult(const std::string& method, std::string result);
+
+    /**
+     * @brief Answers calls of a method with a result computed per request.
+     * @param method The RPC method name.
+     * @param generator Returns the result as JSON text.
+     */
+    void setGenerator(const std::string& method, Generator generator);
+
+    /**
+     * @brief Answers a request; unknown methods get a JSON-RPC "method not found" error.
+     * @param url Ignored.
+     * @param data The JSON-RPC request object.
+     * @return The response, or an empty std::optional if the request has no method.
+     */
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    /**
+     * @brief Answers a request into a caller-owned buffer.
+     */
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Answers a request and invokes the callback before returning.
+     */
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Retrieves the number of requests answered so far.
+     */
+    std::uint64_t requestCount() const;
+
+private:
+    std::map<std::string, Generator, std::less<>> generators; ///< Result generators keyed by method.
+    std::atomic<std::uint64_t> requests {0}; ///< Requests answered.
+};
+
+#endif // LOOPBACKTRANSPORT_HPP
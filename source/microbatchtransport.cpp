@@ -0,0 +1,339 @@
+#include "microbatchtransport.hpp"
+#include "jsonscan.hpp"
+#include "logger.hpp"
+#include <bit>
+#include <charconv>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Checks whether a request is a single call that can join a batch.
+ */
+bool isSingleCall(std::string_view data, const std::vector<JsonSpan>& ids) {
+    const std::size_t start = data.find_first_not_of(" \t\r\n");
+    return ids.size() == 1 && start != std::string_view::npos && data[start] == '{';
+}
+}
+
+struct MicroBatchTransport::Call {
+    std::string url;                  ///< Endpoint of the call.
+    std::string data;                 ///< The request as the caller wrote it.
+    JsonSpan idSpan;                  ///< Location of the request's id in data.
+    Callback callback;                ///< The caller's callback.
+    RequestContext* caller = nullptr; ///< The caller's context, if any.
+    Clock::time_point arrived;        ///< When the call joined its batch.
+    Clock::time_point deadline = Clock::time_point::max(); ///< The caller's deadline, copied since the caller may leave first.
+    std::chrono::milliseconds connectTimeout {0};           ///< The caller's connect budget.
+    std::atomic<bool> done {false};   ///< Set by whichever of answer, deadline and cancellation completes the call first.
+    TimerQueue::Timer deadlineTimer;  ///< Expires the call; set before the call can complete any other way.
+    Scope<std::stop_callback<std::function<void()>>> onCancel; ///< Completes the call on cancellation; destroyed first.
+
+    /**
+     * @brief Completes the call unless it has already been completed, and cancels its deadline timer.
+     */
+    void complete(std::optional<std::string> response, FailureKind failure, long httpStatus, TransferCounters counters) {
+        if (done.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        deadlineTimer.cancel();
+        finish(std::move(response), failure, httpStatus, counters);
+    }
+
+    /**
+     * @brief Completes the call from its deadline timer unless it has already been completed.
+     */
+    void expire() {
+        if (!done.exchange(true, std::memory_order_acq_rel)) {
+            finish(std::nullopt, FailureKind::Timeout, 0, {});
+        }
+    }
+
+private:
+    /**
+     * @brief Reports the outcome to the caller's context and callback.
+     */
+    void finish(std::optional<std::string> response, FailureKind failure, long httpStatus, TransferCounters counters) {
+        if (caller) {
+            caller->failure = response ? FailureKind::None : (failure == FailureKind::None ? FailureKind::Other : failure);
+            caller->httpStatus = httpStatus;
+            caller->counters = counters;
+        }
+        callback(std::move(response));
+    }
+};
+
+struct MicroBatchTransport::Batch {
+    std::string body;             ///< The request sent: a single call, or an array of calls with rewritten ids.
+    std::vector<Ref<Call>> calls; ///< The calls, indexed by their id within the batch.
+    RequestContext context;       ///< Context of the request, bounded by the latest deadline of its calls.
+
+    /**
+     * @brief Splits the answer between the calls and completes each of them.
+     */
+    void deliver(std::optional<std::string> response) {
+        if (!response) {
+            for (const Ref<Call>& call : calls) {
+                call->complete(std::nullopt, context.failure, context.httpStatus, {});
+            }
+            return;
+        }
+        if (calls.size() == 1) {
+            calls.front()->complete(std::move(response), FailureKind::None, context.httpStatus, context.counters);
+            return;
+        }
+
+        const std::string_view text(*response);
+        const std::vector<JsonSpan> elements = findElementSpans(text);
+        const auto share = [&](std::size_t bytes) {
+            // Wire bytes are attributed in proportion to each answer's decoded size.
+            TransferCounters counters;
+            counters.decodedBytes = bytes;
+            counters.wireBytes = text.empty() ? 0 : context.counters.wireBytes * bytes / text.size();
+            return counters;
+        };
+        if (elements.empty()) {
+            // The node rejected the batch as a whole, e.g. over its size limit; every call gets its error.
+            for (const Ref<Call>& call : calls) {
+                call->complete(*response, FailureKind::None, context.httpStatus, share(text.size() / calls.size()));
+            }
+            return;
+        }
+
+        std::vector<bool> answered(calls.size(), false);
+        for (const JsonSpan& span : elements) {
+            const std::string_view element = text.substr(span.begin, span.end - span.begin);
+            const std::optional<JsonSpan> id = findMemberSpan(element, "id");
+            std::size_t index = 0;
+            if (!id || std::from_chars(element.data() + id->begin, element.data() + id->end, index).ec != std::errc()
+                || index >= calls.size() || answered[index]) {
+                continue;
+            }
+            answered[index] = true;
+            Call& call = *calls[index];
+            const std::string_view original = std::string_view(call.data).substr(call.idSpan.begin, call.idSpan.end - call.idSpan.begin);
+            std::string single;
+            single.reserve(element.size() + original.size());
+            single.append(element.substr(0, id->begin)).append(original).append(element.substr(id->end));
+            const std::size_t bytes = single.size();
+            call.complete(std::move(single), FailureKind::None, context.httpStatus, share(bytes));
+        }
+
+        const std::size_t missing = static_cast<std::size_t>(std::count(answered.begin(), answered.end(), false));
+        if (missing > 0) {
+            Logger::getInstance().log("Batch response left " + std::to_string(missing) + " of " + std::to_string(calls.size()) + " calls unanswered.");
+            for (std::size_t i = 0; i < calls.size(); ++i) {
+                if (!answered[i]) {
+                    calls[i]->complete(std::nullopt, FailureKind::Other, context.httpStatus, {});
+                }
+            }
+        }
+    }
+};
+
+MicroBatchTransport::MicroBatchTransport(MicroBatchOptions options, Transport& transport)
+    : options(std::move(options)), transport(transport) {
+    if (this->options.maxBatchSize == 0) {
+        this->options.maxBatchSize = 1;
+    }
+}
+
+MicroBatchTransport::~MicroBatchTransport() {
+    std::unordered_map<std::string, Pending> open;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        open.swap(pending);
+    }
+    for (auto& [url, batch] : open) {
+        for (const Ref<Call>& call : batch.calls) {
+            call->complete(std::nullopt, FailureKind::Cancelled, 0, {});
+        }
+    }
+}
+
+std::optional<std::string> MicroBatchTransport::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool MicroBatchTransport::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                              RequestContext* context) {
+    const std::vector<JsonSpan> ids = findIdSpans(data);
+    if (!isSingleCall(data, ids)) {
+        return transport.sendPostRequestInto(url, data, response, context);
+    }
+
+    std::promise<std::optional<std::string>> result;
+    std::future<std::optional<std::string>> answer = result.get_future();
+    submit(url, data, ids.front(), [&result](std::optional<std::string> body) {
+        result.set_value(std::move(body));
+    }, context);
+    std::optional<std::string> body = answer.get();
+    if (!body) {
+        return false;
+    }
+    response = std::move(*body);
+    return true;
+}
+
+bool MicroBatchTransport::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                                   RequestContext* context) {
+    return transport.sendPostRequestStreaming(url, data, onChunk, context);
+}
+
+void MicroBatchTransport::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                               RequestContext* context) {
+    const std::vector<JsonSpan> ids = findIdSpans(data);
+    if (!isSingleCall(data, ids)) {
+        transport.sendPostRequestAsync(url, data, std::move(callback), context);
+        return;
+    }
+    submit(url, data, ids.front(), std::move(callback), context);
+}
+
+void MicroBatchTransport::submit(const std::string& url, const std::string& data, JsonSpan idSpan, Callback callback,
+                                 RequestContext* context) {
+    if (context) {
+        context->failure = FailureKind::None;
+        if (context->cancellation.stop_requested() || context->deadline <= Clock::now()) {
+            context->failure = context->cancellation.stop_requested() ? FailureKind::Cancelled : FailureKind::Timeout;
+            callback(std::nullopt);
+            return;
+        }
+    }
+
+    auto call = CreateRef<Call>();
+    call->url = url;
+    call->data = data;
+    call->idSpan = idSpan;
+    call->callback = std::move(callback);
+    call->caller = context;
+    call->arrived = Clock::now();
+    if (context) {
+        call->deadline = context->deadline;
+        call->connectTimeout = context->connectTimeout;
+    }
+    if (call->deadline != Clock::time_point::max()) {
+        // Every other completion cancels the timer, so finished calls do not pile up in the queue until their deadline.
+        call->deadlineTimer = timers.schedule(context->deadline, [weak = std::weak_ptr<Call>(call)] {
+            if (Ref<Call> expired = weak.lock()) {
+                expired->expire();
+            }
+        });
+    }
+    if (context && context->cancellation.stop_possible()) {
+        // The call outlives its stop callback, so the raw pointer stays valid while it runs.
+        call->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(context->cancellation,
+            std::function<void()>([raw = call.get()] {
+                raw->complete(std::nullopt, FailureKind::Cancelled, 0, {});
+            }));
+    }
+    enqueue(call);
+}
+
+MicroBatchStats MicroBatchTransport::stats() const {
+    MicroBatchStats stats;
+    stats.calls = calls.load(std::memory_order_relaxed);
+    stats.requests = requests.load(std::memory_order_relaxed);
+    stats.fullBatches = fullBatches.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kMicroBatchSizeBuckets; ++i) {
+        stats.sizeHistogram[i] = sizeHistogram[i].load(std::memory_order_relaxed);
+    }
+    stats.holdP50 = holdTimes.percentile(0.5);
+    stats.holdP90 = holdTimes.percentile(0.9);
+    stats.holdP99 = holdTimes.percentile(0.99);
+    return stats;
+}
+
+void MicroBatchTransport::enqueue(const Ref<Call>& call) {
+    std::vector<Ref<Call>> full;
+    std::optional<std::uint64_t> opened;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Pending& open = pending[call->url];
+        open.calls.push_back(call);
+        if (open.calls.size() >= options.maxBatchSize || options.window.count() <= 0) {
+            full.swap(open.calls);
+            ++open.generation;
+        } else if (open.calls.size() == 1) {
+            opened = open.generation;
+        }
+    }
+
+    if (!full.empty()) {
+        const bool reachedCap = full.size() >= options.maxBatchSize;
+        send(call->url, std::move(full), reachedCap);
+    } else if (opened) {
+        timers.schedule(Clock::now() + options.window, [this, url = call->url, generation = *opened] {
+            flushWindow(url, generation);
+        });
+    }
+}
+
+void MicroBatchTransport::flushWindow(const std::string& url, std::uint64_t generation) {
+    std::vector<Ref<Call>> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pending.find(url);
+        if (it == pending.end() || it->second.generation != generation) {
+            return;
+        }
+        due.swap(it->second.calls);
+        ++it->second.generation;
+    }
+    send(url, std::move(due), false);
+}
+
+void MicroBatchTransport::send(const std::string& url, std::vector<Ref<Call>> due, bool full) {
+    // Calls that timed out or were cancelled while waiting are left out.
+    std::erase_if(due, [](const Ref<Call>& call) { return call->done.load(std::memory_order_acquire); });
+    if (due.empty()) {
+        return;
+    }
+
+    const auto now = Clock::now();
+    calls.fetch_add(due.size(), std::memory_order_relaxed);
+    requests.fetch_add(1, std::memory_order_relaxed);
+    if (full) {
+        fullBatches.fetch_add(1, std::memory_order_relaxed);
+    }
+    const std::size_t bucket = std::min<std::size_t>(std::bit_width(due.size() - 1), kMicroBatchSizeBuckets - 1);
+    sizeHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    auto batch = CreateRef<Batch>();
+    batch->context.deadline = Clock::time_point::min();
+    for (const Ref<Call>& call : due) {
+        holdTimes.record(now - call->arrived);
+        batch->context.deadline = std::max(batch->context.deadline, call->deadline);
+        batch->context.connectTimeout = std::max(batch->context.connectTimeout, call->connectTimeout);
+    }
+
+    if (due.size() == 1) {
+        batch->body = due.front()->data;
+    } else {
+        std::size_t size = due.size() + 1;
+        for (const Ref<Call>& call : due) {
+            size += call->data.size() + 4;
+        }
+        batch->body.reserve(size);
+        batch->body.push_back('[');
+        for (std::size_t i = 0; i < due.size(); ++i) {
+            const Call& call = *due[i];
+            if (i > 0) {
+                batch->body.push_back(',');
+            }
+            batch->body.append(call.data, 0, call.idSpan.begin);
+            batch->body.append(std::to_string(i));
+            batch->body.append(call.data, call.idSpan.end, std::string::npos);
+        }
+        batch->body.push_back(']');
+    }
+    batch->calls = std::move(due);
+
+    transport.sendPostRequestAsync(url, batch->body, [batch](std::optional<std::string> response) {
+        batch->deliver(std::move(response));
+    }, &batch->context);
+}
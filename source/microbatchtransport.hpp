@@ -0,0 +1,146 @@
+#ifndef MICROBATCHTRANSPORT_HPP
+#define MICROBATCHTRANSPORT_HPP
+
+#include "common.hpp"
+#include "jsonscan.hpp"
+#include "latencyhistogram.hpp"
+#include "timerqueue.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct MicroBatchOptions
+ * @brief How long concurrent calls are held to be sent together, and how many may share a batch.
+ */
+struct MicroBatchOptions {
+    std::chrono::microseconds window {200}; ///< How long the first call of a batch waits for others to join; 0 sends at once.
+    std::size_t maxBatchSize = 100; ///< A batch is sent as soon as it holds this many calls, before its window closes.
+};
+
+/**
+ * @brief Number of batch size buckets in MicroBatchStats.
+ */
+inline constexpr std::size_t kMicroBatchSizeBuckets = 12;
+
+/**
+ * @struct MicroBatchStats
+ * @brief Batch sizes and hold times of a MicroBatchTransport, for tuning its window.
+ */
+struct MicroBatchStats {
+    std::uint64_t calls = 0;       ///< Calls sent, alone or in a batch.
+    std::uint64_t requests = 0;    ///< Requests sent to the inner transport; calls / requests is the mean batch size.
+    std::uint64_t fullBatches = 0; ///< Batches sent early because they reached maxBatchSize.
+    std::array<std::uint64_t, kMicroBatchSizeBuckets> sizeHistogram {}; ///< Requests by batch size: bucket 0 counts lone calls, bucket i sizes in (2^(i-1), 2^i]; the last bucket also counts larger batches.
+    std::chrono::nanoseconds holdP50 {0}; ///< Median time a call waited for its batch to be sent.
+    std::chrono::nanoseconds holdP90 {0}; ///< 90th percentile of the hold time.
+    std::chrono::nanoseconds holdP99 {0}; ///< 99th percentile of the hold time.
+};
+
+/**
+ * @class MicroBatchTransport
+ * @brief Transport decorator that coalesces concurrent calls into JSON-RPC batches.
+ *
+ * The first call to an endpoint opens a batch and is held for up to window;
+ * calls arriving meanwhile join it. The batch is then sent as one JSON-RPC array
+ * through the inner transport's non-blocking path, or at once when it reaches
+ * maxBatchSize. Each call's id is rewritten to its position in the batch, and the
+ * answers are split and given back their original ids, so every caller receives
+ * exactly the response it would have received alone. A batch that ends up with a
+ * single call is sent unchanged.
+ *
+ * Calls keep their own deadline and cancellation: a call that runs out of time or
+ * is cancelled completes at once, and its answer is dropped when the batch returns.
+ * The batch itself is bounded by the latest deadline of its calls.
+ *
+ * Requests that already are batches, or carry no single id, are passed through.
+ * The window adds up to its length to each call's latency and saves one request
+ * per joined call; stats() reports batch sizes and hold times to tune it.
+ */
+class PROJECT_EXPORT MicroBatchTransport final : public Transport {
+public:
+    /**
+     * @brief Constructs the decorator.
+     * @param options Window and batch size cap.
+     * @param transport Sends the batches; must outlive this object.
+     */
+    MicroBatchTransport(MicroBatchOptions options, Transport& transport);
+
+    /**
+     * @brief Stops the window timer and fails calls still waiting for their batch with FailureKind::Cancelled.
+     */
+    ~MicroBatchTransport() override;
+
+    MicroBatchTransport(const MicroBatchTransport&) = delete;
+    MicroBatchTransport& operator=(const MicroBatchTransport&) = delete;
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestInto
+     *
+     * Blocks until the batch carrying the call has been answered, or the call's deadline passes.
+     */
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestStreaming
+     *
+     * Sent alone through the inner transport: a streamed response is not held back
+     * to share a batch, and is large enough that batching saves nothing.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Retrieves batch size and hold time statistics.
+     */
+    MicroBatchStats stats() const;
+
+private:
+    struct Call;
+    struct Batch;
+
+    /**
+     * @brief Calls of one endpoint waiting for their batch to be sent.
+     */
+    struct Pending {
+        std::vector<Ref<Call>> calls;  ///< Calls in arrival order.
+        std::uint64_t generation = 0;  ///< Incremented per batch, so a stale window timer sends nothing.
+    };
+
+    /**
+     * @brief Registers a single call's deadline and cancellation and queues it.
+     */
+    void submit(const std::string& url, const std::string& data, JsonSpan idSpan, Callback callback, RequestContext* context);
+
+    /**
+     * @brief Adds a call to its endpoint's open batch, sending the batch if it is full.
+     */
+    void enqueue(const Ref<Call>& call);
+
+    /**
+     * @brief Sends the open batch of an endpoint if it still has the given generation.
+     */
+    void flushWindow(const std::string& url, std::uint64_t generation);
+
+    /**
+     * @brief Sends the calls as one request, or as a batch when there are several.
+     */
+    void send(const std::string& url, std::vector<Ref<Call>> due, bool full);
+
+    MicroBatchOptions options; ///< Window and batch size cap.
+    Transport& transport;      ///< Sends the batches.
+    std::mutex mutex;          ///< Guards the pending map.
+    std::unordered_map<std::string, Pending> pending; ///< Open batches keyed by endpoint URL.
+    std::atomic<std::uint64_t> calls {0};       ///< Calls sent.
+    std::atomic<std::uint64_t> requests {0};    ///< Requests sent.
+    std::atomic<std::uint64_t> fullBatches {0}; ///< Batches sent at maxBatchSize.
+    std::array<std::atomic<std::uint64_t>, kMicroBatchSizeBuckets> sizeHistogram {}; ///< Requests by batch size bucket.
+    LatencyHistogram holdTimes; ///< Time from a call's arrival until its batch was sent.
+    TimerQueue timers;          ///< Closes windows and expires deadlines; stopped first on destruction.
+};
+
+#endif // MICROBATCHTRANSPORT_HPP
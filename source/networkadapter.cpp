@@ -1,91 +1,734 @@
 #include "networkadapter.hpp"
 #include "logger.hpp"
+#include "responsesink.hpp"
+#include "transferresult.hpp"
 #include <mutex>
 
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+
 namespace {
-std::once_flag gCurlInitFlag;
-bool gCurlInitialized = false;
+/**
+ * @brief Request used to open and keep connections alive; every node answers it cheaply.
+ */
+constexpr std::string_view kProbeRequest = R"({"jsonrpc":"2.0","id":0,"method":"eth_chainId","params":[]})";
+
+/**
+ * @brief Idle handles a keep-alive round takes out of a pool at most, so requests never wait on probes for long.
+ */
+constexpr std::size_t kKeepAliveProbesPerRound = 2;
+
+/**
+ * @brief Budget of one keep-alive probe; a node that does not answer this fast gets its handle back unprobed.
+ */
+constexpr std::chrono::milliseconds kKeepAliveProbeTimeout = std::chrono::seconds(2);
+
+/**
+ * @brief Returns a stable per-thread index used to pick a home shard.
+ */
+std::size_t threadShardSeed() {
+    static std::atomic<std::size_t> nextSeed {0};
+    thread_local const std::size_t seed = nextSeed.fetch_add(1, std::memory_order_relaxed);
+    return seed;
 }
 
-NetworkAdapter::NetworkAdapter() {
-    std::call_once(gCurlInitFlag, []() {
-        const CURLcode initResult = curl_global_init(CURL_GLOBAL_DEFAULT);
-        if (initResult != CURLE_OK) {
-            Logger::getInstance().log("Failed to initialize libcurl globals: " + std::string(curl_easy_strerror(initResult)));
-            return;
+/**
+ * @brief Multi handle owned by one thread, used to run its cancellable blocking transfers.
+ */
+struct ThreadMulti {
+    CURLM* handle = curl_multi_init();
+    ~ThreadMulti() { curl_multi_cleanup(handle); }
+};
+
+/**
+ * @brief Performs a blocking transfer that a stop token can abort immediately.
+ * @return The transfer's result, or CURLE_ABORTED_BY_CALLBACK if it was cancelled.
+ *
+ * curl_easy_perform() polls its progress callback only about once a second while
+ * the socket is idle, which is far too late for a caller that gave up. The
+ * transfer instead runs on this thread's multi handle, whose poll the stop
+ * callback interrupts; removing the unfinished transfer closes its connection.
+ */
+CURLcode performCancellable(CURL* handle, const std::stop_token& cancellation) {
+    thread_local ThreadMulti multi;
+    if (!multi.handle || curl_multi_add_handle(multi.handle, handle) != CURLM_OK) {
+        return CURLE_FAILED_INIT;
+    }
+
+    CURLcode result = CURLE_ABORTED_BY_CALLBACK;
+    {
+        std::stop_callback wake(cancellation, [target = multi.handle] { curl_multi_wakeup(target); });
+        bool done = false;
+        while (!done && !cancellation.stop_requested()) {
+            int running = 0;
+            if (curl_multi_perform(multi.handle, &running) != CURLM_OK) {
+                result = CURLE_FAILED_INIT;
+                break;
+            }
+            int queued = 0;
+            while (CURLMsg* message = curl_multi_info_read(multi.handle, &queued)) {
+                if (message->msg == CURLMSG_DONE && message->easy_handle == handle) {
+                    result = message->data.result;
+                    done = true;
+                }
+            }
+            if (!done) {
+                curl_multi_poll(multi.handle, nullptr, 0, 1000, nullptr);
+            }
         }
-        gCurlInitialized = true;
-    });
+    }
+    curl_multi_remove_handle(multi.handle, handle);
+    return result;
+}
+
+/**
+ * @brief Resolves an endpoint's host and formats its addresses as a CURLOPT_RESOLVE entry.
+ * @return "host:port:address[,address...]", or an empty string if the URL already names an
+ *         address or the host could not be resolved.
+ */
+std::string resolveEntry(const std::string& url) {
+#if defined(_WIN32)
+    (void)url;
+    return {};
+#else
+    CURLU* parsed = curl_url();
+    if (!parsed) {
+        return {};
+    }
+    std::string host;
+    std::string port;
+    char* part = nullptr;
+    if (curl_url_set(parsed, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK
+        && curl_url_get(parsed, CURLUPART_HOST, &part, 0) == CURLUE_OK) {
+        host = part;
+        curl_free(part);
+        if (curl_url_get(parsed, CURLUPART_PORT, &part, CURLU_DEFAULT_PORT) == CURLUE_OK) {
+            port = part;
+            curl_free(part);
+        }
+    }
+    curl_url_cleanup(parsed);
 
-    if (!gCurlInitialized) {
+    in_addr ipv4 {};
+    if (host.empty() || port.empty() || host.front() == '[' || inet_pton(AF_INET, host.c_str(), &ipv4) == 1) {
+        return {};
+    }
+
+    addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (const int error = getaddrinfo(host.c_str(), port.c_str(), &hints, &found); error != 0) {
+        Logger::getInstance().log("Could not resolve " + host + " to pin its address: " + gai_strerror(error));
+        return {};
+    }
+
+    std::vector<std::string> addresses;
+    for (const addrinfo* entry = found; entry; entry = entry->ai_next) {
+        char text[INET6_ADDRSTRLEN] = {};
+        std::string address;
+        if (entry->ai_family == AF_INET) {
+            inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(entry->ai_addr)->sin_addr, text, sizeof(text));
+            address = text;
+        } else if (entry->ai_family == AF_INET6) {
+            inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(entry->ai_addr)->sin6_addr, text, sizeof(text));
+            address = "[" + std::string(text) + "]";
+        }
+        if (!address.empty() && std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+            addresses.push_back(std::move(address));
+        }
+    }
+    freeaddrinfo(found);
+    if (addresses.empty()) {
+        return {};
+    }
+
+    std::string entry = host + ":" + port + ":";
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        entry.append(i == 0 ? "" : ",").append(addresses[i]);
+    }
+    return entry;
+#endif
+}
+
+/**
+ * @brief Records why a request failed and returns false.
+ */
+bool failRequest(RequestContext* context, FailureKind kind) {
+    if (context) {
+        context->failure = kind;
+    }
+    return false;
+}
+
+/**
+ * @brief Tells why an IPC request given up to @p deadline came back without a response.
+ */
+FailureKind ipcFailure(const RequestContext* context, std::chrono::steady_clock::time_point deadline) {
+    if (context && context->cancellation.stop_requested()) {
+        return FailureKind::Cancelled;
+    }
+    return std::chrono::steady_clock::now() >= deadline ? FailureKind::Timeout : FailureKind::Other;
+}
+}
+
+struct NetworkAdapter::EndpointPool {
+    /**
+     * @brief A lock stripe holding part of the idle handles.
+     */
+    struct Shard {
+        std::mutex mutex;        ///< Guards this shard's idle list.
+        std::vector<CURL*> idle; ///< Handles ready for the next request.
+    };
+
+    /**
+     * @brief Pops an idle handle, starting at the given shard.
+     * @param home Preferred shard; other shards are only try-locked.
+     */
+    CURL* popIdle(std::size_t home) {
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            Shard& shard = shards[(home + i) % shards.size()];
+            std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+            if (i == 0) {
+                lock.lock();
+            } else if (!lock.try_lock()) {
+                continue;
+            }
+            if (!shard.idle.empty()) {
+                CURL* handle = shard.idle.back();
+                shard.idle.pop_back();
+                return handle;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Pops the handle that has been idle longest, visiting shards round-robin across calls.
+     *
+     * Handles are released to the back of a shard, so the front holds those idle longest.
+     */
+    CURL* popOldestIdle() {
+        const std::size_t start = probeCursor.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            Shard& shard = shards[(start + i) % shards.size()];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.idle.empty()) {
+                CURL* handle = shard.idle.front();
+                shard.idle.erase(shard.idle.begin());
+                return handle;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string url;                   ///< Endpoint URL, kept alive for CURLOPT_URL.
+    curl_slist* headers = nullptr;     ///< Request headers, built once per endpoint.
+    std::atomic<curl_slist*> resolve {nullptr}; ///< Pinned addresses of the host, set once by warmup().
+    std::once_flag pinFlag;            ///< Guards the one-time address pinning.
+    std::atomic<std::size_t> warm {0}; ///< Connections opened by warmup(), kept alive by probes.
+    std::atomic<std::size_t> probeCursor {0}; ///< Shard where the next keep-alive round starts looking.
+    std::vector<Shard> shards;         ///< Lock stripes; a thread starts at its home shard.
+    std::atomic<std::size_t> created {0}; ///< Number of handles owned by this pool.
+    std::atomic<std::size_t> waiters {0}; ///< Threads blocked waiting for a free handle.
+    std::mutex waitMutex;              ///< Only taken when the pool is exhausted.
+    std::condition_variable available; ///< Signalled when a handle is released while threads wait.
+};
+
+NetworkAdapter::NetworkAdapter(NetworkAdapterOptions options)
+    : options(std::move(options)) {
+    if (!CurlShare::initializeGlobals()) {
         Logger::getInstance().log("libcurl global initialization failed.");
         return;
     }
 
-    curlHandle = curl_easy_init();
-    if (!curlHandle) {
-        Logger::getInstance().log("Failed to create CURL handle.");
+    if (this->options.maxHandlesPerEndpoint == 0) {
+        this->options.maxHandlesPerEndpoint = 1;
     }
+    if (this->options.kernelTls) {
+        if (KernelTls::isSupported()) {
+            kernelTls = CreateRef<KernelTls>();
+            if (!this->options.asyncOptions.kernelTls) {
+                this->options.asyncOptions.kernelTls = kernelTls;
+            }
+        } else {
+            Logger::getInstance().log("Kernel TLS offload needs libcurl built with OpenSSL 3 and PROJECT_ENABLE_KTLS; using userspace TLS.");
+        }
+    }
+    initialized = true;
 }
 
 NetworkAdapter::~NetworkAdapter() {
-    if (curlHandle) {
-        curl_easy_cleanup(curlHandle);
-        curlHandle = nullptr;
+    // Waits for a keep-alive round in progress, which still uses the pools.
+    keepAliveTimer.reset();
+    for (auto& [url, pool] : pools) {
+        for (auto& shard : pool->shards) {
+            for (CURL* handle : shard.idle) {
+                curl_easy_cleanup(handle);
+            }
+            shard.idle.clear();
+        }
+        curl_slist_free_all(pool->headers);
+        pool->headers = nullptr;
+        curl_slist_free_all(pool->resolve.exchange(nullptr));
     }
 }
 
 std::optional<std::string> NetworkAdapter::sendPostRequest(const std::string& url, const std::string& data) {
-    if (!curlHandle) {
-        Logger::getInstance().log("Cannot send request: CURL handle is not initialized.");
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
         return std::nullopt;
     }
+    return response;
+}
 
-    std::string response;
-    CURLcode res = CURLE_OK;
+bool NetworkAdapter::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                         RequestContext* context) {
+    response.clear();
+
+    if (context) {
+        context->failure = FailureKind::None;
+        if (context->cancellation.stop_requested()) {
+            return failRequest(context, FailureKind::Cancelled);
+        }
+    }
+    const std::chrono::milliseconds budget = remainingBudget(context, options.timeout);
+    if (budget.count() == 0) {
+        return failRequest(context, FailureKind::Timeout);
+    }
 
-    curl_easy_reset(curlHandle);
+    if (IpcAdapter::isIpcEndpoint(url)) {
+        const auto started = std::chrono::steady_clock::now();
+        auto result = ipcConnection(url).sendRequest(data, budget, context ? context->cancellation : std::stop_token());
+        if (!result) {
+            return failRequest(context, ipcFailure(context, started + budget));
+        }
+        response = std::move(*result);
+        if (context) {
+            context->counters.wireBytes = context->counters.decodedBytes = response.size();
+        }
+        return true;
+    }
 
-    curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    if (!headers) {
-        Logger::getInstance().log("Failed to create HTTP headers for request.");
-        return std::nullopt;
+    if (!initialized) {
+        Logger::getInstance().log("Cannot send request: libcurl is not initialized.");
+        return failRequest(context, FailureKind::Other);
+    }
+
+    if (options.asyncOptions.multiplex) {
+        std::promise<std::optional<std::string>> promise;
+        auto future = promise.get_future();
+        asyncTransport().sendPostRequestAsync(url, data, [&promise](std::optional<std::string> result) {
+            promise.set_value(std::move(result));
+        }, context);
+        auto result = future.get();
+        if (result) {
+            response = std::move(*result);
+        }
+        return result.has_value();
+    }
+
+    ResponseSink sink {nullptr, &response};
+    if (!performPooled(url, data, ResponseSink::write, &sink, &sink.handle, nullptr, budget, context)) {
+        return false;
+    }
+    if (context) {
+        context->counters.decodedBytes = response.size();
+    }
+    return true;
+}
+
+bool NetworkAdapter::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                              RequestContext* context) {
+    if (context) {
+        context->failure = FailureKind::None;
+        if (context->cancellation.stop_requested()) {
+            return failRequest(context, FailureKind::Cancelled);
+        }
+    }
+    const std::chrono::milliseconds budget = remainingBudget(context, options.timeout);
+    if (budget.count() == 0) {
+        return failRequest(context, FailureKind::Timeout);
+    }
+
+    // IPC and multiplexed transfers deliver whole responses only.
+    if (IpcAdapter::isIpcEndpoint(url) || options.asyncOptions.multiplex) {
+        return Transport::sendPostRequestStreaming(url, data, onChunk, context);
+    }
+
+    if (!initialized) {
+        Logger::getInstance().log("Cannot send request: libcurl is not initialized.");
+        return failRequest(context, FailureKind::Other);
+    }
+
+    StreamingSink sink {nullptr, &onChunk};
+    if (!performPooled(url, data, StreamingSink::write, &sink, &sink.handle, &sink.stopped, budget, context)) {
+        return false;
+    }
+    if (context) {
+        context->counters.decodedBytes = sink.delivered;
+    }
+    return true;
+}
+
+void NetworkAdapter::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                          RequestContext* context) {
+    if (IpcAdapter::isIpcEndpoint(url)) {
+        // Connecting to a Unix socket never waits for a handshake, so only the overall budget applies.
+        const std::chrono::milliseconds budget = remainingBudget(context, options.timeout);
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        if (context) {
+            context->failure = FailureKind::None;
+            if (context->cancellation.stop_requested() || budget.count() == 0) {
+                failRequest(context, ipcFailure(context, deadline));
+                callback(std::nullopt);
+                return;
+            }
+            callback = [callback = std::move(callback), context, deadline](std::optional<std::string> response) {
+                if (response) {
+                    context->counters.wireBytes = context->counters.decodedBytes = response->size();
+                }
+                context->failure = response ? FailureKind::None : ipcFailure(context, deadline);
+                callback(std::move(response));
+            };
+        }
+        ipcConnection(url).sendRequestAsync(data, std::move(callback), deadline,
+                                            context ? context->cancellation : std::stop_token());
+        return;
+    }
+    asyncTransport().sendPostRequestAsync(url, data, std::move(callback), context);
+}
+
+bool NetworkAdapter::performPooled(const std::string& url, const std::string& data, WriteFunction write, void* sink,
+                                   CURL** sinkHandle, const bool* aborted, std::chrono::milliseconds budget,
+                                   RequestContext* context) {
+    EndpointPool* pool = endpointPool(url);
+    if (!pool) {
+        return failRequest(context, FailureKind::Other);
     }
 
-    curl_easy_setopt(curlHandle, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curlHandle, CURLOPT_POST, 1L);
-    curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, headers);
+    CURL* curlHandle = acquireHandle(*pool, context ? context->deadline : std::chrono::steady_clock::time_point::max());
+    if (!curlHandle) {
+        if (remainingBudget(context, budget).count() == 0) {
+            return failRequest(context, FailureKind::Timeout);
+        }
+        Logger::getInstance().log("Failed to create CURL handle.");
+        return failRequest(context, FailureKind::Other);
+    }
+    const std::chrono::milliseconds transferBudget = remainingBudget(context, budget);
+    if (transferBudget.count() == 0) {
+        releaseHandle(*pool, curlHandle);
+        return failRequest(context, FailureKind::Timeout);
+    }
+
+    *sinkHandle = curlHandle;
     curl_easy_setopt(curlHandle, CURLOPT_POSTFIELDS, data.c_str());
     curl_easy_setopt(curlHandle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(data.size()));
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curlHandle, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curlHandle, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curlHandle, CURLOPT_NOSIGNAL, 1L);
-    curl_easy_setopt(curlHandle, CURLOPT_SSL_VERIFYPEER, 1L);
-    curl_easy_setopt(curlHandle, CURLOPT_SSL_VERIFYHOST, 2L);
-
-    res = curl_easy_perform(curlHandle);
-    curl_easy_setopt(curlHandle, CURLOPT_HTTPHEADER, nullptr);
-    curl_slist_free_all(headers);
-    if (res != CURLE_OK) {
-        Logger::getInstance().log("CURL error: " + std::string(curl_easy_strerror(res)));
-        return std::nullopt;
+    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, write);
+    curl_easy_setopt(curlHandle, CURLOPT_WRITEDATA, sink);
+    // Budgets are set per request, since the handle keeps whatever the previous caller asked for.
+    const auto connectTimeout = context && context->connectTimeout.count() > 0 ? context->connectTimeout : options.connectTimeout;
+    curl_easy_setopt(curlHandle, CURLOPT_TIMEOUT_MS, static_cast<long>(transferBudget.count()));
+    curl_easy_setopt(curlHandle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(connectTimeout.count()));
+    const CURLcode res = context && context->cancellation.stop_possible()
+        ? performCancellable(curlHandle, context->cancellation)
+        : curl_easy_perform(curlHandle);
+    // A sink that aborted on purpose is the caller's decision, not a transfer error.
+    FailureKind failure = FailureKind::Cancelled;
+    if (aborted && *aborted) {
+        failRequest(context, failure);
+    } else {
+        failure = classifyTransfer(curlHandle, res, context);
+    }
+    if (res == CURLE_OK && context) {
+        curl_off_t received = 0;
+        curl_easy_getinfo(curlHandle, CURLINFO_SIZE_DOWNLOAD_T, &received);
+        context->counters.wireBytes = static_cast<std::uint64_t>(received);
     }
+    curl_easy_setopt(curlHandle, CURLOPT_POSTFIELDS, nullptr);
+    curl_easy_setopt(curlHandle, CURLOPT_WRITEFUNCTION, ResponseSink::write);
+    curl_easy_setopt(curlHandle, CURLOPT_WRITEDATA, nullptr);
+    releaseHandle(*pool, curlHandle);
 
-    long httpStatusCode = 0;
-    curl_easy_getinfo(curlHandle, CURLINFO_RESPONSE_CODE, &httpStatusCode);
-    if (httpStatusCode < 200 || httpStatusCode >= 300) {
-        Logger::getInstance().log("HTTP error: status code " + std::to_string(httpStatusCode));
-        return std::nullopt;
+    return failure == FailureKind::None;
+}
+
+std::size_t NetworkAdapter::warmup(const std::string& url, std::size_t connections) {
+    if (connections == 0) {
+        return 0;
     }
+    if (IpcAdapter::isIpcEndpoint(url)) {
+        return ipcConnection(url).sendRequest(std::string(kProbeRequest)) ? 1 : 0;
+    }
+    if (!initialized) {
+        Logger::getInstance().log("Cannot warm up " + url + ": libcurl is not initialized.");
+        return 0;
+    }
+    EndpointPool* pool = endpointPool(url);
+    if (!pool) {
+        return 0;
+    }
+    connections = std::min(connections, options.maxHandlesPerEndpoint);
 
-    return response;
+    std::size_t answered = 0;
+    if (options.asyncOptions.multiplex) {
+        std::vector<std::future<std::optional<std::string>>> probes;
+        for (std::size_t i = 0; i < connections; ++i) {
+            probes.push_back(asyncTransport().sendPostRequestAsync(url, std::string(kProbeRequest)));
+        }
+        for (auto& result : probes) {
+            answered += result.get().has_value() ? 1 : 0;
+        }
+    } else {
+        if (options.pinAddresses) {
+            std::call_once(pool->pinFlag, [pool]() {
+                const std::string entry = resolveEntry(pool->url);
+                if (!entry.empty()) {
+                    pool->resolve.store(curl_slist_append(nullptr, entry.c_str()));
+                }
+            });
+        }
+
+        std::vector<CURL*> handles;
+        const auto deadline = std::chrono::steady_clock::now() + options.timeout;
+        while (handles.size() < connections) {
+            CURL* handle = acquireHandle(*pool, deadline);
+            if (!handle) {
+                break;
+            }
+            handles.push_back(handle);
+        }
+        answered = probe(*pool, handles, options.timeout);
+        for (CURL* handle : handles) {
+            releaseHandle(*pool, handle);
+        }
+    }
+
+    std::size_t warm = pool->warm.load();
+    while (answered > warm && !pool->warm.compare_exchange_weak(warm, answered)) {
+    }
+    if (answered > 0 && options.keepAliveInterval.count() > 0) {
+        std::call_once(keepAliveFlag, [this]() {
+            keepAliveTimer = CreateScope<TimerQueue>();
+            keepAliveTimer->schedule(std::chrono::steady_clock::now() + options.keepAliveInterval, [this]() { keepAlive(); });
+        });
+    }
+    return answered;
+}
+
+ConnectionStats NetworkAdapter::asyncConnectionStats() const {
+    const AsyncNetworkAdapter* adapter = asyncStarted.load(std::memory_order_acquire);
+    return adapter ? adapter->connectionStats() : ConnectionStats {};
+}
+
+TlsOffloadStats NetworkAdapter::tlsOffloadStats() const {
+    return kernelTls ? kernelTls->stats() : TlsOffloadStats {};
+}
+
+IpcAdapter& NetworkAdapter::ipcConnection(const std::string& url) {
+    {
+        std::shared_lock<std::shared_mutex> lock(ipcMutex);
+        auto it = ipcConnections.find(url);
+        if (it != ipcConnections.end()) {
+            return *it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(ipcMutex);
+    auto& connection = ipcConnections[url];
+    if (!connection) {
+        connection = CreateScope<IpcAdapter>(IpcAdapter::socketPathFromEndpoint(url), options.timeout);
+    }
+    return *connection;
+}
+
+AsyncNetworkAdapter& NetworkAdapter::asyncTransport() {
+    std::call_once(asyncInitFlag, [this]() {
+        asyncAdapter = CreateScope<AsyncNetworkAdapter>(options.asyncOptions);
+        asyncStarted.store(asyncAdapter.get(), std::memory_order_release);
+    });
+    return *asyncAdapter;
+}
+
+NetworkAdapter::EndpointPool* NetworkAdapter::endpointPool(const std::string& url) {
+    {
+        std::shared_lock<std::shared_mutex> lock(poolsMutex);
+        auto it = pools.find(url);
+        if (it != pools.end()) {
+            return it->second.get();
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(poolsMutex);
+    auto it = pools.find(url);
+    if (it != pools.end()) {
+        return it->second.get();
+    }
+
+    auto pool = CreateScope<EndpointPool>();
+    pool->url = url;
+    pool->headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    if (!pool->headers) {
+        Logger::getInstance().log("Failed to create HTTP headers for request.");
+        return nullptr;
+    }
+    const std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    pool->shards = std::vector<EndpointPool::Shard>(std::min(options.maxHandlesPerEndpoint, cores));
+    return pools.emplace(url, std::move(pool)).first->second.get();
+}
+
+CURL* NetworkAdapter::acquireHandle(EndpointPool& pool, std::chrono::steady_clock::time_point deadline) {
+    const std::size_t home = threadShardSeed() % pool.shards.size();
+    if (CURL* handle = pool.popIdle(home)) {
+        return handle;
+    }
+
+    std::size_t created = pool.created.load();
+    while (created < options.maxHandlesPerEndpoint) {
+        if (!pool.created.compare_exchange_weak(created, created + 1)) {
+            continue;
+        }
+        CURL* handle = createHandle(pool);
+        if (!handle) {
+            --pool.created;
+            std::lock_guard<std::mutex> lock(pool.waitMutex);
+            pool.available.notify_one();
+        }
+        return handle;
+    }
+
+    std::unique_lock<std::mutex> lock(pool.waitMutex);
+    ++pool.waiters;
+    CURL* handle = nullptr;
+    const bool ready = pool.available.wait_until(lock, deadline, [&]() {
+        handle = pool.popIdle(home);
+        return handle || pool.created.load() < options.maxHandlesPerEndpoint;
+    });
+    --pool.waiters;
+    lock.unlock();
+
+    if (!ready) {
+        return nullptr;
+    }
+    return handle ? handle : acquireHandle(pool, deadline);
 }
 
-size_t NetworkAdapter::writeCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t totalSize = size * nmemb;
-    std::string* response = reinterpret_cast<std::string*>(userp);
-    response->append(reinterpret_cast<char*>(contents), totalSize);
-    return totalSize;
+void NetworkAdapter::releaseHandle(EndpointPool& pool, CURL* handle) {
+    const std::size_t home = threadShardSeed() % pool.shards.size();
+    {
+        std::lock_guard<std::mutex> lock(pool.shards[home].mutex);
+        pool.shards[home].idle.push_back(handle);
+    }
+
+    if (pool.waiters.load() > 0) {
+        std::lock_guard<std::mutex> lock(pool.waitMutex);
+        pool.available.notify_one();
+    }
+}
+
+CURL* NetworkAdapter::createHandle(const EndpointPool& pool) const {
+    CURL* handle = curl_easy_init();
+    if (!handle) {
+        return nullptr;
+    }
+
+    curl_easy_setopt(handle, CURLOPT_URL, pool.url.c_str());
+    curl_easy_setopt(handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, pool.headers);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, ResponseSink::write);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (options.acceptEncoding) {
+        curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, options.acceptEncoding->c_str());
+    }
+    if (options.share && options.share->handle()) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, options.share->handle());
+    }
+    if (curl_slist* pinned = pool.resolve.load()) {
+        curl_easy_setopt(handle, CURLOPT_RESOLVE, pinned);
+    }
+    if (kernelTls) {
+        kernelTls->enable(handle);
+    }
+    return handle;
+}
+
+std::size_t NetworkAdapter::probe(const EndpointPool& pool, const std::vector<CURL*>& handles, std::chrono::milliseconds timeout) const {
+    // Each probe runs its handle's own blocking perform, so the connection it opens stays in
+    // that handle's connection cache for later requests. Running the probes side by side
+    // makes each of them open its own connection.
+    std::vector<std::future<bool>> probes;
+    probes.reserve(handles.size());
+    for (CURL* handle : handles) {
+        probes.push_back(std::async(std::launch::async, [this, &pool, handle, timeout]() {
+            std::string response;
+            ResponseSink sink {handle, &response};
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDS, kProbeRequest.data());
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(kProbeRequest.size()));
+            curl_easy_setopt(handle, CURLOPT_WRITEDATA, &sink);
+            curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
+            curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(std::min(options.connectTimeout, timeout).count()));
+            // Also loads the pin into a shared DNS cache, where handles created before pinning find it.
+            if (curl_slist* pinned = pool.resolve.load()) {
+                curl_easy_setopt(handle, CURLOPT_RESOLVE, pinned);
+            }
+            const CURLcode result = curl_easy_perform(handle);
+            curl_easy_setopt(handle, CURLOPT_POSTFIELDS, nullptr);
+            curl_easy_setopt(handle, CURLOPT_WRITEDATA, nullptr);
+
+            // Any HTTP answer, even an error status or a JSON-RPC error, means the connection is established.
+            long status = 0;
+            return result == CURLE_OK && curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status) == CURLE_OK && status > 0;
+        }));
+    }
+
+    std::size_t answered = 0;
+    for (auto& probe : probes) {
+        answered += probe.get() ? 1 : 0;
+    }
+    return answered;
+}
+
+void NetworkAdapter::keepAlive() {
+    std::vector<EndpointPool*> warmed;
+    {
+        std::shared_lock<std::shared_mutex> lock(poolsMutex);
+        for (const auto& [url, pool] : pools) {
+            if (pool->warm.load() > 0) {
+                warmed.push_back(pool.get());
+            }
+        }
+    }
+
+    // Rounds probe a few connections each, so they run often enough that every warm connection is probed once per interval.
+    std::size_t rounds = 1;
+    for (EndpointPool* pool : warmed) {
+        if (options.asyncOptions.multiplex) {
+            // The probes share one HTTP/2 connection, so one keeps it open.
+            asyncTransport().sendPostRequestAsync(pool->url, std::string(kProbeRequest), [](std::optional<std::string>) {});
+            continue;
+        }
+        const std::size_t warm = pool->warm.load();
+        rounds = std::max(rounds, (warm + kKeepAliveProbesPerRound - 1) / kKeepAliveProbesPerRound);
+
+        // Only idle handles are probed, those idle longest first; handles serving requests keep their connections busy anyway.
+        std::vector<CURL*> handles;
+        while (handles.size() < std::min(warm, kKeepAliveProbesPerRound)) {
+            CURL* handle = pool->popOldestIdle();
+            if (!handle) {
+                break;
+            }
+            handles.push_back(handle);
+        }
+        probe(*pool, handles, std::min(options.timeout, kKeepAliveProbeTimeout));
+        for (CURL* handle : handles) {
+            releaseHandle(*pool, handle);
+        }
+    }
+
+    keepAliveTimer->schedule(std::chrono::steady_clock::now() + options.keepAliveInterval / rounds, [this]() { keepAlive(); });
 }
@@ -3,6 +3,27 @@
 
 #include "common.hpp"
 #include <curl/curl.h>
+#include "curlshare.hpp"
+#include "asyncnetworkadapter.hpp"
+#include "ipcadapter.hpp"
+#include "timerqueue.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct NetworkAdapterOptions
+ * @brief Tuning knobs for the pooled HTTP transport.
+ */
+struct NetworkAdapterOptions {
+    std::size_t maxHandlesPerEndpoint = std::max(4u, std::thread::hardware_concurrency()); ///< Upper bound of persistent transfer handles kept per endpoint.
+    std::chrono::milliseconds timeout = std::chrono::seconds(30); ///< Total transfer timeout; a request's deadline can only shorten it.
+    std::chrono::milliseconds connectTimeout = std::chrono::seconds(5); ///< Budget for DNS, TCP and TLS setup, so an unreachable node fails fast.
+    Ref<CurlShare> share = CurlShare::shared(); ///< Share object for DNS and TLS sessions (may be null).
+    std::optional<std::string> acceptEncoding = std::string(); ///< Offered content encodings; empty offers all libcurl supports, std::nullopt disables compression.
+    bool pinAddresses = true;       ///< Whether warmup() pins the endpoint's resolved addresses (CURLOPT_RESOLVE), so later connections skip DNS; pooled handles only, not multiplexed ones.
+    std::chrono::milliseconds keepAliveInterval = std::chrono::seconds(30); ///< How often connections opened by warmup() are probed to keep them open; 0 disables probes.
+    bool kernelTls = false;         ///< Hand established TLS sessions to kernel TLS where the kernel and cipher allow it; see KernelTls.
+    AsyncNetworkAdapterOptions asyncOptions;    ///< Settings of the event-loop transport behind sendPostRequestAsync.
+};
 
 /**
  * @class NetworkAdapter
@@ -11,22 +32,54 @@
  * This class provides methods to send HTTP POST requests to an Ethereum node,
  * retrieve the response, and handle the low-level network communication using libcurl.
  * It is designed to be used by other classes to interact with an Ethereum node.
+ *
+ * Transfer handles are pooled per endpoint: headers and static options are
+ * prepared once when a handle is created, and only the request body changes
+ * between calls. Each handle keeps its connection open between requests. All
+ * handles attach to a CurlShare object, so adapters that use the same share (the
+ * process-wide one by default) reuse each other's DNS entries and TLS sessions.
+ *
+ * The adapter is safe to use from many threads at once. Idle handles are spread
+ * over lock stripes and each thread starts at its own stripe, so the request path
+ * takes no adapter-wide lock; threads only block when every handle is busy.
+ *
+ * Responses are requested compressed (gzip, deflate, and br/zstd when libcurl was
+ * built with them) and decompressed while streaming; see acceptEncoding.
+ *
+ * Setting asyncOptions.multiplex opts into HTTP/2 multiplexing: blocking calls are
+ * then routed through the async transport as well, so concurrent callers share
+ * streams on one connection instead of holding a pooled connection each.
+ *
+ * warmup() opens connections ahead of the first request, so a freshly started
+ * service does not pay DNS, TCP and TLS setup inline. It pins the resolved
+ * addresses for the adapter's lifetime and keeps the warmed connections open
+ * with a cheap eth_chainId probe every keepAliveInterval; servers and libcurl
+ * otherwise close connections that stay idle for a minute or two.
+ *
+ * Setting kernelTls hands established HTTPS sessions of the pooled and async
+ * handles to kernel TLS, which pays off for long-lived connections that
+ * download large responses; connections the kernel cannot take stay in userspace.
+ *
+ * Endpoints of the form "ipc:///path/geth.ipc" (or any path ending in ".ipc") are
+ * served by an IpcAdapter over the node's Unix domain socket instead of HTTP, so an
+ * EthereumClient can talk to a co-located node simply by using the socket path as its URL.
  */
-class PROJECT_EXPORT NetworkAdapter {
+class PROJECT_EXPORT NetworkAdapter : public Transport {
 public:
     /**
      * @brief Constructs a NetworkAdapter instance.
+     * @param options Pool size, timeout and share object used by this adapter.
      *
-     * Initializes the libcurl library and prepares the curl handle for making requests.
+     * Initializes the libcurl library. Transfer handles are created lazily, on first use of an endpoint.
      */
-    NetworkAdapter();
+    explicit NetworkAdapter(NetworkAdapterOptions options = {});
 
     /**
      * @brief Destructs the NetworkAdapter instance.
      *
-     * Cleans up the curl handle and shuts down the libcurl library.
+     * Cleans up every pooled curl handle and the per-endpoint headers.
      */
-    ~NetworkAdapter();
+    ~NetworkAdapter() override;
 
     NetworkAdapter(const NetworkAdapter&) = delete;
     NetworkAdapter& operator=(const NetworkAdapter&) = delete;
@@ -38,21 +91,164 @@ public:
      * @param url The URL to send the POST request to (e.g., the Ethereum node endpoint).
      * @param data The data to send in the body of the POST request (usually a JSON-RPC request).
      * @return The response body as a string if successful, or an empty std::optional if an error occurs.
+     *
+     * Blocks while every pooled handle of the endpoint is busy.
+     */
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    /**
+     * @brief Sends a POST request and writes the body into a caller-owned buffer.
+     * @param url The URL to send the POST request to.
+     * @param data The data to send in the body of the POST request.
+     * @param response Receives the response body; it is cleared first, keeping its capacity.
+     * @param context Optional; may cancel the transfer or bound it by a deadline, and receives its sizes.
+     * @return True if the request succeeded with a 2xx status.
+     *
+     * The transfer timeout is shortened to the context's deadline and the connect
+     * timeout to its connectTimeout, so a call abandoned by its caller releases the
+     * pooled handle (and drops its connection) as soon as its budget runs out.
+     *
+     * The buffer is reserved to the announced Content-Length before the body arrives.
+     * Compressed bodies are decoded by libcurl as they stream in, so the buffer
+     * always holds the decoded JSON.
+     */
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Sends a POST request and passes the body to a consumer as it arrives.
+     * @param url The URL to send the POST request to.
+     * @param data The data to send in the body of the POST request.
+     * @param onChunk Receives the decoded body piece by piece, on the calling thread; returning false aborts the transfer.
+     * @param context Optional; may cancel the transfer or bound it by a deadline, and receives its sizes.
+     * @return True if the request succeeded with a 2xx status and the consumer took the whole body.
+     *
+     * Runs on a pooled handle like sendPostRequestInto(), but no body buffer is kept:
+     * each piece libcurl receives and decompresses is handed on directly, so parsing
+     * overlaps the transfer. Bodies of non-2xx responses are not passed on. IPC
+     * endpoints and multiplexed transfers deliver the whole body as one piece.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Sends a POST request without blocking the calling thread.
+     * @param url The URL to send the POST request to.
+     * @param data The data to send in the body of the POST request.
+     * @param callback Invoked with the response body, or an empty std::optional if an error occurs.
+     * @param context Optional; may cancel the transfer and receives its sizes before the callback runs.
+     *
+     * The request is performed by an AsyncNetworkAdapter started on first use; the
+     * callback runs on its event-loop thread and must not block.
+     */
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Opens connections to an endpoint before the first request needs them.
+     * @param url The endpoint to warm up.
+     * @param connections How many connections to open; capped at maxHandlesPerEndpoint.
+     * @return The number of connections that answered a probe request.
+     *
+     * Resolves the host and pins its addresses (see pinAddresses), then sends one
+     * eth_chainId probe per connection concurrently, which completes DNS, TCP and
+     * TLS setup for each of them. Blocks until the probes finish or time out.
+     * With multiplexing enabled the probes go through the async transport, where
+     * they share one HTTP/2 connection; addresses are not pinned on that path.
+     *
+     * The warmed connections are then probed about once per keepAliveInterval
+     * while they sit idle. Each keep-alive round borrows at most two idle handles
+     * and gives up on a probe after two seconds, so a hung node delays requests
+     * waiting for a handle by no more than that.
+     */
+    std::size_t warmup(const std::string& url, std::size_t connections = 1);
+
+    /**
+     * @brief Retrieves stream and connection counters of the async transport.
+     * @return All-zero counters if the async transport has not been started.
+     */
+    ConnectionStats asyncConnectionStats() const;
+
+    /**
+     * @brief Retrieves how many TLS connections were offloaded to the kernel.
+     * @return All-zero counters if kernelTls is disabled or unsupported.
      */
-    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data);
+    TlsOffloadStats tlsOffloadStats() const;
 
 private:
-    CURL* curlHandle = nullptr; ///< The libcurl handle used for making HTTP requests.
+    /**
+     * @brief Returns the IPC connection for an endpoint, creating it on first use.
+     */
+    IpcAdapter& ipcConnection(const std::string& url);
+
+    /**
+     * @brief Returns the async transport, starting it on first use.
+     */
+    AsyncNetworkAdapter& asyncTransport();
+
+    struct EndpointPool;
+
+    /**
+     * @brief Returns the pool for the given URL, creating it on first use.
+     */
+    EndpointPool* endpointPool(const std::string& url);
+
+    /**
+     * @brief Takes an idle handle from the pool, creating or waiting for one if needed.
+     * @param deadline Gives up waiting for a busy pool at this time.
+     * @return A ready-to-use handle, or nullptr if a new handle could not be created or the deadline passed.
+     */
+    CURL* acquireHandle(EndpointPool& pool, std::chrono::steady_clock::time_point deadline);
 
     /**
-     * @brief Callback function used by libcurl to write the response data.
-     * @param contents The received data chunk.
-     * @param size The size of each chunk of data.
-     * @param nmemb The number of chunks.
-     * @param userp A pointer to the user data (used to store the response).
-     * @return The number of bytes successfully written.
+     * @brief Returns a handle to its pool and wakes one waiter.
      */
-    static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp);
+    void releaseHandle(EndpointPool& pool, CURL* handle);
+
+    /**
+     * @brief CURLOPT_WRITEFUNCTION of a transfer.
+     */
+    using WriteFunction = size_t (*)(void* contents, size_t size, size_t nmemb, void* userp);
+
+    /**
+     * @brief Performs a request on a pooled handle of the endpoint, writing the body through a sink.
+     * @param write The sink's write function; @p sink is passed to it.
+     * @param sinkHandle Receives the transfer's handle before it starts, for sinks that query it.
+     * @param aborted Optional; set by the sink when it aborted the transfer on purpose, which is reported as FailureKind::Cancelled.
+     * @param budget Time left for the request, used while waiting for a handle.
+     * @return True on a 2xx response; sets the context's failure and wire size.
+     */
+    bool performPooled(const std::string& url, const std::string& data, WriteFunction write, void* sink, CURL** sinkHandle,
+                       const bool* aborted, std::chrono::milliseconds budget, RequestContext* context);
+
+    /**
+     * @brief Creates a handle with all per-endpoint options applied.
+     */
+    CURL* createHandle(const EndpointPool& pool) const;
+
+    /**
+     * @brief Sends a probe request on each handle at once and returns how many got an HTTP answer.
+     * @param timeout Budget of each probe.
+     */
+    std::size_t probe(const EndpointPool& pool, const std::vector<CURL*>& handles, std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief Probes the longest-idle warmed connections of every endpoint and schedules the next round.
+     */
+    void keepAlive();
+
+    NetworkAdapterOptions options; ///< Pool and transfer settings.
+    bool initialized = false; ///< Whether libcurl globals were initialized successfully.
+    std::shared_mutex poolsMutex; ///< Guards the endpoint map; lookups take it shared.
+    std::unordered_map<std::string, Scope<EndpointPool>> pools; ///< Handle pools keyed by endpoint URL.
+    std::shared_mutex ipcMutex; ///< Guards the IPC connection map.
+    std::unordered_map<std::string, Scope<IpcAdapter>> ipcConnections; ///< IPC connections keyed by endpoint.
+    std::once_flag asyncInitFlag; ///< Guards lazy creation of the async transport.
+    std::atomic<AsyncNetworkAdapter*> asyncStarted {nullptr}; ///< Published once the async transport exists.
+    Scope<AsyncNetworkAdapter> asyncAdapter; ///< Event-loop transport used by sendPostRequestAsync.
+    std::once_flag keepAliveFlag; ///< Guards the first keep-alive schedule.
+    Scope<TimerQueue> keepAliveTimer; ///< Runs keep-alive probes; stopped first on destruction.
+    Ref<KernelTls> kernelTls; ///< Kernel TLS offload shared with the async transport; null when disabled.
 };
 
 #endif // NETWORKADAPTER_HPP
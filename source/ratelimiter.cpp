@@ -0,0 +1,397 @@
+#include "ratelimiter.hpp"
+#include "jsonscan.hpp"
+#include <cmath>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double capacityOf(const EndpointLimits& limits) {
+    return limits.burst > 0.0 ? limits.burst : limits.costPerSecond;
+}
+
+double costOf(const EndpointLimits& limits, std::string_view request) {
+    const bool batch = !request.empty() && request.front() == '[';
+    if (limits.methodCosts.empty() && !batch) {
+        return limits.defaultCost;
+    }
+    // A batch takes the sum of its requests' costs, as providers bill each element.
+    double cost = 0.0;
+    for (const std::string_view method : findMethods(request)) {
+        const auto it = limits.methodCosts.find(method);
+        cost += it != limits.methodCosts.end() ? it->second : limits.defaultCost;
+    }
+    return cost;
+}
+}
+
+struct RateLimiter::Waiter {
+    std::uint64_t id = 0;        ///< Identifies the waiter for withdrawal.
+    double cost = 0.0;           ///< Tokens the request takes.
+    std::function<void()> start; ///< Sends the request; runs once admitted, outside the endpoint lock.
+};
+
+struct RateLimiter::Endpoint {
+    Endpoint(std::string url, const EndpointLimits& limits)
+        : url(std::move(url)), limits(limits), tokens(capacityOf(limits)), refilled(Clock::now()),
+          limit(static_cast<double>(std::clamp(limits.initialConcurrency, std::max<std::size_t>(limits.minConcurrency, 1),
+                                               std::max(limits.maxConcurrency, std::max<std::size_t>(limits.minConcurrency, 1))))) {}
+
+    const std::string url;         ///< Endpoint URL.
+    const EndpointLimits& limits;  ///< Limits of this endpoint, owned by the options.
+
+    mutable std::mutex mutex;      ///< Guards the state below.
+    double tokens = 0.0;           ///< Tokens in the bucket; negative after an oversized request.
+    Clock::time_point refilled;    ///< Time of the last refill.
+    double limit = 1.0;            ///< Concurrency limit; requests are admitted while inFlight < floor(limit).
+    std::size_t inFlight = 0;      ///< Requests sent and not completed.
+    Clock::time_point pausedUntil {}; ///< No requests are admitted before this time (Retry-After).
+    Clock::time_point lastDecrease {}; ///< Time of the last limit cut.
+    double windowMinMs = 0.0;      ///< Fastest response in the current baseline window (0 if none).
+    double previousMinMs = 0.0;    ///< Fastest response in the previous baseline window (0 if none).
+    Clock::time_point windowStarted {}; ///< Start of the current baseline window.
+    bool timerArmed = false;       ///< Whether a refill timer is pending.
+    Clock::time_point timerAt {};  ///< Deadline of the pending refill timer.
+    std::deque<Waiter> queue;      ///< Requests waiting for admission, in arrival order.
+    std::uint64_t requests = 0;    ///< Requests admitted.
+    std::uint64_t delayed = 0;     ///< Requests that had to queue.
+    std::uint64_t throttled = 0;   ///< 429 responses received.
+    std::uint64_t decreases = 0;   ///< Limit cuts.
+
+    double baselineMs() const {
+        return previousMinMs == 0.0 ? windowMinMs : std::min(windowMinMs, previousMinMs);
+    }
+};
+
+RateLimiter::RateLimiter(RateLimiterOptions options, Transport& transport)
+    : options(std::move(options)), transport(transport) {}
+
+RateLimiter::~RateLimiter() = default;
+
+std::optional<std::string> RateLimiter::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool RateLimiter::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                      RequestContext* context) {
+    RequestContext local;
+    RequestContext& attempt = context ? *context : local;
+    Endpoint& endpoint = endpointFor(url);
+    if (!waitForAdmission(endpoint, data, attempt)) {
+        return false;
+    }
+
+    const auto started = Clock::now();
+    if (attempt.cancellation.stop_requested()) {
+        attempt.failure = FailureKind::Cancelled;
+        complete(endpoint, started, attempt, false);
+        return false;
+    }
+    const bool succeeded = transport.sendPostRequestInto(url, data, response, &attempt);
+    complete(endpoint, started, attempt, succeeded);
+    return succeeded;
+}
+
+bool RateLimiter::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                           RequestContext* context) {
+    RequestContext local;
+    RequestContext& attempt = context ? *context : local;
+    Endpoint& endpoint = endpointFor(url);
+    if (!waitForAdmission(endpoint, data, attempt)) {
+        return false;
+    }
+
+    const auto started = Clock::now();
+    if (attempt.cancellation.stop_requested()) {
+        attempt.failure = FailureKind::Cancelled;
+        complete(endpoint, started, attempt, false);
+        return false;
+    }
+    // A large body takes long to deliver however idle the node is, so only the wait for its first piece counts as latency.
+    Clock::time_point answered {};
+    const bool succeeded = transport.sendPostRequestStreaming(url, data, [&onChunk, &answered](std::string_view chunk) {
+        if (answered == Clock::time_point {}) {
+            answered = Clock::now();
+        }
+        return onChunk(chunk);
+    }, &attempt);
+    complete(endpoint, started, attempt, succeeded, answered);
+    return succeeded;
+}
+
+void RateLimiter::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                       RequestContext* context) {
+    struct Request {
+        std::string url;
+        std::string data;
+        Callback callback;
+        RequestContext* caller = nullptr;
+        RequestContext local;
+        Scope<std::stop_callback<std::function<void()>>> onCancel;
+
+        RequestContext& context() { return caller ? *caller : local; }
+    };
+
+    if (context && context->cancellation.stop_requested()) {
+        context->failure = FailureKind::Cancelled;
+        callback(std::nullopt);
+        return;
+    }
+
+    Endpoint& endpoint = endpointFor(url);
+    auto request = CreateRef<Request>();
+    request->url = url;
+    request->data = data;
+    request->callback = std::move(callback);
+    request->caller = context;
+    const std::uint64_t id = nextWaiterId.fetch_add(1, std::memory_order_relaxed);
+
+    if (context && context->cancellation.stop_possible()) {
+        request->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(context->cancellation,
+            std::function<void()>([this, &endpoint, raw = request.get(), id] {
+                // The withdrawn waiter owns the request, so it stays alive until the callback has run.
+                if (std::optional<Waiter> withdrawn = withdraw(endpoint, id)) {
+                    raw->context().failure = FailureKind::Cancelled;
+                    raw->callback(std::nullopt);
+                }
+            }));
+    }
+    if (context && context->deadline != Clock::time_point::max()) {
+        timers.schedule(context->deadline, [this, &endpoint, weak = std::weak_ptr<Request>(request), id] {
+            if (std::optional<Waiter> withdrawn = withdraw(endpoint, id)) {
+                if (Ref<Request> expired = weak.lock()) {
+                    expired->onCancel.reset();
+                    expired->context().failure = FailureKind::Timeout;
+                    expired->callback(std::nullopt);
+                }
+            }
+        });
+    }
+
+    enqueue(endpoint, Waiter {id, costOf(endpoint.limits, data), [this, &endpoint, request] {
+        request->onCancel.reset();
+        const auto started = Clock::now();
+        transport.sendPostRequestAsync(request->url, request->data,
+            [this, &endpoint, request, started](std::optional<std::string> response) {
+                complete(endpoint, started, request->context(), response.has_value());
+                request->callback(std::move(response));
+            }, &request->context());
+    }});
+}
+
+std::vector<EndpointLimitStats> RateLimiter::limitStats() const {
+    std::vector<EndpointLimitStats> stats;
+    std::shared_lock<std::shared_mutex> lock(endpointsMutex);
+    stats.reserve(endpoints.size());
+    for (const auto& [url, endpoint] : endpoints) {
+        std::lock_guard<std::mutex> endpointLock(endpoint->mutex);
+        EndpointLimitStats entry;
+        entry.url = url;
+        entry.concurrencyLimit = endpoint->limit;
+        entry.inFlight = endpoint->inFlight;
+        entry.queued = endpoint->queue.size();
+        entry.tokens = endpoint->tokens;
+        entry.baselineLatencyMs = endpoint->baselineMs();
+        entry.requests = endpoint->requests;
+        entry.delayed = endpoint->delayed;
+        entry.throttled = endpoint->throttled;
+        entry.decreases = endpoint->decreases;
+        stats.push_back(std::move(entry));
+    }
+    return stats;
+}
+
+RateLimiter::Endpoint& RateLimiter::endpointFor(const std::string& url) {
+    {
+        std::shared_lock<std::shared_mutex> lock(endpointsMutex);
+        auto it = endpoints.find(url);
+        if (it != endpoints.end()) {
+            return *it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(endpointsMutex);
+    auto& endpoint = endpoints[url];
+    if (!endpoint) {
+        const auto limits = options.endpoints.find(url);
+        endpoint = CreateScope<Endpoint>(url, limits != options.endpoints.end() ? limits->second : options.defaults);
+    }
+    return *endpoint;
+}
+
+void RateLimiter::enqueue(Endpoint& endpoint, Waiter waiter) {
+    const std::uint64_t id = waiter.id;
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(endpoint.mutex);
+        endpoint.queue.push_back(std::move(waiter));
+        ready = admitLocked(endpoint, Clock::now());
+        if (!endpoint.queue.empty() && endpoint.queue.back().id == id) {
+            ++endpoint.delayed;
+        }
+    }
+    for (auto& start : ready) {
+        start();
+    }
+}
+
+std::optional<RateLimiter::Waiter> RateLimiter::withdraw(Endpoint& endpoint, std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(endpoint.mutex);
+    auto it = std::find_if(endpoint.queue.begin(), endpoint.queue.end(), [id](const Waiter& waiter) { return waiter.id == id; });
+    if (it == endpoint.queue.end()) {
+        return std::nullopt;
+    }
+    Waiter waiter = std::move(*it);
+    endpoint.queue.erase(it);
+    return waiter;
+}
+
+bool RateLimiter::waitForAdmission(Endpoint& endpoint, const std::string& data, RequestContext& context) {
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable_any opened;
+        bool open = false;
+    } gate;
+    const std::uint64_t id = nextWaiterId.fetch_add(1, std::memory_order_relaxed);
+    enqueue(endpoint, Waiter {id, costOf(endpoint.limits, data), [&gate] {
+        std::lock_guard<std::mutex> lock(gate.mutex);
+        gate.open = true;
+        gate.opened.notify_one();
+    }});
+
+    std::unique_lock<std::mutex> lock(gate.mutex);
+    if (context.deadline == Clock::time_point::max()) {
+        gate.opened.wait(lock, context.cancellation, [&gate] { return gate.open; });
+    } else {
+        gate.opened.wait_until(lock, context.cancellation, context.deadline, [&gate] { return gate.open; });
+    }
+    if (!gate.open) {
+        lock.unlock();
+        if (withdraw(endpoint, id)) {
+            context.failure = context.cancellation.stop_requested() ? FailureKind::Cancelled : FailureKind::Timeout;
+            return false;
+        }
+        // Admitted while we were giving up: wait for the start action so the gate outlives it.
+        lock.lock();
+        gate.opened.wait(lock, [&gate] { return gate.open; });
+    }
+    return true;
+}
+
+std::vector<std::function<void()>> RateLimiter::admitLocked(Endpoint& endpoint, Clock::time_point now) {
+    const EndpointLimits& limits = endpoint.limits;
+    if (limits.costPerSecond > 0.0) {
+        const double elapsed = std::chrono::duration<double>(now - endpoint.refilled).count();
+        endpoint.tokens = std::min(capacityOf(limits), endpoint.tokens + elapsed * limits.costPerSecond);
+    }
+    endpoint.refilled = now;
+
+    std::vector<std::function<void()>> ready;
+    std::optional<Clock::time_point> wakeAt;
+    while (!endpoint.queue.empty()) {
+        if (now < endpoint.pausedUntil) {
+            wakeAt = endpoint.pausedUntil;
+            break;
+        }
+        // Completions re-run admission, so a full window needs no timer.
+        if (static_cast<double>(endpoint.inFlight) + 1.0 > std::max(std::floor(endpoint.limit), 1.0)) {
+            break;
+        }
+        Waiter& head = endpoint.queue.front();
+        if (limits.costPerSecond > 0.0) {
+            // A request costing more than the whole bucket waits for a full bucket and leaves a debt.
+            const double needed = std::min(head.cost, capacityOf(limits));
+            if (endpoint.tokens < needed) {
+                wakeAt = now + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>((needed - endpoint.tokens) / limits.costPerSecond));
+                break;
+            }
+            endpoint.tokens -= head.cost;
+        }
+        ++endpoint.inFlight;
+        ++endpoint.requests;
+        ready.push_back(std::move(head.start));
+        endpoint.queue.pop_front();
+    }
+
+    if (wakeAt && (!endpoint.timerArmed || *wakeAt < endpoint.timerAt)) {
+        endpoint.timerArmed = true;
+        endpoint.timerAt = *wakeAt;
+        timers.schedule(*wakeAt, [this, &endpoint] {
+            {
+                std::lock_guard<std::mutex> lock(endpoint.mutex);
+                endpoint.timerArmed = false;
+            }
+            admit(endpoint);
+        });
+    }
+    return ready;
+}
+
+void RateLimiter::admit(Endpoint& endpoint) {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(endpoint.mutex);
+        ready = admitLocked(endpoint, Clock::now());
+    }
+    for (auto& start : ready) {
+        start();
+    }
+}
+
+void RateLimiter::complete(Endpoint& endpoint, Clock::time_point started, const RequestContext& context, bool succeeded,
+                           Clock::time_point answered) {
+    const auto now = Clock::now();
+    const double latencyMs = std::chrono::duration<double, std::milli>((answered == Clock::time_point {} ? now : answered) - started).count();
+    const EndpointLimits& limits = endpoint.limits;
+
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(endpoint.mutex);
+        const bool saturated = static_cast<double>(endpoint.inFlight) >= std::floor(endpoint.limit);
+        --endpoint.inFlight;
+
+        bool congested = false;
+        if (!succeeded && context.failure == FailureKind::RateLimited) {
+            ++endpoint.throttled;
+            congested = true;
+            endpoint.tokens = std::min(endpoint.tokens, 0.0);
+            if (context.retryAfter.count() > 0) {
+                endpoint.pausedUntil = std::max(endpoint.pausedUntil, now + context.retryAfter);
+            }
+        } else if (!succeeded && context.failure == FailureKind::Timeout && !deadlineExceeded(context)) {
+            congested = true;
+        } else if (succeeded) {
+            // The baseline is the minimum over the last one to two windows, so it tracks a node
+            // that really got slower without absorbing the queueing delay we cause ourselves.
+            if (now - endpoint.windowStarted >= limits.baselineWindow) {
+                endpoint.previousMinMs = endpoint.windowMinMs;
+                endpoint.windowMinMs = 0.0;
+                endpoint.windowStarted = now;
+            }
+            if (endpoint.windowMinMs == 0.0 || latencyMs < endpoint.windowMinMs) {
+                endpoint.windowMinMs = latencyMs;
+            }
+            congested = latencyMs > endpoint.baselineMs() * limits.latencyTolerance;
+            if (!congested && saturated && limits.adaptiveConcurrency) {
+                // Additive increase: about one slot per round trip, and only while the window is in use.
+                endpoint.limit = std::min(static_cast<double>(limits.maxConcurrency), endpoint.limit + 1.0 / endpoint.limit);
+            }
+        }
+
+        // Responses already in flight when the limit was cut carry no new signal, so cut at most once per round trip.
+        const auto roundTrip = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(latencyMs));
+        if (congested && limits.adaptiveConcurrency && now - endpoint.lastDecrease >= roundTrip) {
+            endpoint.limit = std::max(static_cast<double>(std::max<std::size_t>(limits.minConcurrency, 1)), endpoint.limit * limits.backoffRatio);
+            endpoint.lastDecrease = now;
+            ++endpoint.decreases;
+        }
+        ready = admitLocked(endpoint, now);
+    }
+    for (auto& start : ready) {
+        start();
+    }
+}
@@ -0,0 +1,167 @@
+#ifndef RATELIMITER_HPP
+#define RATELIMITER_HPP
+
+#include "common.hpp"
+#include "timerqueue.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct EndpointLimits
+ * @brief Request budget and concurrency bounds of one endpoint.
+ */
+struct EndpointLimits {
+    double costPerSecond = 0.0; ///< Token refill rate in cost units per second; 0 disables the token bucket.
+    double burst = 0.0;         ///< Bucket capacity; 0 means one second's worth of tokens.
+    std::map<std::string, double, std::less<>> methodCosts; ///< Cost per method, e.g. a provider's compute units.
+    double defaultCost = 1.0;   ///< Cost of methods not listed in methodCosts; a batch costs the sum over its requests.
+
+    bool adaptiveConcurrency = true;   ///< Adjust the concurrency limit from latency and throttling; otherwise it stays at initialConcurrency.
+    std::size_t initialConcurrency = 16; ///< Starting concurrency limit.
+    std::size_t minConcurrency = 1;    ///< Lower bound of the limit.
+    std::size_t maxConcurrency = 256;  ///< Upper bound of the limit.
+    double latencyTolerance = 2.0;     ///< A response slower than this multiple of the baseline latency signals congestion.
+    std::chrono::milliseconds baselineWindow = std::chrono::seconds(10); ///< The baseline is the fastest response seen over the last one to two windows.
+    double backoffRatio = 0.9;         ///< Factor applied to the limit on congestion, throttling or timeouts.
+};
+
+/**
+ * @struct RateLimiterOptions
+ * @brief Limits applied by a RateLimiter.
+ */
+struct RateLimiterOptions {
+    EndpointLimits defaults; ///< Limits of endpoints without an override.
+    std::map<std::string, EndpointLimits, std::less<>> endpoints; ///< Per-URL overrides.
+};
+
+/**
+ * @struct EndpointLimitStats
+ * @brief Live limiter state of one endpoint.
+ */
+struct EndpointLimitStats {
+    std::string url;               ///< Endpoint URL.
+    double concurrencyLimit = 0.0; ///< Current concurrency limit.
+    std::size_t inFlight = 0;      ///< Requests currently sent.
+    std::size_t queued = 0;        ///< Requests waiting for a slot or tokens.
+    double tokens = 0.0;           ///< Tokens currently in the bucket.
+    double baselineLatencyMs = 0.0; ///< Latency the congestion signal is measured against.
+    std::uint64_t requests = 0;    ///< Requests admitted.
+    std::uint64_t delayed = 0;     ///< Requests that had to wait before being sent.
+    std::uint64_t throttled = 0;   ///< 429 responses received.
+    std::uint64_t decreases = 0;   ///< Times the concurrency limit was cut.
+};
+
+/**
+ * @class RateLimiter
+ * @brief Transport decorator that keeps each endpoint within its request budget.
+ *
+ * Two limits gate every request, per endpoint URL:
+ *
+ * - A token bucket refilled at costPerSecond, where each request takes the cost of
+ *   its method. This models provider budgets such as compute units per second.
+ * - A concurrency limit adapted by AIMD. It grows by one per round trip while
+ *   latency stays within latencyTolerance of the baseline (the fastest response
+ *   of the recent baselineWindow) and the limit is actually in use. It shrinks by
+ *   backoffRatio on a slow response, a timeout or a 429, at most once per round
+ *   trip. A 429 also pauses the endpoint for its Retry-After delay.
+ *
+ * Requests over either limit wait in a FIFO queue instead of being sent, so
+ * bursts are smoothed to the rate the provider sustains rather than bouncing off
+ * its throttle. Place it under a LoadBalancer, which passes each endpoint's URL
+ * down, or directly over a NetworkAdapter.
+ */
+class PROJECT_EXPORT RateLimiter final : public Transport {
+public:
+    /**
+     * @brief Constructs the limiter.
+     * @param options Default limits and per-endpoint overrides.
+     * @param transport The transport that performs the requests; must outlive the limiter.
+     */
+    RateLimiter(RateLimiterOptions options, Transport& transport);
+
+    ~RateLimiter() override;
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestInto
+     *
+     * Blocks while the endpoint is over its limits; cancellation or the context's
+     * deadline ends the wait.
+     */
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestStreaming
+     *
+     * Admitted like sendPostRequestInto(). The request holds its concurrency slot
+     * until the whole body has been delivered, but its latency, which drives the
+     * limit, is measured to the first piece.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestAsync
+     *
+     * Queued requests are sent from whichever thread frees their slot or tokens.
+     * If the caller cancels while the request is queued, the callback runs on the
+     * cancelling thread; if its deadline passes, on the limiter's timer thread.
+     */
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Retrieves the limiter state of every endpoint used so far.
+     */
+    std::vector<EndpointLimitStats> limitStats() const;
+
+private:
+    struct Endpoint;
+    struct Waiter;
+
+    Endpoint& endpointFor(const std::string& url);
+
+    /**
+     * @brief Queues a waiter and admits whatever the limits allow.
+     */
+    void enqueue(Endpoint& endpoint, Waiter waiter);
+
+    /**
+     * @brief Removes a queued waiter.
+     * @return The removed waiter, or an empty std::optional if it was already admitted.
+     */
+    std::optional<Waiter> withdraw(Endpoint& endpoint, std::uint64_t id);
+
+    /**
+     * @brief Blocks a synchronous request until it is admitted, cancelled or past its deadline.
+     * @return True once admitted; otherwise false with the context's failure set.
+     */
+    bool waitForAdmission(Endpoint& endpoint, const std::string& data, RequestContext& context);
+
+    /**
+     * @brief Admits queued waiters up to the limits and arms the refill timer if needed.
+     * @return The start actions of the admitted waiters, to run after unlocking.
+     */
+    std::vector<std::function<void()>> admitLocked(Endpoint& endpoint, std::chrono::steady_clock::time_point now);
+    void admit(Endpoint& endpoint);
+
+    /**
+     * @brief Releases a request's slot and feeds its outcome to the concurrency limit.
+     * @param answered When the response began to arrive; the latency is measured to it, or to now if unset.
+     */
+    void complete(Endpoint& endpoint, std::chrono::steady_clock::time_point started, const RequestContext& context, bool succeeded,
+                  std::chrono::steady_clock::time_point answered = {});
+
+    RateLimiterOptions options; ///< Limits per endpoint.
+    Transport& transport; ///< Transport performing the requests.
+    mutable std::shared_mutex endpointsMutex; ///< Guards the endpoint map; lookups take it shared.
+    std::unordered_map<std::string, Scope<Endpoint>> endpoints; ///< Limiter state keyed by URL.
+    std::atomic<std::uint64_t> nextWaiterId {1}; ///< Identifies queued waiters.
+    TimerQueue timers; ///< Wakes queues blocked on token refill or a Retry-After pause.
+};
+
+#endif // RATELIMITER_HPP
@@ -0,0 +1,58 @@
+#include "responsesink.hpp"
+#include "transferresult.hpp"
+
+namespace {
+/**
+ * @brief Most bytes reserved up front from a Content-Length; larger bodies grow as they arrive.
+ */
+constexpr std::size_t kMaxReserve = 8 * 1024 * 1024;
+}
+
+size_t ResponseSink::write(void* contents, size_t size, size_t nmemb, void* userp) {
+    const size_t totalSize = size * nmemb;
+    auto* sink = static_cast<ResponseSink*>(userp);
+    // Exceptions must not unwind through libcurl; returning 0 fails the transfer instead.
+    try {
+        if (!sink->sized) {
+            sink->sized = true;
+            curl_off_t contentLength = -1;
+            if (curl_easy_getinfo(sink->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength) == CURLE_OK && contentLength > 0) {
+                // The header is untrusted: a bogus length must not allocate gigabytes before any data arrives.
+                const auto announced = static_cast<std::uint64_t>(contentLength);
+                sink->body->reserve(sink->body->size() + static_cast<std::size_t>(std::min<std::uint64_t>(announced, kMaxReserve)));
+            }
+        }
+        sink->body->append(static_cast<const char*>(contents), totalSize);
+    } catch (...) {
+        return 0;
+    }
+    return totalSize;
+}
+
+size_t StreamingSink::write(void* contents, size_t size, size_t nmemb, void* userp) {
+    const size_t totalSize = size * nmemb;
+    auto* sink = static_cast<StreamingSink*>(userp);
+    if (!sink->checked) {
+        sink->checked = true;
+        long status = 0;
+        curl_easy_getinfo(sink->handle, CURLINFO_RESPONSE_CODE, &status);
+        sink->discard = classifyStatus(status) != FailureKind::None;
+    }
+    if (sink->discard) {
+        return totalSize;
+    }
+    bool proceed = false;
+    try {
+        proceed = (*sink->consumer)(std::string_view(static_cast<const char*>(contents), totalSize));
+    } catch (...) {
+        // A throwing consumer fails the transfer rather than unwinding through libcurl.
+        return 0;
+    }
+    if (!proceed) {
+        sink->stopped = true;
+        // Anything other than totalSize makes libcurl abort with CURLE_WRITE_ERROR.
+        return 0;
+    }
+    sink->delivered += totalSize;
+    return totalSize;
+}
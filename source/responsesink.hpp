@@ -0,0 +1,51 @@
+#ifndef RESPONSESINK_HPP
+#define RESPONSESINK_HPP
+
+#include "common.hpp"
+#include <curl/curl.h>
+#include "transport.hpp"
+
+/**
+ * @struct ResponseSink
+ * @brief Write target of a transfer: appends the body to a caller-owned buffer.
+ *
+ * On the first chunk the buffer is reserved to the announced Content-Length, up
+ * to 8 MiB, so large bodies (e.g. blocks with full transactions) are received
+ * with few reallocations. Buffers that are reused across requests keep their
+ * capacity. If appending throws, the transfer fails with CURLE_WRITE_ERROR.
+ */
+struct ResponseSink {
+    CURL* handle = nullptr;      ///< The transfer, queried for its Content-Length.
+    std::string* body = nullptr; ///< Buffer receiving the response body.
+    bool sized = false;          ///< Whether the buffer has been reserved for this transfer.
+
+    /**
+     * @brief CURLOPT_WRITEFUNCTION callback; @p userp points to a ResponseSink.
+     */
+    static size_t write(void* contents, size_t size, size_t nmemb, void* userp);
+};
+
+/**
+ * @struct StreamingSink
+ * @brief Write target of a streamed transfer: passes each piece of the body to a consumer instead of buffering it.
+ *
+ * Bodies of non-2xx responses are discarded rather than passed on, since they
+ * are error pages, not the JSON the consumer expects; the transfer's status
+ * reports the failure. A consumer that throws fails the transfer with
+ * CURLE_WRITE_ERROR; the exception does not propagate.
+ */
+struct StreamingSink {
+    CURL* handle = nullptr;                               ///< The transfer, queried for its HTTP status.
+    const Transport::ChunkCallback* consumer = nullptr;   ///< Receives the body.
+    std::uint64_t delivered = 0; ///< Body bytes passed to the consumer.
+    bool checked = false;        ///< Whether the HTTP status has been checked.
+    bool discard = false;        ///< Whether the body is an error page being dropped.
+    bool stopped = false;        ///< Whether the consumer aborted the transfer.
+
+    /**
+     * @brief CURLOPT_WRITEFUNCTION callback; @p userp points to a StreamingSink.
+     */
+    static size_t write(void* contents, size_t size, size_t nmemb, void* userp);
+};
+
+#endif // RESPONSESINK_HPP
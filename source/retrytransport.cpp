@@ -0,0 +1,264 @@
+#include "retrytransport.hpp"
+#include "jsonscan.hpp"
+#include "loadbalancer.hpp"
+#include <random>
+
+namespace {
+/**
+ * @brief Waits for the given delay unless the stop token is triggered first.
+ * @return False if the wait was cut short by cancellation.
+ */
+bool waitFor(std::chrono::milliseconds delay, const std::stop_token& cancellation) {
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait_for(lock, cancellation, delay, [] { return false; });
+    return !cancellation.stop_requested();
+}
+
+/**
+ * @brief Draws a "full jitter" backoff in [0, cap].
+ */
+std::chrono::milliseconds jitter(std::chrono::milliseconds cap) {
+    thread_local std::minstd_rand engine(std::random_device {}());
+    std::uniform_int_distribution<std::int64_t> distribution(0, std::max<std::int64_t>(cap.count(), 0));
+    return std::chrono::milliseconds(distribution(engine));
+}
+
+/**
+ * @brief Checks whether every request of a message (one call or a batch) may be sent twice.
+ */
+bool isIdempotentMessage(std::string_view data) {
+    const std::vector<std::string_view> methods = findMethods(data);
+    return std::all_of(methods.begin(), methods.end(), [](std::string_view method) { return LoadBalancer::isIdempotent(method); });
+}
+}
+
+struct RetryTransport::Call {
+    std::string url;                  ///< Endpoint passed to the inner transport.
+    std::string data;                 ///< The request, resent on every attempt.
+    Callback callback;                ///< The caller's callback.
+    RequestContext* caller = nullptr; ///< The caller's context, if any.
+    RequestContext local;             ///< Context used when the caller passed none.
+    bool idempotent = false;          ///< Whether timeouts and server errors may be retried.
+    RetryCounts retries {};           ///< Retries made so far, per failure kind.
+    std::atomic<bool> waiting {false}; ///< Set during a backoff; whoever clears it continues the call.
+    Scope<std::stop_callback<std::function<void()>>> onCancel; ///< Ends a backoff early on cancellation.
+
+    RequestContext& context() { return caller ? *caller : local; }
+};
+
+RetryTransport::RetryTransport(RetryOptions options, Transport& transport)
+    : options(std::move(options)), transport(transport) {}
+
+RetryTransport::~RetryTransport() = default;
+
+std::optional<std::string> RetryTransport::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool RetryTransport::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                         RequestContext* context) {
+    RequestContext local;
+    RequestContext& attemptContext = context ? *context : local;
+    const bool idempotent = isIdempotentMessage(data);
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    RetryCounts retried {};
+    for (;;) {
+        const bool succeeded = transport.sendPostRequestInto(url, data, response, &attemptContext);
+        const FailureKind kind = classify(succeeded ? std::optional<std::string_view>(response) : std::nullopt, attemptContext);
+        if (kind == FailureKind::None) {
+            if (std::any_of(retried.begin(), retried.end(), [](std::size_t count) { return count > 0; })) {
+                recovered.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        const auto delay = nextDelay(kind, retried, idempotent, attemptContext);
+        if (!delay) {
+            return succeeded;
+        }
+        if (!waitFor(*delay, attemptContext.cancellation)) {
+            attemptContext.failure = FailureKind::Cancelled;
+            return false;
+        }
+    }
+}
+
+bool RetryTransport::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                              RequestContext* context) {
+    RequestContext local;
+    RequestContext& attemptContext = context ? *context : local;
+    const bool idempotent = isIdempotentMessage(data);
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    bool started = false;
+    const ChunkCallback forward = [&onChunk, &started](std::string_view chunk) {
+        started = true;
+        return onChunk(chunk);
+    };
+    RetryCounts retried {};
+    for (;;) {
+        if (transport.sendPostRequestStreaming(url, data, forward, &attemptContext)) {
+            if (std::any_of(retried.begin(), retried.end(), [](std::size_t count) { return count > 0; })) {
+                recovered.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        // Pieces already delivered cannot be taken back, so only an attempt that delivered nothing is retried.
+        const FailureKind kind = classify(std::nullopt, attemptContext);
+        if (started) {
+            failures[static_cast<std::size_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+            if (kind != FailureKind::Cancelled) {
+                notRetried.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        }
+        const auto delay = nextDelay(kind, retried, idempotent, attemptContext);
+        if (!delay) {
+            return false;
+        }
+        if (!waitFor(*delay, attemptContext.cancellation)) {
+            attemptContext.failure = FailureKind::Cancelled;
+            return false;
+        }
+    }
+}
+
+void RetryTransport::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                          RequestContext* context) {
+    auto call = CreateRef<Call>();
+    call->url = url;
+    call->data = data;
+    call->callback = std::move(callback);
+    call->caller = context;
+    call->idempotent = isIdempotentMessage(data);
+    requests.fetch_add(1, std::memory_order_relaxed);
+    attempt(call);
+}
+
+RetryStats RetryTransport::retryStats() const {
+    RetryStats stats;
+    stats.requests = requests.load(std::memory_order_relaxed);
+    stats.retries = retries.load(std::memory_order_relaxed);
+    stats.recovered = recovered.load(std::memory_order_relaxed);
+    stats.exhausted = exhausted.load(std::memory_order_relaxed);
+    stats.notRetried = notRetried.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kFailureKindCount; ++i) {
+        stats.failures[i] = failures[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+FailureKind RetryTransport::classify(const std::optional<std::string_view>& response, const RequestContext& context) const {
+    if (!response) {
+        return context.failure == FailureKind::None ? FailureKind::Other : context.failure;
+    }
+    // Only retryable error codes count; other JSON-RPC errors are ordinary answers (e.g. a revert).
+    const std::optional<int> code = findErrorCode(*response);
+    return code && options.retryableRpcCodes.contains(*code) ? FailureKind::RpcError : FailureKind::None;
+}
+
+const RetryRule* RetryTransport::ruleFor(FailureKind kind, bool idempotent) const {
+    switch (kind) {
+    case FailureKind::Connect:
+        return &options.connect;
+    case FailureKind::RateLimited:
+        return &options.rateLimited;
+    case FailureKind::Timeout:
+        return idempotent ? &options.timeout : nullptr;
+    case FailureKind::Network:
+        return idempotent ? &options.network : nullptr;
+    case FailureKind::ServerError:
+        return idempotent ? &options.serverError : nullptr;
+    case FailureKind::RpcError:
+        return idempotent ? &options.rpcError : nullptr;
+    default:
+        return nullptr;
+    }
+}
+
+std::optional<std::chrono::milliseconds> RetryTransport::nextDelay(FailureKind kind, RetryCounts& retried, bool idempotent,
+                                                                   const RequestContext& context) {
+    failures[static_cast<std::size_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+    if (kind == FailureKind::Cancelled) {
+        return std::nullopt;
+    }
+
+    const RetryRule* rule = ruleFor(kind, idempotent);
+    if (!rule || rule->maxRetries == 0) {
+        notRetried.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    std::size_t& retry = retried[static_cast<std::size_t>(kind)];
+    if (retry >= rule->maxRetries || context.cancellation.stop_requested()
+        || (kind == FailureKind::RateLimited && context.retryAfter > rule->maxDelay)) {
+        exhausted.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    const auto cap = rule->baseDelay * (std::int64_t {1} << std::min<std::size_t>(retry, 30));
+    std::chrono::milliseconds delay = jitter(std::min(cap, rule->maxDelay));
+    if (kind == FailureKind::RateLimited) {
+        delay = std::max(delay, context.retryAfter);
+    }
+    // A retry that could only start after the caller's deadline would be wasted; report the failure now.
+    if (context.deadline != std::chrono::steady_clock::time_point::max()
+        && std::chrono::steady_clock::now() + delay >= context.deadline) {
+        exhausted.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    ++retry;
+    retries.fetch_add(1, std::memory_order_relaxed);
+    return delay;
+}
+
+void RetryTransport::attempt(const Ref<Call>& call) {
+    transport.sendPostRequestAsync(call->url, call->data,
+        [this, call](std::optional<std::string> response) {
+            onAttempt(call, std::move(response));
+        }, &call->context());
+}
+
+void RetryTransport::onAttempt(const Ref<Call>& call, std::optional<std::string> response) {
+    RequestContext& context = call->context();
+    const FailureKind kind = classify(response ? std::optional<std::string_view>(*response) : std::nullopt, context);
+    if (kind == FailureKind::None) {
+        if (std::any_of(call->retries.begin(), call->retries.end(), [](std::size_t count) { return count > 0; })) {
+            recovered.fetch_add(1, std::memory_order_relaxed);
+        }
+        call->callback(std::move(response));
+        return;
+    }
+
+    const auto delay = nextDelay(kind, call->retries, call->idempotent, context);
+    if (!delay) {
+        call->callback(std::move(response));
+        return;
+    }
+
+    call->waiting = true;
+    if (context.cancellation.stop_possible()) {
+        // The call outlives its stop callback, so the raw pointer stays valid while it runs.
+        call->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(context.cancellation,
+            std::function<void()>([raw = call.get()] {
+                if (raw->waiting.exchange(false)) {
+                    raw->context().failure = FailureKind::Cancelled;
+                    raw->callback(std::nullopt);
+                }
+            }));
+    }
+    timers.schedule(std::chrono::steady_clock::now() + *delay, [this, call] {
+        if (!call->waiting.exchange(false)) {
+            return;
+        }
+        call->onCancel.reset();
+        attempt(call);
+    });
+}
@@ -0,0 +1,156 @@
+#ifndef RETRYTRANSPORT_HPP
+#define RETRYTRANSPORT_HPP
+
+#include "common.hpp"
+#include "timerqueue.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct RetryRule
+ * @brief How often, and how patiently, one class of failure is retried.
+ */
+struct RetryRule {
+    std::size_t maxRetries = 0; ///< Retries after the first attempt; 0 disables retrying.
+    std::chrono::milliseconds baseDelay = std::chrono::milliseconds(100); ///< Backoff cap of the first retry; doubles per retry.
+    std::chrono::milliseconds maxDelay = std::chrono::seconds(5); ///< Upper bound of a single backoff.
+};
+
+/**
+ * @struct RetryOptions
+ * @brief Retry rule per failure class.
+ *
+ * Connect failures and rate limiting are retried for every method, since the node
+ * did not process the request. The other classes are retried only for idempotent
+ * methods, so e.g. a timed-out eth_sendRawTransaction is never sent twice.
+ */
+struct RetryOptions {
+    RetryRule connect {3, std::chrono::milliseconds(50), std::chrono::seconds(1)};      ///< DNS, TCP or TLS setup failed.
+    RetryRule rateLimited {3, std::chrono::milliseconds(500), std::chrono::seconds(30)}; ///< HTTP 429; waits at least Retry-After and gives up if that exceeds maxDelay.
+    RetryRule timeout {1, std::chrono::milliseconds(100), std::chrono::seconds(2)};     ///< The transfer timed out.
+    RetryRule network {2, std::chrono::milliseconds(50), std::chrono::seconds(1)};      ///< The connection broke mid-request.
+    RetryRule serverError {2, std::chrono::milliseconds(100), std::chrono::seconds(2)}; ///< HTTP 5xx.
+    RetryRule rpcError {2, std::chrono::milliseconds(100), std::chrono::seconds(2)};    ///< JSON-RPC errors listed in retryableRpcCodes.
+    std::set<int> retryableRpcCodes {-32005, -32603}; ///< JSON-RPC error codes worth retrying ("limit exceeded", "internal error").
+};
+
+/**
+ * @struct RetryStats
+ * @brief Counters showing how often each retry path fires.
+ */
+struct RetryStats {
+    std::uint64_t requests = 0;   ///< Requests sent through the transport.
+    std::uint64_t retries = 0;    ///< Extra attempts made.
+    std::uint64_t recovered = 0;  ///< Requests that succeeded after at least one retry.
+    std::uint64_t exhausted = 0;  ///< Requests that still failed when their retries ran out.
+    std::uint64_t notRetried = 0; ///< Failures returned at once (no rule for the class, or a non-idempotent method).
+    std::array<std::uint64_t, kFailureKindCount> failures {}; ///< Failed attempts, indexed by FailureKind.
+};
+
+/**
+ * @class RetryTransport
+ * @brief Transport decorator that retries failed requests according to their failure class.
+ *
+ * Failures are classified by the inner transport (see FailureKind); JSON-RPC error
+ * responses are classified here by their error code. Each failure class has its own
+ * retry budget, and each retry waits a random "full jitter" backoff between zero and
+ * min(maxDelay, baseDelay * 2^n), where n counts earlier retries of that class, so
+ * clients that failed together do not retry in lockstep.
+ *
+ * Placed in front of a LoadBalancer, every retry is routed afresh: the failed
+ * endpoint has lost score (or tripped its circuit breaker), so the retry usually
+ * lands on a healthy node. Cancellation through the RequestContext also ends a
+ * backoff early, and no retry is attempted whose backoff would end past the
+ * context's deadline.
+ */
+class PROJECT_EXPORT RetryTransport final : public Transport {
+public:
+    /**
+     * @brief Constructs the decorator.
+     * @param options Retry rule per failure class.
+     * @param transport The transport that performs the requests; must outlive this object.
+     */
+    RetryTransport(RetryOptions options, Transport& transport);
+
+    ~RetryTransport() override;
+
+    RetryTransport(const RetryTransport&) = delete;
+    RetryTransport& operator=(const RetryTransport&) = delete;
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestInto
+     *
+     * Blocks through the backoff delays. A JSON-RPC error that is not retried, or
+     * still occurs after the last retry, is returned as a successful response.
+     */
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestStreaming
+     *
+     * A failed attempt is retried only while no piece has reached @p onChunk; once
+     * the body has started the failure is returned. JSON-RPC errors in the body are
+     * not classified, so they are passed on rather than retried.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestAsync
+     *
+     * Backoff delays run on a timer thread. If the caller cancels during a backoff
+     * the callback runs on the cancelling thread.
+     */
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Retrieves the retry counters.
+     */
+    RetryStats retryStats() const;
+
+private:
+    struct Call;
+
+    /**
+     * @brief Retries made for one request, indexed by FailureKind; each kind has its own budget.
+     */
+    using RetryCounts = std::array<std::size_t, kFailureKindCount>;
+
+    /**
+     * @brief Classifies the outcome of one attempt.
+     */
+    FailureKind classify(const std::optional<std::string_view>& response, const RequestContext& context) const;
+
+    /**
+     * @brief Returns the rule for a failure, or nullptr if the failure is never retried for this method.
+     */
+    const RetryRule* ruleFor(FailureKind kind, bool idempotent) const;
+
+    /**
+     * @brief Decides whether to retry and records the failure.
+     * @param retried Retries made so far; the entry of @p kind is incremented when retrying.
+     * @return The backoff before the next attempt, or an empty std::optional to give up.
+     */
+    std::optional<std::chrono::milliseconds> nextDelay(FailureKind kind, RetryCounts& retried, bool idempotent,
+                                                       const RequestContext& context);
+
+    void attempt(const Ref<Call>& call);
+    void onAttempt(const Ref<Call>& call, std::optional<std::string> response);
+
+    RetryOptions options; ///< Retry rule per failure class.
+    Transport& transport; ///< Transport performing the requests.
+
+    std::atomic<std::uint64_t> requests {0};   ///< Requests sent.
+    std::atomic<std::uint64_t> retries {0};    ///< Extra attempts made.
+    std::atomic<std::uint64_t> recovered {0};  ///< Successes after a retry.
+    std::atomic<std::uint64_t> exhausted {0};  ///< Failures after the last retry.
+    std::atomic<std::uint64_t> notRetried {0}; ///< Failures without an applicable rule.
+    std::array<std::atomic<std::uint64_t>, kFailureKindCount> failures {}; ///< Failed attempts by kind.
+
+    TimerQueue timers; ///< Runs async backoffs.
+};
+
+#endif // RETRYTRANSPORT_HPP
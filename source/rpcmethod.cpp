@@ -0,0 +1,121 @@
+#include "rpcmethod.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace {
+/**
+ * @brief Appends a number formatted by std::to_chars.
+ */
+template <typename Number>
+void appendNumber(std::string& out, Number number) {
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    out.append(digits, result.ptr);
+}
+}
+
+void appendJsonString(std::string& out, std::string_view text) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    out.push_back('"');
+    std::size_t clean = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // Runs of plain characters are copied at once.
+        out.append(text.substr(clean, i - clean));
+        clean = i + 1;
+        switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            out.append("\\u00");
+            out.push_back(kHex[c >> 4]);
+            out.push_back(kHex[c & 0xf]);
+        }
+    }
+    out.append(text.substr(clean));
+    out.push_back('"');
+}
+
+void appendJson(std::string& out, const Json::Value& value) {
+    switch (value.type()) {
+    case Json::nullValue:
+        out.append("null");
+        break;
+    case Json::intValue:
+        appendNumber(out, value.asLargestInt());
+        break;
+    case Json::uintValue:
+        appendNumber(out, value.asLargestUInt());
+        break;
+    case Json::realValue: {
+        const double number = value.asDouble();
+        if (std::isfinite(number)) {
+            appendNumber(out, number);
+        } else {
+            out.append("null");
+        }
+        break;
+    }
+    case Json::stringValue: {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        value.getString(&begin, &end);
+        appendJsonString(out, std::string_view(begin, static_cast<std::size_t>(end - begin)));
+        break;
+    }
+    case Json::booleanValue:
+        out.append(value.asBool() ? "true" : "false");
+        break;
+    case Json::arrayValue: {
+        out.push_back('[');
+        for (Json::ArrayIndex i = 0; i < value.size(); ++i) {
+            if (i > 0) {
+                out.push_back(',');
+            }
+            appendJson(out, value[i]);
+        }
+        out.push_back(']');
+        break;
+    }
+    case Json::objectValue: {
+        out.push_back('{');
+        bool first = true;
+        // Members are stored in key order; memberName() reads the key without copying it.
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            if (!first) {
+                out.push_back(',');
+            }
+            first = false;
+            const char* end = nullptr;
+            const char* begin = it.memberName(&end);
+            appendJsonString(out, std::string_view(begin, static_cast<std::size_t>(end - begin)));
+            out.push_back(':');
+            appendJson(out, *it);
+        }
+        out.push_back('}');
+        break;
+    }
+    }
+}
+
+void appendRequest(std::string& out, std::string_view method, const Json::Value& params, std::uint64_t id) {
+    out.append("{\"id\":");
+    appendNumber(out, id);
+    out.append(",\"jsonrpc\":\"2.0\",\"method\":");
+    appendJsonString(out, method);
+    out.append(",\"params\":");
+    if (params.isNull()) {
+        out.append("[]");
+    } else {
+        appendJson(out, params);
+    }
+    out.push_back('}');
+}
@@ -0,0 +1,155 @@
+#ifndef RPCMETHOD_HPP
+#define RPCMETHOD_HPP
+
+#include "common.hpp"
+#include <json/json.h>
+
+/**
+ * @file rpcmethod.hpp
+ * @brief Writes JSON-RPC requests as compact text straight into a caller's buffer.
+ *
+ * Requests are written as {"id":1,"jsonrpc":"2.0","method":...,"params":[...]}
+ * without whitespace and with object members in key order, the layout of
+ * jsoncpp's compact writer. The text is equivalent JSON, not always the same
+ * bytes: non-ASCII characters are kept as UTF-8 where jsoncpp writes unicode
+ * escapes, and doubles are written in their shortest round-trip form. Every
+ * request EthereumClient sends is built here, so transports that rewrite ids
+ * or key on request text still see one form per request.
+ */
+
+/**
+ * @brief Appends a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+ */
+void appendJsonString(std::string& out, std::string_view text);
+
+/**
+ * @brief Appends a JSON value as compact JSON text, without building an intermediate string.
+ *
+ * Object members are written in key order; non-finite numbers are written as null.
+ */
+void appendJson(std::string& out, const Json::Value& value);
+
+/**
+ * @brief Appends a JSON-RPC 2.0 request for a method named at run time.
+ * @param method The RPC method.
+ * @param params The parameters; null is written as an empty array.
+ * @param id The request id.
+ */
+void appendRequest(std::string& out, std::string_view method, const Json::Value& params, std::uint64_t id = 1);
+
+/**
+ * @struct StringParam
+ * @brief Encodes a parameter as a JSON string, e.g. a hash, an address or a block tag.
+ */
+struct StringParam {
+    using Type = std::string_view;
+    static void encode(std::string& out, std::string_view value) { appendJsonString(out, value); }
+};
+
+/**
+ * @struct BoolParam
+ * @brief Encodes a parameter as a JSON boolean.
+ */
+struct BoolParam {
+    using Type = bool;
+    static void encode(std::string& out, bool value) { out.append(value ? "true" : "false"); }
+};
+
+/**
+ * @struct JsonParam
+ * @brief Encodes an arbitrary JSON parameter, e.g. a log filter object.
+ */
+struct JsonParam {
+    using Type = Json::Value;
+    static void encode(std::string& out, const Json::Value& value) { appendJson(out, value); }
+};
+
+/**
+ * @struct CallObjectParam
+ * @brief Encodes the transaction call object of eth_estimateGas.
+ */
+struct CallObjectParam {
+    /**
+     * @brief Fields of the call object.
+     */
+    struct Type {
+        std::string_view from;  ///< Sender address.
+        std::string_view to;    ///< Recipient address.
+        std::string_view value; ///< Value in wei, as a hex quantity.
+    };
+
+    static void encode(std::string& out, const Type& call) {
+        out.append("{\"from\":");
+        appendJsonString(out, call.from);
+        out.append(",\"to\":");
+        appendJsonString(out, call.to);
+        out.append(",\"value\":");
+        appendJsonString(out, call.value);
+        out.push_back('}');
+    }
+};
+
+/**
+ * @struct MethodName
+ * @brief A method name usable as a template argument.
+ */
+template <std::size_t N>
+struct MethodName {
+    consteval MethodName(const char (&text)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            // The name is written into the request verbatim.
+            if (text[i] == '"' || text[i] == '\\' || (i + 1 < N && static_cast<unsigned char>(text[i]) < 0x20)) {
+                throw "RPC method names must not need escaping";
+            }
+            chars[i] = text[i];
+        }
+    }
+
+    char chars[N] {}; ///< The name and its terminating null.
+};
+
+/**
+ * @class RpcMethod
+ * @brief Compile-time descriptor of a JSON-RPC method and its parameter types.
+ *
+ * Everything up to the first parameter is fixed for a method and is encoded
+ * at compile time; encode() appends that prefix and then each parameter through
+ * its encoder, so writing a request into a buffer with enough capacity allocates
+ * nothing. Requests carry id 1, like every single call of EthereumClient.
+ *
+ * @code
+ * inline constexpr RpcMethod<"eth_getBlockByNumber", StringParam, BoolParam> kGetBlockByNumber;
+ * kGetBlockByNumber.encode(buffer, "latest", false);
+ * @endcode
+ */
+template <MethodName Name, typename... Params>
+class RpcMethod {
+    static constexpr std::string_view kHead = "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"";
+    static constexpr std::string_view kTail = "\",\"params\":[";
+
+    static constexpr auto kPrefix = [] {
+        std::array<char, kHead.size() + sizeof(Name.chars) - 1 + kTail.size()> text {};
+        auto it = std::copy(kHead.begin(), kHead.end(), text.begin());
+        it = std::copy(Name.chars, Name.chars + sizeof(Name.chars) - 1, it);
+        std::copy(kTail.begin(), kTail.end(), it);
+        return text;
+    }();
+
+public:
+    static constexpr std::string_view name {Name.chars, sizeof(Name.chars) - 1}; ///< The method, e.g. "eth_blockNumber".
+    static constexpr std::string_view prefix {kPrefix.data(), kPrefix.size()};   ///< The request text before the first parameter.
+
+    /**
+     * @brief Appends a request for this method with the given parameters.
+     */
+    void encode(std::string& out, const typename Params::Type&... params) const {
+        out.append(prefix);
+        if constexpr (sizeof...(Params) > 0) {
+            bool first = true;
+            ((first ? void(first = false) : out.push_back(','), Params::encode(out, params)), ...);
+        }
+        out.append("]}");
+    }
+};
+
+#endif // RPCMETHOD_HPP
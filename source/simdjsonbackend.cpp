@@ -0,0 +1,664 @@
+#include "simdjsonbackend.hpp"
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMDJSON_X86_64 1
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr std::size_t kBlockSize = 64;
+constexpr int kMaxDepth = 1000;                        ///< Nesting limit, as in jsoncpp.
+constexpr std::size_t kMaxPooledOffsets = 4 * 1024 * 1024; ///< Offsets a thread keeps between parses.
+
+/**
+ * @brief Character classes of one 64-byte block, one bit per byte.
+ */
+struct BlockMasks {
+    std::uint64_t quote = 0;      ///< '"'
+    std::uint64_t backslash = 0;  ///< '\\'
+    std::uint64_t op = 0;         ///< '{', '}', '[', ']', ':' and ','
+    std::uint64_t whitespace = 0; ///< ' ', '\t', '\n' and '\r'
+};
+
+/**
+ * @brief Carries escape and string state across blocks and appends the offsets each block contributes.
+ *
+ * Everything here is plain 64-bit arithmetic, shared by every instruction set.
+ */
+class Indexer {
+public:
+    explicit Indexer(std::vector<std::uint32_t>& index) : index(index) {}
+
+    /**
+     * @brief Returns the bits of characters escaped by a backslash, following runs of backslashes across blocks.
+     */
+    std::uint64_t escaped(std::uint64_t backslash) {
+        constexpr std::uint64_t kEvenBits = 0x5555555555555555ULL;
+        backslash &= ~prevEscaped;
+        const std::uint64_t followsEscape = backslash << 1 | prevEscaped;
+        // Adding the starts of runs on odd bits to the runs carries out of each run,
+        // which tells whether the run has odd length, i.e. escapes the next character.
+        const std::uint64_t oddStarts = backslash & ~kEvenBits & ~followsEscape;
+        const std::uint64_t sequencesOnEven = oddStarts + backslash;
+        prevEscaped = sequencesOnEven < oddStarts ? 1 : 0;
+        const std::uint64_t invert = sequencesOnEven << 1;
+        return (kEvenBits ^ invert) & followsEscape;
+    }
+
+    /**
+     * @brief Returns all ones if the previous block ended inside a string.
+     */
+    std::uint64_t stringCarry() const { return prevInString; }
+
+    /**
+     * @brief Appends the offsets of a block's structural characters, string quotes and scalar starts.
+     * @param quotes Unescaped quotes.
+     * @param inside Bits from each opening quote up to, not including, its closing quote.
+     */
+    void add(const BlockMasks& masks, std::uint64_t quotes, std::uint64_t inside, std::uint32_t base) {
+        prevInString = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+        const std::uint64_t stringBytes = inside | quotes;
+        const std::uint64_t scalar = ~(masks.op | masks.whitespace | stringBytes);
+        const std::uint64_t scalarStarts = scalar & ~(scalar << 1 | prevScalar);
+        prevScalar = scalar >> 63;
+        std::uint64_t bits = (masks.op & ~stringBytes) | quotes | scalarStarts;
+
+        if (index.size() < count + kBlockSize) {
+            index.resize(std::max(index.size() * 2, count + kBlockSize + 1024));
+        }
+        std::uint32_t* out = index.data() + count;
+        count += static_cast<std::size_t>(std::popcount(bits));
+        while (bits != 0) {
+            *out++ = base + static_cast<std::uint32_t>(std::countr_zero(bits));
+            bits &= bits - 1;
+        }
+    }
+
+    /**
+     * @brief Number of offsets written; the vector may be larger.
+     */
+    std::size_t size() const { return count; }
+
+private:
+    std::vector<std::uint32_t>& index;
+    std::size_t count = 0;
+    std::uint64_t prevEscaped = 0;
+    std::uint64_t prevInString = 0;
+    std::uint64_t prevScalar = 0;
+};
+
+/**
+ * @brief Computes bit i = XOR of bits 0..i, turning quote positions into string interiors.
+ */
+inline std::uint64_t prefixXor(std::uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/**
+ * @brief Copies the last, partial block into a buffer padded with whitespace.
+ */
+inline void padBlock(std::string_view text, std::size_t offset, char* block) {
+    std::memset(block, ' ', kBlockSize);
+    std::memcpy(block, text.data() + offset, text.size() - offset);
+}
+
+constexpr std::array<std::uint8_t, 256> kCharClasses = [] {
+    std::array<std::uint8_t, 256> classes {};
+    classes['"'] = 1;
+    classes['\\'] = 2;
+    for (const unsigned char c : {'{', '}', '[', ']', ':', ','}) {
+        classes[c] = 4;
+    }
+    for (const unsigned char c : {' ', '\t', '\n', '\r'}) {
+        classes[c] = 8;
+    }
+    return classes;
+}();
+
+BlockMasks classifyScalar(const char* block) {
+    BlockMasks masks;
+    for (std::size_t i = 0; i < kBlockSize; ++i) {
+        const std::uint8_t kind = kCharClasses[static_cast<unsigned char>(block[i])];
+        const std::uint64_t bit = std::uint64_t {1} << i;
+        masks.quote |= (kind & 1) ? bit : 0;
+        masks.backslash |= (kind & 2) ? bit : 0;
+        masks.op |= (kind & 4) ? bit : 0;
+        masks.whitespace |= (kind & 8) ? bit : 0;
+    }
+    return masks;
+}
+
+std::size_t indexScalar(std::string_view text, std::vector<std::uint32_t>& index, bool& inString) {
+    Indexer indexer(index);
+    char padded[kBlockSize];
+    for (std::size_t offset = 0; offset < text.size(); offset += kBlockSize) {
+        const char* block = text.data() + offset;
+        if (text.size() - offset < kBlockSize) {
+            padBlock(text, offset, padded);
+            block = padded;
+        }
+        const BlockMasks masks = classifyScalar(block);
+        const std::uint64_t quotes = masks.quote & ~indexer.escaped(masks.backslash);
+        indexer.add(masks, quotes, prefixXor(quotes) ^ indexer.stringCarry(), static_cast<std::uint32_t>(offset));
+    }
+    inString = indexer.stringCarry() != 0;
+    return indexer.size();
+}
+
+#ifdef SIMDJSON_X86_64
+/**
+ * @brief Prefix XOR as one carry-less multiplication by all ones.
+ */
+__attribute__((target("pclmul,sse2"))) inline std::uint64_t prefixXorClmul(std::uint64_t bits) {
+    const __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)), _mm_set1_epi8(static_cast<char>(0xFF)), 0);
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(product));
+}
+
+__attribute__((target("sse4.2"))) inline BlockMasks classifySse42(const char* block) {
+    const __m128i ops = _mm_setr_epi8('{', '}', '[', ']', ':', ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i spaces = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    constexpr int kMode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    BlockMasks masks;
+    for (int i = 0; i < 4; ++i) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        const int shift = i * 16;
+        // Explicit lengths, so NUL bytes in the text do not end the comparison.
+        masks.op |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_cvtsi128_si32(_mm_cmpestrm(ops, 6, chunk, 16, kMode)))) << shift;
+        masks.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_cvtsi128_si32(_mm_cmpestrm(spaces, 4, chunk, 16, kMode)))) << shift;
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << shift;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << shift;
+    }
+    return masks;
+}
+
+__attribute__((target("sse4.2,pclmul"))) std::size_t indexSse42(std::string_view text, std::vector<std::uint32_t>& index, bool& inString) {
+    Indexer indexer(index);
+    char padded[kBlockSize];
+    for (std::size_t offset = 0; offset < text.size(); offset += kBlockSize) {
+        const char* block = text.data() + offset;
+        if (text.size() - offset < kBlockSize) {
+            padBlock(text, offset, padded);
+            block = padded;
+        }
+        const BlockMasks masks = classifySse42(block);
+        const std::uint64_t quotes = masks.quote & ~indexer.escaped(masks.backslash);
+        indexer.add(masks, quotes, prefixXorClmul(quotes) ^ indexer.stringCarry(), static_cast<std::uint32_t>(offset));
+    }
+    inString = indexer.stringCarry() != 0;
+    return indexer.size();
+}
+
+__attribute__((target("avx2"))) inline std::uint64_t movemask256(__m256i lanes) {
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(lanes));
+}
+
+__attribute__((target("avx2"))) inline BlockMasks classifyAvx2(const char* block) {
+    BlockMasks masks;
+    for (int i = 0; i < 2; ++i) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 32));
+        // '{' | 0x20 == '{' and '[' | 0x20 == '{'; likewise for the closing brackets.
+        const __m256i folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        const __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','))));
+        const __m256i space = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+        const int shift = i * 32;
+        masks.op |= movemask256(op) << shift;
+        masks.whitespace |= movemask256(space) << shift;
+        masks.quote |= movemask256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'))) << shift;
+        masks.backslash |= movemask256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'))) << shift;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2,pclmul"))) std::size_t indexAvx2(std::string_view text, std::vector<std::uint32_t>& index, bool& inString) {
+    Indexer indexer(index);
+    char padded[kBlockSize];
+    for (std::size_t offset = 0; offset < text.size(); offset += kBlockSize) {
+        const char* block = text.data() + offset;
+        if (text.size() - offset < kBlockSize) {
+            padBlock(text, offset, padded);
+            block = padded;
+        }
+        const BlockMasks masks = classifyAvx2(block);
+        const std::uint64_t quotes = masks.quote & ~indexer.escaped(masks.backslash);
+        indexer.add(masks, quotes, prefixXorClmul(quotes) ^ indexer.stringCarry(), static_cast<std::uint32_t>(offset));
+    }
+    inString = indexer.stringCarry() != 0;
+    return indexer.size();
+}
+#endif
+
+/**
+ * @brief Runs the first stage at a level; the vector may end up larger than the returned count.
+ */
+std::size_t indexText(SimdLevel level, std::string_view text, std::vector<std::uint32_t>& index, bool& inString) {
+#ifdef SIMDJSON_X86_64
+    if (level == SimdLevel::Avx2) {
+        return indexAvx2(text, index, inString);
+    }
+    if (level == SimdLevel::Sse42) {
+        return indexSse42(text, index, inString);
+    }
+#endif
+    return indexScalar(text, index, inString);
+}
+
+/**
+ * @brief Second stage: builds a Json::Value by walking the offsets of the first.
+ */
+class TreeBuilder {
+public:
+    TreeBuilder(std::string_view text, const std::uint32_t* index, std::size_t count)
+        : text(text), index(index), count(count) {}
+
+    bool build(Json::Value& root) {
+        if (count == 0) {
+            return fail(text.size(), "Empty document");
+        }
+        if (!parseValue(root, 0)) {
+            return false;
+        }
+        if (next != count) {
+            return fail(index[next], "Unexpected content after the root value");
+        }
+        return true;
+    }
+
+    const std::string& error() const { return message; }
+
+private:
+    bool fail(std::size_t offset, const char* what) {
+        message = "Offset " + std::to_string(offset) + ": " + what;
+        return false;
+    }
+
+    /**
+     * @brief Returns the character at the next offset, or 0 at the end.
+     */
+    char peek() const { return next < count ? text[index[next]] : '\0'; }
+
+    bool parseValue(Json::Value& out, int depth) {
+        if (next >= count) {
+            return fail(text.size(), "Unexpected end of input");
+        }
+        const std::uint32_t pos = index[next++];
+        switch (text[pos]) {
+        case '{':
+            return parseObject(out, pos, depth + 1);
+        case '[':
+            return parseArray(out, pos, depth + 1);
+        case '"': {
+            std::string_view content;
+            if (!readString(pos, content)) {
+                return false;
+            }
+            out = Json::Value(content.data(), content.data() + content.size());
+            return true;
+        }
+        case '}':
+        case ']':
+        case ':':
+        case ',':
+            return fail(pos, "Expected a value");
+        default:
+            return parseScalar(out, pos);
+        }
+    }
+
+    bool parseObject(Json::Value& out, std::uint32_t pos, int depth) {
+        if (depth > kMaxDepth) {
+            return fail(pos, "Nesting too deep");
+        }
+        out = Json::Value(Json::objectValue);
+        if (peek() == '}') {
+            ++next;
+            return true;
+        }
+        while (true) {
+            if (peek() != '"') {
+                return fail(next < count ? index[next] : text.size(), "Expected a member name");
+            }
+            std::string_view key;
+            if (!readString(index[next++], key)) {
+                return false;
+            }
+            if (peek() != ':') {
+                return fail(next < count ? index[next] : text.size(), "Expected ':' after a member name");
+            }
+            ++next;
+            // The key may live in the scratch buffer, which the value may reuse; insert it first.
+            Json::Value* slot = out.demand(key.data(), key.data() + key.size());
+            if (!parseValue(*slot, depth)) {
+                return false;
+            }
+            const char separator = peek();
+            ++next;
+            if (separator == '}') {
+                return true;
+            }
+            if (separator != ',') {
+                return fail(next <= count ? index[next - 1] : text.size(), "Expected ',' or '}'");
+            }
+        }
+    }
+
+    bool parseArray(Json::Value& out, std::uint32_t pos, int depth) {
+        if (depth > kMaxDepth) {
+            return fail(pos, "Nesting too deep");
+        }
+        out = Json::Value(Json::arrayValue);
+        if (peek() == ']') {
+            ++next;
+            return true;
+        }
+        while (true) {
+            if (!parseValue(out.append(Json::Value()), depth)) {
+                return false;
+            }
+            const char separator = peek();
+            ++next;
+            if (separator == ']') {
+                return true;
+            }
+            if (separator != ',') {
+                return fail(next <= count ? index[next - 1] : text.size(), "Expected ',' or ']'");
+            }
+        }
+    }
+
+    /**
+     * @brief Reads the string opened at @p open; the closing quote is the next offset.
+     * @param content Receives the unescaped text, pointing into the input unless it had escapes.
+     */
+    bool readString(std::uint32_t open, std::string_view& content) {
+        if (next >= count) {
+            return fail(open, "Unterminated string");
+        }
+        const std::uint32_t close = index[next++];
+        const std::string_view raw = text.substr(open + 1, close - open - 1);
+        const void* escape = std::memchr(raw.data(), '\\', raw.size());
+        if (!escape) {
+            content = raw;
+            return true;
+        }
+
+        scratch.clear();
+        std::size_t i = static_cast<std::size_t>(static_cast<const char*>(escape) - raw.data());
+        scratch.append(raw.data(), i);
+        while (i < raw.size()) {
+            if (raw[i] != '\\') {
+                const std::size_t stop = std::min(raw.find('\\', i), raw.size());
+                scratch.append(raw.substr(i, stop - i));
+                i = stop;
+                continue;
+            }
+            if (++i >= raw.size()) {
+                return fail(open + 1 + i, "Unterminated escape");
+            }
+            const char c = raw[i++];
+            switch (c) {
+            case '"': scratch.push_back('"'); break;
+            case '\\': scratch.push_back('\\'); break;
+            case '/': scratch.push_back('/'); break;
+            case 'b': scratch.push_back('\b'); break;
+            case 'f': scratch.push_back('\f'); break;
+            case 'n': scratch.push_back('\n'); break;
+            case 'r': scratch.push_back('\r'); break;
+            case 't': scratch.push_back('\t'); break;
+            case 'u': {
+                std::uint32_t codePoint = 0;
+                if (!readHex(raw, i, codePoint)) {
+                    return fail(open + 1 + i, "Bad unicode escape");
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    std::uint32_t low = 0;
+                    if (i + 1 >= raw.size() || raw[i] != '\\' || raw[i + 1] != 'u') {
+                        return fail(open + 1 + i, "Missing the second half of a surrogate pair");
+                    }
+                    i += 2;
+                    if (!readHex(raw, i, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return fail(open + 1 + i, "Bad surrogate pair");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(codePoint);
+                break;
+            }
+            default:
+                return fail(open + i, "Bad escape");
+            }
+        }
+        content = scratch;
+        return true;
+    }
+
+    static bool readHex(std::string_view raw, std::size_t& i, std::uint32_t& value) {
+        if (raw.size() - i < 4) {
+            return false;
+        }
+        const auto result = std::from_chars(raw.data() + i, raw.data() + i + 4, value, 16);
+        if (result.ptr != raw.data() + i + 4) {
+            return false;
+        }
+        i += 4;
+        return true;
+    }
+
+    void appendUtf8(std::uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            scratch.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            scratch.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            scratch.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            scratch.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    /**
+     * @brief Parses true, false, null or a number; the scalar runs up to the next offset, minus whitespace.
+     */
+    bool parseScalar(Json::Value& out, std::uint32_t pos) {
+        std::size_t end = next < count ? index[next] : text.size();
+        while (end > pos && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\n' || text[end - 1] == '\r')) {
+            --end;
+        }
+        const std::string_view scalar = text.substr(pos, end - pos);
+        if (scalar == "true") {
+            out = true;
+            return true;
+        }
+        if (scalar == "false") {
+            out = false;
+            return true;
+        }
+        if (scalar == "null") {
+            out = Json::Value();
+            return true;
+        }
+        return parseNumber(out, pos, scalar);
+    }
+
+    bool parseNumber(Json::Value& out, std::uint32_t pos, std::string_view number) {
+        // JSON grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        std::size_t i = 0;
+        const auto digits = [&] {
+            const std::size_t start = i;
+            while (i < number.size() && number[i] >= '0' && number[i] <= '9') {
+                ++i;
+            }
+            return i - start;
+        };
+        const bool negative = i < number.size() && number[i] == '-';
+        i += negative ? 1 : 0;
+        const std::size_t intStart = i;
+        const std::size_t intDigits = digits();
+        if (intDigits == 0 || (intDigits > 1 && number[intStart] == '0')) {
+            return fail(pos, "Invalid value");
+        }
+        bool integral = true;
+        if (i < number.size() && number[i] == '.') {
+            ++i;
+            integral = false;
+            if (digits() == 0) {
+                return fail(pos, "Invalid number");
+            }
+        }
+        if (i < number.size() && (number[i] == 'e' || number[i] == 'E')) {
+            ++i;
+            integral = false;
+            if (i < number.size() && (number[i] == '+' || number[i] == '-')) {
+                ++i;
+            }
+            if (digits() == 0) {
+                return fail(pos, "Invalid number");
+            }
+        }
+        if (i != number.size()) {
+            return fail(pos, "Invalid value");
+        }
+
+        const char* first = number.data();
+        const char* last = number.data() + number.size();
+        if (integral) {
+            // Like jsoncpp: signed when it fits, unsigned above INT64_MAX, double beyond.
+            if (negative) {
+                std::int64_t value = 0;
+                if (std::from_chars(first, last, value).ec == std::errc()) {
+                    out = Json::Value(static_cast<Json::Int64>(value));
+                    return true;
+                }
+            } else {
+                std::uint64_t value = 0;
+                if (std::from_chars(first, last, value).ec == std::errc()) {
+                    out = value <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())
+                        ? Json::Value(static_cast<Json::Int64>(value)) : Json::Value(static_cast<Json::UInt64>(value));
+                    return true;
+                }
+            }
+        }
+        double value = 0;
+        if (std::from_chars(first, last, value).ec != std::errc()) {
+            return fail(pos, "Number out of range");
+        }
+        out = value;
+        return true;
+    }
+
+    std::string_view text;
+    const std::uint32_t* index;
+    std::size_t count;
+    std::size_t next = 0;   ///< Next offset to consume.
+    std::string scratch;    ///< Unescaped text of the last escaped string.
+    std::string message;    ///< Why parsing failed.
+};
+
+/**
+ * @brief Returns this thread's offset buffer, kept between parses.
+ */
+std::vector<std::uint32_t>& threadIndex() {
+    thread_local std::vector<std::uint32_t> index;
+    return index;
+}
+}
+
+std::string_view simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Sse42: return "sse4.2";
+    case SimdLevel::Scalar: break;
+    }
+    return "scalar";
+}
+
+SimdJsonBackend::SimdJsonBackend()
+    : simdLevel(detectLevel()) {}
+
+SimdJsonBackend::SimdJsonBackend(SimdLevel level)
+    : simdLevel(std::min(level, detectLevel())) {}
+
+SimdLevel SimdJsonBackend::detectLevel() {
+#ifdef SIMDJSON_X86_64
+    static const SimdLevel detected = [] {
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("pclmul")) {
+            return SimdLevel::Scalar;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::Avx2;
+        }
+        return __builtin_cpu_supports("sse4.2") ? SimdLevel::Sse42 : SimdLevel::Scalar;
+    }();
+    return detected;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel SimdJsonBackend::level() const {
+    return simdLevel;
+}
+
+std::string SimdJsonBackend::name() const {
+    return "simd-" + std::string(simdLevelName(simdLevel));
+}
+
+bool SimdJsonBackend::buildIndex(std::string_view text, std::vector<std::uint32_t>& index) const {
+    if (text.size() > std::numeric_limits<std::uint32_t>::max()) {
+        index.clear();
+        return false;
+    }
+    bool inString = false;
+    index.resize(indexText(simdLevel, text, index, inString));
+    return !inString;
+}
+
+bool SimdJsonBackend::parse(std::string_view text, Json::Value& value, std::string* errors) {
+    if (text.size() > std::numeric_limits<std::uint32_t>::max()) {
+        if (errors) {
+            *errors = "Document larger than 4 GiB";
+        }
+        return false;
+    }
+
+    std::vector<std::uint32_t>& index = threadIndex();
+    bool inString = false;
+    const std::size_t count = indexText(simdLevel, text, index, inString);
+    TreeBuilder builder(text, index.data(), count);
+    bool parsed = false;
+    if (inString) {
+        if (errors) {
+            *errors = "Unterminated string";
+        }
+    } else if (builder.build(value)) {
+        parsed = true;
+    } else if (errors) {
+        *errors = builder.error();
+    }
+
+    if (index.size() > kMaxPooledOffsets) {
+        std::vector<std::uint32_t>().swap(index);
+    }
+    return parsed;
+}
@@ -0,0 +1,80 @@
+#ifndef SIMDJSONBACKEND_HPP
+#define SIMDJSONBACKEND_HPP
+
+#include "common.hpp"
+#include "jsonbackend.hpp"
+
+/**
+ * @enum SimdLevel
+ * @brief Instruction sets the structural indexer of SimdJsonBackend can use.
+ */
+enum class SimdLevel {
+    Scalar, ///< Portable code, one byte at a time.
+    Sse42,  ///< SSE4.2 string compares and carry-less multiplication, 16 bytes at a time.
+    Avx2    ///< AVX2 compares and carry-less multiplication, 32 bytes at a time.
+};
+
+/**
+ * @brief Retrieves the name of a SIMD level, e.g. "avx2".
+ */
+std::string_view simdLevelName(SimdLevel level);
+
+/**
+ * @class SimdJsonBackend
+ * @brief JSON parser that finds the structure of a text with SIMD instructions before building the tree.
+ *
+ * Parsing runs in two stages. The first classifies the text 64 bytes at a time
+ * into bit masks of quotes, backslashes, operators and whitespace, resolves
+ * escapes and string boundaries with bit arithmetic, and records the offset of
+ * every structural character and the start of every scalar. No byte is looked
+ * at one by one unless the CPU supports neither AVX2 nor SSE4.2. The second
+ * stage walks the offsets to build the Json::Value, copying unescaped strings
+ * and keys in one piece.
+ *
+ * The instruction set is picked at run time from what the CPU supports; the
+ * scalar path keeps the backend usable everywhere. Produces the same values as
+ * jsoncpp for valid JSON, and rejects trailing content after the root value.
+ */
+class PROJECT_EXPORT SimdJsonBackend final : public JsonBackend {
+public:
+    /**
+     * @brief Constructs a backend using the best level the CPU supports.
+     */
+    SimdJsonBackend();
+
+    /**
+     * @brief Constructs a backend capped at a level, e.g. to compare levels in a benchmark.
+     * @param level The highest level to use; lowered to what the CPU supports.
+     */
+    explicit SimdJsonBackend(SimdLevel level);
+
+    /**
+     * @brief Retrieves the best level the running CPU supports.
+     */
+    static SimdLevel detectLevel();
+
+    /**
+     * @brief Retrieves the level this backend uses.
+     */
+    SimdLevel level() const;
+
+    bool parse(std::string_view text, Json::Value& value, std::string* errors) override;
+
+    /**
+     * @brief Returns "simd-" followed by the level name, e.g. "simd-avx2".
+     */
+    std::string name() const override;
+
+    /**
+     * @brief Runs only the first stage: records the offsets of structural characters and scalar starts.
+     * @param text The JSON text.
+     * @param index Receives the offsets in ascending order; string quotes are recorded in open/close pairs.
+     * @return False if the text ends inside a string.
+     */
+    bool buildIndex(std::string_view text, std::vector<std::uint32_t>& index) const;
+
+private:
+    SimdLevel simdLevel; ///< Level of the first stage.
+};
+
+#endif // SIMDJSONBACKEND_HPP
@@ -0,0 +1,277 @@
+#include "singleflighttransport.hpp"
+#include "loadbalancer.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+}
+
+struct SingleFlightTransport::Waiter {
+    std::string url;                  ///< Endpoint of the call.
+    std::string data;                 ///< The request as the caller wrote it.
+    std::string key;                  ///< Deduplication key.
+    Callback callback;                ///< The caller's callback.
+    RequestContext* caller = nullptr; ///< The caller's context, if any.
+    Clock::time_point deadline = Clock::time_point::max(); ///< The caller's deadline, copied since the caller may leave first.
+    std::chrono::milliseconds connectTimeout {0};           ///< The caller's connect budget.
+    std::stop_token cancellation;     ///< The caller's stop token.
+    Ref<Flight> flight;               ///< The flight the call waits for; guarded by the transport's mutex.
+    std::atomic<bool> done {false};   ///< Set by whichever of answer, deadline and cancellation completes the call first.
+    TimerQueue::Timer deadlineTimer;  ///< Expires the call; set before the call can complete any other way.
+    Scope<std::stop_callback<std::function<void()>>> onCancel; ///< Completes the call on cancellation; destroyed first.
+
+    /**
+     * @brief Completes the call unless it has already been completed, and cancels its deadline timer.
+     * @return True if this completion was the one delivered.
+     */
+    bool complete(std::optional<std::string> response, FailureKind failure, long httpStatus, TransferCounters counters) {
+        if (done.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        deadlineTimer.cancel();
+        finish(std::move(response), failure, httpStatus, counters);
+        return true;
+    }
+
+    /**
+     * @brief Completes the call from its deadline timer unless it has already been completed.
+     * @return True if this completion was the one delivered.
+     */
+    bool expire() {
+        if (done.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        finish(std::nullopt, FailureKind::Timeout, 0, {});
+        return true;
+    }
+
+private:
+    /**
+     * @brief Reports the outcome to the caller's context and callback.
+     */
+    void finish(std::optional<std::string> response, FailureKind failure, long httpStatus, TransferCounters counters) {
+        if (caller) {
+            caller->failure = response ? FailureKind::None : (failure == FailureKind::None ? FailureKind::Other : failure);
+            caller->httpStatus = httpStatus;
+            caller->counters = counters;
+        }
+        callback(std::move(response));
+    }
+};
+
+struct SingleFlightTransport::Flight {
+    std::string key;                   ///< The flight's entry in the flight map.
+    std::string url;                   ///< Endpoint of the request.
+    std::string data;                  ///< The request as its first caller wrote it.
+    std::vector<Ref<Waiter>> waiters;  ///< Callers waiting for the response; guarded by the transport's mutex.
+    std::size_t live = 0;              ///< Waiters that have not given up; guarded by the transport's mutex.
+    RequestContext context;            ///< Context of the request, bounded by its first caller's deadline.
+    std::stop_source stop;             ///< Aborts the request once every waiter has given up.
+};
+
+SingleFlightTransport::SingleFlightTransport(Transport& transport)
+    : transport(transport) {}
+
+SingleFlightTransport::~SingleFlightTransport() = default;
+
+std::optional<std::string> SingleFlightTransport::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool SingleFlightTransport::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                                RequestContext* context) {
+    std::string key = keyOf(url, data);
+    if (key.empty()) {
+        return transport.sendPostRequestInto(url, data, response, context);
+    }
+
+    std::promise<std::optional<std::string>> result;
+    std::future<std::optional<std::string>> answer = result.get_future();
+    submit(url, data, std::move(key), [&result](std::optional<std::string> body) {
+        result.set_value(std::move(body));
+    }, context);
+    std::optional<std::string> body = answer.get();
+    if (!body) {
+        return false;
+    }
+    response = std::move(*body);
+    return true;
+}
+
+bool SingleFlightTransport::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                                     RequestContext* context) {
+    return transport.sendPostRequestStreaming(url, data, onChunk, context);
+}
+
+void SingleFlightTransport::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                                 RequestContext* context) {
+    std::string key = keyOf(url, data);
+    if (key.empty()) {
+        transport.sendPostRequestAsync(url, data, std::move(callback), context);
+        return;
+    }
+    submit(url, data, std::move(key), std::move(callback), context);
+}
+
+SingleFlightStats SingleFlightTransport::stats() const {
+    SingleFlightStats stats;
+    stats.calls = calls.load(std::memory_order_relaxed);
+    stats.requests = requests.load(std::memory_order_relaxed);
+    stats.collapsed = collapsed.load(std::memory_order_relaxed);
+    stats.rejoined = rejoined.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string SingleFlightTransport::keyOf(const std::string& url, std::string_view data) {
+    const std::vector<JsonSpan> ids = findIdSpans(data);
+    const std::size_t start = data.find_first_not_of(" \t\r\n");
+    if (ids.size() != 1 || start == std::string_view::npos || data[start] != '{') {
+        return {};
+    }
+    const std::string_view method = findMethod(data);
+    if (method.empty() || !LoadBalancer::isIdempotent(method)) {
+        return {};
+    }
+
+    std::string key;
+    key.reserve(url.size() + 1 + data.size());
+    key.append(url).push_back('\n');
+    key.append(data.substr(0, ids.front().begin)).append(data.substr(ids.front().end));
+    return key;
+}
+
+void SingleFlightTransport::submit(const std::string& url, const std::string& data, std::string key, Callback callback,
+                                   RequestContext* context) {
+    if (context) {
+        context->failure = FailureKind::None;
+        if (context->cancellation.stop_requested() || context->deadline <= Clock::now()) {
+            context->failure = context->cancellation.stop_requested() ? FailureKind::Cancelled : FailureKind::Timeout;
+            callback(std::nullopt);
+            return;
+        }
+    }
+    calls.fetch_add(1, std::memory_order_relaxed);
+
+    auto waiter = CreateRef<Waiter>();
+    waiter->url = url;
+    waiter->data = data;
+    waiter->key = std::move(key);
+    waiter->callback = std::move(callback);
+    waiter->caller = context;
+    if (context) {
+        waiter->deadline = context->deadline;
+        waiter->connectTimeout = context->connectTimeout;
+        waiter->cancellation = context->cancellation;
+    }
+
+    if (waiter->deadline != Clock::time_point::max()) {
+        // Armed before the waiter joins a flight, which may land at once; every other completion cancels the timer,
+        // so finished calls do not pile up in the queue until their deadline.
+        waiter->deadlineTimer = timers.schedule(waiter->deadline, [this, weak = std::weak_ptr<Waiter>(waiter)] {
+            Ref<Waiter> expired = weak.lock();
+            if (expired && expired->expire()) {
+                abandon(*expired);
+            }
+        });
+    }
+    if (waiter->cancellation.stop_possible()) {
+        // The waiter outlives its stop callback, so the raw pointer stays valid while it runs.
+        waiter->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(waiter->cancellation,
+            std::function<void()>([this, raw = waiter.get()] {
+                if (raw->complete(std::nullopt, FailureKind::Cancelled, 0, {})) {
+                    abandon(*raw);
+                }
+            }));
+    }
+    attach(waiter);
+}
+
+void SingleFlightTransport::attach(const Ref<Waiter>& waiter, bool rejoining) {
+    Ref<Flight> started;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (waiter->done.load(std::memory_order_acquire)) {
+            return;
+        }
+        Ref<Flight>& flight = flights[waiter->key];
+        if (flight && !rejoining) {
+            collapsed.fetch_add(1, std::memory_order_relaxed);
+        } else if (!flight) {
+            flight = CreateRef<Flight>();
+            flight->key = waiter->key;
+            flight->url = waiter->url;
+            flight->data = waiter->data;
+            started = flight;
+        }
+        flight->waiters.push_back(waiter);
+        ++flight->live;
+        waiter->flight = flight;
+    }
+    if (!started) {
+        return;
+    }
+
+    requests.fetch_add(1, std::memory_order_relaxed);
+    started->context.deadline = waiter->deadline;
+    started->context.connectTimeout = waiter->connectTimeout;
+    started->context.cancellation = started->stop.get_token();
+    transport.sendPostRequestAsync(started->url, started->data, [this, started](std::optional<std::string> response) {
+        land(started, std::move(response));
+    }, &started->context);
+}
+
+void SingleFlightTransport::abandon(Waiter& waiter) {
+    Ref<Flight> aborted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Ref<Flight> flight = std::move(waiter.flight);
+        if (!flight || --flight->live > 0) {
+            return;
+        }
+        auto it = flights.find(flight->key);
+        if (it != flights.end() && it->second == flight) {
+            flights.erase(it);
+        }
+        aborted = std::move(flight);
+    }
+    // Nobody waits for the response any more; free the connection.
+    aborted->stop.request_stop();
+}
+
+void SingleFlightTransport::land(const Ref<Flight>& flight, std::optional<std::string> response) {
+    std::vector<Ref<Waiter>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = flights.find(flight->key);
+        if (it != flights.end() && it->second == flight) {
+            flights.erase(it);
+        }
+        waiters.swap(flight->waiters);
+        for (const Ref<Waiter>& waiter : waiters) {
+            waiter->flight.reset();
+        }
+    }
+
+    const RequestContext& context = flight->context;
+    const auto now = Clock::now();
+    bool transferred = false;
+    for (std::size_t i = 0; i < waiters.size(); ++i) {
+        const Ref<Waiter>& waiter = waiters[i];
+        if (response) {
+            // The wire bytes are counted once; the other callers received the body without a transfer.
+            const TransferCounters counters = transferred ? TransferCounters {0, response->size()} : context.counters;
+            std::optional<std::string> body = i + 1 == waiters.size() ? std::move(response) : response;
+            transferred |= waiter->complete(std::move(body), FailureKind::None, context.httpStatus, counters);
+        } else if (context.failure == FailureKind::Timeout && !waiter->done.load(std::memory_order_acquire)
+                   && waiter->deadline > now && !waiter->cancellation.stop_requested()) {
+            // The flight ran out of its first caller's budget; this caller has time left.
+            rejoined.fetch_add(1, std::memory_order_relaxed);
+            attach(waiter, true);
+        } else {
+            waiter->complete(std::nullopt, context.failure, context.httpStatus, {});
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef SINGLEFLIGHTTRANSPORT_HPP
+#define SINGLEFLIGHTTRANSPORT_HPP
+
+#include "common.hpp"
+#include "jsonscan.hpp"
+#include "timerqueue.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct SingleFlightStats
+ * @brief Counters showing how many calls were served by another caller's request.
+ */
+struct SingleFlightStats {
+    std::uint64_t calls = 0;     ///< Calls eligible for deduplication.
+    std::uint64_t requests = 0;  ///< Requests actually sent for them.
+    std::uint64_t collapsed = 0; ///< Calls that joined an identical request already in flight.
+    std::uint64_t rejoined = 0;  ///< Calls that outlived the budget of the request they joined and were sent again.
+};
+
+/**
+ * @class SingleFlightTransport
+ * @brief Transport decorator that sends identical concurrent calls to the node only once.
+ *
+ * Calls are identical when they go to the same URL with the same request text
+ * apart from the id, i.e. the same method and parameters; EthereumClient writes
+ * parameters canonically (object members sorted, fixed formatting). While one
+ * such request is in flight, further identical calls wait for it instead of
+ * sending their own, and every caller receives the shared response, e.g. all
+ * workers calling getBlockByNumber("latest", true) when a new head arrives.
+ *
+ * Each caller keeps its own deadline and cancellation. The shared request is
+ * bounded by the deadline of the call that started it, and is aborted only
+ * once every caller waiting for it has given up. Callers with budget left when
+ * it times out are sent again, together.
+ *
+ * Only idempotent methods are deduplicated (see LoadBalancer::isIdempotent), so
+ * two eth_sendRawTransaction calls are both sent. Batches pass through.
+ */
+class PROJECT_EXPORT SingleFlightTransport final : public Transport {
+public:
+    /**
+     * @brief Constructs the decorator.
+     * @param transport Sends the requests; must outlive this object.
+     */
+    explicit SingleFlightTransport(Transport& transport);
+
+    /**
+     * @brief Stops the deadline timer; requests in flight must have completed.
+     */
+    ~SingleFlightTransport() override;
+
+    SingleFlightTransport(const SingleFlightTransport&) = delete;
+    SingleFlightTransport& operator=(const SingleFlightTransport&) = delete;
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestStreaming
+     *
+     * Never coalesced, since one stream cannot feed several consumers; sent as is
+     * through the inner transport.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+    /**
+     * @brief Retrieves the deduplication counters.
+     */
+    SingleFlightStats stats() const;
+
+private:
+    struct Waiter;
+    struct Flight;
+
+    /**
+     * @brief Builds the deduplication key of a request, or returns an empty string if it may not be shared.
+     */
+    static std::string keyOf(const std::string& url, std::string_view data);
+
+    /**
+     * @brief Registers a caller's deadline and cancellation and attaches it to a flight.
+     */
+    void submit(const std::string& url, const std::string& data, std::string key, Callback callback, RequestContext* context);
+
+    /**
+     * @brief Attaches a waiter to the flight of its key, starting the flight if there is none.
+     * @param rejoining Whether the waiter's previous flight timed out; it then counts as rejoined, not collapsed.
+     */
+    void attach(const Ref<Waiter>& waiter, bool rejoining = false);
+
+    /**
+     * @brief Detaches a waiter that gave up, aborting its flight if no other waiter is left.
+     */
+    void abandon(Waiter& waiter);
+
+    /**
+     * @brief Hands a flight's response to its waiters, re-attaching those it timed out too early for.
+     */
+    void land(const Ref<Flight>& flight, std::optional<std::string> response);
+
+    Transport& transport; ///< Sends the requests.
+    std::mutex mutex;     ///< Guards the flight map and the waiters of every flight.
+    std::unordered_map<std::string, Ref<Flight>> flights; ///< Requests in flight keyed by URL and request text without id.
+    std::atomic<std::uint64_t> calls {0};     ///< Eligible calls.
+    std::atomic<std::uint64_t> requests {0};  ///< Requests sent.
+    std::atomic<std::uint64_t> collapsed {0}; ///< Calls that joined a flight.
+    std::atomic<std::uint64_t> rejoined {0};  ///< Calls re-attached after their flight timed out.
+    TimerQueue timers; ///< Expires waiters' deadlines; stopped first on destruction.
+};
+
+#endif // SINGLEFLIGHTTRANSPORT_HPP
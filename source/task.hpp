@@ -0,0 +1,211 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include "common.hpp"
+#include <coroutine>
+
+template<typename T>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief Promise state shared by every Task specialization.
+ *
+ * Tasks are lazy: the coroutine body starts when the task is awaited, and on
+ * completion control transfers symmetrically to the awaiting coroutine.
+ */
+class TaskPromiseBase {
+public:
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+    std::coroutine_handle<> continuation; ///< Coroutine resumed when this task completes.
+    std::exception_ptr exception;         ///< Exception escaping the coroutine body, if any.
+};
+
+template<typename T>
+class TaskPromise final : public TaskPromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+    T takeResult() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+
+private:
+    std::optional<T> value; ///< Value produced by co_return.
+};
+
+template<>
+class TaskPromise<void> final : public TaskPromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void takeResult() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @class Task
+ * @brief A lazily started, awaitable coroutine result.
+ * @tparam T The type produced by co_return (may be void).
+ *
+ * A Task owns its coroutine frame. Awaiting it from another coroutine starts the
+ * body; use syncWait() to drive a task from ordinary code.
+ */
+template<typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(Handle handle) noexcept : handle(handle) {}
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * @brief Starts the task and suspends the caller until it completes.
+     */
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            Handle handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().takeResult(); }
+        };
+        return Awaiter {handle};
+    }
+
+private:
+    Handle handle;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T> {std::coroutine_handle<TaskPromise<T>>::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void> {std::coroutine_handle<TaskPromise<void>>::from_promise(*this)};
+}
+
+/**
+ * @brief Eagerly started, self-destroying coroutine used to drive syncWait().
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+template<typename T>
+struct SyncWaitState {
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    std::optional<std::conditional_t<std::is_void_v<T>, std::monostate, T>> value;
+    std::exception_ptr exception;
+};
+
+template<typename T>
+DetachedTask runAndSignal(Task<T>& task, SyncWaitState<T>& state) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            state.value.emplace();
+        } else {
+            state.value.emplace(co_await task);
+        }
+    } catch (...) {
+        state.exception = std::current_exception();
+    }
+
+    // Notify under the lock: once syncWait() sees done it returns and destroys state.
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done = true;
+    state.finished.notify_one();
+}
+
+} // namespace detail
+
+/**
+ * @brief Runs a task to completion, blocking the calling thread.
+ * @param task The task to run.
+ * @return The value produced by the task; exceptions are rethrown.
+ */
+template<typename T>
+T syncWait(Task<T> task) {
+    detail::SyncWaitState<T> state;
+    detail::runAndSignal(task, state);
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&]() { return state.done; });
+
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*state.value);
+    }
+}
+
+#endif // TASK_HPP
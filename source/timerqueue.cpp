@@ -0,0 +1,74 @@
+#include "timerqueue.hpp"
+
+void TimerQueue::Timer::cancel() {
+    const Ref<State> queue = state.lock();
+    if (!queue || id == 0) {
+        return;
+    }
+    // The task's captures are released after the lock, in case releasing them touches the queue.
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        const auto [first, last] = queue->tasks.equal_range(when);
+        for (auto it = first; it != last; ++it) {
+            if (it->second.first == id) {
+                task = std::move(it->second.second);
+                queue->tasks.erase(it);
+                break;
+            }
+        }
+    }
+    id = 0;
+}
+
+TimerQueue::TimerQueue()
+    : state(CreateRef<State>()) {}
+
+TimerQueue::~TimerQueue() {
+    // Handles may keep the state alive, so the dropped tasks are released here rather than with it.
+    std::multimap<std::chrono::steady_clock::time_point, std::pair<std::uint64_t, std::function<void()>>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->stopping = true;
+        dropped.swap(state->tasks);
+    }
+    state->wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+TimerQueue::Timer TimerQueue::schedule(std::chrono::steady_clock::time_point when, std::function<void()> task) {
+    Timer timer;
+    timer.state = state;
+    timer.when = when;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!worker.joinable()) {
+        worker = std::thread(&TimerQueue::run, this);
+    }
+    timer.id = state->nextId++;
+    state->tasks.emplace(when, std::make_pair(timer.id, std::move(task)));
+    state->wake.notify_one();
+    return timer;
+}
+
+void TimerQueue::run() {
+    State& queue = *state;
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    while (!queue.stopping) {
+        if (queue.tasks.empty()) {
+            queue.wake.wait(lock);
+            continue;
+        }
+        const auto next = queue.tasks.begin();
+        if (next->first > std::chrono::steady_clock::now()) {
+            queue.wake.wait_until(lock, next->first);
+            continue;
+        }
+        std::function<void()> task = std::move(next->second.second);
+        queue.tasks.erase(next);
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
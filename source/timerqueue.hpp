@@ -0,0 +1,75 @@
+#ifndef TIMERQUEUE_HPP
+#define TIMERQUEUE_HPP
+
+#include "common.hpp"
+
+/**
+ * @class TimerQueue
+ * @brief Runs delayed tasks on one background thread.
+ *
+ * The thread is started on the first schedule() call, so owners that never need
+ * a timer pay nothing. Tasks run in deadline order and must not block; tasks still
+ * pending when the queue is destroyed are dropped without running.
+ */
+class PROJECT_EXPORT TimerQueue {
+    struct State;
+
+public:
+    /**
+     * @class Timer
+     * @brief Handle of a scheduled task, used to cancel it before it runs.
+     *
+     * A handle may outlive its queue; cancelling it then does nothing.
+     */
+    class PROJECT_EXPORT Timer {
+    public:
+        Timer() = default;
+
+        /**
+         * @brief Removes the task from its queue unless it has already run or been cancelled.
+         */
+        void cancel();
+
+    private:
+        friend class TimerQueue;
+
+        std::weak_ptr<State> state;             ///< The queue's tasks; expired once the queue is destroyed.
+        std::chrono::steady_clock::time_point when; ///< The task's deadline, to find it among the pending tasks.
+        std::uint64_t id = 0;                   ///< Tells the task apart from others with the same deadline; 0 for no task.
+    };
+
+    TimerQueue();
+
+    /**
+     * @brief Stops the timer thread, dropping pending tasks.
+     */
+    ~TimerQueue();
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    /**
+     * @brief Runs a task at (or shortly after) the given time.
+     * @return Handle to cancel the task; owners of many short-lived timers cancel them so they do not pile up.
+     */
+    Timer schedule(std::chrono::steady_clock::time_point when, std::function<void()> task);
+
+private:
+    /**
+     * @brief The pending tasks, shared with the Timer handles.
+     */
+    struct State {
+        std::mutex mutex; ///< Guards the state below.
+        std::condition_variable wake; ///< Signals new tasks and shutdown.
+        std::multimap<std::chrono::steady_clock::time_point, std::pair<std::uint64_t, std::function<void()>>> tasks; ///< Pending tasks and their ids by deadline.
+        std::uint64_t nextId = 1; ///< Id of the next scheduled task.
+        bool stopping = false; ///< Set when the queue is being destroyed.
+    };
+
+    void run();
+
+    Ref<State> state; ///< Pending tasks.
+    std::thread worker; ///< Runs the tasks; started on first use.
+};
+
+#endif // TIMERQUEUE_HPP
@@ -0,0 +1,73 @@
+#include "transferresult.hpp"
+#include "logger.hpp"
+
+FailureKind classifyStatus(long status) {
+    if (status >= 200 && status < 300) {
+        return FailureKind::None;
+    }
+    if (status == 429) {
+        return FailureKind::RateLimited;
+    }
+    return status >= 500 && status < 600 ? FailureKind::ServerError : FailureKind::HttpStatus;
+}
+
+namespace {
+FailureKind classifyError(CURL* handle, CURLcode result) {
+    switch (result) {
+    case CURLE_ABORTED_BY_CALLBACK:
+        return FailureKind::Cancelled;
+    case CURLE_COULDNT_RESOLVE_PROXY:
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_SSL_CONNECT_ERROR:
+        return FailureKind::Connect;
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM: {
+        long requestBytes = 0;
+        curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &requestBytes);
+        if (requestBytes == 0) {
+            return FailureKind::Connect;
+        }
+        return result == CURLE_OPERATION_TIMEDOUT ? FailureKind::Timeout : FailureKind::Network;
+    }
+    default:
+        return FailureKind::Other;
+    }
+}
+}
+
+FailureKind classifyTransfer(CURL* handle, CURLcode result, RequestContext* context) {
+    long status = 0;
+    FailureKind kind = FailureKind::None;
+    if (result == CURLE_OK) {
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+        kind = classifyStatus(status);
+    } else {
+        kind = classifyError(handle, result);
+    }
+
+    if (kind == FailureKind::None || kind == FailureKind::Cancelled) {
+        // Cancellation is the caller's decision, not an error worth logging.
+    } else if (result != CURLE_OK) {
+        Logger::getInstance().log("CURL error: " + std::string(curl_easy_strerror(result)));
+    } else {
+        Logger::getInstance().log("HTTP error: status code " + std::to_string(status));
+    }
+
+    if (context) {
+        context->failure = kind;
+        context->httpStatus = status;
+        context->retryAfter = std::chrono::milliseconds(0);
+        if (kind == FailureKind::RateLimited) {
+            curl_off_t seconds = 0;
+            curl_easy_getinfo(handle, CURLINFO_RETRY_AFTER, &seconds);
+            context->retryAfter = std::chrono::seconds(seconds);
+        }
+    }
+    return kind;
+}
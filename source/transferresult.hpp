@@ -0,0 +1,25 @@
+#ifndef TRANSFERRESULT_HPP
+#define TRANSFERRESULT_HPP
+
+#include "common.hpp"
+#include <curl/curl.h>
+#include "transport.hpp"
+
+/**
+ * @brief Classifies an HTTP status: 2xx succeeds, 429 is RateLimited, 5xx ServerError, the rest HttpStatus.
+ */
+FailureKind classifyStatus(long status);
+
+/**
+ * @brief Classifies a finished libcurl transfer and logs failures.
+ * @param handle The transfer, queried for its HTTP status, Retry-After and bytes sent.
+ * @param result The result code of the transfer.
+ * @param context Optional; receives the failure kind, HTTP status and Retry-After delay.
+ * @return FailureKind::None for a 2xx response.
+ *
+ * Transfers that failed before a single request byte was written are reported as
+ * FailureKind::Connect even when they timed out, since the node never saw them.
+ */
+FailureKind classifyTransfer(CURL* handle, CURLcode result, RequestContext* context);
+
+#endif // TRANSFERRESULT_HPP
@@ -0,0 +1,199 @@
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+
+#include "common.hpp"
+#include <stop_token>
+
+/**
+ * @struct TransferCounters
+ * @brief Size of one response as received on the wire and after content decoding.
+ */
+struct TransferCounters {
+    std::uint64_t wireBytes = 0;    ///< Response body bytes received, before decompression.
+    std::uint64_t decodedBytes = 0; ///< Response body bytes delivered, after decompression.
+};
+
+/**
+ * @enum FailureKind
+ * @brief Why a request failed, as far as the transport can tell.
+ */
+enum class FailureKind {
+    None,        ///< The request succeeded.
+    Cancelled,   ///< The caller cancelled the request.
+    Connect,     ///< DNS, TCP or TLS setup failed; the node never saw the request.
+    Timeout,     ///< The transfer exceeded its time budget.
+    Network,     ///< The connection broke after the request may have reached the node.
+    RateLimited, ///< HTTP 429; RequestContext::retryAfter holds the node's hint.
+    ServerError, ///< HTTP 5xx.
+    HttpStatus,  ///< Any other non-2xx HTTP status.
+    RpcError,    ///< The node answered with a JSON-RPC error object.
+    CircuitOpen, ///< Refused locally because the endpoint's circuit breaker is open.
+    Other        ///< Any other local failure.
+};
+
+/**
+ * @brief Number of FailureKind values, for per-kind counters.
+ */
+inline constexpr std::size_t kFailureKindCount = static_cast<std::size_t>(FailureKind::Other) + 1;
+
+/**
+ * @brief Returns a short lowercase name of a failure kind, e.g. "timeout".
+ */
+constexpr std::string_view failureKindName(FailureKind kind) {
+    constexpr std::array<std::string_view, kFailureKindCount> names {
+        "none", "cancelled", "connect", "timeout", "network", "rate-limited",
+        "server-error", "http-status", "rpc-error", "circuit-open", "other"};
+    return names[static_cast<std::size_t>(kind)];
+}
+
+/**
+ * @struct RequestContext
+ * @brief Per-call state shared between a caller and the transport.
+ */
+struct RequestContext {
+    std::stop_token cancellation; ///< Requesting stop aborts the transfer, which then fails with FailureKind::Cancelled.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(); ///< The request fails with FailureKind::Timeout once this passes, including time spent queued or backing off.
+    std::chrono::milliseconds connectTimeout {0}; ///< Budget for connection setup of this request; 0 keeps the transport's default.
+    TransferCounters counters;    ///< Filled by the transport with the size of the response.
+    FailureKind failure = FailureKind::None; ///< Set by the transport when the request fails.
+    long httpStatus = 0;          ///< HTTP status of the response, if one was received.
+    std::chrono::milliseconds retryAfter {0}; ///< Delay requested by a Retry-After header, if any.
+};
+
+/**
+ * @brief Returns how long a request may still take: a transport's own limit, shortened to the context's deadline.
+ * @param context The request's context, or null.
+ * @param limit The transport's limit for the request.
+ * @return Zero once the deadline has passed; otherwise at least one millisecond.
+ */
+inline std::chrono::milliseconds remainingBudget(const RequestContext* context, std::chrono::milliseconds limit) {
+    if (!context || context->deadline == std::chrono::steady_clock::time_point::max()) {
+        return limit;
+    }
+    const auto left = context->deadline - std::chrono::steady_clock::now();
+    if (left <= std::chrono::steady_clock::duration::zero()) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::min(limit, std::chrono::ceil<std::chrono::milliseconds>(left));
+}
+
+/**
+ * @brief Checks whether a request timed out because its caller's deadline ran out.
+ *
+ * Such a timeout reflects the caller's budget rather than the endpoint's health,
+ * so health tracking treats it like a cancellation.
+ */
+inline bool deadlineExceeded(const RequestContext& context) {
+    return context.failure == FailureKind::Timeout && context.deadline <= std::chrono::steady_clock::now();
+}
+
+/**
+ * @class Transport
+ * @brief Interface of the request/response channel an EthereumClient talks through.
+ *
+ * Implementations deliver a serialized JSON-RPC request to an endpoint and hand
+ * back the raw response. NetworkAdapter is the production implementation;
+ * LoopbackTransport answers in-process for tests and benchmarks.
+ */
+class PROJECT_EXPORT Transport {
+public:
+    /**
+     * @brief Callback invoked with the response, or an empty std::optional on failure.
+     */
+    using Callback = std::function<void(std::optional<std::string>)>;
+
+    /**
+     * @brief Receives the next piece of a response body; returning false aborts the transfer.
+     */
+    using ChunkCallback = std::function<bool(std::string_view chunk)>;
+
+    virtual ~Transport() = default;
+
+    /**
+     * @brief Sends a request and waits for its response.
+     * @param url The endpoint to send the request to.
+     * @param data The serialized JSON-RPC request.
+     * @return The raw response, or an empty std::optional if an error occurs.
+     */
+    virtual std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) = 0;
+
+    /**
+     * @brief Sends a request and writes the response into a caller-owned buffer.
+     * @param url The endpoint to send the request to.
+     * @param data The serialized JSON-RPC request.
+     * @param response Receives the raw response; its previous contents are replaced.
+     * @param context Optional; may cancel the request or bound it by a deadline, and
+     *        receives the response size, or the FailureKind when the request fails.
+     * @return True on success.
+     *
+     * Callers that reuse one buffer across requests avoid a fresh allocation per
+     * response. The default implementation moves the result of sendPostRequest().
+     */
+    virtual bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                     RequestContext* context = nullptr) {
+        if (context) {
+            context->failure = context->cancellation.stop_requested() ? FailureKind::Cancelled
+                : context->deadline <= std::chrono::steady_clock::now() ? FailureKind::Timeout
+                : FailureKind::None;
+            if (context->failure != FailureKind::None) {
+                return false;
+            }
+        }
+        auto result = sendPostRequest(url, data);
+        if (!result) {
+            if (context) {
+                context->failure = FailureKind::Other;
+            }
+            return false;
+        }
+        response = std::move(*result);
+        if (context) {
+            context->counters.wireBytes = context->counters.decodedBytes = response.size();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Sends a request and hands the response body to a consumer piece by piece as it arrives.
+     * @param url The endpoint to send the request to.
+     * @param data The serialized JSON-RPC request.
+     * @param onChunk Receives the body in order; the pieces together form the whole body.
+     * @param context Optional; may cancel the request or bound it by a deadline, and receives
+     *        the response size, or the FailureKind when the request fails.
+     * @return True if the whole body was delivered; false if the request failed or
+     *         @p onChunk aborted it, in which case the failure is FailureKind::Cancelled.
+     *
+     * Lets a caller parse a large response while it is still being received, without
+     * ever holding all of it. Pieces already delivered stay delivered when the request
+     * fails midway. The default implementation receives the whole response with
+     * sendPostRequestInto() and delivers it as a single piece, so a decorator must
+     * override this and forward to its inner transport to keep the body streaming.
+     */
+    virtual bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                          RequestContext* context = nullptr) {
+        std::string response;
+        if (!sendPostRequestInto(url, data, response, context)) {
+            return false;
+        }
+        if (!onChunk(response)) {
+            if (context) {
+                context->failure = FailureKind::Cancelled;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Sends a request without blocking the calling thread.
+     * @param url The endpoint to send the request to.
+     * @param data The serialized JSON-RPC request.
+     * @param callback Invoked once with the response; may run on a transport thread or inline.
+     * @param context Optional; may cancel the request, is filled (sizes or FailureKind)
+     *        before the callback runs and must stay valid until then.
+     */
+    virtual void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                      RequestContext* context = nullptr) = 0;
+};
+
+#endif // TRANSPORT_HPP
@@ -0,0 +1,1540 @@
+#include "uringtransport.hpp"
+#include "jsonscan.hpp"
+#include "loadbalancer.hpp"
+#include "logger.hpp"
+#include "transferresult.hpp"
+#include <curl/curl.h>
+#include <charconv>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define URING_TRANSPORT_AVAILABLE 1
+#include <linux/io_uring.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <csignal>
+#endif
+
+#if defined(URING_TRANSPORT_AVAILABLE)
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kBufferSize = 64 * 1024;     ///< Registered receive buffer per thread ring and per engine slot.
+constexpr std::size_t kEngineBufferSlots = 16;     ///< Engine connections that read into registered buffers; later ones use their own.
+constexpr unsigned kThreadRingEntries = 8;
+constexpr unsigned kEngineRingEntries = 1024;
+constexpr std::size_t kMaxHeadSize = 64 * 1024;    ///< Longest accepted header block, chunk-size line or trailer.
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int ring, unsigned submit, unsigned wait, unsigned flags, const void* arg, std::size_t argSize) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring, submit, wait, flags, arg, argSize));
+}
+
+int uringRegister(int ring, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, count));
+}
+
+/**
+ * @brief Checks whether every request of a message (one call or a batch) may be sent twice.
+ */
+bool isIdempotentMessage(std::string_view data) {
+    const std::vector<std::string_view> methods = findMethods(data);
+    return std::all_of(methods.begin(), methods.end(), [](std::string_view method) { return LoadBalancer::isIdempotent(method); });
+}
+
+__kernel_timespec toTimespec(Clock::duration duration) {
+    const auto nanoseconds = std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 1);
+    return {.tv_sec = nanoseconds / 1'000'000'000, .tv_nsec = nanoseconds % 1'000'000'000};
+}
+
+/**
+ * @class Ring
+ * @brief One io_uring instance: submission and completion queues mapped into the process.
+ *
+ * Only the thread that opened the ring may use it.
+ */
+class Ring {
+public:
+    Ring() = default;
+    ~Ring() { close(); }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    /**
+     * @brief Creates the ring; prefers deferred task running, which keeps completions on this thread.
+     */
+    bool open(unsigned entries) {
+        io_uring_params params {};
+        params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+        ringFd = uringSetup(entries, &params);
+        if (ringFd < 0 && errno == EINVAL) {
+            params = {};
+            ringFd = uringSetup(entries, &params);
+        }
+        if (ringFd < 0) {
+            return false;
+        }
+        // Single mapping (5.4), extended wait arguments (5.11): everything used below.
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+            close();
+            return false;
+        }
+
+        ringSize = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                         params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ringMemory = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (ringMemory == MAP_FAILED || sqeMemory == MAP_FAILED) {
+            if (sqeMemory != MAP_FAILED) {
+                munmap(sqeMemory, sqesSize);
+            }
+            ringMemory = ringMemory == MAP_FAILED ? nullptr : ringMemory;
+            close();
+            return false;
+        }
+
+        auto* base = static_cast<char*>(ringMemory);
+        sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+        sqTailShared = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+        sqTail = *sqTailShared;
+        return true;
+    }
+
+    /**
+     * @brief Registers memory for READ_FIXED; @return false if the kernel or RLIMIT_MEMLOCK refuses.
+     */
+    bool registerBuffers(const iovec* buffers, unsigned count) {
+        return uringRegister(ringFd, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+    }
+
+    /**
+     * @brief Submits queued entries if fewer than @p count slots are free, so a linked chain is submitted whole.
+     */
+    void reserve(unsigned count) {
+        if (sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) + count > sqEntries) {
+            submitAndWait(0);
+        }
+    }
+
+    /**
+     * @brief Returns a cleared submission entry, submitting queued entries first if the queue is full.
+     */
+    io_uring_sqe* prepare(std::uint8_t opcode, int fd, std::uint64_t userData) {
+        reserve(1);
+        const unsigned index = sqTail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        ++sqTail;
+        ++unsubmitted;
+        return sqe;
+    }
+
+    /**
+     * @brief Submits queued entries and waits for at least @p count completions, or until @p timeout passes.
+     */
+    void submitAndWait(unsigned count, std::optional<Clock::duration> timeout = std::nullopt) {
+        __atomic_store_n(sqTailShared, sqTail, __ATOMIC_RELEASE);
+        unsigned flags = IORING_ENTER_GETEVENTS;
+        io_uring_getevents_arg arg {};
+        __kernel_timespec wait {};
+        if (timeout) {
+            wait = toTimespec(*timeout);
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = reinterpret_cast<std::uint64_t>(&wait);
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+        const int submitted = uringEnter(ringFd, unsubmitted, count, flags, timeout ? &arg : nullptr, timeout ? sizeof(arg) : 0);
+        if (submitted > 0) {
+            unsubmitted -= std::min<unsigned>(unsubmitted, static_cast<unsigned>(submitted));
+        }
+    }
+
+    /**
+     * @brief Hands every available completion to @p handler.
+     */
+    template<typename Handler>
+    void drain(Handler&& handler) {
+        unsigned head = *cqHead;
+        const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe cqe = cqes[head & cqMask];
+            ++head;
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            handler(cqe);
+        }
+    }
+
+private:
+    void close() {
+        if (sqes) {
+            munmap(sqes, sqesSize);
+            sqes = nullptr;
+        }
+        if (ringMemory) {
+            munmap(ringMemory, ringSize);
+            ringMemory = nullptr;
+        }
+        if (ringFd >= 0) {
+            ::close(ringFd);
+            ringFd = -1;
+        }
+    }
+
+    int ringFd = -1;
+    void* ringMemory = nullptr;
+    std::size_t ringSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqesSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTailShared = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned sqTail = 0;      ///< Local tail, published on submit.
+    unsigned unsubmitted = 0; ///< Entries prepared since the last submit.
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+bool equalsIgnoreCase(std::string_view left, std::string_view right) {
+    return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    });
+}
+
+std::string_view trim(std::string_view text) {
+    const std::size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(begin, text.find_last_not_of(" \t") - begin + 1);
+}
+
+/**
+ * @class ResponseParser
+ * @brief Incremental HTTP/1.1 response parser that appends the body to a caller's string.
+ *
+ * Handles Content-Length, chunked and close-delimited bodies and skips interim
+ * 1xx responses. Stops at the end of one response, so pipelined responses that
+ * share a read are split correctly.
+ */
+class ResponseParser {
+public:
+    void reset(std::string* target) {
+        body = target;
+        body->clear();
+        state = State::Head;
+        line.clear();
+        remaining = 0;
+        status = 0;
+        keepAlive = true;
+        retryAfter = std::chrono::seconds(0);
+        wireBytes = 0;
+        received = false;
+    }
+
+    /**
+     * @brief Consumes bytes of the response.
+     * @return How many bytes belong to this response, or npos if it is malformed.
+     */
+    std::size_t feed(const char* data, std::size_t size) {
+        received = received || size > 0;
+        std::size_t used = 0;
+        while (used < size && state != State::Done) {
+            const char* at = data + used;
+            const std::size_t left = size - used;
+            switch (state) {
+            case State::Head:
+            case State::Trailer:
+            case State::ChunkSize:
+            case State::ChunkEnd: {
+                const std::string_view terminator = state == State::Head || state == State::Trailer ? "\r\n\r\n" : "\r\n";
+                const std::size_t before = line.size();
+                const std::size_t searchFrom = before >= terminator.size() ? before - terminator.size() + 1 : 0;
+                line.append(at, left);
+                const std::size_t end = line.find(terminator, searchFrom);
+                if (end == std::string::npos) {
+                    if (line.size() > kMaxHeadSize) {
+                        return std::string::npos;
+                    }
+                    used += left;
+                    break;
+                }
+                used += end + terminator.size() - before;
+                line.resize(end);
+                if (!completeLine()) {
+                    return std::string::npos;
+                }
+                break;
+            }
+            case State::Body:
+            case State::ChunkData: {
+                const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(left, remaining));
+                body->append(at, count);
+                wireBytes += count;
+                remaining -= count;
+                used += count;
+                if (remaining == 0) {
+                    state = state == State::Body ? State::Done : State::ChunkEnd;
+                }
+                break;
+            }
+            case State::UntilClose:
+                body->append(at, left);
+                wireBytes += left;
+                used += left;
+                break;
+            case State::Done:
+                break;
+            }
+        }
+        return used;
+    }
+
+    /**
+     * @brief Ends a body delimited by the connection closing.
+     * @return True if the response is complete.
+     */
+    bool finishAtClose() {
+        if (state == State::UntilClose) {
+            state = State::Done;
+        }
+        return complete();
+    }
+
+    bool complete() const { return state == State::Done; }
+    bool started() const { return received; }
+
+    long status = 0;                          ///< HTTP status code.
+    bool keepAlive = true;                    ///< Whether the connection may carry another request.
+    std::chrono::seconds retryAfter {0};      ///< Retry-After hint, in seconds.
+    std::uint64_t wireBytes = 0;              ///< Body bytes received.
+
+private:
+    enum class State { Head, Body, UntilClose, ChunkSize, ChunkData, ChunkEnd, Trailer, Done };
+
+    bool completeLine() {
+        switch (state) {
+        case State::Head:
+            return parseHead();
+        case State::ChunkSize: {
+            const std::string_view text = trim(std::string_view(line).substr(0, line.find(';')));
+            std::uint64_t size = 0;
+            const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), size, 16);
+            if (text.empty() || ec != std::errc() || ptr != text.data() + text.size()) {
+                return false;
+            }
+            remaining = size;
+            state = size == 0 ? State::Trailer : State::ChunkData;
+            // The trailer ends with an empty line; priming the buffer lets the same search find it.
+            line = size == 0 ? "\r\n" : "";
+            return true;
+        }
+        case State::ChunkEnd:
+            state = State::ChunkSize;
+            return line.empty();
+        case State::Trailer:
+            state = State::Done;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool parseHead() {
+        const std::string_view head(line);
+        if (!head.starts_with("HTTP/1.") || head.size() < 12) {
+            return false;
+        }
+        keepAlive = head[7] == '1';
+        const auto [ptr, ec] = std::from_chars(head.data() + 9, head.data() + 12, status);
+        if (ec != std::errc()) {
+            return false;
+        }
+
+        bool chunked = false;
+        std::optional<std::uint64_t> length;
+        std::size_t position = head.find("\r\n");
+        while (position != std::string_view::npos) {
+            const std::size_t next = head.find("\r\n", position + 2);
+            const std::string_view field = head.substr(position + 2, next == std::string_view::npos ? std::string_view::npos : next - position - 2);
+            position = next;
+            const std::size_t colon = field.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            const std::string_view name = trim(field.substr(0, colon));
+            const std::string_view value = trim(field.substr(colon + 1));
+            if (equalsIgnoreCase(name, "content-length")) {
+                std::uint64_t parsed = 0;
+                if (std::from_chars(value.data(), value.data() + value.size(), parsed).ec != std::errc()) {
+                    return false;
+                }
+                length = parsed;
+            } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+                chunked = value.size() >= 7 && equalsIgnoreCase(value.substr(value.size() - 7), "chunked");
+            } else if (equalsIgnoreCase(name, "connection")) {
+                keepAlive = equalsIgnoreCase(value, "close") ? false : equalsIgnoreCase(value, "keep-alive") ? true : keepAlive;
+            } else if (equalsIgnoreCase(name, "retry-after")) {
+                long seconds = 0;
+                std::from_chars(value.data(), value.data() + value.size(), seconds);
+                retryAfter = std::chrono::seconds(seconds);
+            }
+        }
+        line.clear();
+
+        if (status >= 100 && status < 200) {
+            keepAlive = true;
+            return true;
+        }
+        if (chunked) {
+            state = State::ChunkSize;
+        } else if (status == 204 || status == 304 || (length && *length == 0)) {
+            state = State::Done;
+        } else if (length) {
+            remaining = *length;
+            body->reserve(static_cast<std::size_t>(*length));
+            state = State::Body;
+        } else {
+            keepAlive = false;
+            state = State::UntilClose;
+        }
+        return true;
+    }
+
+    State state = State::Head;
+    std::string line;            ///< Header block, chunk-size line or trailer collected so far.
+    std::uint64_t remaining = 0; ///< Body or chunk bytes still expected.
+    std::string* body = nullptr; ///< Receives the body.
+    bool received = false;       ///< Whether any byte of the response has arrived.
+};
+
+/**
+ * @brief Fills the context's status fields from a parsed response and logs HTTP errors.
+ */
+FailureKind classifyResponse(const ResponseParser& parser, std::size_t bodySize, RequestContext* context) {
+    const FailureKind kind = classifyStatus(parser.status);
+    if (kind != FailureKind::None) {
+        Logger::getInstance().log("HTTP error: status code " + std::to_string(parser.status));
+    }
+    if (context) {
+        context->failure = kind;
+        context->httpStatus = parser.status;
+        context->retryAfter = kind == FailureKind::RateLimited ? parser.retryAfter : std::chrono::seconds(0);
+        if (kind == FailureKind::None) {
+            context->counters.wireBytes = parser.wireBytes;
+            context->counters.decodedBytes = bodySize;
+        }
+    }
+    return kind;
+}
+
+bool failRequest(RequestContext* context, FailureKind kind) {
+    if (context) {
+        context->failure = kind;
+    }
+    return false;
+}
+
+/**
+ * @struct ThreadRing
+ * @brief The calling thread's ring for blocking calls, with its registered receive buffer.
+ */
+struct ThreadRing {
+    Scope<char[]> buffer = CreateScope<char[]>(kBufferSize); ///< Receive buffer, registered with the ring when allowed.
+    Ring ring;
+    bool fixed = false; ///< Whether the buffer is registered, so reads may use READ_FIXED.
+
+    /**
+     * @brief Returns this thread's ring, creating it on first use; nullptr if io_uring is unavailable.
+     */
+    static ThreadRing* current() {
+        thread_local Scope<ThreadRing> instance;
+        thread_local bool attempted = false;
+        if (!attempted) {
+            attempted = true;
+            auto candidate = CreateScope<ThreadRing>();
+            if (candidate->ring.open(kThreadRingEntries)) {
+                const iovec registered {candidate->buffer.get(), kBufferSize};
+                candidate->fixed = candidate->ring.registerBuffers(&registered, 1);
+                instance = std::move(candidate);
+            }
+        }
+        return instance.get();
+    }
+
+    /**
+     * @brief Runs the prepared operations and waits until all @p count of them completed.
+     */
+    template<typename Handler>
+    void run(unsigned count, Handler&& handler) {
+        while (count > 0) {
+            ring.submitAndWait(count);
+            ring.drain([&](const io_uring_cqe& cqe) {
+                --count;
+                handler(cqe);
+            });
+        }
+    }
+
+    /**
+     * @brief Queues a read of the socket into the receive buffer.
+     */
+    void prepareRead(int socket, std::uint64_t userData, std::uint8_t flags) {
+        io_uring_sqe* read = ring.prepare(fixed ? IORING_OP_READ_FIXED : IORING_OP_RECV, socket, userData);
+        read->addr = reinterpret_cast<std::uint64_t>(buffer.get());
+        read->len = static_cast<std::uint32_t>(kBufferSize);
+        read->flags = flags;
+    }
+
+    /**
+     * @brief Connects a socket, bounded by a linked timeout.
+     * @return 0, or the negative error code.
+     */
+    int connect(int socket, const sockaddr_storage& address, socklen_t length, Clock::duration budget) {
+        io_uring_sqe* connect = ring.prepare(IORING_OP_CONNECT, socket, 1);
+        connect->addr = reinterpret_cast<std::uint64_t>(&address);
+        connect->off = length;
+        connect->flags = IOSQE_IO_LINK;
+        const __kernel_timespec limit = toTimespec(budget);
+        io_uring_sqe* timeout = ring.prepare(IORING_OP_LINK_TIMEOUT, -1, 2);
+        timeout->addr = reinterpret_cast<std::uint64_t>(&limit);
+        timeout->len = 1;
+
+        int result = 0;
+        bool expired = false;
+        run(2, [&](const io_uring_cqe& cqe) {
+            if (cqe.user_data == 1) {
+                result = cqe.res;
+            } else {
+                expired = cqe.res == -ETIME;
+            }
+        });
+        return expired && result == -ECANCELED ? -ETIMEDOUT : result;
+    }
+};
+
+/**
+ * @struct Exchange
+ * @brief Outcome of one request/response exchange on a connection.
+ */
+struct Exchange {
+    FailureKind failure = FailureKind::None; ///< Transport-level failure; None once a complete response arrived.
+    bool keep = false;  ///< Whether the connection may carry another request.
+    bool stale = false; ///< Whether the node closed the connection before answering, as it does to idle connections.
+    std::size_t sent = 0; ///< Request bytes handed to the socket; once any were, the node may have processed the request.
+    int error = 0;      ///< errno of a failed operation, for the log.
+};
+
+/**
+ * @brief Sends a request on a connected socket and reads its response with one linked chain per round trip.
+ *
+ * The send, the read and a timeout bounding the read are submitted together.
+ * Only a response larger than the receive buffer, or a short send, needs more
+ * round trips. Cancellation shuts the socket down, which completes the read.
+ */
+Exchange exchange(ThreadRing& thread, int socket, std::string_view head, std::string_view data, ResponseParser& parser,
+                  Clock::time_point deadline, const std::stop_token* cancellation) {
+    enum : std::uint64_t { SendOp = 1, ReadOp, TimeoutOp };
+    auto abort = [socket]() { shutdown(socket, SHUT_RDWR); };
+    std::optional<std::stop_callback<decltype(abort)>> onCancel;
+    if (cancellation && cancellation->stop_possible()) {
+        onCancel.emplace(*cancellation, abort);
+    }
+
+    Exchange outcome;
+    const std::size_t total = head.size() + data.size();
+    std::size_t& sent = outcome.sent;
+    while (true) {
+        const auto now = Clock::now();
+        if (now >= deadline) {
+            outcome.failure = sent == 0 ? FailureKind::Connect : FailureKind::Timeout;
+            return outcome;
+        }
+
+        unsigned operations = 0;
+        iovec parts[2];
+        msghdr message {};
+        if (sent < total) {
+            const std::size_t headSent = std::min(sent, head.size());
+            parts[0] = {const_cast<char*>(head.data()) + headSent, head.size() - headSent};
+            parts[1] = {const_cast<char*>(data.data()) + (sent - headSent), data.size() - (sent - headSent)};
+            message.msg_iov = parts[0].iov_len > 0 ? parts : parts + 1;
+            message.msg_iovlen = parts[0].iov_len > 0 ? 2 : 1;
+            io_uring_sqe* send = thread.ring.prepare(IORING_OP_SENDMSG, socket, SendOp);
+            send->addr = reinterpret_cast<std::uint64_t>(&message);
+            send->len = 1;
+            send->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+            send->flags = IOSQE_IO_LINK;
+            ++operations;
+        }
+        thread.prepareRead(socket, ReadOp, IOSQE_IO_LINK);
+        const __kernel_timespec limit = toTimespec(deadline - now);
+        io_uring_sqe* timeout = thread.ring.prepare(IORING_OP_LINK_TIMEOUT, -1, TimeoutOp);
+        timeout->addr = reinterpret_cast<std::uint64_t>(&limit);
+        timeout->len = 1;
+        operations += 2;
+
+        int sendResult = 0;
+        int readResult = 0;
+        bool expired = false;
+        thread.run(operations, [&](const io_uring_cqe& cqe) {
+            switch (cqe.user_data) {
+            case SendOp: sendResult = cqe.res; break;
+            case ReadOp: readResult = cqe.res; break;
+            default: expired = cqe.res == -ETIME; break;
+            }
+        });
+
+        if (cancellation && cancellation->stop_requested()) {
+            outcome.failure = FailureKind::Cancelled;
+            return outcome;
+        }
+        if (sendResult < 0) {
+            outcome.error = -sendResult;
+            outcome.stale = sent == 0;
+            outcome.failure = sent == 0 ? FailureKind::Connect : FailureKind::Network;
+            return outcome;
+        }
+        sent += static_cast<std::size_t>(sendResult);
+        if (expired && readResult < 0) {
+            outcome.failure = sent == 0 ? FailureKind::Connect : FailureKind::Timeout;
+            return outcome;
+        }
+        if (readResult == -ECANCELED && sent < total) {
+            continue; // A short send breaks the chain; send the rest and read again.
+        }
+        if (readResult < 0) {
+            outcome.error = -readResult;
+            outcome.stale = !parser.started() && readResult == -ECONNRESET;
+            outcome.failure = FailureKind::Network;
+            return outcome;
+        }
+        if (readResult == 0) {
+            if (parser.finishAtClose()) {
+                return outcome;
+            }
+            outcome.stale = !parser.started();
+            outcome.failure = FailureKind::Network;
+            return outcome;
+        }
+
+        const std::size_t used = parser.feed(thread.buffer.get(), static_cast<std::size_t>(readResult));
+        if (used == std::string::npos) {
+            outcome.failure = FailureKind::Network;
+            return outcome;
+        }
+        if (parser.complete()) {
+            // Bytes after the response mean the node sent something unrequested: don't trust the connection.
+            outcome.keep = parser.keepAlive && used == static_cast<std::size_t>(readResult);
+            return outcome;
+        }
+    }
+}
+
+/**
+ * @brief Opens a TCP socket for an address; latency matters more than throughput, so Nagle is off.
+ */
+int openSocket(const sockaddr_storage& address) {
+    const int fd = socket(address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0) {
+        const int enabled = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+    }
+    return fd;
+}
+
+bool isLoopback(const sockaddr_storage& address) {
+    if (address.ss_family == AF_INET) {
+        return (ntohl(reinterpret_cast<const sockaddr_in&>(address).sin_addr.s_addr) >> 24) == 127;
+    }
+    if (address.ss_family == AF_INET6) {
+        const in6_addr& ip = reinterpret_cast<const sockaddr_in6&>(address).sin6_addr;
+        return IN6_IS_ADDR_LOOPBACK(&ip)
+            || (IN6_IS_ADDR_V4MAPPED(&ip) && ip.s6_addr[12] == 127);
+    }
+    return false;
+}
+}
+
+struct UringTransport::Endpoint {
+    std::string url;                 ///< Endpoint URL, for log messages.
+    bool served = false;             ///< Whether io_uring serves the endpoint; otherwise the fallback does.
+    sockaddr_storage address {};     ///< Resolved node address.
+    socklen_t addressLength = 0;     ///< Size of address.
+    std::string requestHead;         ///< Request line and headers, up to the Content-Length value.
+    std::mutex mutex;                ///< Guards the blocking-call connection pool.
+    std::condition_variable released; ///< Signalled when a connection returns to the pool.
+    std::vector<int> idle;           ///< Connected sockets that have carried a request.
+    std::size_t open = 0;            ///< Sockets of the pool, idle or in use.
+
+    /**
+     * @brief Returns the full request header for a body of the given size.
+     */
+    std::string header(std::size_t bodySize) const {
+        std::string head;
+        head.reserve(requestHead.size() + 24);
+        head += requestHead;
+        head += std::to_string(bodySize);
+        head += "\r\n\r\n";
+        return head;
+    }
+};
+
+/**
+ * @class UringTransport::Engine
+ * @brief Event loop on its own ring that pipelines async requests over persistent connections.
+ */
+class UringTransport::Engine {
+public:
+    explicit Engine(const UringTransportOptions& options) : options(options) {
+        std::promise<bool> started;
+        auto result = started.get_future();
+        loopThread = std::thread([this, &started]() { run(started); });
+        running = result.get();
+        if (!running) {
+            loopThread.join();
+        }
+    }
+
+    ~Engine() {
+        if (!running) {
+            return;
+        }
+        stopping = true;
+        wakeUp();
+        loopThread.join();
+        ::close(wakeFd);
+    }
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    bool isRunning() const { return running; }
+
+    void submit(Endpoint& endpoint, const std::string& data, Callback callback, RequestContext* context) {
+        auto request = CreateRef<Request>();
+        request->endpoint = &endpoint;
+        request->wire = endpoint.header(data.size());
+        request->wire += data;
+        request->callback = std::move(callback);
+        request->context = context;
+        request->deadline = std::min(context ? context->deadline : Clock::time_point::max(), Clock::now() + options.timeout);
+        request->connectTimeout = context && context->connectTimeout.count() > 0 ? context->connectTimeout : options.connectTimeout;
+        request->id = nextId.fetch_add(1, std::memory_order_relaxed);
+        request->idempotent = isIdempotentMessage(data);
+        if (context && context->cancellation.stop_possible()) {
+            // The flag covers a stop that lands before the loop takes the request in; the id covers every later one.
+            request->onCancel = CreateScope<std::stop_callback<std::function<void()>>>(context->cancellation,
+                std::function<void()>([this, raw = request.get()]() {
+                    raw->cancelRequested = true;
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex);
+                        cancelled.push_back(raw->id);
+                    }
+                    wakeUp();
+                }));
+        }
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            incoming.push_back(std::move(request));
+            wake = !wakeRequested;
+            wakeRequested = true;
+        }
+        if (wake) {
+            wakeUp();
+        }
+    }
+
+private:
+    struct Connection;
+
+    struct Request {
+        Endpoint* endpoint = nullptr;
+        std::string wire;             ///< Request line, headers and body.
+        std::string response;         ///< Response body.
+        Callback callback;
+        RequestContext* context = nullptr;
+        Clock::time_point deadline;
+        std::chrono::milliseconds connectTimeout {0};
+        std::uint64_t id = 0;
+        std::optional<std::multimap<Clock::time_point, std::uint64_t>::iterator> deadlineEntry; ///< Entry in deadlines while unfinished.
+        Clock::time_point sentAt;     ///< When the request was queued on a connection.
+        bool finished = false;        ///< The callback has run; a late response is discarded.
+        bool retried = false;         ///< Already resent after its connection closed unanswered.
+        bool idempotent = false;      ///< Every method in the request may be sent twice.
+        std::atomic<bool> cancelRequested {false}; ///< Set by the caller's stop request, possibly before the loop takes the request in.
+        Scope<std::stop_callback<std::function<void()>>> onCancel; ///< Forwards cancellation to the loop.
+    };
+
+    struct Route {
+        std::deque<Ref<Request>> queue;        ///< Requests waiting for a connection.
+        std::vector<Connection*> connections;  ///< Open and opening connections.
+    };
+
+    struct Connection {
+        int fd = -1;
+        Endpoint* endpoint = nullptr;
+        int slot = -1;                    ///< Registered buffer index, or -1 to read into ownBuffer.
+        Scope<char[]> ownBuffer;
+        std::deque<Ref<Request>> inflight; ///< Written (or being written) requests, in response order.
+        std::string sending;              ///< Bytes of the send in flight.
+        std::size_t sendOffset = 0;
+        std::string outgoing;             ///< Bytes queued behind the send in flight.
+        ResponseParser parser;            ///< Parses the response of inflight.front().
+        std::size_t operations = 0;       ///< Submitted operations not yet completed.
+        std::uint64_t answered = 0;       ///< Responses received so far.
+        bool connected = false;
+        bool busySending = false;
+        bool closeAnnounced = false;      ///< The node answered with "Connection: close".
+        bool closing = false;
+    };
+
+    enum Operation : std::uint64_t { ConnectOp, SendOp, ReadOp, TimeoutOp, WakeOp };
+
+    static std::uint64_t tag(Connection* connection, Operation operation) {
+        return reinterpret_cast<std::uint64_t>(connection) | operation;
+    }
+
+    char* buffer(Connection& connection) {
+        return connection.slot >= 0 ? slots.get() + connection.slot * kBufferSize : connection.ownBuffer.get();
+    }
+
+    void wakeUp() {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(wakeFd, &one, sizeof(one));
+    }
+
+    void run(std::promise<bool>& started) {
+        wakeFd = eventfd(0, EFD_CLOEXEC);
+        if (wakeFd < 0 || !ring.open(kEngineRingEntries)) {
+            if (wakeFd >= 0) {
+                ::close(wakeFd);
+            }
+            started.set_value(false);
+            return;
+        }
+        slots = CreateScope<char[]>(kEngineBufferSlots * kBufferSize);
+        std::vector<iovec> registered(kEngineBufferSlots);
+        for (std::size_t i = 0; i < kEngineBufferSlots; ++i) {
+            registered[i] = {slots.get() + i * kBufferSize, kBufferSize};
+        }
+        if (ring.registerBuffers(registered.data(), static_cast<unsigned>(registered.size()))) {
+            for (std::size_t i = kEngineBufferSlots; i > 0; --i) {
+                freeSlots.push_back(static_cast<int>(i - 1));
+            }
+        } else {
+            slots.reset();
+        }
+        started.set_value(true);
+
+        armWake();
+        while (true) {
+            std::optional<Clock::duration> wait;
+            if (!deadlines.empty()) {
+                wait = std::max(deadlines.begin()->first - Clock::now(), Clock::duration::zero());
+            }
+            ring.submitAndWait(1, wait);
+            ring.drain([this](const io_uring_cqe& cqe) { complete(cqe); });
+
+            std::vector<Ref<Request>> arrived;
+            std::vector<std::uint64_t> stopped;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                arrived.swap(incoming);
+                stopped.swap(cancelled);
+                wakeRequested = false;
+            }
+            if (stopping) {
+                for (Ref<Request>& request : arrived) {
+                    finish(*request, FailureKind::Other);
+                }
+                break;
+            }
+            for (Ref<Request>& request : arrived) {
+                if (request->cancelRequested) {
+                    finish(*request, FailureKind::Cancelled);
+                    continue;
+                }
+                live.emplace(request->id, request);
+                request->deadlineEntry = deadlines.emplace(request->deadline, request->id);
+                routes[request->endpoint].queue.push_back(std::move(request));
+            }
+            for (std::uint64_t id : stopped) {
+                if (auto it = live.find(id); it != live.end()) {
+                    Ref<Request> request = it->second;
+                    finish(*request, FailureKind::Cancelled);
+                }
+            }
+            expire();
+            for (auto& [endpoint, route] : routes) {
+                dispatch(*endpoint, route);
+            }
+        }
+        shutdownAll();
+    }
+
+    void armWake() {
+        io_uring_sqe* read = ring.prepare(IORING_OP_READ, wakeFd, WakeOp);
+        read->addr = reinterpret_cast<std::uint64_t>(&wakeValue);
+        read->len = sizeof(wakeValue);
+        ++outstanding;
+    }
+
+    /**
+     * @brief Fails requests whose deadline passed; a connection whose oldest request is overdue is closed.
+     */
+    void expire() {
+        const auto now = Clock::now();
+        while (!deadlines.empty() && deadlines.begin()->first <= now) {
+            Ref<Request> request = live.at(deadlines.begin()->second);
+            finish(*request, FailureKind::Timeout);
+            for (Connection* connection : routes[request->endpoint].connections) {
+                if (!connection->inflight.empty() && connection->inflight.front() == request
+                    && now - request->sentAt >= options.timeout) {
+                    Logger::getInstance().log("io_uring transport: node stopped answering on " + request->endpoint->url);
+                    close(*connection, FailureKind::Timeout);
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Hands queued requests to connections: new connections first, then pipelining on the least loaded one.
+     */
+    void dispatch(Endpoint& endpoint, Route& route) {
+        while (!route.queue.empty()) {
+            if (route.queue.front()->finished) {
+                route.queue.pop_front();
+                continue;
+            }
+            Connection* target = nullptr;
+            for (Connection* connection : route.connections) {
+                if (!connection->closing && connection->inflight.size() < options.pipelineDepth
+                    && (!target || connection->inflight.size() < target->inflight.size())) {
+                    target = connection;
+                }
+            }
+            if ((!target || !target->inflight.empty()) && route.connections.size() < options.connectionsPerEndpoint) {
+                if (Connection* fresh = open(endpoint, route, route.queue.front()->connectTimeout)) {
+                    target = fresh;
+                }
+            }
+            if (!target) {
+                return;
+            }
+            Ref<Request> request = std::move(route.queue.front());
+            route.queue.pop_front();
+            request->sentAt = Clock::now();
+            if (target->inflight.empty()) {
+                target->parser.reset(&request->response);
+            }
+            target->outgoing += request->wire;
+            target->inflight.push_back(std::move(request));
+            if (target->connected && !target->busySending) {
+                flush(*target);
+            }
+        }
+    }
+
+    Connection* open(Endpoint& endpoint, Route& route, std::chrono::milliseconds connectTimeout) {
+        const int fd = openSocket(endpoint.address);
+        if (fd < 0) {
+            Logger::getInstance().log("io_uring transport: failed to create socket: " + std::string(std::strerror(errno)));
+            return nullptr;
+        }
+        auto* connection = new Connection();
+        connection->fd = fd;
+        connection->endpoint = &endpoint;
+        if (!freeSlots.empty()) {
+            connection->slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            connection->ownBuffer = CreateScope<char[]>(kBufferSize);
+        }
+        route.connections.push_back(connection);
+
+        ring.reserve(2);
+        io_uring_sqe* connect = ring.prepare(IORING_OP_CONNECT, fd, tag(connection, ConnectOp));
+        connect->addr = reinterpret_cast<std::uint64_t>(&endpoint.address);
+        connect->off = endpoint.addressLength;
+        connect->flags = IOSQE_IO_LINK;
+        const __kernel_timespec limit = toTimespec(connectTimeout);
+        io_uring_sqe* timeout = ring.prepare(IORING_OP_LINK_TIMEOUT, -1, tag(connection, TimeoutOp));
+        timeout->addr = reinterpret_cast<std::uint64_t>(&limit);
+        timeout->len = 1;
+        // The kernel copies the timeout when the entry is submitted, which must happen while limit is alive.
+        ring.submitAndWait(0);
+        connection->operations += 2;
+        outstanding += 2;
+        return connection;
+    }
+
+    void flush(Connection& connection) {
+        if (connection.sendOffset == connection.sending.size()) {
+            if (connection.outgoing.empty()) {
+                connection.busySending = false;
+                return;
+            }
+            connection.sending.swap(connection.outgoing);
+            connection.outgoing.clear();
+            connection.sendOffset = 0;
+        }
+        io_uring_sqe* send = ring.prepare(IORING_OP_SEND, connection.fd, tag(&connection, SendOp));
+        send->addr = reinterpret_cast<std::uint64_t>(connection.sending.data() + connection.sendOffset);
+        send->len = static_cast<std::uint32_t>(std::min<std::size_t>(connection.sending.size() - connection.sendOffset, UINT32_MAX));
+        send->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        connection.busySending = true;
+        ++connection.operations;
+        ++outstanding;
+    }
+
+    void read(Connection& connection) {
+        io_uring_sqe* read = ring.prepare(connection.slot >= 0 ? IORING_OP_READ_FIXED : IORING_OP_RECV, connection.fd,
+                                          tag(&connection, ReadOp));
+        read->addr = reinterpret_cast<std::uint64_t>(buffer(connection));
+        read->len = static_cast<std::uint32_t>(kBufferSize);
+        read->buf_index = static_cast<std::uint16_t>(std::max(connection.slot, 0));
+        ++connection.operations;
+        ++outstanding;
+    }
+
+    void complete(const io_uring_cqe& cqe) {
+        --outstanding;
+        const auto operation = static_cast<Operation>(cqe.user_data & 7);
+        auto* connection = reinterpret_cast<Connection*>(cqe.user_data & ~std::uint64_t {7});
+        if (operation == WakeOp) {
+            if (!stopping) {
+                armWake();
+            }
+            return;
+        }
+        --connection->operations;
+        switch (operation) {
+        case ConnectOp:
+            if (cqe.res < 0) {
+                if (!connection->closing) {
+                    Logger::getInstance().log("io_uring transport: failed to connect to " + connection->endpoint->url + ": "
+                                              + std::strerror(cqe.res == -ECANCELED ? ETIMEDOUT : -cqe.res));
+                }
+                close(*connection, FailureKind::Connect);
+            } else if (!connection->closing) {
+                connection->connected = true;
+                read(*connection);
+                flush(*connection);
+            }
+            break;
+        case SendOp:
+            if (cqe.res < 0) {
+                close(*connection, FailureKind::Network, -cqe.res);
+            } else if (!connection->closing) {
+                connection->sendOffset += static_cast<std::size_t>(cqe.res);
+                flush(*connection);
+            }
+            break;
+        case ReadOp:
+            received(*connection, cqe.res);
+            break;
+        default:
+            break;
+        }
+        if (connection->closing && connection->operations == 0) {
+            destroy(connection);
+        }
+    }
+
+    void received(Connection& connection, int result) {
+        if (connection.closing) {
+            return;
+        }
+        if (result <= 0) {
+            if (result == 0 && !connection.inflight.empty() && connection.parser.finishAtClose()) {
+                deliver(connection);
+            }
+            close(connection, FailureKind::Network, result < 0 ? -result : 0);
+            return;
+        }
+
+        const char* data = buffer(connection);
+        std::size_t offset = 0;
+        while (offset < static_cast<std::size_t>(result)) {
+            if (connection.inflight.empty()) {
+                Logger::getInstance().log("io_uring transport: unexpected data from " + connection.endpoint->url);
+                close(connection, FailureKind::Network);
+                return;
+            }
+            const std::size_t used = connection.parser.feed(data + offset, static_cast<std::size_t>(result) - offset);
+            if (used == std::string::npos) {
+                Logger::getInstance().log("io_uring transport: malformed HTTP response from " + connection.endpoint->url);
+                close(connection, FailureKind::Network);
+                return;
+            }
+            offset += used;
+            if (connection.parser.complete()) {
+                const bool keepAlive = connection.parser.keepAlive;
+                deliver(connection);
+                if (!keepAlive) {
+                    connection.closeAnnounced = true;
+                    close(connection, FailureKind::Network);
+                    return;
+                }
+            }
+        }
+        read(connection);
+    }
+
+    /**
+     * @brief Completes the oldest request of a connection with its parsed response.
+     */
+    void deliver(Connection& connection) {
+        Ref<Request> request = std::move(connection.inflight.front());
+        connection.inflight.pop_front();
+        ++connection.answered;
+        if (!request->finished) {
+            finish(*request, FailureKind::None, &connection.parser);
+        }
+        if (!connection.inflight.empty()) {
+            connection.parser.reset(&connection.inflight.front()->response);
+        }
+    }
+
+    /**
+     * @brief Closes a connection once its operations drain; its unanswered requests are resent or failed.
+     *
+     * Requests are resent on another connection when the node should not have
+     * processed them: it announced the close, which it may do after any number of
+     * requests, or it dropped a connection that had served requests before (an idle
+     * timeout) without starting to answer, which earns a request one resend. Only
+     * idempotent requests are resent, since a node may still have acted on one; a
+     * resent eth_sendRawTransaction could be broadcast twice.
+     */
+    void close(Connection& connection, FailureKind kind, int error = 0) {
+        if (connection.closing) {
+            return;
+        }
+        connection.closing = true;
+        if (error != 0) {
+            Logger::getInstance().log("io_uring transport: connection to " + connection.endpoint->url + " failed: "
+                                      + std::strerror(error));
+        }
+        shutdown(connection.fd, SHUT_RDWR);
+        if (!connection.connected && connection.operations > 0) {
+            io_uring_sqe* cancel = ring.prepare(IORING_OP_ASYNC_CANCEL, -1, tag(&connection, TimeoutOp));
+            cancel->addr = tag(&connection, ConnectOp);
+            ++connection.operations;
+            ++outstanding;
+        }
+
+        const bool dropped = kind == FailureKind::Network && connection.answered > 0 && !connection.parser.started();
+        Route& route = routes[connection.endpoint];
+        std::deque<Ref<Request>> unanswered = std::move(connection.inflight);
+        connection.inflight.clear();
+        for (auto it = unanswered.rbegin(); it != unanswered.rend(); ++it) {
+            Request& request = **it;
+            if (request.finished) {
+                continue;
+            }
+            if (request.idempotent && (connection.closeAnnounced || (dropped && !request.retried))) {
+                request.retried = request.retried || !connection.closeAnnounced;
+                route.queue.push_front(*it);
+            } else {
+                finish(request, kind);
+            }
+        }
+        std::erase(route.connections, &connection);
+    }
+
+    void destroy(Connection* connection) {
+        ::close(connection->fd);
+        if (connection->slot >= 0) {
+            freeSlots.push_back(connection->slot);
+        }
+        delete connection;
+    }
+
+    /**
+     * @brief Runs a request's callback; with a parser, the outcome follows the parsed HTTP status instead of @p kind.
+     */
+    void finish(Request& request, FailureKind kind, const ResponseParser* parser = nullptr) {
+        if (request.finished) {
+            return;
+        }
+        request.finished = true;
+        live.erase(request.id);
+        if (request.deadlineEntry) {
+            deadlines.erase(*request.deadlineEntry);
+            request.deadlineEntry.reset();
+        }
+        request.onCancel.reset();
+        if (parser) {
+            kind = classifyResponse(*parser, request.response.size(), request.context);
+        } else if (request.context) {
+            request.context->failure = kind;
+        }
+        std::optional<std::string> response;
+        if (kind == FailureKind::None) {
+            response = std::move(request.response);
+        }
+        request.context = nullptr;
+        Callback callback = std::move(request.callback);
+        callback(std::move(response));
+    }
+
+    /**
+     * @brief Fails every request and waits for the kernel to release all buffers before the ring closes.
+     */
+    void shutdownAll() {
+        for (auto& [endpoint, route] : routes) {
+            const std::vector<Connection*> connections = route.connections;
+            for (Connection* connection : connections) {
+                close(*connection, FailureKind::Other);
+            }
+            while (!route.queue.empty()) {
+                finish(*route.queue.front(), FailureKind::Other);
+                route.queue.pop_front();
+            }
+        }
+        wakeUp();
+        while (outstanding > 0) {
+            ring.submitAndWait(1);
+            ring.drain([this](const io_uring_cqe& cqe) { complete(cqe); });
+        }
+    }
+
+    const UringTransportOptions& options;
+    Scope<char[]> slots;             ///< Registered receive buffers, kBufferSize each.
+    Ring ring;                       ///< Used by the loop thread only.
+    int wakeFd = -1;                 ///< eventfd that interrupts the wait for completions.
+    std::uint64_t wakeValue = 0;     ///< Target of the eventfd read.
+    std::vector<int> freeSlots;      ///< Registered buffers not owned by a connection.
+    std::size_t outstanding = 0;     ///< Submitted operations not yet completed.
+    std::unordered_map<Endpoint*, Route> routes;          ///< Per-endpoint queue and connections.
+    std::unordered_map<std::uint64_t, Ref<Request>> live;  ///< Unfinished requests by id.
+    std::multimap<Clock::time_point, std::uint64_t> deadlines; ///< Deadlines of unfinished requests.
+
+    std::mutex queueMutex;                  ///< Guards incoming, cancelled and wakeRequested.
+    std::vector<Ref<Request>> incoming;     ///< Requests submitted since the last loop iteration.
+    std::vector<std::uint64_t> cancelled;   ///< Ids of requests cancelled by their callers.
+    bool wakeRequested = false;             ///< Whether the loop has been woken for incoming requests.
+    std::atomic<std::uint64_t> nextId {1};
+    std::atomic<bool> stopping {false};
+    bool running = false;
+    std::thread loopThread;
+};
+
+UringTransport::UringTransport(UringTransportOptions options, Transport& fallback)
+    : options(std::move(options)), fallback(fallback) {
+    this->options.connectionsPerEndpoint = std::max<std::size_t>(this->options.connectionsPerEndpoint, 1);
+    this->options.pipelineDepth = std::max<std::size_t>(this->options.pipelineDepth, 1);
+}
+
+UringTransport::~UringTransport() {
+    asyncEngine.reset();
+    for (auto& [url, target] : endpoints) {
+        for (int socket : target->idle) {
+            ::close(socket);
+        }
+    }
+}
+
+bool UringTransport::isSupported() {
+    static const bool supported = []() {
+        io_uring_params params {};
+        const int ring = uringSetup(1, &params);
+        if (ring < 0) {
+            Logger::getInstance().log("io_uring is unavailable (" + std::string(std::strerror(errno)) + "); requests use the fallback transport.");
+            return false;
+        }
+        ::close(ring);
+        return (params.features & IORING_FEAT_EXT_ARG) != 0;
+    }();
+    return supported;
+}
+
+bool UringTransport::servesEndpoint(const std::string& url) {
+    return endpoint(url) != nullptr;
+}
+
+UringTransport::Endpoint* UringTransport::endpoint(const std::string& url) {
+    {
+        std::shared_lock<std::shared_mutex> lock(endpointsMutex);
+        auto it = endpoints.find(url);
+        if (it != endpoints.end()) {
+            return it->second->served ? it->second.get() : nullptr;
+        }
+    }
+
+    auto target = CreateScope<Endpoint>();
+    target->url = url;
+    const bool listed = std::find(options.endpoints.begin(), options.endpoints.end(), url) != options.endpoints.end();
+    CURLU* parsed = curl_url();
+    char* scheme = nullptr;
+    char* host = nullptr;
+    char* port = nullptr;
+    char* path = nullptr;
+    char* query = nullptr;
+    if (isSupported() && (options.endpoints.empty() || listed) && parsed
+        && curl_url_set(parsed, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK
+        && curl_url_get(parsed, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK && std::string_view(scheme) == "http"
+        && curl_url_get(parsed, CURLUPART_HOST, &host, 0) == CURLUE_OK
+        && curl_url_get(parsed, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK
+        && curl_url_get(parsed, CURLUPART_PATH, &path, 0) == CURLUE_OK) {
+        curl_url_get(parsed, CURLUPART_QUERY, &query, 0);
+        std::string name(host);
+        if (name.size() > 2 && name.front() == '[') {
+            name = name.substr(1, name.size() - 2);
+        }
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        addrinfo* results = nullptr;
+        if (getaddrinfo(name.c_str(), port, &hints, &results) == 0 && results) {
+            std::memcpy(&target->address, results->ai_addr, results->ai_addrlen);
+            target->addressLength = results->ai_addrlen;
+            // Only loopback nodes are picked automatically; listing an endpoint opts it in regardless.
+            target->served = listed || isLoopback(target->address);
+            freeaddrinfo(results);
+        }
+        target->requestHead = "POST " + std::string(path) + (query ? "?" + std::string(query) : std::string())
+            + " HTTP/1.1\r\nHost: " + std::string(host) + ":" + port
+            + "\r\nContent-Type: application/json\r\nContent-Length: ";
+    }
+    curl_free(scheme);
+    curl_free(host);
+    curl_free(port);
+    curl_free(path);
+    curl_free(query);
+    curl_url_cleanup(parsed);
+    if (listed && !target->served) {
+        Logger::getInstance().log("io_uring transport cannot serve endpoint " + url + "; using the fallback transport.");
+    }
+
+    std::unique_lock<std::shared_mutex> lock(endpointsMutex);
+    auto [it, inserted] = endpoints.try_emplace(url, std::move(target));
+    return it->second->served ? it->second.get() : nullptr;
+}
+
+UringTransport::Engine* UringTransport::engine() {
+    std::call_once(engineInitFlag, [this]() {
+        auto candidate = CreateScope<Engine>(options);
+        if (candidate->isRunning()) {
+            asyncEngine = std::move(candidate);
+        } else {
+            Logger::getInstance().log("io_uring transport could not start its event loop; async requests use the fallback transport.");
+        }
+    });
+    return asyncEngine.get();
+}
+
+int UringTransport::acquireConnection(Endpoint& target, std::chrono::steady_clock::time_point deadline, bool& reused) {
+    std::unique_lock<std::mutex> lock(target.mutex);
+    while (target.idle.empty() && target.open >= options.connectionsPerEndpoint) {
+        if (target.released.wait_until(lock, deadline) == std::cv_status::timeout && target.idle.empty()
+            && target.open >= options.connectionsPerEndpoint) {
+            return -1;
+        }
+    }
+    if (!target.idle.empty()) {
+        const int socket = target.idle.back();
+        target.idle.pop_back();
+        reused = true;
+        return socket;
+    }
+    const int socket = openSocket(target.address);
+    if (socket < 0) {
+        Logger::getInstance().log("io_uring transport: failed to create socket: " + std::string(std::strerror(errno)));
+        return -1;
+    }
+    ++target.open;
+    reused = false;
+    return socket;
+}
+
+void UringTransport::releaseConnection(Endpoint& target, int socket, bool keep) {
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        if (keep) {
+            target.idle.push_back(socket);
+        } else {
+            ::close(socket);
+            --target.open;
+        }
+    }
+    target.released.notify_one();
+}
+
+std::optional<std::string> UringTransport::sendPostRequest(const std::string& url, const std::string& data) {
+    std::string response;
+    if (!sendPostRequestInto(url, data, response)) {
+        return std::nullopt;
+    }
+    return response;
+}
+
+bool UringTransport::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                         RequestContext* context) {
+    Endpoint* target = endpoint(url);
+    ThreadRing* thread = target ? ThreadRing::current() : nullptr;
+    if (!thread) {
+        return fallback.sendPostRequestInto(url, data, response, context);
+    }
+
+    if (context) {
+        context->failure = FailureKind::None;
+        context->httpStatus = 0;
+        if (context->cancellation.stop_requested()) {
+            return failRequest(context, FailureKind::Cancelled);
+        }
+    }
+    const auto budget = remainingBudget(context, options.timeout);
+    if (budget.count() == 0) {
+        return failRequest(context, FailureKind::Timeout);
+    }
+    const auto deadline = Clock::now() + budget;
+    const auto connectBudget = context && context->connectTimeout.count() > 0 ? context->connectTimeout : options.connectTimeout;
+    const std::string head = target->header(data.size());
+    ResponseParser parser;
+    const bool idempotent = isIdempotentMessage(data);
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        const int socket = acquireConnection(*target, deadline, reused);
+        if (socket < 0) {
+            return failRequest(context, Clock::now() >= deadline ? FailureKind::Timeout : FailureKind::Other);
+        }
+        if (!reused) {
+            const int connected = thread->connect(socket, target->address, target->addressLength,
+                                                  std::min<Clock::duration>(connectBudget, deadline - Clock::now()));
+            if (connected < 0) {
+                releaseConnection(*target, socket, false);
+                Logger::getInstance().log("io_uring transport: failed to connect to " + url + ": " + std::strerror(-connected));
+                return failRequest(context, connected == -ETIMEDOUT && Clock::now() >= deadline ? FailureKind::Timeout : FailureKind::Connect);
+            }
+        }
+
+        parser.reset(&response);
+        const Exchange outcome = exchange(*thread, socket, head, data, parser, deadline,
+                                          context ? &context->cancellation : nullptr);
+        releaseConnection(*target, socket, outcome.keep);
+        if (outcome.stale && reused) {
+            // The node closed idle connections; the rest of the pool is likely just as dead.
+            {
+                std::lock_guard<std::mutex> lock(target->mutex);
+                for (int idle : target->idle) {
+                    ::close(idle);
+                }
+                target->open -= target->idle.size();
+                target->idle.clear();
+            }
+            // Resend only what the node cannot have processed, as Engine::close() does: nothing was sent, or the call is idempotent.
+            if (attempt == 0 && (outcome.sent == 0 || idempotent)) {
+                continue;
+            }
+        }
+        if (outcome.failure != FailureKind::None) {
+            if (outcome.failure == FailureKind::Network || outcome.failure == FailureKind::Connect) {
+                Logger::getInstance().log("io_uring transport: request to " + url + " failed"
+                                          + (outcome.error ? ": " + std::string(std::strerror(outcome.error)) : std::string()));
+            }
+            return failRequest(context, outcome.failure);
+        }
+        return classifyResponse(parser, response.size(), context) == FailureKind::None;
+    }
+    return failRequest(context, FailureKind::Network);
+}
+
+bool UringTransport::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                              RequestContext* context) {
+    return fallback.sendPostRequestStreaming(url, data, onChunk, context);
+}
+
+void UringTransport::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                          RequestContext* context) {
+    Endpoint* target = endpoint(url);
+    Engine* loop = target ? engine() : nullptr;
+    if (!loop) {
+        fallback.sendPostRequestAsync(url, data, std::move(callback), context);
+        return;
+    }
+
+    if (context) {
+        context->failure = context->cancellation.stop_requested() ? FailureKind::Cancelled
+            : context->deadline <= Clock::now() ? FailureKind::Timeout
+            : FailureKind::None;
+        context->httpStatus = 0;
+        if (context->failure != FailureKind::None) {
+            callback(std::nullopt);
+            return;
+        }
+    }
+    loop->submit(*target, data, std::move(callback), context);
+}
+
+#else
+
+struct UringTransport::Endpoint {};
+
+class UringTransport::Engine {};
+
+UringTransport::UringTransport(UringTransportOptions options, Transport& fallback)
+    : options(std::move(options)), fallback(fallback) {}
+
+UringTransport::~UringTransport() = default;
+
+bool UringTransport::isSupported() {
+    return false;
+}
+
+bool UringTransport::servesEndpoint(const std::string&) {
+    return false;
+}
+
+std::optional<std::string> UringTransport::sendPostRequest(const std::string& url, const std::string& data) {
+    return fallback.sendPostRequest(url, data);
+}
+
+bool UringTransport::sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                                         RequestContext* context) {
+    return fallback.sendPostRequestInto(url, data, response, context);
+}
+
+bool UringTransport::sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                              RequestContext* context) {
+    return fallback.sendPostRequestStreaming(url, data, onChunk, context);
+}
+
+void UringTransport::sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                                          RequestContext* context) {
+    fallback.sendPostRequestAsync(url, data, std::move(callback), context);
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef URINGTRANSPORT_HPP
+#define URINGTRANSPORT_HPP
+
+#include "common.hpp"
+#include "transport.hpp"
+
+/**
+ * @struct UringTransportOptions
+ * @brief Endpoint selection and connection settings of the io_uring transport.
+ */
+struct UringTransportOptions {
+    std::vector<std::string> endpoints; ///< Endpoints served by io_uring; empty selects every plain-HTTP loopback endpoint.
+    std::size_t connectionsPerEndpoint = 4; ///< Persistent connections per endpoint for blocking calls, and again for the async engine.
+    std::size_t pipelineDepth = 16; ///< Requests the async engine writes ahead on one connection before waiting for responses.
+    std::chrono::milliseconds timeout = std::chrono::seconds(30); ///< Total request timeout; a request's deadline can only shorten it.
+    std::chrono::milliseconds connectTimeout = std::chrono::seconds(5); ///< Budget for opening a connection; RequestContext::connectTimeout overrides it.
+};
+
+/**
+ * @class UringTransport
+ * @brief Transport decorator that talks HTTP/1.1 to loopback nodes over io_uring.
+ *
+ * A node on the same host (the default "http://127.0.0.1:8545") needs none of
+ * libcurl's generality: no DNS, TLS, proxies or content negotiation. Requests
+ * to such endpoints are written and read by a small purpose-built HTTP/1.1
+ * client over persistent connections, with a request's send, receive and
+ * timeout submitted to io_uring as one linked chain, so a small call costs a
+ * single system call in the common case. Responses are read into buffers
+ * registered with the ring once per thread.
+ *
+ * Blocking calls run on a ring owned by the calling thread and take a pooled
+ * connection per call. Async calls are served by one event-loop thread that
+ * pipelines up to pipelineDepth requests per connection; responses arrive in
+ * request order. A request that is cancelled or misses its deadline completes
+ * at once, and its response is discarded when it arrives.
+ *
+ * Every other endpoint, and every request when the kernel lacks io_uring (or
+ * a seccomp policy blocks it), goes to the fallback transport, typically a
+ * NetworkAdapter, so the decorator can be placed in front of any stack.
+ */
+class PROJECT_EXPORT UringTransport final : public Transport {
+public:
+    /**
+     * @brief Constructs the decorator.
+     * @param options Endpoint selection and connection settings.
+     * @param fallback Serves endpoints not selected for io_uring; must outlive this object.
+     */
+    UringTransport(UringTransportOptions options, Transport& fallback);
+
+    /**
+     * @brief Stops the async engine, failing its pending requests, and closes every connection.
+     */
+    ~UringTransport() override;
+
+    UringTransport(const UringTransport&) = delete;
+    UringTransport& operator=(const UringTransport&) = delete;
+
+    /**
+     * @brief Checks whether the running kernel allows io_uring.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Checks whether requests to an endpoint are served by io_uring rather than the fallback.
+     * @param url The endpoint, e.g. "http://127.0.0.1:8545".
+     */
+    bool servesEndpoint(const std::string& url);
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestInto
+     *
+     * A request that finds its pooled connection closed by the node (after an
+     * idle timeout) is retried once on a fresh connection, as libcurl does, but
+     * only if none of it was sent or its methods are idempotent: a closed
+     * connection does not prove the node ignored what it received.
+     */
+    bool sendPostRequestInto(const std::string& url, const std::string& data, std::string& response,
+                             RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestStreaming
+     *
+     * Always sent through the fallback, whose libcurl handles deliver the body as it
+     * arrives; the io_uring path reads whole responses only.
+     */
+    bool sendPostRequestStreaming(const std::string& url, const std::string& data, const ChunkCallback& onChunk,
+                                  RequestContext* context = nullptr) override;
+
+    /**
+     * @copydoc Transport::sendPostRequestAsync
+     *
+     * Callbacks of io_uring endpoints run on the engine thread and must not block.
+     */
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback,
+                              RequestContext* context = nullptr) override;
+
+private:
+    struct Endpoint;
+    class Engine;
+
+    /**
+     * @brief Returns the endpoint's state, or nullptr if the fallback serves it.
+     */
+    Endpoint* endpoint(const std::string& url);
+
+    /**
+     * @brief Returns the async engine, starting it on first use; nullptr if it could not start.
+     */
+    Engine* engine();
+
+    /**
+     * @brief Takes an idle connection of the endpoint, connecting or waiting for one if needed.
+     * @param reused Set to whether the connection has carried a request before.
+     * @return The socket, or -1 if connecting failed or the deadline passed.
+     */
+    int acquireConnection(Endpoint& endpoint, std::chrono::steady_clock::time_point deadline, bool& reused);
+
+    /**
+     * @brief Returns a connection to the pool, or closes it if it may not be reused.
+     */
+    void releaseConnection(Endpoint& endpoint, int socket, bool keep);
+
+    UringTransportOptions options; ///< Endpoint selection and connection settings.
+    Transport& fallback;           ///< Serves every other endpoint.
+    std::shared_mutex endpointsMutex; ///< Guards the endpoint map; lookups take it shared.
+    std::unordered_map<std::string, Scope<Endpoint>> endpoints; ///< Endpoint state keyed by URL, including endpoints left to the fallback.
+    std::once_flag engineInitFlag; ///< Guards lazy creation of the async engine.
+    Scope<Engine> asyncEngine;     ///< Pipelining event loop behind sendPostRequestAsync.
+};
+
+#endif // URINGTRANSPORT_HPP
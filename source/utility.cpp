@@ -4,41 +4,111 @@
 #include <fstream>
 #include <vector>
 
-std::optional<std::string> loadConfig(const std::string& filename) {
+namespace {
+std::vector<std::string> configCandidates(const std::string& filename) {
     std::vector<std::string> candidates = {filename};
     if (filename == "config.json") {
         candidates.emplace_back("config/system-config.json");
         candidates.emplace_back("system-config.json");
     }
+    return candidates;
+}
+
+std::optional<Json::Value> readConfig(const std::string& candidate) {
+    std::ifstream configFile(candidate);
+    if (!configFile.is_open()) {
+        return std::nullopt;
+    }
+
+    Json::Value config;
+    Json::CharReaderBuilder reader;
+    std::string errs;
+    if (!Json::parseFromStream(reader, configFile, &config, &errs)) {
+        Logger::getInstance().log("Failed to parse config file '" + candidate + "': " + errs);
+        return std::nullopt;
+    }
+    return config;
+}
 
-    for (const auto& candidate : candidates) {
-        std::ifstream configFile(candidate);
-        if (!configFile.is_open()) {
+/**
+ * @brief Looks a key up at the top level of the configuration, then under "system".
+ */
+const Json::Value* findSetting(const Json::Value& config, const char* key) {
+    if (config.isMember(key)) {
+        return &config[key];
+    }
+    if (config.isMember("system") && config["system"].isObject() && config["system"].isMember(key)) {
+        return &config["system"][key];
+    }
+    return nullptr;
+}
+}
+
+std::optional<std::string> loadConfig(const std::string& filename) {
+    for (const auto& candidate : configCandidates(filename)) {
+        const auto config = readConfig(candidate);
+        if (!config) {
             continue;
         }
 
-        Json::Value config;
-        Json::CharReaderBuilder reader;
-        std::string errs;
-        if (!Json::parseFromStream(reader, configFile, &config, &errs)) {
-            Logger::getInstance().log("Failed to parse config file '" + candidate + "': " + errs);
+        if (const Json::Value* nodeUrl = findSetting(*config, "nodeUrl"); nodeUrl && nodeUrl->isString()) {
+            return nodeUrl->asString();
+        }
+
+        Logger::getInstance().log("nodeUrl not found in config file '" + candidate + "'.");
+    }
+
+    Logger::getInstance().log("Could not load nodeUrl from config. Checked starting from: " + filename);
+    return std::nullopt;
+}
+
+std::optional<LoadBalancerOptions> loadEndpoints(const std::string& filename) {
+    for (const auto& candidate : configCandidates(filename)) {
+        const auto config = readConfig(candidate);
+        if (!config) {
             continue;
         }
 
-        if (config.isMember("nodeUrl") && config["nodeUrl"].isString()) {
-            return config["nodeUrl"].asString();
+        LoadBalancerOptions options;
+        if (const Json::Value* endpoints = findSetting(*config, "endpoints"); endpoints && endpoints->isArray()) {
+            for (const Json::Value& entry : *endpoints) {
+                EndpointConfig endpoint;
+                if (entry.isString()) {
+                    endpoint.url = entry.asString();
+                } else if (entry.isObject() && entry["url"].isString()) {
+                    endpoint.url = entry["url"].asString();
+                    const Json::Value& weight = entry["weight"];
+                    if (!weight.isNull() && !weight.isNumeric()) {
+                        Logger::getInstance().log("Ignoring endpoint '" + endpoint.url + "' with a non-numeric weight in config file '"
+                                                  + candidate + "'.");
+                        continue;
+                    }
+                    endpoint.weight = weight.isNull() ? 1.0 : weight.asDouble();
+                } else {
+                    Logger::getInstance().log("Ignoring malformed endpoint entry in config file '" + candidate + "'.");
+                    continue;
+                }
+                options.endpoints.push_back(std::move(endpoint));
+            }
+        } else if (const Json::Value* nodeUrl = findSetting(*config, "nodeUrl"); nodeUrl && nodeUrl->isString()) {
+            options.endpoints.push_back({nodeUrl->asString()});
         }
 
-        if (config.isMember("system")
-            && config["system"].isObject()
-            && config["system"].isMember("nodeUrl")
-            && config["system"]["nodeUrl"].isString()) {
-            return config["system"]["nodeUrl"].asString();
+        if (const Json::Value* sticky = findSetting(*config, "stickyMethods"); sticky && sticky->isArray()) {
+            options.stickyMethods.clear();
+            for (const Json::Value& method : *sticky) {
+                if (method.isString()) {
+                    options.stickyMethods.insert(method.asString());
+                }
+            }
         }
 
-        Logger::getInstance().log("nodeUrl not found in config file '" + candidate + "'.");
+        if (!options.endpoints.empty()) {
+            return options;
+        }
+        Logger::getInstance().log("No endpoints found in config file '" + candidate + "'.");
     }
 
-    Logger::getInstance().log("Could not load nodeUrl from config. Checked starting from: " + filename);
+    Logger::getInstance().log("Could not load endpoints from config. Checked starting from: " + filename);
     return std::nullopt;
 }
@@ -3,6 +3,7 @@
 
 #include "common.hpp"
 #include <json/json.h>
+#include "loadbalancer.hpp"
 
 /**
  * @file utility.hpp
@@ -23,4 +24,16 @@
  */
 std::optional<std::string> loadConfig(const std::string& filename = "config.json");
 
+/**
+ * @brief Loads the endpoint set for a LoadBalancer from a JSON configuration file.
+ * @param filename The name of the configuration file to load (default is "config.json").
+ * @return The configured endpoints and sticky methods, or an empty std::optional if none are found.
+ *
+ * Reads an "endpoints" array whose entries are either URL strings or objects of the form
+ * {"url": "...", "weight": 2.0}, and an optional "stickyMethods" array of method names
+ * that replaces the default list. Both may also live under "system". A configuration
+ * without "endpoints" yields its single "nodeUrl" as the only endpoint.
+ */
+std::optional<LoadBalancerOptions> loadEndpoints(const std::string& filename = "config.json");
+
 #endif // UTILITY_HPP
@@ -0,0 +1,470 @@
+#include "websocketadapter.hpp"
+#include "curlshare.hpp"
+#include "logger.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr std::size_t kReceiveChunkSize = 64 * 1024;
+constexpr int kIdlePollMilliseconds = 1000;
+
+/**
+ * @brief Calls curl_ws_recv(); deduces its frame pointer type, which became const in libcurl 8.
+ */
+template<typename Frame>
+CURLcode receiveFrame(CURLcode (*receive)(CURL*, void*, size_t, size_t*, Frame**),
+                      CURL* curl, void* buffer, std::size_t length, std::size_t* received, const curl_ws_frame** frame) {
+    Frame* meta = nullptr;
+    const CURLcode res = receive(curl, buffer, length, received, &meta);
+    *frame = meta;
+    return res;
+}
+}
+
+struct WebSocketAdapter::Subscription {
+    Json::Value params;            ///< eth_subscribe parameters, replayed on reconnect.
+    NotificationCallback callback; ///< Receives notification results.
+    std::string serverId;          ///< Subscription id assigned by the node on the current connection.
+    std::function<void(bool)> firstConfirmation; ///< Wakes subscribe() once the node first answers.
+};
+
+WebSocketAdapter::WebSocketAdapter(std::string url, WebSocketAdapterOptions options)
+    : url(std::move(url)), options(std::move(options)) {
+#if defined(_WIN32)
+    Logger::getInstance().log("WebSocket transport is not supported on this platform.");
+#else
+    if (!CurlShare::initializeGlobals()) {
+        Logger::getInstance().log("libcurl global initialization failed.");
+        return;
+    }
+    bool hasWebSockets = false;
+    for (const char* const* protocol = curl_version_info(CURLVERSION_NOW)->protocols; *protocol; ++protocol) {
+        hasWebSockets = hasWebSockets || std::string_view(*protocol) == "ws";
+    }
+    if (!hasWebSockets) {
+        Logger::getInstance().log("libcurl was built without WebSocket support; cannot connect to " + this->url);
+        return;
+    }
+    if (pipe2(wakePipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        Logger::getInstance().log("Failed to create wake pipe for WebSocket transport: " + std::string(std::strerror(errno)));
+        return;
+    }
+    worker = std::thread([this]() { run(); });
+#endif
+}
+
+WebSocketAdapter::~WebSocketAdapter() {
+    stopping = true;
+    wakeUp();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    resetConnectionState();
+#if !defined(_WIN32)
+    for (int& fd : wakePipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+#endif
+}
+
+std::optional<std::uint64_t> WebSocketAdapter::subscribe(const Json::Value& params, NotificationCallback callback) {
+    if (!worker.joinable()) {
+        Logger::getInstance().log("WebSocket transport is not running; cannot subscribe on " + url);
+        return std::nullopt;
+    }
+    if (std::this_thread::get_id() == worker.get_id()) {
+        // Only the connection thread can deliver the confirmation, so waiting here would never end.
+        Logger::getInstance().log("subscribe() called from a WebSocket callback; subscribe from another thread instead.");
+        return std::nullopt;
+    }
+
+    auto confirmed = CreateRef<std::promise<bool>>();
+    auto future = confirmed->get_future();
+
+    auto subscription = CreateRef<Subscription>();
+    subscription->params = params;
+    subscription->callback = std::move(callback);
+    subscription->firstConfirmation = [confirmed](bool accepted) { confirmed->set_value(accepted); };
+
+    const std::uint64_t handle = nextHandle.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        subscriptions.emplace(handle, subscription);
+        // While disconnected the connection thread subscribes everything as soon as it is back.
+        if (connected) {
+            subscribeLocked(handle, subscription);
+        }
+    }
+    wakeUp();
+
+    if (future.wait_for(options.requestTimeout) == std::future_status::ready && !future.get()) {
+        return std::nullopt;
+    }
+    return handle;
+}
+
+std::optional<std::uint64_t> WebSocketAdapter::subscribeNewHeads(NotificationCallback callback) {
+    Json::Value params(Json::arrayValue);
+    params.append("newHeads");
+    return subscribe(params, std::move(callback));
+}
+
+std::optional<std::uint64_t> WebSocketAdapter::subscribeLogs(const Json::Value& filter, NotificationCallback callback) {
+    Json::Value params(Json::arrayValue);
+    params.append("logs");
+    params.append(filter);
+    return subscribe(params, std::move(callback));
+}
+
+std::optional<std::uint64_t> WebSocketAdapter::subscribeNewPendingTransactions(NotificationCallback callback) {
+    Json::Value params(Json::arrayValue);
+    params.append("newPendingTransactions");
+    return subscribe(params, std::move(callback));
+}
+
+bool WebSocketAdapter::unsubscribe(std::uint64_t handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = subscriptions.find(handle);
+        if (it == subscriptions.end()) {
+            return false;
+        }
+        const std::string serverId = it->second->serverId;
+        subscriptions.erase(it);
+        if (serverId.empty()) {
+            return true;
+        }
+        serverIds.erase(serverId);
+        if (connected) {
+            Json::Value params(Json::arrayValue);
+            params.append(serverId);
+            queueRequestLocked("eth_unsubscribe", params, [serverId](const Json::Value& response) {
+                if (response.isObject() && response.isMember("error")) {
+                    Logger::getInstance().log("eth_unsubscribe failed for subscription " + serverId + ": "
+                                              + response["error"].get("message", "").asString());
+                }
+            });
+        }
+    }
+    wakeUp();
+    return true;
+}
+
+bool WebSocketAdapter::isSubscribed(std::uint64_t handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = subscriptions.find(handle);
+    return it != subscriptions.end() && !it->second->serverId.empty();
+}
+
+bool WebSocketAdapter::isConnected() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return connected;
+}
+
+void WebSocketAdapter::run() {
+    std::chrono::milliseconds delay = options.reconnectDelay;
+    while (!stopping) {
+        CURL* curl = connect();
+        if (!curl) {
+            waitFor(delay);
+            delay = std::min(delay * 2, options.maxReconnectDelay);
+            continue;
+        }
+        delay = options.reconnectDelay;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connected = true;
+            for (const auto& [handle, subscription] : subscriptions) {
+                subscribeLocked(handle, subscription);
+            }
+        }
+
+        const bool closedByUs = serve(curl);
+        if (closedByUs) {
+            sendFrame(curl, {}, CURLWS_CLOSE);
+        } else if (!stopping) {
+            Logger::getInstance().log("WebSocket connection lost: " + url);
+        }
+        curl_easy_cleanup(curl);
+        resetConnectionState();
+    }
+}
+
+CURL* WebSocketAdapter::connect() const {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        Logger::getInstance().log("Failed to create CURL handle for WebSocket transport.");
+        return nullptr;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 2L); // Perform the HTTP upgrade, then hand the socket to curl_ws_*.
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(options.connectTimeout.count()));
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    const CURLcode res = curl_easy_perform(curl);
+    if (res != CURLE_OK) {
+        Logger::getInstance().log("WebSocket connect to '" + url + "' failed: " + curl_easy_strerror(res));
+        curl_easy_cleanup(curl);
+        return nullptr;
+    }
+    return curl;
+}
+
+bool WebSocketAdapter::serve(CURL* curl) {
+#if defined(_WIN32)
+    (void)curl;
+    return true;
+#else
+    curl_socket_t socket = CURL_SOCKET_BAD;
+    if (curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket) != CURLE_OK || socket == CURL_SOCKET_BAD) {
+        return false;
+    }
+
+    std::string message;
+    std::array<char, kReceiveChunkSize> chunk {};
+    bool readable = true; // Frames may already be buffered from the upgrade response.
+
+    while (!stopping) {
+        if (!flushOutgoing(curl)) {
+            return false;
+        }
+
+        std::array<pollfd, 2> fds {};
+        fds[0].fd = socket;
+        fds[0].events = POLLIN;
+        fds[1].fd = wakePipe[0];
+        fds[1].events = POLLIN;
+        if (poll(fds.data(), fds.size(), readable ? 0 : kIdlePollMilliseconds) < 0 && errno != EINTR) {
+            Logger::getInstance().log("poll failed in WebSocket transport: " + std::string(std::strerror(errno)));
+            return false;
+        }
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+        }
+        readable = readable || (fds[0].revents & (POLLIN | POLLERR | POLLHUP));
+        if (!readable) {
+            continue;
+        }
+        readable = false;
+
+        // Drain everything curl has buffered; a single readiness event may carry several frames.
+        while (true) {
+            std::size_t received = 0;
+            const curl_ws_frame* frame = nullptr;
+            const CURLcode res = receiveFrame(&curl_ws_recv, curl, chunk.data(), chunk.size(), &received, &frame);
+            if (res == CURLE_AGAIN) {
+                break;
+            }
+            if (res != CURLE_OK) {
+                if (res != CURLE_GOT_NOTHING) {
+                    Logger::getInstance().log("WebSocket receive failed: " + std::string(curl_easy_strerror(res)));
+                }
+                return false;
+            }
+            if (frame->flags & CURLWS_CLOSE) {
+                return false;
+            }
+            if (!(frame->flags & (CURLWS_TEXT | CURLWS_BINARY | CURLWS_CONT))) {
+                continue; // Control frames; libcurl answers pings itself.
+            }
+            message.append(chunk.data(), received);
+            if (frame->bytesleft == 0 && !(frame->flags & CURLWS_CONT)) {
+                handleMessage(message);
+                message.clear();
+            }
+        }
+    }
+    return true;
+#endif
+}
+
+bool WebSocketAdapter::flushOutgoing(CURL* curl) {
+    std::deque<std::string> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.swap(outgoing);
+    }
+    for (const std::string& message : batch) {
+        if (!sendFrame(curl, message, CURLWS_TEXT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WebSocketAdapter::sendFrame(CURL* curl, std::string_view payload, unsigned int flags) {
+#if defined(_WIN32)
+    (void)curl;
+    (void)payload;
+    (void)flags;
+    return false;
+#else
+    std::size_t offset = 0;
+    do {
+        std::size_t sent = 0;
+        const CURLcode res = curl_ws_send(curl, payload.data() + offset, payload.size() - offset, &sent, 0, flags);
+        offset += sent;
+        if (res == CURLE_AGAIN) {
+            curl_socket_t socket = CURL_SOCKET_BAD;
+            curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket);
+            pollfd writable {socket, POLLOUT, 0};
+            poll(&writable, 1, kIdlePollMilliseconds);
+            continue;
+        }
+        if (res != CURLE_OK) {
+            Logger::getInstance().log("WebSocket send failed: " + std::string(curl_easy_strerror(res)));
+            return false;
+        }
+    } while (offset < payload.size());
+    return true;
+#endif
+}
+
+void WebSocketAdapter::handleMessage(const std::string& message) {
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    Json::Value root;
+    std::string errors;
+    if (!reader->parse(message.data(), message.data() + message.size(), &root, &errors) || !root.isObject()) {
+        Logger::getInstance().log("Ignoring malformed WebSocket message: " + errors);
+        return;
+    }
+
+    if (root.isMember("id") && root["id"].isUInt64()) {
+        ResponseHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = pendingRequests.find(root["id"].asUInt64());
+            if (it != pendingRequests.end()) {
+                handler = std::move(it->second);
+                pendingRequests.erase(it);
+            }
+        }
+        if (handler) {
+            handler(root);
+        }
+        return;
+    }
+
+    if (root.get("method", "").asString() != "eth_subscription") {
+        return;
+    }
+    const Json::Value& params = root["params"];
+    const std::string serverId = params.get("subscription", "").asString();
+
+    Ref<Subscription> subscription;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto id = serverIds.find(serverId);
+        if (id != serverIds.end()) {
+            auto it = subscriptions.find(id->second);
+            if (it != subscriptions.end()) {
+                subscription = it->second;
+            }
+        }
+    }
+    if (subscription && subscription->callback) {
+        subscription->callback(params["result"]);
+    }
+}
+
+void WebSocketAdapter::subscribeLocked(std::uint64_t handle, const Ref<Subscription>& subscription) {
+    queueRequestLocked("eth_subscribe", subscription->params, [this, handle, subscription](const Json::Value& response) {
+        if (response.isNull()) {
+            return; // Connection dropped; the subscription is replayed after reconnecting.
+        }
+
+        const bool accepted = response["result"].isString();
+        std::function<void(bool)> firstConfirmation;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            firstConfirmation = std::exchange(subscription->firstConfirmation, nullptr);
+            auto it = subscriptions.find(handle);
+            const bool live = it != subscriptions.end() && it->second == subscription;
+
+            if (accepted && live) {
+                subscription->serverId = response["result"].asString();
+                serverIds[subscription->serverId] = handle;
+            } else if (accepted) {
+                // Unsubscribed before the node answered; release the node-side subscription.
+                Json::Value params(Json::arrayValue);
+                params.append(response["result"]);
+                queueRequestLocked("eth_unsubscribe", params, nullptr);
+            } else {
+                Logger::getInstance().log("eth_subscribe rejected: " + response["error"].get("message", "").asString());
+                if (live && firstConfirmation) {
+                    subscriptions.erase(it);
+                }
+            }
+        }
+        if (firstConfirmation) {
+            firstConfirmation(accepted);
+        }
+    });
+}
+
+void WebSocketAdapter::queueRequestLocked(const std::string& method, const Json::Value& params, ResponseHandler handler) {
+    const std::uint64_t id = nextRequestId++;
+    Json::Value request;
+    request["jsonrpc"] = "2.0";
+    request["method"] = method;
+    request["params"] = params;
+    request["id"] = Json::UInt64(id);
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    outgoing.push_back(Json::writeString(writer, request));
+    if (handler) {
+        pendingRequests.emplace(id, std::move(handler));
+    }
+}
+
+void WebSocketAdapter::resetConnectionState() {
+    std::unordered_map<std::uint64_t, ResponseHandler> failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        connected = false;
+        serverIds.clear();
+        for (auto& [handle, subscription] : subscriptions) {
+            subscription->serverId.clear();
+        }
+        outgoing.clear();
+        failed.swap(pendingRequests);
+    }
+    for (auto& [id, handler] : failed) {
+        handler(Json::Value());
+    }
+}
+
+void WebSocketAdapter::wakeUp() {
+#if !defined(_WIN32)
+    if (wakePipe[1] >= 0) {
+        const char byte = 1;
+        [[maybe_unused]] const ssize_t written = write(wakePipe[1], &byte, 1);
+    }
+#endif
+}
+
+void WebSocketAdapter::waitFor(std::chrono::milliseconds delay) {
+#if !defined(_WIN32)
+    pollfd wake {wakePipe[0], POLLIN, 0};
+    if (poll(&wake, 1, static_cast<int>(delay.count())) > 0) {
+        char drain[64];
+        while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+    }
+#else
+    std::this_thread::sleep_for(delay);
+#endif
+}
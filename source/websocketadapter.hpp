@@ -0,0 +1,148 @@
+#ifndef WEBSOCKETADAPTER_HPP
+#define WEBSOCKETADAPTER_HPP
+
+#include "common.hpp"
+#include <curl/curl.h>
+#include <json/json.h>
+
+/**
+ * @struct WebSocketAdapterOptions
+ * @brief Timeouts and reconnect behaviour of the WebSocket transport.
+ */
+struct WebSocketAdapterOptions {
+    std::chrono::milliseconds requestTimeout = std::chrono::seconds(30);  ///< How long subscribe() waits for the node to confirm.
+    std::chrono::milliseconds connectTimeout = std::chrono::seconds(10);  ///< Budget for TCP/TLS connect and the HTTP upgrade.
+    std::chrono::milliseconds reconnectDelay = std::chrono::milliseconds(500); ///< First delay before reconnecting; doubles per failure.
+    std::chrono::milliseconds maxReconnectDelay = std::chrono::seconds(30); ///< Upper bound of the reconnect delay.
+};
+
+/**
+ * @class WebSocketAdapter
+ * @brief Persistent WebSocket connection for eth_subscribe push notifications.
+ *
+ * The adapter keeps one WebSocket connection open on a background thread and
+ * dispatches "eth_subscription" notifications to per-subscription callbacks,
+ * replacing polling loops such as repeated getBlockNumber() calls.
+ *
+ * Subscriptions are owned locally and identified by a handle that stays valid
+ * across reconnects: when the connection drops the adapter reconnects with
+ * exponential backoff and re-issues eth_subscribe for every live subscription.
+ *
+ * Callbacks run on the connection thread and must not block. In particular they
+ * must not call subscribe(), which waits for the connection thread and therefore
+ * fails immediately when called from it; unsubscribe() does not wait and may be
+ * called from a callback.
+ */
+class PROJECT_EXPORT WebSocketAdapter {
+public:
+    /**
+     * @brief Callback receiving the "result" of each notification.
+     */
+    using NotificationCallback = std::function<void(const Json::Value& result)>;
+
+    /**
+     * @brief Starts connecting to the given WebSocket endpoint in the background.
+     * @param url The endpoint, e.g. "ws://127.0.0.1:8546" or "wss://...".
+     * @param options Timeouts and reconnect behaviour.
+     */
+    explicit WebSocketAdapter(std::string url, WebSocketAdapterOptions options = {});
+
+    /**
+     * @brief Closes the connection and stops the background thread.
+     */
+    ~WebSocketAdapter();
+
+    WebSocketAdapter(const WebSocketAdapter&) = delete;
+    WebSocketAdapter& operator=(const WebSocketAdapter&) = delete;
+    WebSocketAdapter(WebSocketAdapter&&) = delete;
+    WebSocketAdapter& operator=(WebSocketAdapter&&) = delete;
+
+    /**
+     * @brief Subscribes to an arbitrary eth_subscribe kind.
+     * @param params The eth_subscribe parameters, e.g. ["logs", {filter}].
+     * @param callback Invoked with each notification result.
+     * @return A local subscription handle, or an empty std::optional if the node rejected it.
+     *
+     * Waits up to the request timeout for the node to confirm, including while the
+     * connection is still being established. If no answer arrives in time the handle
+     * is still returned, but the subscription is only queued: it is sent again once
+     * the node is reachable, and dropped if the node then rejects it. A handle alone
+     * therefore does not prove the node accepted; isSubscribed() tells the two apart.
+     * Fails immediately when called from a notification callback.
+     */
+    std::optional<std::uint64_t> subscribe(const Json::Value& params, NotificationCallback callback);
+
+    /**
+     * @brief Subscribes to new block headers ("newHeads").
+     */
+    std::optional<std::uint64_t> subscribeNewHeads(NotificationCallback callback);
+
+    /**
+     * @brief Subscribes to logs matching a filter ("logs").
+     * @param filter The filter object (address, topics).
+     */
+    std::optional<std::uint64_t> subscribeLogs(const Json::Value& filter, NotificationCallback callback);
+
+    /**
+     * @brief Subscribes to hashes of new pending transactions ("newPendingTransactions").
+     */
+    std::optional<std::uint64_t> subscribeNewPendingTransactions(NotificationCallback callback);
+
+    /**
+     * @brief Cancels a subscription and sends eth_unsubscribe if it is live on the node.
+     * @param handle The handle returned by subscribe().
+     * @return True if the handle referred to a live subscription.
+     */
+    bool unsubscribe(std::uint64_t handle);
+
+    /**
+     * @brief Checks whether the node has confirmed a subscription on the current connection.
+     * @param handle The handle returned by subscribe().
+     * @return False while the subscription is queued or being re-established after a
+     *         reconnect, and for handles that were unsubscribed or rejected.
+     */
+    bool isSubscribed(std::uint64_t handle) const;
+
+    /**
+     * @brief Checks whether the WebSocket connection is currently established.
+     */
+    bool isConnected() const;
+
+private:
+    struct Subscription;
+
+    /**
+     * @brief Handler of a JSON-RPC response; receives a null value if the connection dropped.
+     */
+    using ResponseHandler = std::function<void(const Json::Value& response)>;
+
+    void run();
+    CURL* connect() const;
+    bool serve(CURL* curl);
+    bool flushOutgoing(CURL* curl);
+    bool sendFrame(CURL* curl, std::string_view payload, unsigned int flags);
+    void handleMessage(const std::string& message);
+    void subscribeLocked(std::uint64_t handle, const Ref<Subscription>& subscription);
+    void queueRequestLocked(const std::string& method, const Json::Value& params, ResponseHandler handler);
+    void resetConnectionState();
+    void wakeUp();
+    void waitFor(std::chrono::milliseconds delay);
+
+    std::string url; ///< The WebSocket endpoint.
+    WebSocketAdapterOptions options; ///< Timeouts and reconnect behaviour.
+
+    mutable std::mutex mutex; ///< Guards the state below.
+    std::map<std::uint64_t, Ref<Subscription>> subscriptions; ///< Live subscriptions by local handle.
+    std::unordered_map<std::string, std::uint64_t> serverIds; ///< Node subscription id to local handle.
+    std::unordered_map<std::uint64_t, ResponseHandler> pendingRequests; ///< Handlers by JSON-RPC request id.
+    std::deque<std::string> outgoing; ///< Messages waiting to be written by the connection thread.
+    std::uint64_t nextRequestId = 1; ///< Next JSON-RPC request id.
+    bool connected = false; ///< Whether the connection is up.
+
+    std::atomic<std::uint64_t> nextHandle {1}; ///< Next local subscription handle.
+    std::atomic<bool> stopping {false}; ///< Set when the adapter is being destroyed.
+    int wakePipe[2] = {-1, -1}; ///< Self-pipe that interrupts the connection thread's poll.
+    std::thread worker; ///< The connection thread.
+};
+
+#endif // WEBSOCKETADAPTER_HPP
@@ -0,0 +1,192 @@
+/**
+ * @file ethereumclientbatchtest.cpp
+ * @brief Tests of EthereumClient::executeBatch() against a node built on LoopbackTransport.
+ *
+ * The node answers each call of a batch through a LoopbackTransport, then a
+ * per-test script reorders, drops or duplicates the answers, or replaces them
+ * with one error object, the way real nodes and proxies do.
+ */
+#include "ethereumclient.hpp"
+#include "loopbacktransport.hpp"
+#include <iostream>
+
+namespace {
+std::size_t failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "FAIL: " << what << std::endl;
+    }
+}
+
+/**
+ * @brief Answers batch arrays element by element through a LoopbackTransport and lets a script reshape the answers.
+ */
+class ScriptedNode final : public Transport {
+public:
+    /**
+     * @brief Turns the answers of a batch, in request order, into the response body; std::nullopt fails the request.
+     */
+    using Script = std::function<std::optional<std::string>(std::vector<std::string>& answers)>;
+
+    ScriptedNode() {
+        loopback.setGenerator("eth_getBalance", [](std::string_view request) {
+            // The result names the call, so a misrouted answer shows.
+            const std::size_t open = request.find("[\"");
+            return std::string(request.substr(open + 1, request.find('"', open + 2) - open));
+        });
+    }
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override {
+        bodies.push_back(data);
+        std::vector<std::string> answers;
+        const std::string_view text(data);
+        for (const JsonSpan& span : findElementSpans(text)) {
+            answers.push_back(*loopback.sendPostRequest(url, std::string(text.substr(span.begin, span.end - span.begin))));
+        }
+        if (script) {
+            return script(answers);
+        }
+        return join(answers);
+    }
+
+    void sendPostRequestAsync(const std::string& url, const std::string& data, Callback callback, RequestContext*) override {
+        callback(sendPostRequest(url, data));
+    }
+
+    static std::string join(const std::vector<std::string>& answers) {
+        std::string body = "[";
+        for (const std::string& answer : answers) {
+            body += (body.size() > 1 ? "," : "") + answer;
+        }
+        return body + "]";
+    }
+
+    Script script;                   ///< Reshapes the answers; joins them in order if empty.
+    std::vector<std::string> bodies; ///< Every request received.
+
+private:
+    LoopbackTransport loopback;
+};
+
+BatchRequest balances(std::size_t count) {
+    BatchRequest batch;
+    for (std::size_t i = 0; i < count; ++i) {
+        Json::Value params(Json::arrayValue);
+        params.append("a" + std::to_string(i));
+        params.append("latest");
+        batch.add("eth_getBalance", params);
+    }
+    return batch;
+}
+
+bool answered(const BatchResult& result, std::size_t call) {
+    return result.failure == FailureKind::None && result.result && *result.result == "a" + std::to_string(call);
+}
+
+void testShuffled() {
+    ScriptedNode node;
+    node.script = [](std::vector<std::string>& answers) {
+        std::swap(answers.front(), answers.back());
+        std::reverse(answers.begin() + 1, answers.end() - 1);
+        return ScriptedNode::join(answers);
+    };
+    EthereumClient client("loopback", node);
+    const std::vector<BatchResult> results = client.executeBatch(balances(6));
+    check(results.size() == 6 && node.bodies.size() == 1, "six calls go out as one batch");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        check(answered(results[i], i), "shuffled answer " + std::to_string(i) + " reaches its own call");
+    }
+}
+
+void testMissingAndDuplicate() {
+    ScriptedNode node;
+    node.script = [](std::vector<std::string>& answers) {
+        // Drop the answer of call 2 and repeat call 1 with a result that must not replace the first.
+        std::string duplicate = answers[1];
+        duplicate.replace(duplicate.find("\"a1\""), 4, "\"a9\"");
+        answers.erase(answers.begin() + 2);
+        answers.push_back(duplicate);
+        return ScriptedNode::join(answers);
+    };
+    EthereumClient client("loopback", node);
+    const std::vector<BatchResult> results = client.executeBatch(balances(4));
+    check(answered(results[0], 0) && answered(results[3], 3), "answered calls keep their results");
+    check(answered(results[1], 1), "a duplicate answer does not replace the first");
+    check(results[2].failure == FailureKind::Other && !results[2].result && !results[2].error, "unanswered call fails");
+}
+
+void testPerCallError() {
+    ScriptedNode node;
+    EthereumClient client("loopback", node);
+    BatchRequest batch = balances(2);
+    batch.add("eth_noSuchMethod");
+    const std::vector<BatchResult> results = client.executeBatch(batch);
+    check(answered(results[0], 0) && answered(results[1], 1), "calls beside a failing one are answered");
+    check(results[2].failure == FailureKind::RpcError && results[2].error && results[2].error->code == -32601,
+          "a call's own error is reported on that call");
+}
+
+void testWholeBatchError() {
+    ScriptedNode node;
+    node.script = [](std::vector<std::string>&) {
+        return std::string(R"({"jsonrpc":"2.0","id":null,"error":{"code":-32600,"message":"batch too large"}})");
+    };
+    EthereumClient client("loopback", node);
+    const std::vector<BatchResult> results = client.executeBatch(balances(3));
+    for (const BatchResult& result : results) {
+        check(result.failure == FailureKind::RpcError && result.error && result.error->code == -32600
+                  && result.error->message == "batch too large" && !result.result,
+              "a whole-batch error object fails every call with that error");
+    }
+}
+
+void testSplit() {
+    ScriptedNode node;
+    std::size_t part = 0;
+    node.script = [&part](std::vector<std::string>& answers) -> std::optional<std::string> {
+        // The second part fails in transit.
+        if (part++ == 1) {
+            return std::nullopt;
+        }
+        std::reverse(answers.begin(), answers.end());
+        return ScriptedNode::join(answers);
+    };
+    EthereumClient client("loopback", node);
+    client.setMaxBatchSize(4);
+    const std::vector<BatchResult> results = client.executeBatch(balances(10));
+
+    check(node.bodies.size() == 3, "ten calls with a limit of four go out as three batches");
+    std::set<std::string> ids;
+    std::vector<std::size_t> sizes;
+    for (const std::string& body : node.bodies) {
+        const std::vector<JsonSpan> spans = findIdSpans(body);
+        sizes.push_back(spans.size());
+        for (const JsonSpan& span : spans) {
+            ids.insert(body.substr(span.begin, span.end - span.begin));
+        }
+    }
+    check(sizes == std::vector<std::size_t> {4, 4, 2}, "parts carry four, four and two calls");
+    check(ids.size() == 10, "ids are unique across the parts");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (i >= 4 && i < 8) {
+            check(results[i].failure == FailureKind::Other && !results[i].result, "call " + std::to_string(i) + " of the failed part fails");
+        } else {
+            check(answered(results[i], i), "call " + std::to_string(i) + " of an answered part gets its result");
+        }
+    }
+    check(client.executeBatch(BatchRequest()).empty() && node.bodies.size() == 3, "an empty batch sends nothing");
+}
+}
+
+int main() {
+    testShuffled();
+    testMissingAndDuplicate();
+    testPerCallError();
+    testWholeBatchError();
+    testSplit();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
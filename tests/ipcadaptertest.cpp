@@ -0,0 +1,297 @@
+/**
+ * @file ipcadaptertest.cpp
+ * @brief Tests of IpcAdapter against an in-process stand-in node on a Unix domain socket.
+ *
+ * The stand-in answers each request with its first parameter as the result, or its
+ * method if there are none, and batches in reverse order. Three methods script its
+ * behaviour: "hold" is answered only after the next request, "silent" is never
+ * answered and "drop" closes the connection.
+ */
+#include "ipcadapter.hpp"
+#include <json/json.h>
+#include <future>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+std::size_t failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "FAIL: " << what << std::endl;
+    }
+}
+
+Json::Value parse(const std::string& text) {
+    Json::Value value;
+    Json::CharReaderBuilder builder;
+    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errors;
+    reader->parse(text.data(), text.data() + text.size(), &value, &errors);
+    return value;
+}
+
+std::string write(const Json::Value& value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
+
+std::string request(const std::string& id, const std::string& method, const std::string& param = "") {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"method\":\"" + method + "\",\"params\":["
+           + (param.empty() ? "" : "\"" + param + "\"") + "]}";
+}
+
+/**
+ * @brief Minimal newline-delimited JSON-RPC node on a Unix socket, one thread per connection.
+ */
+class StandInNode {
+public:
+    StandInNode() {
+        char directory[] = "/tmp/ipcadaptertest-XXXXXX";
+        if (mkdtemp(directory)) {
+            socketPath = std::string(directory) + "/node.ipc";
+        }
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0) {
+            std::cerr << "stand-in node cannot listen on " << socketPath << std::endl;
+        }
+        acceptor = std::thread([this]() { acceptLoop(); });
+    }
+
+    ~StandInNode() {
+        stopping = true;
+        shutdown(listener, SHUT_RDWR);
+        acceptor.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const int fd : open) {
+                shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        close(listener);
+        unlink(socketPath.c_str());
+        rmdir(socketPath.substr(0, socketPath.rfind('/')).c_str());
+    }
+
+    const std::string& path() const { return socketPath; }
+
+    std::size_t connectionsAccepted() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return accepted;
+    }
+
+private:
+    void acceptLoop() {
+        while (!stopping) {
+            const int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            ++accepted;
+            open.insert(fd);
+            threads.emplace_back([this, fd]() { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        std::vector<std::string> held;
+        char chunk[4096];
+        bool dropped = false;
+        while (!dropped) {
+            const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                break;
+            }
+            buffer.append(chunk, static_cast<std::size_t>(received));
+            for (std::size_t newline = buffer.find('\n'); newline != std::string::npos && !dropped; newline = buffer.find('\n')) {
+                const Json::Value message = parse(buffer.substr(0, newline));
+                buffer.erase(0, newline + 1);
+                if (message.isArray()) {
+                    Json::Value answers(Json::arrayValue);
+                    for (Json::ArrayIndex i = message.size(); i > 0; --i) {
+                        answers.append(answer(message[i - 1]));
+                    }
+                    sendLine(fd, write(answers));
+                    continue;
+                }
+                const std::string method = message["method"].asString();
+                if (method == "drop") {
+                    dropped = true;
+                } else if (method == "hold") {
+                    held.push_back(write(answer(message)));
+                } else if (method != "silent") {
+                    sendLine(fd, write(answer(message)));
+                    for (const std::string& text : held) {
+                        sendLine(fd, text);
+                    }
+                    held.clear();
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        open.erase(fd);
+        close(fd);
+    }
+
+    static Json::Value answer(const Json::Value& message) {
+        Json::Value response;
+        response["jsonrpc"] = "2.0";
+        response["id"] = message["id"];
+        response["result"] = message["params"].empty() ? message["method"] : message["params"][0];
+        return response;
+    }
+
+    static void sendLine(int fd, const std::string& text) {
+        const std::string line = text + "\n";
+        send(fd, line.data(), line.size(), MSG_NOSIGNAL);
+    }
+
+    std::string socketPath;
+    int listener = -1;
+    std::atomic<bool> stopping {false};
+    std::thread acceptor;
+    std::mutex mutex;
+    std::set<int> open;
+    std::vector<std::thread> threads;
+    std::size_t accepted = 0;
+};
+
+using Future = std::future<std::optional<std::string>>;
+
+Future sendAsync(IpcAdapter& adapter, const std::string& data,
+                 std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(),
+                 std::stop_token cancellation = {}) {
+    auto promise = CreateRef<std::promise<std::optional<std::string>>>();
+    Future future = promise->get_future();
+    adapter.sendRequestAsync(data, [promise](std::optional<std::string> response) {
+        promise->set_value(std::move(response));
+    }, deadline, std::move(cancellation));
+    return future;
+}
+
+std::optional<std::string> await(Future& future) {
+    if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+        return "no callback";
+    }
+    return future.get();
+}
+
+void testOutOfOrder(StandInNode& node) {
+    IpcAdapter adapter(node.path());
+    Future first = sendAsync(adapter, request("1", "hold", "first"));
+    Future second = sendAsync(adapter, request("1", "echo", "second"));
+    const std::optional<std::string> secondResponse = await(second);
+    const std::optional<std::string> firstResponse = await(first);
+    check(firstResponse && parse(*firstResponse)["result"] == "first", "held request gets its own answer");
+    check(secondResponse && parse(*secondResponse)["result"] == "second", "later request answered first gets its own answer");
+    check(firstResponse && parse(*firstResponse)["id"] == 1, "caller's id is restored");
+}
+
+void testBatch(StandInNode& node) {
+    IpcAdapter adapter(node.path());
+    const std::optional<std::string> response =
+        adapter.sendRequest("[" + request("7", "echo", "a") + "," + request("\"x\"", "echo", "b") + "]");
+    const Json::Value answers = response ? parse(*response) : Json::Value();
+    check(answers.isArray() && answers.size() == 2, "batch is answered as an array");
+    std::map<std::string, Json::Value> ids;
+    for (const Json::Value& answer : answers) {
+        ids[answer["result"].asString()] = answer["id"];
+    }
+    check(ids["a"] == 7 && ids["b"] == "x", "batch ids are restored, numeric and string");
+}
+
+void testDeadline(StandInNode& node) {
+    IpcAdapter adapter(node.path());
+    const auto start = std::chrono::steady_clock::now();
+    Future future = sendAsync(adapter, request("1", "silent"), start + std::chrono::milliseconds(100));
+    const std::optional<std::string> response = await(future);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    check(!response, "silent node fails the request at its deadline");
+    check(elapsed >= std::chrono::milliseconds(100) && elapsed < std::chrono::seconds(2), "deadline is honoured on time");
+
+    check(!adapter.sendRequest(request("2", "silent"), std::chrono::milliseconds(50)), "sync request times out");
+    check(adapter.sendRequest(request("3", "echo", "after")).has_value(), "connection still usable after timeouts");
+}
+
+void testCancellation(StandInNode& node) {
+    IpcAdapter adapter(node.path());
+    std::stop_source source;
+    Future future = sendAsync(adapter, request("1", "silent"), std::chrono::steady_clock::time_point::max(), source.get_token());
+    check(future.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout, "request waits before cancellation");
+    source.request_stop();
+    check(future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready && !future.get(),
+          "stop fails the request at once");
+
+    std::stop_source stopped;
+    stopped.request_stop();
+    check(!adapter.sendRequest(request("2", "silent"), std::chrono::seconds(5), stopped.get_token()),
+          "already cancelled sync request fails");
+}
+
+void testReconnect(StandInNode& node) {
+    IpcAdapter adapter(node.path());
+    const std::size_t before = node.connectionsAccepted();
+    Future pending = sendAsync(adapter, request("1", "silent"));
+    Future dropping = sendAsync(adapter, request("2", "drop"));
+    check(!await(pending) && !await(dropping), "pending requests fail when the node closes the socket");
+
+    const std::optional<std::string> response = adapter.sendRequest(request("3", "echo", "again"));
+    check(response && parse(*response)["result"] == "again", "next request reconnects");
+    check(node.connectionsAccepted() == before + 2, "exactly one reconnect");
+}
+
+void testResendFromFailureCallback(StandInNode& node) {
+    // A failure callback that sends again must not deadlock against a caller reconnecting at the same time.
+    IpcAdapter adapter(node.path());
+    std::promise<void> failing;
+    auto resent = CreateRef<std::promise<std::optional<std::string>>>();
+    Future resentFuture = resent->get_future();
+    adapter.sendRequestAsync(request("1", "silent"), [&adapter, &failing, resent](std::optional<std::string>) {
+        failing.set_value();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        adapter.sendRequestAsync(request("2", "echo", "resent"), [resent](std::optional<std::string> response) {
+            resent->set_value(std::move(response));
+        });
+    });
+    sendAsync(adapter, request("3", "drop"));
+    failing.get_future().wait();
+
+    auto caller = std::async(std::launch::async, [&adapter]() { return adapter.sendRequest(request("4", "echo", "caller")); });
+    if (caller.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+        std::cerr << "FAIL: reconnecting caller deadlocks against a resending callback" << std::endl;
+        std::_Exit(1);
+    }
+    const std::optional<std::string> callerResponse = caller.get();
+    const std::optional<std::string> resentResponse = await(resentFuture);
+    check(callerResponse && parse(*callerResponse)["result"] == "caller", "reconnecting caller is answered");
+    check(resentResponse && parse(*resentResponse)["result"] == "resent", "request sent from a failure callback is answered");
+}
+}
+
+int main() {
+    StandInNode node;
+    testOutOfOrder(node);
+    testBatch(node);
+    testDeadline(node);
+    testCancellation(node);
+    testReconnect(node);
+    testResendFromFailureCallback(node);
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file jsonscantest.cpp
+ * @brief Checks the JSON-RPC scanners of jsonscan.hpp on hand-written messages.
+ *
+ * The cases target what a scanner that does not parse can get wrong: quotes and
+ * backslashes inside strings, members of the same name in nested objects,
+ * whitespace around colons, string and null ids, and text cut off midway.
+ */
+#include "jsonscan.hpp"
+#include <iostream>
+
+namespace {
+std::size_t failures = 0;
+
+void check(bool condition, const std::string& what, std::string_view json) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "FAIL: " << what << "\n  json: " << json << std::endl;
+    }
+}
+
+std::string_view text(std::string_view json, const JsonSpan& span) {
+    return json.substr(span.begin, span.end - span.begin);
+}
+
+std::string_view text(std::string_view json, const std::optional<JsonSpan>& span) {
+    return span ? text(json, *span) : std::string_view("<none>");
+}
+
+std::vector<std::string_view> texts(std::string_view json, const std::vector<JsonSpan>& spans) {
+    std::vector<std::string_view> values;
+    for (const JsonSpan& span : spans) {
+        values.push_back(text(json, span));
+    }
+    return values;
+}
+
+void testIdSpans() {
+    struct Case {
+        std::string_view json;
+        std::vector<std::string_view> ids;
+    };
+    const Case cases[] = {
+        {R"({"jsonrpc":"2.0","id":7,"method":"eth_call"})", {"7"}},
+        {R"({"id" :  "ab\"c" ,"method":"x"})", {R"("ab\"c")"}},
+        {R"({"id":null,"result":1})", {"null"}},
+        {"{\n  \"method\" : \"id\",\n  \"id\"\t:\t\"a\\\\\"\n}", {R"("a\\")"}},
+        {R"({"params":[{"id":5},"\"id\":6"],"result":{"id":8},"id":1})", {"1"}},
+        {R"({"params":["a\\",{"id":2}],"id":3})", {"3"}},
+        {R"([{"id":1,"method":"a"}, {"params":{"id":9},"id":"two"} ,{"method":"c","id":null}])", {"1", R"("two")", "null"}},
+        {R"({"method":"eth_call","params":[]})", {}},
+        {R"({"method":"x","id":)", {}},
+        {R"({"method":"x","id":"ab)", {}},
+        {R"({"method":"x","id":12)", {}},
+        {R"([{"id":1},{"id":2)", {"1"}},
+    };
+    for (const Case& test : cases) {
+        check(texts(test.json, findIdSpans(test.json)) == test.ids, "findIdSpans", test.json);
+    }
+}
+
+void testMemberSpan() {
+    const std::string_view json = R"({ "jsonrpc" : "2.0", "result" : {"id":1,"error":2} , "error":{"code":-1},"s":"x\"}y\\"})";
+    check(text(json, findMemberSpan(json, "result")) == R"({"id":1,"error":2})", "object member, spaces around colon", json);
+    check(text(json, findMemberSpan(json, "error")) == R"({"code":-1})", "top-level member after a nested one of the same name", json);
+    check(text(json, findMemberSpan(json, "s")) == R"("x\"}y\\")", "string with escaped quote and trailing backslash", json);
+    check(!findMemberSpan(json, "id"), "nested member is not a top-level one", json);
+    check(!findMemberSpan(json, "code"), "member of a nested object is not found", json);
+    check(!findMemberSpan(R"(["id",1])", "id"), "array is not an object", "[\"id\",1]");
+
+    const std::string_view truncated = R"({"id":1,"result":"0x)";
+    check(text(truncated, findMemberSpan(truncated, "id")) == "1", "complete member before the cut", truncated);
+    check(!findMemberSpan(truncated, "result"), "member cut off by the end of the text", truncated);
+}
+
+void testElementSpans() {
+    const std::string_view json = R"([ {"a":"]"} , "x\"]" ,3,[1,[2]],null ])";
+    check(texts(json, findElementSpans(json)) == std::vector<std::string_view> {R"({"a":"]"})", R"("x\"]")", "3", "[1,[2]]", "null"},
+          "elements with brackets inside strings and nested arrays", json);
+    check(findElementSpans("[]").empty() && findElementSpans(" [ ] ").empty(), "empty array", "[]");
+    check(findElementSpans(R"({"a":[1]})").empty(), "object is not an array", R"({"a":[1]})");
+
+    const std::string_view truncated = R"([{"id":0,"result":"0x1"},{"id":1,"resu)";
+    check(texts(truncated, findElementSpans(truncated)) == std::vector<std::string_view> {R"({"id":0,"result":"0x1"})"},
+          "element cut off by the end of the text is left out", truncated);
+    check(texts("[1,23", findElementSpans("[1,23")) == std::vector<std::string_view> {"1"}, "cut-off number is left out", "[1,23");
+}
+
+void testMethods() {
+    check(findMethod(R"({"id":1, "method" : "eth_getBalance","params":[{"method":"no"}]})") == "eth_getBalance", "method of a request",
+          "findMethod");
+    check(findMethod(R"({"id":1,"params":[{"method":"nested"}]})").empty(), "nested method is not the request's", "findMethod");
+    check(findMethod(R"({"id":1,"method":"eth_)").empty(), "cut-off method", "findMethod");
+
+    const std::string_view batch = R"([{"method":"a","params":["\"method\":\"b\""]},{"id":2},{"id":3,"method":"c"}])";
+    check(findMethods(batch) == std::vector<std::string_view> {"a", "", "c"}, "methods of a batch", batch);
+    check(findMethods(R"({"method":"single"})") == std::vector<std::string_view> {"single"}, "method of a single request", "findMethods");
+}
+
+void testErrorCode() {
+    struct Case {
+        std::string_view json;
+        std::optional<int> code;
+    };
+    const Case cases[] = {
+        {R"({"jsonrpc":"2.0","id":1,"error":{"code":-32601,"message":"not found"}})", -32601},
+        {R"({ "id" : "x" , "error" : { "message" : "\"code\":1" , "data":{"code":5}, "code" : -32000 } })", -32000},
+        {R"({"id":1,"result":{"error":{"code":3}}})", std::nullopt},
+        {R"({"id":1,"result":"0x1","error":{"code":3}})", std::nullopt},
+        {R"({"id":null,"error":"overloaded"})", std::nullopt},
+        {R"({"id":1,"error":{"message":"no code"}})", std::nullopt},
+        {R"({"id":1,"error":{"code":-32)", std::nullopt},
+        {R"({"id":1,"error":{"code":-32000,"message":"cut)", std::nullopt},
+    };
+    for (const Case& test : cases) {
+        check(findErrorCode(test.json) == test.code, "findErrorCode", test.json);
+    }
+}
+
+void testResponseSpans() {
+    const std::string_view success = R"({"jsonrpc":"2.0", "id" : "a\"b" , "result" : {"error":{"code":1},"result":[1]} })";
+    std::optional<ResponseSpans> spans = findResponseSpans(success);
+    check(spans && text(success, spans->result) == R"({"error":{"code":1},"result":[1]})" && !spans->error,
+          "result with nested error and result members", success);
+
+    const std::string_view failure = R"({"id":null,"error":{"code":-32700,"message":"a \\ b \" c"}})";
+    spans = findResponseSpans(failure);
+    check(spans && !spans->result && text(failure, spans->error) == R"({"code":-32700,"message":"a \\ b \" c"})",
+          "error with escapes, null id", failure);
+
+    const std::string_view plain = R"({"id":1,"result":"0x10"})";
+    spans = findResponseSpans(plain);
+    check(spans && text(plain, spans->result) == "\"0x10\"", "string result", plain);
+    check(findResponseSpans("{}") && !findResponseSpans("{}")->result, "empty object", "{}");
+
+    for (const std::string_view truncated : {R"({"id":1,"result":"0x1)", R"({"id":1,"result":[1,2)", R"({"id":1,"result":1)",
+                                            R"({"id":1,"result":"0x1\")", R"({"id":1,"res)", R"({"id":1,)", R"({)", ""}) {
+        check(!findResponseSpans(truncated), "truncated response is rejected", truncated);
+    }
+    check(!findResponseSpans(R"([{"id":1,"result":1}])"), "batch is not a response object", "[...]");
+}
+
+void testPlainString() {
+    check(findPlainString(R"("0x1f")") == "0x1f", "plain string", "\"0x1f\"");
+    check(findPlainString(R"("")") == "", "empty string", "\"\"");
+    check(!findPlainString(R"("a\"b")"), "escaped quote needs unescaping", R"("a\"b")");
+    check(!findPlainString(R"("a\\")"), "escaped backslash needs unescaping", R"("a\\")");
+    check(!findPlainString(R"("abc)") && !findPlainString("\""), "cut-off string", "\"abc");
+    check(!findPlainString("12") && !findPlainString("null"), "non-strings", "12");
+    check(!findPlainString("\"a\nb\""), "control character", "\"a\\nb\"");
+}
+}
+
+int main() {
+    testIdSpans();
+    testMemberSpan();
+    testElementSpans();
+    testMethods();
+    testErrorCode();
+    testResponseSpans();
+    testPlainString();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file jsonstreamparsertest.cpp
+ * @brief Checks that JsonStreamParser gives the same elements and remainder however a response is split into chunks.
+ *
+ * Random responses, with the streamed array at "result" or at "result.transactions"
+ * or absent (an error response), are fed in random pieces of 1 to 40 bytes. The
+ * elements must equal the array jsoncpp parses from the whole text, and the
+ * remainder must parse to the response with that array emptied. Half of the
+ * documents use the jsoncpp element parser and half SimdJsonBackend.
+ */
+#include "jsonstreamparser.hpp"
+#include "simdjsonbackend.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+std::mt19937_64 engine(20240612);
+
+std::size_t failures = 0;
+
+void fail(const std::string& what, const std::string& document) {
+    if (++failures <= 10) {
+        std::cerr << "FAIL: " << what << "\n  document: " << document << std::endl;
+    }
+}
+
+/**
+ * @brief A string whose contents look like JSON structure, so a parser that ignores quoting would go wrong.
+ */
+std::string randomString() {
+    static const char* const kPieces[] = {"abc", "\\\"q\\\"", "x\\\\", "[1,2]", "{\\\"k\\\":1}", "\\u00e9", "", " ,]}"};
+    return std::string("\"") + kPieces[engine() % std::size(kPieces)] + kPieces[engine() % std::size(kPieces)] + "\"";
+}
+
+std::string randomValue(int depth) {
+    switch (engine() % (depth > 3 ? 4 : 7)) {
+    case 0:
+        return std::to_string(static_cast<int>(engine() % 1000) - 500);
+    case 1:
+        return randomString();
+    case 2:
+        return engine() % 2 ? "true" : "null";
+    case 3:
+        return "1.5e3";
+    case 4: {
+        std::string text = "[";
+        for (std::size_t i = 0, elements = engine() % 4; i < elements; ++i) {
+            text += (i > 0 ? (engine() % 2 ? ", " : ",") : "") + randomValue(depth + 1);
+        }
+        return text + " ]";
+    }
+    default: {
+        std::string text = "{";
+        for (std::size_t i = 0, members = engine() % 4; i < members; ++i) {
+            text += (i > 0 ? "," : "") + randomString() + " : " + randomValue(depth + 1);
+        }
+        return text + "}";
+    }
+    }
+}
+}
+
+int main() {
+    Json::CharReaderBuilder builder;
+    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    const Ref<JsonBackend> simd = CreateRef<SimdJsonBackend>();
+
+    constexpr std::size_t kDocuments = 20000;
+    for (std::size_t n = 0; n < kDocuments; ++n) {
+        std::string array = "[ ";
+        for (std::size_t i = 0, elements = engine() % 6; i < elements; ++i) {
+            array += (i > 0 ? " ,\n" : "") + randomValue(1);
+        }
+        array += " ]";
+
+        // The decoy keys check that only the full path matches, not a key of the same name elsewhere.
+        std::string document;
+        std::vector<std::string> path;
+        const std::size_t shape = engine() % 3;
+        if (shape == 0) {
+            document = "{\"jsonrpc\":\"2.0\", \"id\":1,\"result\" : " + array + "}";
+            path = {"result"};
+        } else if (shape == 1) {
+            document = "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"number\":\"0x1\",\"transactionsRoot\":\"x\","
+                       "\"nested\":{\"transactions\":[9]},\"transactions\":" + array + ",\"z\":[1]}}";
+            path = {"result", "transactions"};
+        } else {
+            document = "{\"id\":1,\"error\":{\"code\":-1,\"message\":\"result\"}}";
+            path = {"result"};
+        }
+
+        Json::Value whole;
+        std::string errors;
+        if (!reader->parse(document.data(), document.data() + document.size(), &whole, &errors)) {
+            fail("jsoncpp rejects a generated document: " + errors, document);
+            continue;
+        }
+        Json::Value expectedElements(Json::arrayValue);
+        Json::Value expectedRemainder = whole;
+        if (shape == 0) {
+            expectedElements = whole["result"];
+            expectedRemainder["result"] = Json::Value(Json::arrayValue);
+        } else if (shape == 1) {
+            expectedElements = whole["result"]["transactions"];
+            expectedRemainder["result"]["transactions"] = Json::Value(Json::arrayValue);
+        }
+
+        Json::Value elements(Json::arrayValue);
+        JsonStreamParser parser(path, [&elements](Json::Value& element) {
+            elements.append(element);
+            return true;
+        }, n % 2 ? simd : nullptr);
+        bool accepted = true;
+        for (std::size_t at = 0; at < document.size();) {
+            const std::size_t size = std::min<std::size_t>(1 + engine() % (engine() % 3 == 0 ? 3 : 40), document.size() - at);
+            accepted = parser.feed(std::string_view(document).substr(at, size)) && accepted;
+            at += size;
+        }
+        accepted = parser.finish() && accepted;
+        if (!accepted) {
+            fail("parser rejects a valid document: " + parser.error(), document);
+            continue;
+        }
+
+        Json::Value remainder;
+        const std::string& text = parser.remainder();
+        if (!reader->parse(text.data(), text.data() + text.size(), &remainder, &errors)) {
+            fail("remainder is not valid JSON: " + text, document);
+        } else if (remainder != expectedRemainder) {
+            fail("remainder differs: " + text, document);
+        }
+        if (elements != expectedElements) {
+            fail("elements differ", document);
+        }
+    }
+
+    // Malformed text, a truncated response and a callback that stops must all end parsing.
+    {
+        JsonStreamParser parser({"result"}, [](Json::Value&) { return true; });
+        if (parser.feed("{\"result\":[1}") || parser.error().empty()) {
+            fail("a mismatched bracket is accepted", "{\"result\":[1}");
+        }
+    }
+    {
+        JsonStreamParser parser({"result"}, [](Json::Value&) { return true; });
+        parser.feed("{\"result\":[1,2");
+        if (parser.finish()) {
+            fail("a truncated response is accepted", "{\"result\":[1,2");
+        }
+    }
+    {
+        std::size_t seen = 0;
+        JsonStreamParser parser({"result"}, [&seen](Json::Value&) { return ++seen < 2; });
+        if (parser.feed("{\"result\":[1,2,3]}") || !parser.stopped() || seen != 2) {
+            fail("a stop from the callback is ignored", "{\"result\":[1,2,3]}");
+        }
+    }
+    {
+        JsonStreamParser parser({"result"}, [](Json::Value&) { return true; });
+        if (parser.feed("{\"result\":[{\"a\":tru}]}")) {
+            fail("a malformed element is accepted", "{\"result\":[{\"a\":tru}]}");
+        }
+    }
+
+    std::cout << kDocuments << " documents; " << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file microbatchtransporttest.cpp
+ * @brief Tests of MicroBatchTransport over a LoopbackTransport that also answers batches.
+ *
+ * The inner transport answers the calls of a batch in reverse order, so the
+ * decorator must match answers by id, and can hold requests until released to
+ * let deadlines run out while a batch is in flight.
+ */
+#include "loopbacktransport.hpp"
+#include "microbatchtransport.hpp"
+#include <json/json.h>
+#include <future>
+#include <iostream>
+
+namespace {
+std::size_t failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "FAIL: " << what << std::endl;
+    }
+}
+
+Json::Value parse(const std::string& text) {
+    Json::Value value;
+    Json::CharReaderBuilder builder;
+    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errors;
+    reader->parse(text.data(), text.data() + text.size(), &value, &errors);
+    return value;
+}
+
+std::string request(const std::string& id, const std::string& param) {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"method\":\"echo\",\"params\":[\"" + param + "\"]}";
+}
+
+/**
+ * @brief Answers single calls through a LoopbackTransport and batches element by element, in reverse.
+ */
+class BatchLoopback final : public Transport {
+public:
+    BatchLoopback() {
+        loopback.setGenerator("echo", [](std::string_view request) {
+            const Json::Value message = parse(std::string(request));
+            return "\"" + message["params"][0].asString() + "\"";
+        });
+    }
+
+    std::optional<std::string> sendPostRequest(const std::string&, const std::string& data) override {
+        return answer(data);
+    }
+
+    void sendPostRequestAsync(const std::string&, const std::string& data, Callback callback, RequestContext* context) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bodies.push_back(data);
+            if (hold) {
+                held.emplace_back(data, std::move(callback));
+                return;
+            }
+        }
+        if (context) {
+            context->failure = FailureKind::None;
+        }
+        callback(answer(data));
+    }
+
+    /**
+     * @brief Answers the requests held so far.
+     */
+    void release() {
+        std::vector<std::pair<std::string, Callback>> due;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            due.swap(held);
+            hold = false;
+        }
+        for (auto& [data, callback] : due) {
+            callback(answer(data));
+        }
+    }
+
+    std::vector<std::string> sent() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bodies;
+    }
+
+    bool hold = false; ///< Set before sending to keep requests unanswered until release().
+
+private:
+    std::optional<std::string> answer(const std::string& data) {
+        const std::string_view text(data);
+        if (text.front() != '[') {
+            return loopback.sendPostRequest("", data);
+        }
+        std::string response = "[";
+        const std::vector<JsonSpan> elements = findElementSpans(text);
+        for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+            const std::optional<std::string> single = loopback.sendPostRequest("", std::string(text.substr(it->begin, it->end - it->begin)));
+            response += (response.size() > 1 ? "," : "") + single.value_or("null");
+        }
+        return response + "]";
+    }
+
+    LoopbackTransport loopback;
+    std::mutex mutex;
+    std::vector<std::string> bodies;
+    std::vector<std::pair<std::string, Callback>> held;
+};
+
+using Future = std::future<std::optional<std::string>>;
+
+Future sendAsync(Transport& transport, const std::string& data, RequestContext* context = nullptr) {
+    auto promise = CreateRef<std::promise<std::optional<std::string>>>();
+    Future future = promise->get_future();
+    transport.sendPostRequestAsync("loopback", data, [promise](std::optional<std::string> response) {
+        promise->set_value(std::move(response));
+    }, context);
+    return future;
+}
+
+std::optional<std::string> await(Future& future) {
+    if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+        return "no callback";
+    }
+    return future.get();
+}
+
+void testSplitting() {
+    BatchLoopback inner;
+    MicroBatchTransport transport(MicroBatchOptions {std::chrono::milliseconds(50), 3}, inner);
+    const std::vector<std::string> ids = {"1", "\"a\"", "3", "\"b\\\"c\"", "5", "6", "7"};
+    std::vector<Future> futures;
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        futures.push_back(sendAsync(transport, request(ids[i], "p" + std::to_string(i))));
+    }
+
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        const std::optional<std::string> response = await(futures[i]);
+        const Json::Value answer = response ? parse(*response) : Json::Value();
+        check(answer["result"] == "p" + std::to_string(i), "call " + std::to_string(i) + " gets its own answer");
+        check(answer["id"] == parse(ids[i]), "call " + std::to_string(i) + " gets its original id back");
+    }
+
+    const std::vector<std::string> sent = inner.sent();
+    check(sent.size() == 3, "seven calls with a cap of three go out as three requests");
+    if (sent.size() == 3) {
+        const Json::Value first = parse(sent[0]);
+        check(first.isArray() && first.size() == 3 && first[0]["id"] == 0 && first[2]["id"] == 2,
+              "a full batch carries positional ids");
+        check(sent[2] == request(ids[6], "p6"), "the call left alone in its window is sent unchanged");
+    }
+    const MicroBatchStats stats = transport.stats();
+    check(stats.calls == 7 && stats.requests == 3 && stats.fullBatches == 2, "stats count calls, requests and full batches");
+}
+
+void testBlockingCallJoinsBatch() {
+    BatchLoopback inner;
+    MicroBatchTransport transport(MicroBatchOptions {std::chrono::milliseconds(50), 2}, inner);
+    Future pending = sendAsync(transport, request("\"async\"", "first"));
+    std::string response;
+    const bool answered = transport.sendPostRequestInto("loopback", request("9", "second"), response);
+    check(answered && parse(response)["id"] == 9 && parse(response)["result"] == "second", "blocking call is answered from the batch");
+    check(await(pending).has_value() && inner.sent().size() == 1, "both calls share one request");
+}
+
+void testDeadline() {
+    BatchLoopback inner;
+    inner.hold = true;
+    MicroBatchTransport transport(MicroBatchOptions {std::chrono::milliseconds(5), 10}, inner);
+    RequestContext context;
+    const auto start = std::chrono::steady_clock::now();
+    context.deadline = start + std::chrono::milliseconds(100);
+    std::atomic<int> expiredCalls {0};
+    std::promise<void> expired;
+    transport.sendPostRequestAsync("loopback", request("1", "late"), [&](std::optional<std::string> response) {
+        if (++expiredCalls == 1) {
+            check(!response, "call past its deadline fails");
+            expired.set_value();
+        }
+    }, &context);
+    Future patient = sendAsync(transport, request("2", "patient"));
+
+    check(expired.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready, "deadline fires while the batch is held");
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    check(elapsed >= std::chrono::milliseconds(100), "deadline is not early");
+    check(context.failure == FailureKind::Timeout, "expired call reports FailureKind::Timeout");
+
+    inner.release();
+    const std::optional<std::string> response = await(patient);
+    check(response && parse(*response)["result"] == "patient", "other call of the batch is still answered");
+    check(expiredCalls == 1, "late answer of an expired call is dropped");
+}
+
+void testTimerCancel() {
+    auto token = CreateRef<int>(0);
+    std::atomic<bool> ran {false};
+    TimerQueue::Timer outlived;
+    {
+        TimerQueue timers;
+        TimerQueue::Timer distant = timers.schedule(std::chrono::steady_clock::now() + std::chrono::hours(1), [token] {});
+        check(token.use_count() == 2, "scheduled task holds its captures");
+        distant.cancel();
+        check(token.use_count() == 1, "cancelled task is released at once, not at its deadline");
+
+        TimerQueue::Timer soon = timers.schedule(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), [&ran] { ran = true; });
+        soon.cancel();
+        soon.cancel();
+        outlived = timers.schedule(std::chrono::steady_clock::now() + std::chrono::hours(1), [token] {});
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    }
+    check(!ran, "cancelled task does not run");
+    check(token.use_count() == 1, "destroyed queue releases its pending tasks");
+    outlived.cancel();
+}
+}
+
+int main() {
+    testSplitting();
+    testBlockingCallJoinsBatch();
+    testDeadline();
+    testTimerCancel();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
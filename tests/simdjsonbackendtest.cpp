@@ -0,0 +1,169 @@
+/**
+ * @file simdjsonbackendtest.cpp
+ * @brief Differential test of SimdJsonBackend against jsoncpp, and of its SIMD levels against each other.
+ *
+ * Random documents, a third of them corrupted by one edit, are parsed by jsoncpp
+ * and by SimdJsonBackend at every level the CPU supports. Every level must
+ * accept and reject the same documents and produce the same value and first-stage
+ * index. A document the backend accepts must be accepted by jsoncpp with an
+ * equal value. jsoncpp may accept more: it tolerates unpaired surrogate escapes
+ * and objects cut off at the end of the text.
+ */
+#include "simdjsonbackend.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+std::mt19937_64 engine(20240611);
+
+std::size_t failures = 0;
+
+void fail(const std::string& what, const std::string& document) {
+    if (++failures <= 10) {
+        std::cerr << "FAIL: " << what << "\n  document: " << document << std::endl;
+    }
+}
+
+std::string randomString() {
+    static const char* const kPieces[] = {"a", "0x", "\\\"", "\\\\", "\\n", "\\u00e9", "\\ud83d\\ude00", "{", "}",
+                                          "[", "]", ":", ",", " ", "\xc3\xa9", "\\/"};
+    std::string text = "\"";
+    for (std::size_t i = engine() % 12; i > 0; --i) {
+        text += kPieces[engine() % std::size(kPieces)];
+    }
+    return text + "\"";
+}
+
+std::string randomDocument(int depth) {
+    static const char* const kNumbers[] = {"0", "-1", "123", "18446744073709551615", "9223372036854775807",
+                                           "9223372036854775808", "-9223372036854775808", "1.5", "-0.25e3", "1E+2", "3.14159"};
+    static const char* const kSpace[] = {"", " ", "\n  ", "\t"};
+    const auto space = []() { return std::string(kSpace[engine() % std::size(kSpace)]); };
+
+    switch (engine() % (depth > 5 ? 5 : 8)) {
+    case 0:
+        return randomString();
+    case 1:
+        return kNumbers[engine() % std::size(kNumbers)];
+    case 2:
+        return "true";
+    case 3:
+        return "false";
+    case 4:
+        return "null";
+    case 5:
+    case 6: {
+        std::string text = "{" + space();
+        for (std::size_t i = 0, members = engine() % 5; i < members; ++i) {
+            text += (i > 0 ? "," + space() : "") + randomString() + space() + ":" + space() + randomDocument(depth + 1);
+        }
+        return text + space() + "}";
+    }
+    default: {
+        std::string text = "[" + space();
+        for (std::size_t i = 0, elements = engine() % 5; i < elements; ++i) {
+            text += (i > 0 ? space() + "," : "") + randomDocument(depth + 1);
+        }
+        return text + "]";
+    }
+    }
+}
+
+/**
+ * @brief Deletes, inserts or replaces one byte with a character likely to matter to a JSON parser.
+ */
+void corrupt(std::string& document) {
+    static constexpr std::string_view kBytes = "{}[]:,\"\\ x1";
+    if (document.empty()) {
+        return;
+    }
+    const std::size_t at = engine() % document.size();
+    const char byte = kBytes[engine() % kBytes.size()];
+    switch (engine() % 3) {
+    case 0:
+        document.erase(at, 1);
+        break;
+    case 1:
+        document.insert(at, 1, byte);
+        break;
+    default:
+        document[at] = byte;
+        break;
+    }
+}
+}
+
+int main() {
+    Json::CharReaderBuilder builder;
+    builder["failIfExtra"] = true;
+    builder["allowComments"] = false;
+    builder["allowSpecialFloats"] = false;
+    builder["allowTrailingCommas"] = false;
+    const std::unique_ptr<Json::CharReader> reference(builder.newCharReader());
+
+    std::vector<SimdJsonBackend> backends;
+    for (const SimdLevel level : {SimdLevel::Scalar, SimdLevel::Sse42, SimdLevel::Avx2}) {
+        if (level <= SimdJsonBackend::detectLevel()) {
+            backends.emplace_back(level);
+        }
+    }
+    std::cout << "Levels under test:";
+    for (const SimdJsonBackend& backend : backends) {
+        std::cout << ' ' << simdLevelName(backend.level());
+    }
+    std::cout << std::endl;
+
+    constexpr std::size_t kDocuments = 20000;
+    std::size_t accepted = 0;
+    for (std::size_t n = 0; n < kDocuments; ++n) {
+        std::string document = randomDocument(0);
+        if (n % 3 == 0) {
+            corrupt(document);
+        }
+
+        Json::Value expected;
+        std::string errors;
+        const bool referenceAccepts = reference->parse(document.data(), document.data() + document.size(), &expected, &errors);
+
+        std::optional<bool> firstAccepts;
+        Json::Value firstValue;
+        for (SimdJsonBackend& backend : backends) {
+            Json::Value value;
+            const bool accepts = backend.parse(document, value, &errors);
+            const std::string level(simdLevelName(backend.level()));
+            if (accepts && !referenceAccepts) {
+                fail(level + " accepts a document jsoncpp rejects", document);
+            }
+            if (accepts && referenceAccepts && value != expected) {
+                fail(level + " parses a different value than jsoncpp", document);
+            }
+            if (!firstAccepts) {
+                firstAccepts = accepts;
+                firstValue = value;
+            } else if (accepts != *firstAccepts || (accepts && value != firstValue)) {
+                fail(level + " disagrees with " + std::string(simdLevelName(backends.front().level())), document);
+            }
+        }
+        accepted += firstAccepts.value_or(false) ? 1 : 0;
+    }
+
+    // Long runs of quotes, backslashes and operators cross the 64-byte blocks of the first stage.
+    constexpr std::string_view kIndexBytes = "\"\\ {}[]:, a1\n";
+    for (std::size_t n = 0; n < kDocuments; ++n) {
+        std::string document;
+        for (std::size_t i = engine() % 400; i > 0; --i) {
+            document += kIndexBytes[engine() % kIndexBytes.size()];
+        }
+        std::vector<std::uint32_t> expected;
+        const bool complete = backends.front().buildIndex(document, expected);
+        for (const SimdJsonBackend& backend : backends) {
+            std::vector<std::uint32_t> index;
+            if (backend.buildIndex(document, index) != complete || index != expected) {
+                fail(std::string(simdLevelName(backend.level())) + " builds a different index", document);
+            }
+        }
+    }
+
+    std::cout << kDocuments << " documents, " << accepted << " accepted; " << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file singleflighttransporttest.cpp
+ * @brief Tests of SingleFlightTransport over a LoopbackTransport that holds requests until told otherwise.
+ *
+ * Holding the shared request lets the tests attach several callers to it, let
+ * their deadlines and cancellations run out, and then answer or fail it.
+ */
+#include "loopbacktransport.hpp"
+#include "singleflighttransport.hpp"
+#include <json/json.h>
+#include <future>
+#include <iostream>
+
+namespace {
+std::size_t failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "FAIL: " << what << std::endl;
+    }
+}
+
+std::string request(int id, const std::string& method = "eth_blockNumber") {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) + ",\"method\":\"" + method + "\",\"params\":[]}";
+}
+
+/**
+ * @brief Keeps asynchronous requests until release() answers them through a LoopbackTransport, or fail() fails one.
+ */
+class HeldLoopback final : public Transport {
+public:
+    HeldLoopback() {
+        loopback.setResult("eth_blockNumber", "\"0x10\"");
+        loopback.setResult("eth_sendRawTransaction", "\"0xabc\"");
+    }
+
+    std::optional<std::string> sendPostRequest(const std::string& url, const std::string& data) override {
+        return loopback.sendPostRequest(url, data);
+    }
+
+    void sendPostRequestAsync(const std::string&, const std::string& data, Callback callback, RequestContext* context) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        held.push_back(Held {data, std::move(callback), context});
+    }
+
+    /**
+     * @brief Answers every held request, or fails it with FailureKind::Cancelled if its caller stopped it.
+     */
+    void release() {
+        for (Held& request : take()) {
+            if (request.context && request.context->cancellation.stop_requested()) {
+                request.context->failure = FailureKind::Cancelled;
+                request.callback(std::nullopt);
+                continue;
+            }
+            if (request.context) {
+                request.context->failure = FailureKind::None;
+            }
+            request.callback(loopback.sendPostRequest("", request.data));
+        }
+    }
+
+    /**
+     * @brief Fails every held request the way a transport does when its budget runs out.
+     */
+    void fail(FailureKind failure) {
+        for (Held& request : take()) {
+            if (request.context) {
+                request.context->failure = failure;
+            }
+            request.callback(std::nullopt);
+        }
+    }
+
+    std::size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return held.size();
+    }
+
+    bool stopRequested() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !held.empty() && held.front().context && held.front().context->cancellation.stop_requested();
+    }
+
+    std::uint64_t requestCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sent;
+    }
+
+private:
+    struct Held {
+        std::string data;
+        Callback callback;
+        RequestContext* context;
+    };
+
+    std::vector<Held> take() {
+        std::lock_guard<std::mutex> lock(mutex);
+        sent += held.size();
+        return std::exchange(held, {});
+    }
+
+    LoopbackTransport loopback;
+    std::mutex mutex;
+    std::vector<Held> held;
+    std::uint64_t sent = 0;
+};
+
+/**
+ * @brief A caller's context and the response its callback received.
+ */
+struct Caller {
+    RequestContext context;
+    std::promise<std::optional<std::string>> promise;
+    std::future<std::optional<std::string>> future = promise.get_future();
+    std::atomic<int> callbacks {0};
+
+    void send(Transport& transport, const std::string& data) {
+        transport.sendPostRequestAsync("loopback", data, [this](std::optional<std::string> response) {
+            if (++callbacks == 1) {
+                promise.set_value(std::move(response));
+            }
+        }, &context);
+    }
+
+    std::optional<std::string> await() {
+        if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+            return "no callback";
+        }
+        return future.get();
+    }
+
+    bool ready() {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+};
+
+bool answered(const std::optional<std::string>& response) {
+    return response && response->find("\"0x10\"") != std::string::npos;
+}
+
+void testCollapse() {
+    HeldLoopback inner;
+    SingleFlightTransport transport(inner);
+    std::array<Caller, 5> callers;
+    for (std::size_t i = 0; i < callers.size(); ++i) {
+        callers[i].send(transport, request(static_cast<int>(i + 1)));
+    }
+    check(inner.pending() == 1, "identical calls share one request");
+    inner.release();
+    for (Caller& caller : callers) {
+        check(answered(caller.await()), "every caller receives the shared response");
+        check(caller.context.failure == FailureKind::None, "shared response reports no failure");
+    }
+
+    Caller first;
+    Caller second;
+    first.send(transport, request(1, "eth_sendRawTransaction"));
+    second.send(transport, request(2, "eth_sendRawTransaction"));
+    check(inner.pending() == 2, "non-idempotent calls are each sent");
+    inner.release();
+    check(first.await().has_value() && second.await().has_value(), "non-idempotent calls are answered");
+
+    const SingleFlightStats stats = transport.stats();
+    check(stats.calls == 5 && stats.requests == 1 && stats.collapsed == 4, "stats count the collapsed calls");
+}
+
+void testRejoinAfterTimeout() {
+    HeldLoopback inner;
+    SingleFlightTransport transport(inner);
+    const auto start = std::chrono::steady_clock::now();
+    Caller hasty;
+    hasty.context.deadline = start + std::chrono::milliseconds(50);
+    Caller patient;
+    patient.context.deadline = start + std::chrono::seconds(10);
+    Caller unbounded;
+    hasty.send(transport, request(1));
+    patient.send(transport, request(2));
+    unbounded.send(transport, request(3));
+    check(inner.pending() == 1, "later callers join the first caller's request");
+
+    check(!hasty.await() && hasty.context.failure == FailureKind::Timeout, "first caller times out at its own deadline");
+    check(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50), "deadline is not early");
+    check(!inner.stopRequested(), "request is kept while other callers wait for it");
+
+    // The shared request was bounded by the first caller's deadline and runs out too.
+    inner.fail(FailureKind::Timeout);
+    check(!patient.ready() && !unbounded.ready(), "callers with budget left are not failed");
+    check(inner.pending() == 1, "callers with budget left are sent again, together");
+    inner.release();
+    check(answered(patient.await()) && answered(unbounded.await()), "rejoined callers are answered");
+    check(hasty.callbacks == 1, "expired caller is completed once");
+    check(transport.stats().rejoined == 2, "stats count the rejoined callers");
+}
+
+void testAbortWhenAllAbandon() {
+    HeldLoopback inner;
+    SingleFlightTransport transport(inner);
+    std::stop_source firstStop;
+    std::stop_source secondStop;
+    Caller first;
+    first.context.cancellation = firstStop.get_token();
+    Caller second;
+    second.context.cancellation = secondStop.get_token();
+    first.send(transport, request(1));
+    second.send(transport, request(2));
+
+    firstStop.request_stop();
+    check(!first.await() && first.context.failure == FailureKind::Cancelled, "cancelled caller fails at once");
+    check(!inner.stopRequested(), "request goes on while one caller still waits");
+    secondStop.request_stop();
+    check(!second.await() && second.context.failure == FailureKind::Cancelled, "last caller is cancelled too");
+    check(inner.stopRequested(), "request is aborted once every caller gave up");
+
+    Caller later;
+    later.send(transport, request(3));
+    check(inner.pending() == 2, "a new call after the abort starts its own request");
+    inner.release();
+    check(answered(later.await()), "new request is answered");
+    check(first.callbacks == 1 && second.callbacks == 1, "aborted request's failure reaches nobody again");
+}
+}
+
+int main() {
+    testCollapse();
+    testRejoinAfterTimeout();
+    testAbortWhenAllAbandon();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,510 @@
+/**
+ * @file websocketadaptertest.cpp
+ * @brief Tests of WebSocketAdapter against an in-process WebSocket stand-in node.
+ *
+ * The stand-in performs the HTTP upgrade and speaks just enough of RFC 6455 for
+ * eth_subscribe: it confirms each subscription with a fresh server id, unique
+ * across connections, and sends eth_subscription notifications on request, whole
+ * or fragmented into continuation frames. Subscriptions of kind "silent" are never
+ * answered. Exits with 77, which CTest reports as skipped, when libcurl has no
+ * WebSocket support.
+ */
+#include "websocketadapter.hpp"
+#include <arpa/inet.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kSkipped = 77;
+
+std::size_t failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        ++failures;
+        std::cerr << "FAIL: " << what << std::endl;
+    }
+}
+
+/**
+ * @brief Polls @p condition until it holds or five seconds pass.
+ */
+template <typename Condition>
+bool eventually(Condition condition) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+bool hasWebSockets() {
+    for (const char* const* protocol = curl_version_info(CURLVERSION_NOW)->protocols; *protocol; ++protocol) {
+        if (std::string_view(*protocol) == "ws") {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string write(const Json::Value& value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
+
+/**
+ * @brief Minimal WebSocket JSON-RPC node on a loopback port, one thread per connection.
+ */
+class StandInNode {
+public:
+    StandInNode() {
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0 || listen(listener, 16) != 0
+            || getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            std::cerr << "stand-in node cannot listen" << std::endl;
+        }
+        port = ntohs(address.sin_port);
+        acceptor = std::thread([this]() { acceptLoop(); });
+    }
+
+    ~StandInNode() {
+        stopping = true;
+        shutdown(listener, SHUT_RDWR);
+        acceptor.join();
+        drop();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        close(listener);
+    }
+
+    std::string url() const { return "ws://127.0.0.1:" + std::to_string(port); }
+
+    /**
+     * @brief While set, upgrade requests are answered with 503, so the adapter cannot reconnect.
+     */
+    void refuse(bool value) { refusing = value; }
+
+    /**
+     * @brief Closes every connection without a close frame, as a crashed node would.
+     */
+    void drop() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const int fd : open) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        open.clear();
+    }
+
+    /**
+     * @brief Sends an eth_subscription notification on every open connection.
+     * @param fragments Number of frames to split the message into.
+     */
+    void notify(const std::string& serverId, const Json::Value& result, std::size_t fragments = 1) {
+        Json::Value message;
+        message["jsonrpc"] = "2.0";
+        message["method"] = "eth_subscription";
+        message["params"]["subscription"] = serverId;
+        message["params"]["result"] = result;
+        const std::string text = write(message);
+        const std::size_t piece = (text.size() + fragments - 1) / fragments;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const int fd : open) {
+            for (std::size_t offset = 0; offset < text.size(); offset += piece) {
+                const bool last = offset + piece >= text.size();
+                sendFrame(fd, offset == 0 ? 0x1 : 0x0, last, std::string_view(text).substr(offset, piece));
+            }
+        }
+    }
+
+    /**
+     * @brief Server ids handed out for subscriptions of the given kind, in order.
+     */
+    std::vector<std::string> subscribed(const std::string& kind) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::string> ids;
+        for (const auto& [id, subscriptionKind] : subscriptions) {
+            if (subscriptionKind == kind) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    std::vector<std::string> unsubscribed() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cancelled;
+    }
+
+    std::size_t connectionsAccepted() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return accepted;
+    }
+
+private:
+    void acceptLoop() {
+        while (!stopping) {
+            const int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.emplace_back([this, fd]() { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        if (upgrade(fd)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++accepted;
+                open.insert(fd);
+            }
+            std::string payload;
+            while (readMessage(fd, payload)) {
+                answer(fd, payload);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            open.erase(fd);
+        }
+        close(fd);
+    }
+
+    bool upgrade(int fd) {
+        std::string request;
+        char chunk[1024];
+        while (request.find("\r\n\r\n") == std::string::npos) {
+            const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            request.append(chunk, static_cast<std::size_t>(received));
+        }
+        if (refusing) {
+            sendAll(fd, "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            return false;
+        }
+
+        constexpr std::string_view kKeyHeader = "sec-websocket-key:";
+        std::string lower = request;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        const std::size_t at = lower.find(kKeyHeader);
+        if (at == std::string::npos) {
+            return false;
+        }
+        std::string key = request.substr(at + kKeyHeader.size(), request.find("\r\n", at) - at - kKeyHeader.size());
+        key.erase(0, key.find_first_not_of(' '));
+        key += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+        unsigned char digest[SHA_DIGEST_LENGTH];
+        SHA1(reinterpret_cast<const unsigned char*>(key.data()), key.size(), digest);
+        unsigned char accept[32] = {};
+        EVP_EncodeBlock(accept, digest, SHA_DIGEST_LENGTH);
+        return sendAll(fd, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: "
+                               + std::string(reinterpret_cast<const char*>(accept)) + "\r\n\r\n");
+    }
+
+    /**
+     * @brief Reads one whole text message, answering pings and skipping other control frames.
+     */
+    bool readMessage(int fd, std::string& payload) {
+        payload.clear();
+        while (true) {
+            unsigned char head[2];
+            if (!receiveAll(fd, head, 2)) {
+                return false;
+            }
+            const bool fin = head[0] & 0x80;
+            const int opcode = head[0] & 0x0f;
+            std::uint64_t length = head[1] & 0x7f;
+            if (length >= 126) {
+                unsigned char extended[8];
+                const std::size_t bytes = length == 126 ? 2 : 8;
+                if (!receiveAll(fd, extended, bytes)) {
+                    return false;
+                }
+                length = 0;
+                for (std::size_t i = 0; i < bytes; ++i) {
+                    length = (length << 8) | extended[i];
+                }
+            }
+            unsigned char mask[4] = {};
+            if ((head[1] & 0x80) && !receiveAll(fd, mask, 4)) {
+                return false;
+            }
+            std::string data(length, '\0');
+            if (length > 0 && !receiveAll(fd, data.data(), length)) {
+                return false;
+            }
+            for (std::size_t i = 0; i < data.size(); ++i) {
+                data[i] = static_cast<char>(data[i] ^ mask[i % 4]);
+            }
+            if (opcode == 0x8) {
+                return false;
+            }
+            if (opcode == 0x9) {
+                std::lock_guard<std::mutex> lock(mutex);
+                sendFrame(fd, 0xa, true, data);
+                continue;
+            }
+            if (opcode >= 0x8) {
+                continue;
+            }
+            payload += data;
+            if (fin) {
+                return true;
+            }
+        }
+    }
+
+    void answer(int fd, const std::string& payload) {
+        Json::Value request;
+        Json::CharReaderBuilder builder;
+        const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        std::string errors;
+        if (!reader->parse(payload.data(), payload.data() + payload.size(), &request, &errors)) {
+            return;
+        }
+        Json::Value response;
+        response["jsonrpc"] = "2.0";
+        response["id"] = request["id"];
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::string method = request["method"].asString();
+        if (method == "eth_subscribe") {
+            const std::string kind = request["params"][0].asString();
+            if (kind == "silent") {
+                return;
+            }
+            const std::string id = "0x" + std::to_string(++lastId);
+            subscriptions.emplace_back(id, kind);
+            response["result"] = id;
+        } else if (method == "eth_unsubscribe") {
+            cancelled.push_back(request["params"][0].asString());
+            response["result"] = true;
+        } else {
+            response["error"]["code"] = -32601;
+            response["error"]["message"] = "method not found";
+        }
+        sendFrame(fd, 0x1, true, write(response));
+    }
+
+    static void sendFrame(int fd, int opcode, bool fin, std::string_view payload) {
+        std::string frame(1, static_cast<char>((fin ? 0x80 : 0x00) | opcode));
+        if (payload.size() < 126) {
+            frame += static_cast<char>(payload.size());
+        } else {
+            frame += static_cast<char>(126);
+            frame += static_cast<char>(payload.size() >> 8);
+            frame += static_cast<char>(payload.size() & 0xff);
+        }
+        frame += payload;
+        sendAll(fd, frame);
+    }
+
+    static bool sendAll(int fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t sent = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+            data.remove_prefix(static_cast<std::size_t>(sent));
+        }
+        return true;
+    }
+
+    static bool receiveAll(int fd, void* buffer, std::size_t length) {
+        auto* bytes = static_cast<char*>(buffer);
+        while (length > 0) {
+            const ssize_t received = recv(fd, bytes, length, 0);
+            if (received <= 0) {
+                return false;
+            }
+            bytes += received;
+            length -= static_cast<std::size_t>(received);
+        }
+        return true;
+    }
+
+    int listener = -1;
+    std::uint16_t port = 0;
+    std::atomic<bool> stopping {false};
+    std::atomic<bool> refusing {false};
+    std::thread acceptor;
+    std::mutex mutex;
+    std::set<int> open;
+    std::vector<std::thread> threads;
+    std::vector<std::pair<std::string, std::string>> subscriptions; ///< Server id and kind of every subscription.
+    std::vector<std::string> cancelled;
+    std::uint64_t lastId = 0;
+    std::size_t accepted = 0;
+};
+
+/**
+ * @brief Notification results received by one subscription.
+ */
+struct Received {
+    std::mutex mutex;
+    std::vector<Json::Value> results;
+
+    WebSocketAdapter::NotificationCallback callback() {
+        return [this](const Json::Value& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result);
+        };
+    }
+
+    std::size_t count() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return results.size();
+    }
+
+    Json::Value last() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return results.empty() ? Json::Value() : results.back();
+    }
+};
+
+WebSocketAdapterOptions fastOptions() {
+    WebSocketAdapterOptions options;
+    options.requestTimeout = std::chrono::seconds(5);
+    options.reconnectDelay = std::chrono::milliseconds(20);
+    options.maxReconnectDelay = std::chrono::milliseconds(100);
+    return options;
+}
+
+void testSubscribeAndNotify(StandInNode& node) {
+    WebSocketAdapter adapter(node.url(), fastOptions());
+    Received heads;
+    Received logs;
+    const std::optional<std::uint64_t> headsHandle = adapter.subscribeNewHeads(heads.callback());
+    const std::optional<std::uint64_t> logsHandle = adapter.subscribeLogs(Json::Value(Json::objectValue), logs.callback());
+    check(headsHandle && adapter.isSubscribed(*headsHandle), "newHeads subscription is confirmed");
+    check(logsHandle && adapter.isSubscribed(*logsHandle), "logs subscription is confirmed");
+    const std::vector<std::string> headIds = node.subscribed("newHeads");
+    check(headIds.size() == 1, "node received one newHeads subscription");
+    if (headIds.empty()) {
+        return;
+    }
+
+    Json::Value head;
+    head["number"] = "0x1";
+    node.notify(headIds.back(), head);
+    check(eventually([&]() { return heads.count() == 1; }) && heads.last()["number"] == "0x1", "notification reaches its callback");
+    check(logs.count() == 0, "notification is not routed to another subscription");
+
+    // A large notification split over continuation frames arrives as one message.
+    Json::Value bigHead;
+    bigHead["number"] = "0x2";
+    bigHead["extraData"] = std::string(3000, 'a');
+    node.notify(headIds.back(), bigHead, 4);
+    check(eventually([&]() { return heads.count() == 2; }) && heads.last() == bigHead, "fragmented notification is reassembled");
+}
+
+void testReconnect(StandInNode& node) {
+    WebSocketAdapter adapter(node.url(), fastOptions());
+    Received heads;
+    const std::optional<std::uint64_t> handle = adapter.subscribeNewHeads(heads.callback());
+    const std::size_t before = node.subscribed("newHeads").size();
+    check(handle && adapter.isSubscribed(*handle), "subscription confirmed before the drop");
+
+    node.drop();
+    check(eventually([&]() { return node.subscribed("newHeads").size() == before + 1; }), "subscription is replayed after reconnect");
+    check(eventually([&]() { return adapter.isSubscribed(*handle); }), "handle is confirmed again after reconnect");
+    const std::vector<std::string> ids = node.subscribed("newHeads");
+    if (ids.size() < 2) {
+        return;
+    }
+    check(ids[ids.size() - 1] != ids[ids.size() - 2], "node assigned a new server id");
+
+    Json::Value stale;
+    stale["number"] = "0xdead";
+    node.notify(ids[ids.size() - 2], stale);
+    Json::Value head;
+    head["number"] = "0x3";
+    node.notify(ids.back(), head);
+    check(eventually([&]() { return heads.count() == 1; }) && heads.last()["number"] == "0x3",
+          "only the new server id is routed to the callback");
+}
+
+void testUnsubscribeWhileDisconnected(StandInNode& node) {
+    WebSocketAdapter adapter(node.url(), fastOptions());
+    Received kept;
+    Received removed;
+    const std::optional<std::uint64_t> keptHandle = adapter.subscribeNewPendingTransactions(kept.callback());
+    const std::optional<std::uint64_t> removedHandle = adapter.subscribeLogs(Json::Value(Json::objectValue), removed.callback());
+    const std::size_t pendingBefore = node.subscribed("newPendingTransactions").size();
+    const std::size_t logsBefore = node.subscribed("logs").size();
+    const std::size_t unsubscribedBefore = node.unsubscribed().size();
+
+    node.refuse(true);
+    node.drop();
+    check(eventually([&]() { return !adapter.isConnected(); }), "adapter notices the drop");
+    check(removedHandle && adapter.unsubscribe(*removedHandle), "unsubscribe succeeds while disconnected");
+    check(removedHandle && !adapter.unsubscribe(*removedHandle), "second unsubscribe reports an unknown handle");
+    node.refuse(false);
+
+    check(eventually([&]() { return keptHandle && adapter.isSubscribed(*keptHandle); }), "remaining subscription is replayed");
+    check(node.subscribed("newPendingTransactions").size() == pendingBefore + 1, "remaining subscription subscribed once");
+    check(node.subscribed("logs").size() == logsBefore, "unsubscribed subscription is not replayed");
+    check(node.unsubscribed().size() == unsubscribedBefore, "nothing is unsubscribed on a connection that never had it");
+}
+
+void testUnconfirmed(StandInNode& node) {
+    WebSocketAdapterOptions options = fastOptions();
+    options.requestTimeout = std::chrono::milliseconds(200);
+    WebSocketAdapter adapter(node.url(), options);
+    Json::Value params(Json::arrayValue);
+    params.append("silent");
+    const std::optional<std::uint64_t> handle = adapter.subscribe(params, [](const Json::Value&) {});
+    check(handle && !adapter.isSubscribed(*handle), "unanswered subscription returns a handle that is not confirmed");
+}
+
+void testSubscribeFromCallback(StandInNode& node) {
+    WebSocketAdapter adapter(node.url(), fastOptions());
+    std::atomic<int> outcome {0};
+    adapter.subscribeNewHeads([&adapter, &outcome](const Json::Value&) {
+        outcome = adapter.subscribeNewHeads([](const Json::Value&) {}) ? 1 : 2;
+    });
+    const std::vector<std::string> ids = node.subscribed("newHeads");
+    if (ids.empty()) {
+        check(false, "subscription for the callback test is confirmed");
+        return;
+    }
+    node.notify(ids.back(), Json::Value("0x4"));
+    check(eventually([&]() { return outcome != 0; }) && outcome == 2, "subscribe() from a callback fails instead of deadlocking");
+}
+}
+
+int main() {
+    if (!hasWebSockets()) {
+        std::cout << "libcurl was built without WebSocket support; skipping." << std::endl;
+        return kSkipped;
+    }
+
+    StandInNode node;
+    testSubscribeAndNotify(node);
+    testReconnect(node);
+    testUnsubscribeWhileDisconnected(node);
+    testUnconfirmed(node);
+    testSubscribeFromCallback(node);
+
+    std::cout << node.connectionsAccepted() << " connections; " << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}